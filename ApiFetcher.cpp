@@ -1,126 +1,120 @@
 ﻿#include "ApiFetcher.h"
+#include "Log.h"
+#include "Utf8.h"
 
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-#include <windows.h>
-#include <winhttp.h>
-#include <sstream>
 #include <string>
 #include <vector>
-#include <mutex>
-#include <stdexcept>
-
-#pragma comment(lib, "winhttp.lib")
-
-static std::mutex apiMutex;
-
-double ApiFetcher::FetchPrice(const std::wstring& symbol) {
-    std::lock_guard<std::mutex> lock(apiMutex);
-    double price = 0.0;
-
-    HINTERNET hSession = nullptr, hConnect = nullptr, hRequest = nullptr;
-
-    try {
-        hSession = WinHttpOpen(
-            L"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36",
-            WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-            WINHTTP_NO_PROXY_NAME,
-            WINHTTP_NO_PROXY_BYPASS,
-            0);
-        if (!hSession) throw std::runtime_error("WinHttpOpen failed");
-
-        hConnect = WinHttpConnect(hSession, L"query1.finance.yahoo.com",
-            INTERNET_DEFAULT_HTTPS_PORT, 0);
-        if (!hConnect) throw std::runtime_error("WinHttpConnect failed");
-
-        std::wstring path = L"/v8/finance/chart/" + symbol + L"?interval=1d";
-
-        hRequest = WinHttpOpenRequest(
-            hConnect, L"GET", path.c_str(), nullptr, WINHTTP_NO_REFERER,
-            WINHTTP_DEFAULT_ACCEPT_TYPES, WINHTTP_FLAG_SECURE);
-        if (!hRequest) throw std::runtime_error("WinHttpOpenRequest failed");
-
-        // Add realistic headers
-        WinHttpAddRequestHeaders(
-            hRequest,
-            L"User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36",
-            (DWORD)-1,
-            WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE
-        );
-
-        WinHttpAddRequestHeaders(
-            hRequest,
-            L"Accept: application/json",
-            (DWORD)-1,
-            WINHTTP_ADDREQ_FLAG_ADD
-        );
-
-        if (!WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-            WINHTTP_NO_REQUEST_DATA, 0, 0, 0)) {
-            throw std::runtime_error("SendRequest failed");
-        }
+#include <charconv>
+#include <cstdio>
+#include <cmath>
+
+// Parses in place from the JSON digits: the engine calls this for every
+// response, so it builds no strings and never rounds through a double
+bool ApiFetcher::ExtractPrice(const std::string& json, const char* key, Price& value) {
+    char needle[64];
+    int needleLength = snprintf(needle, sizeof(needle), "\"%s\":", key);
+    if (needleLength <= 0 || needleLength >= static_cast<int>(sizeof(needle))) return false;
+
+    size_t pos = json.find(needle, 0, needleLength);
+    if (pos == std::string::npos) return false;
+
+    pos += needleLength;
+    size_t end = json.find_first_of(",}", pos);
+    if (end == std::string::npos) return false;
+
+    while (pos < end && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\r' || json[pos] == '\n')) ++pos;
+    return Price::Parse(json.data() + pos, json.data() + end, value);
+}
 
-        if (!WinHttpReceiveResponse(hRequest, nullptr)) {
-            throw std::runtime_error("ReceiveResponse failed");
+bool ApiFetcher::ParseSeries(const std::string& body, std::vector<float>& closes) {
+    closes.clear();
+    static const char needle[] = "\"close\":[";
+    size_t pos = body.find(needle);
+    if (pos == std::string::npos) return false;
+
+    // Intervals without a trade are null and left out
+    const char* p = body.data() + pos + sizeof(needle) - 1;
+    const char* end = body.data() + body.size();
+    while (p < end && *p != ']') {
+        if (*p == ',' || *p == ' ') {
+            ++p;
+            continue;
         }
-
-        std::string response;
-        DWORD dwSize = 0, dwDownloaded = 0;
-        do {
-            dwSize = 0;
-            if (!WinHttpQueryDataAvailable(hRequest, &dwSize)) break;
-            if (dwSize == 0) break;
-
-            std::vector<char> buf(dwSize);
-            if (WinHttpReadData(hRequest, buf.data(), dwSize, &dwDownloaded)) {
-                response.append(buf.data(), dwDownloaded);
-            }
-        } while (dwSize > 0);
-
-        // Debug logging
-        if (response.empty()) {
-            OutputDebugStringW(L"API: Empty response (likely blocked)\n");
+        float value = 0.0f;
+        std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec == std::errc()) {
+            if (std::isfinite(value)) closes.push_back(value);
+            p = result.ptr;
         }
-        else if (response.find("crumb") != std::string::npos && response.find("login") != std::string::npos) {
-            OutputDebugStringW(L"API: Redirected to login — blocked\n");
+        else if (end - p >= 4 && std::string_view(p, 4) == "null") {
+            p += 4;
         }
         else {
-            std::string dbg = "API Response (first 200): " + response.substr(0, 200) + "\n";
-            OutputDebugStringA(dbg.c_str());
+            break;
         }
+    }
+    return !closes.empty();
+}
+
+const wchar_t* ApiFetcher::DescribeError(FetchError error) {
+    switch (error) {
+    case FetchError::None: return L"ok";
+    case FetchError::Cancelled: return L"cancelled";
+    case FetchError::Timeout: return L"timed out";
+    case FetchError::Network: return L"network error";
+    case FetchError::HttpStatus: return L"HTTP error status";
+    case FetchError::Blocked: return L"blocked by the server";
+    case FetchError::Parse: return L"unparseable response";
+    }
+    return L"unknown error";
+}
 
-        // Parse the price from JSON response
-        size_t pos = response.find("\"regularMarketPrice\":");
-        if (pos != std::string::npos) {
-            pos += 21; // Length of "\"regularMarketPrice\":"
-            size_t end = response.find_first_of(",}", pos);
-            if (end != std::string::npos) {
-                std::string priceStr = response.substr(pos, end - pos);
-                try {
-                    price = std::stod(priceStr);
-                }
-                catch (...) {
-                    OutputDebugStringW(L"Failed to parse price\n");
-                }
-            }
+std::wstring ApiFetcher::ChartPath(std::string_view symbol, bool series) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string path = "/v8/finance/chart/";
+    for (char c : symbol) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        bool unreserved = (byte >= 'A' && byte <= 'Z') || (byte >= 'a' && byte <= 'z') ||
+            (byte >= '0' && byte <= '9') || byte == '-' || byte == '.' || byte == '_' || byte == '~' || byte == '=';
+        if (unreserved) {
+            path += c;
         }
         else {
-            OutputDebugStringW(L"regularMarketPrice not found\n");
+            path += '%';
+            path += hex[byte >> 4];
+            path += hex[byte & 15];
         }
     }
-    catch (const std::exception& e) {
-        std::string error = "Exception in FetchPrice: " + std::string(e.what()) + "\n";
-        OutputDebugStringA(error.c_str());
+    if (series) path += "?range=1d&interval=5m";
+    return Utf8::ToWide(path);
+}
+
+Quote ApiFetcher::ParseQuote(const std::string& body) {
+    Quote quote;
+
+    if (body.empty()) {
+        LOG_WARN("API: Empty response (likely blocked)");
+        quote.error = FetchError::Blocked;
+        return quote;
     }
-    catch (...) {
-        OutputDebugStringW(L"Unknown exception in FetchPrice\n");
+    if (body.find("crumb") != std::string::npos && body.find("login") != std::string::npos) {
+        LOG_WARN("API: Redirected to login, blocked");
+        quote.error = FetchError::Blocked;
+        return quote;
     }
 
-    // Cleanup
-    if (hRequest) WinHttpCloseHandle(hRequest);
-    if (hConnect) WinHttpCloseHandle(hConnect);
-    if (hSession) WinHttpCloseHandle(hSession);
-
-    return price;
+    // Parse the price and previous close from the JSON response
+    if (body.find("\"regularMarketPrice\":") == std::string::npos) {
+        LOG_WARN("API: regularMarketPrice not found in a {} byte response", body.size());
+        quote.error = FetchError::Parse;
+    }
+    else if (!ExtractPrice(body, "regularMarketPrice", quote.price)) {
+        LOG_WARN("API: Failed to parse regularMarketPrice");
+        quote.price = Price();
+        quote.error = FetchError::Parse;
+    }
+    else if (!ExtractPrice(body, "chartPreviousClose", quote.previousClose)) {
+        ExtractPrice(body, "previousClose", quote.previousClose);
+    }
+    return quote;
 }
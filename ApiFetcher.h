@@ -3,10 +3,57 @@
 #define API_FETCHER_H
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include "Price.h"
 
+// Default quote server (see apiHost/apiPort in config.ini) and the browser
+// identity requests present to it
+#define API_HOST L"query1.finance.yahoo.com"
+#define API_PORT 443
+#define API_USER_AGENT L"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36"
+
+// Why a fetch produced no price
+enum class FetchError {
+    None,
+    Cancelled,   // CancelToken::Cancel() was called
+    Timeout,     // Deadline expired in DNS, connect, TLS, send or receive
+    Network,     // Any other transport failure
+    HttpStatus,  // Server answered with a non-200 status (see httpStatus)
+    Blocked,     // Empty body or a login redirect
+    Parse        // Body did not contain a usable price
+};
+
+struct Quote {
+    Price price;           // Zero when the fetch failed
+    Price previousClose;   // Zero when not reported
+    FetchError error = FetchError::None;
+    int httpStatus = 0;          // Set for FetchError::HttpStatus
+
+    bool Ok() const { return error == FetchError::None; }
+};
+
+// The quote server's chart JSON: request paths and parsing. The requests
+// themselves go through HttpClient.
 class ApiFetcher {
 public:
-    static double FetchPrice(const std::wstring& symbol);
+    // Turn a chart JSON body into a quote
+    static Quote ParseQuote(const std::string& body);
+
+    // Intraday closes of a chart body in time order, for the sparkline;
+    // closes keeps its capacity. False if the body has none.
+    static bool ParseSeries(const std::string& body, std::vector<float>& closes);
+
+    // Request path of a symbol's chart JSON on the quote server, with the
+    // symbol percent-encoded ("^GSPC" -> "%5EGSPC"). With series it asks
+    // for today's five minute bars, which carry the sparkline's series;
+    // without, the response holds little more than the quote.
+    static std::wstring ChartPath(std::string_view symbol, bool series);
+
+    static const wchar_t* DescribeError(FetchError error);
+
+private:
+    static bool ExtractPrice(const std::string& json, const char* key, Price& value);
 };
 
 #endif
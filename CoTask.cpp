@@ -0,0 +1,53 @@
+#include "CoTask.h"
+
+#include <mutex>
+#include <new>
+
+// Frames are recycled in size classes of FRAME_GRANULE bytes; larger
+// frames go straight to the heap
+#define FRAME_GRANULE 64
+#define FRAME_CLASSES 64
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+struct alignas(64) FrameClass {
+    std::mutex mutex;
+    FreeFrame* head = nullptr;
+};
+
+static FrameClass g_classes[FRAME_CLASSES];
+
+static size_t ClassOf(size_t size) {
+    return (size + FRAME_GRANULE - 1) / FRAME_GRANULE - 1;
+}
+
+void* CoroutineFrames::Allocate(size_t size) {
+    size_t index = ClassOf(size);
+    if (index >= FRAME_CLASSES) return ::operator new(size);
+
+    FrameClass& frames = g_classes[index];
+    {
+        std::lock_guard<std::mutex> lock(frames.mutex);
+        if (FreeFrame* frame = frames.head) {
+            frames.head = frame->next;
+            return frame;
+        }
+    }
+    return ::operator new((index + 1) * FRAME_GRANULE);
+}
+
+void CoroutineFrames::Free(void* frame, size_t size) {
+    size_t index = ClassOf(size);
+    if (index >= FRAME_CLASSES) {
+        ::operator delete(frame);
+        return;
+    }
+
+    FrameClass& frames = g_classes[index];
+    FreeFrame* node = static_cast<FreeFrame*>(frame);
+    std::lock_guard<std::mutex> lock(frames.mutex);
+    node->next = frames.head;
+    frames.head = node;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#ifndef CO_TASK_H
+#define CO_TASK_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <utility>
+#include "TaskPool.h"
+
+// Allocator for coroutine frames. Freed frames are kept on a free list per
+// size class, so once as many coroutines of each kind have been in flight
+// as ever will be, starting more costs no heap allocation. Frames may be
+// freed on any thread.
+class CoroutineFrames {
+public:
+    static void* Allocate(size_t size);
+    static void Free(void* frame, size_t size);
+};
+
+// Lazily started coroutine producing a T. Awaiting it starts it and resumes
+// the awaiter when it finishes (symmetric transfer, so long chains of
+// awaits do not grow the stack).
+template <typename T>
+class CoTask {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        static void* operator new(size_t size) { return CoroutineFrames::Allocate(size); }
+        static void operator delete(void* frame, size_t size) { CoroutineFrames::Free(frame, size); }
+
+        CoTask get_return_object() {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_value(T result) { value = std::move(result); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    CoTask(CoTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    CoTask& operator=(CoTask&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+
+    ~CoTask() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return !m_handle || m_handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        m_handle.promise().continuation = awaiter;
+        return m_handle;
+    }
+
+    T await_resume() {
+        if (m_handle.promise().error) std::rethrow_exception(m_handle.promise().error);
+        return std::move(*m_handle.promise().value);
+    }
+
+private:
+    explicit CoTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+// Coroutine that starts immediately and frees itself when done
+struct DetachedCoroutine {
+    struct promise_type {
+        static void* operator new(size_t size) { return CoroutineFrames::Allocate(size); }
+        static void operator delete(void* frame, size_t size) { CoroutineFrames::Free(frame, size); }
+
+        DetachedCoroutine get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// Run a task without awaiting it; onDone receives its result on whichever
+// thread finishes it
+template <typename T, typename Callback>
+DetachedCoroutine Spawn(CoTask<T> task, Callback onDone) {
+    onDone(co_await std::move(task));
+}
+
+// co_await ResumeOn(pool) continues the coroutine on a pool worker, e.g. to
+// move CPU work off an I/O completion thread
+inline auto ResumeOn(TaskPool& pool) {
+    struct Awaiter {
+        TaskPool& pool;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { pool.Submit([h]() { h.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{ pool };
+}
+
+#endif
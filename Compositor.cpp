@@ -0,0 +1,365 @@
+#include "Compositor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define COMPOSITOR_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang need the ISA enabled per function; MSVC accepts the intrinsics as is
+#if defined(COMPOSITOR_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+// Exact round(x / 255) for x <= 255 * 255
+static inline uint32_t Div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// ---------------------------------------------------------------------------
+// Scalar kernels (reference implementation and SIMD tails)
+// ---------------------------------------------------------------------------
+
+struct BlendParams {
+    uint32_t b, g, r, alpha;
+};
+
+static inline uint32_t BlendPixel(uint32_t d, uint32_t coverage, const BlendParams& p) {
+    if (coverage == 0) return d;
+
+    uint32_t sa = Div255(p.alpha * coverage);
+    uint32_t inv = 255 - sa;
+
+    uint32_t ob = Div255(p.b * sa) + Div255((d & 0xFF) * inv);
+    uint32_t og = Div255(p.g * sa) + Div255(((d >> 8) & 0xFF) * inv);
+    uint32_t orr = Div255(p.r * sa) + Div255(((d >> 16) & 0xFF) * inv);
+    uint32_t oa = sa + Div255((d >> 24) * inv);
+
+    return std::min(ob, 255u) | (std::min(og, 255u) << 8) |
+        (std::min(orr, 255u) << 16) | (std::min(oa, 255u) << 24);
+}
+
+static inline uint32_t ScalePixel(uint32_t d, uint32_t f) {
+    return Div255((d & 0xFF) * f) |
+        (Div255(((d >> 8) & 0xFF) * f) << 8) |
+        (Div255(((d >> 16) & 0xFF) * f) << 16) |
+        (Div255((d >> 24) * f) << 24);
+}
+
+static void FillRowScalar(uint32_t* dst, int n, uint32_t pixel) {
+    std::fill(dst, dst + n, pixel);
+}
+
+static void BlendRowScalar(uint32_t* dst, const uint32_t* mask, int n, const BlendParams& p) {
+    for (int i = 0; i < n; ++i) {
+        dst[i] = BlendPixel(dst[i], (mask[i] >> 8) & 0xFF, p);
+    }
+}
+
+// factors[i] holds the 0-255 scale replicated into all four bytes
+static void ScaleRowScalar(uint32_t* dst, const uint32_t* factors, int n) {
+    for (int i = 0; i < n; ++i) {
+        dst[i] = ScalePixel(dst[i], factors[i] & 0xFF);
+    }
+}
+
+#ifdef COMPOSITOR_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 kernels, 4 pixels per iteration
+// ---------------------------------------------------------------------------
+
+TARGET_SSE2 static inline __m128i Div255Sse2(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Replicate the green byte of each pixel into all four bytes
+TARGET_SSE2 static inline __m128i SplatGreenSse2(__m128i m) {
+    __m128i c = _mm_and_si128(_mm_srli_epi32(m, 8), _mm_set1_epi32(0xFF));
+    c = _mm_or_si128(c, _mm_slli_epi32(c, 8));
+    return _mm_or_si128(c, _mm_slli_epi32(c, 16));
+}
+
+TARGET_SSE2 static void FillRowSse2(uint32_t* dst, int n, uint32_t pixel) {
+    __m128i v = _mm_set1_epi32(static_cast<int>(pixel));
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+    }
+    FillRowScalar(dst + i, n - i, pixel);
+}
+
+TARGET_SSE2 static void BlendRowSse2(uint32_t* dst, const uint32_t* mask, int n, const BlendParams& p) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v255 = _mm_set1_epi16(255);
+    const __m128i alpha = _mm_set1_epi16(static_cast<short>(p.alpha));
+    const __m128i color = _mm_setr_epi16(
+        (short)p.b, (short)p.g, (short)p.r, 255,
+        (short)p.b, (short)p.g, (short)p.r, 255);
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i c = SplatGreenSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(c, zero)) == 0xFFFF) continue; // No glyph pixels
+
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+        __m128i saLo = Div255Sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), alpha));
+        __m128i saHi = Div255Sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), alpha));
+
+        __m128i outLo = _mm_add_epi16(
+            Div255Sse2(_mm_mullo_epi16(color, saLo)),
+            Div255Sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(v255, saLo))));
+        __m128i outHi = _mm_add_epi16(
+            Div255Sse2(_mm_mullo_epi16(color, saHi)),
+            Div255Sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(v255, saHi))));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(outLo, outHi));
+    }
+    BlendRowScalar(dst + i, mask + i, n - i, p);
+}
+
+TARGET_SSE2 static void ScaleRowSse2(uint32_t* dst, const uint32_t* factors, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(factors + i));
+
+        __m128i lo = Div255Sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(f, zero)));
+        __m128i hi = Div255Sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(f, zero)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    ScaleRowScalar(dst + i, factors + i, n - i);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels, 8 pixels per iteration
+// ---------------------------------------------------------------------------
+
+TARGET_AVX2 static inline __m256i Div255Avx2(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+TARGET_AVX2 static inline __m256i SplatGreenAvx2(__m256i m) {
+    __m256i c = _mm256_and_si256(_mm256_srli_epi32(m, 8), _mm256_set1_epi32(0xFF));
+    c = _mm256_or_si256(c, _mm256_slli_epi32(c, 8));
+    return _mm256_or_si256(c, _mm256_slli_epi32(c, 16));
+}
+
+TARGET_AVX2 static void FillRowAvx2(uint32_t* dst, int n, uint32_t pixel) {
+    __m256i v = _mm256_set1_epi32(static_cast<int>(pixel));
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+    FillRowScalar(dst + i, n - i, pixel);
+}
+
+TARGET_AVX2 static void BlendRowAvx2(uint32_t* dst, const uint32_t* mask, int n, const BlendParams& p) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i v255 = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi16(static_cast<short>(p.alpha));
+    const __m256i color = _mm256_setr_epi16(
+        (short)p.b, (short)p.g, (short)p.r, 255,
+        (short)p.b, (short)p.g, (short)p.r, 255,
+        (short)p.b, (short)p.g, (short)p.r, 255,
+        (short)p.b, (short)p.g, (short)p.r, 255);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i c = SplatGreenAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i)));
+        if (_mm256_testz_si256(c, c)) continue; // No glyph pixels
+
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+        __m256i saLo = Div255Avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(c, zero), alpha));
+        __m256i saHi = Div255Avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(c, zero), alpha));
+
+        __m256i outLo = _mm256_add_epi16(
+            Div255Avx2(_mm256_mullo_epi16(color, saLo)),
+            Div255Avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(v255, saLo))));
+        __m256i outHi = _mm256_add_epi16(
+            Div255Avx2(_mm256_mullo_epi16(color, saHi)),
+            Div255Avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(v255, saHi))));
+
+        // unpack/pack work per 128-bit lane, so the pixel order is preserved
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(outLo, outHi));
+    }
+    BlendRowSse2(dst + i, mask + i, n - i, p);
+}
+
+TARGET_AVX2 static void ScaleRowAvx2(uint32_t* dst, const uint32_t* factors, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(factors + i));
+
+        __m256i lo = Div255Avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(f, zero)));
+        __m256i hi = Div255Avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(f, zero)));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    ScaleRowSse2(dst + i, factors + i, n - i);
+}
+
+static bool CpuHasAvx2() {
+#if defined(_MSC_VER)
+    int regs[4] = {};
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+
+    // The OS must save the YMM registers on context switches
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool CpuHasSse2() {
+#if defined(_M_X64) || defined(__x86_64__)
+    return true;
+#elif defined(_MSC_VER)
+    int regs[4] = {};
+    __cpuid(regs, 1);
+    return (regs[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+#endif // COMPOSITOR_X86
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+struct Kernels {
+    const char* name;
+    void (*fillRow)(uint32_t*, int, uint32_t);
+    void (*blendRow)(uint32_t*, const uint32_t*, int, const BlendParams&);
+    void (*scaleRow)(uint32_t*, const uint32_t*, int);
+};
+
+static const Kernels g_scalarKernels = { "scalar", FillRowScalar, BlendRowScalar, ScaleRowScalar };
+#ifdef COMPOSITOR_X86
+static const Kernels g_sse2Kernels = { "sse2", FillRowSse2, BlendRowSse2, ScaleRowSse2 };
+static const Kernels g_avx2Kernels = { "avx2", FillRowAvx2, BlendRowAvx2, ScaleRowAvx2 };
+#endif
+
+// The kernel set in use; null until first use or after SelectKernel(nullptr)
+static std::atomic<const Kernels*> g_kernels(nullptr);
+
+static const Kernels* DetectKernels() {
+#ifdef COMPOSITOR_X86
+    if (CpuHasAvx2()) return &g_avx2Kernels;
+    if (CpuHasSse2()) return &g_sse2Kernels;
+#endif
+    return &g_scalarKernels;
+}
+
+static const Kernels& GetKernels() {
+    const Kernels* kernels = g_kernels.load(std::memory_order_acquire);
+    if (!kernels) {
+        kernels = DetectKernels();
+        g_kernels.store(kernels, std::memory_order_release);
+    }
+    return *kernels;
+}
+
+uint32_t Compositor::Premultiply(uint32_t rgb, uint8_t alpha) {
+    uint32_t r = Div255(((rgb >> 16) & 0xFF) * alpha);
+    uint32_t g = Div255(((rgb >> 8) & 0xFF) * alpha);
+    uint32_t b = Div255((rgb & 0xFF) * alpha);
+    return b | (g << 8) | (r << 16) | (static_cast<uint32_t>(alpha) << 24);
+}
+
+void Compositor::Fill(uint32_t* dst, int stride, int width, int height, uint32_t pixel) {
+    if (!dst || width <= 0 || height <= 0) return;
+
+    const Kernels& k = GetKernels();
+    if (stride == width) {
+        k.fillRow(dst, width * height, pixel);
+        return;
+    }
+    for (int y = 0; y < height; ++y) {
+        k.fillRow(dst + static_cast<size_t>(y) * stride, width, pixel);
+    }
+}
+
+void Compositor::BlendCoverage(uint32_t* dst, int dstStride,
+    const uint32_t* mask, int maskStride,
+    int width, int height, uint32_t rgb, uint8_t alpha) {
+    if (!dst || !mask || width <= 0 || height <= 0 || alpha == 0) return;
+
+    BlendParams p = { rgb & 0xFF, (rgb >> 8) & 0xFF, (rgb >> 16) & 0xFF, alpha };
+
+    const Kernels& k = GetKernels();
+    for (int y = 0; y < height; ++y) {
+        k.blendRow(dst + static_cast<size_t>(y) * dstStride,
+            mask + static_cast<size_t>(y) * maskStride, width, p);
+    }
+}
+
+void Compositor::FadeEdges(uint32_t* dst, int stride, int width, int height, int fadeWidth) {
+    fadeWidth = std::min(fadeWidth, width / 2);
+    if (!dst || fadeWidth <= 0 || height <= 0) return;
+
+    // One replicated factor per faded column: left ramp then right ramp
+    thread_local std::vector<uint32_t> factors;
+    factors.resize(static_cast<size_t>(fadeWidth) * 2);
+    for (int x = 0; x < fadeWidth; ++x) {
+        uint32_t f = static_cast<uint32_t>((x + 1) * 255 / (fadeWidth + 1));
+        factors[x] = f * 0x01010101u;
+        factors[static_cast<size_t>(fadeWidth) * 2 - 1 - x] = f * 0x01010101u;
+    }
+
+    const Kernels& k = GetKernels();
+    for (int y = 0; y < height; ++y) {
+        uint32_t* row = dst + static_cast<size_t>(y) * stride;
+        k.scaleRow(row, factors.data(), fadeWidth);
+        k.scaleRow(row + width - fadeWidth, factors.data() + fadeWidth, fadeWidth);
+    }
+}
+
+const char* Compositor::GetKernelName() {
+    return GetKernels().name;
+}
+
+bool Compositor::SelectKernel(const char* name) {
+    const Kernels* kernels = nullptr;
+    if (!name) kernels = DetectKernels();
+    else if (strcmp(name, "scalar") == 0) kernels = &g_scalarKernels;
+#ifdef COMPOSITOR_X86
+    else if (strcmp(name, "sse2") == 0 && CpuHasSse2()) kernels = &g_sse2Kernels;
+    else if (strcmp(name, "avx2") == 0 && CpuHasAvx2()) kernels = &g_avx2Kernels;
+#endif
+    if (!kernels) return false;
+
+    g_kernels.store(kernels, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <cstdint>
+
+// Software compositor for the tape's back buffer.
+//
+// All buffers are premultiplied BGRA, one uint32_t per pixel (0xAARRGGBB in
+// memory order B, G, R, A), which is what UpdateLayeredWindow expects with
+// AC_SRC_ALPHA. Strides are in pixels. Every kernel has a scalar, SSE2 and
+// AVX2 implementation that produce bit-identical results; the fastest one the
+// CPU supports is picked on first use unless SelectKernel() chose one.
+class Compositor {
+public:
+    // Convert a 0xRRGGBB config color plus alpha to a premultiplied pixel
+    static uint32_t Premultiply(uint32_t rgb, uint8_t alpha);
+
+    // Fill a rectangle with a premultiplied pixel
+    static void Fill(uint32_t* dst, int stride, int width, int height, uint32_t pixel);
+
+    // Blend a solid 0xRRGGBB color at the given alpha over dst, weighted by a
+    // glyph coverage mask. The mask is a BGRA buffer rendered white-on-black
+    // (grayscale antialiasing); its green channel is used as coverage.
+    static void BlendCoverage(uint32_t* dst, int dstStride,
+        const uint32_t* mask, int maskStride,
+        int width, int height, uint32_t rgb, uint8_t alpha);
+
+    // Fade the left and right fadeWidth columns linearly to transparent
+    static void FadeEdges(uint32_t* dst, int stride, int width, int height, int fadeWidth);
+
+    // Name of the kernel set in use ("avx2", "sse2" or "scalar")
+    static const char* GetKernelName();
+
+    // Force a kernel set by name, e.g. to compare them; nullptr goes back to
+    // the fastest supported one. False if the CPU cannot run it. Not meant
+    // to be called while another thread composites.
+    static bool SelectKernel(const char* name);
+};
+
+#endif
@@ -8,6 +8,8 @@
 #include <wtypes.h>
 #include <sstream>
 #include "ConfigManager.h"
+#include "SymbolStatus.h"
+#include "Utf8.h"
 #include "resource.h"
 #include "ConfigDialog.h"
 
@@ -18,6 +20,21 @@ extern HINSTANCE g_hInstance;
 COLORREF selectedTextColor = RGB(255, 255, 255);
 COLORREF selectedBgColor = RGB(0, 0, 0);
 
+// Symbol flags are refreshed while the dialog is open: symbols added by
+// Apply are checked by the quote engine in the background
+#define SYMBOL_STATUS_TIMER 1
+#define SYMBOL_STATUS_INTERVAL_MS 1000
+#define SYMBOL_FLAG_COLOR RGB(192, 0, 0)
+
+static void UpdateSymbolStatus(HWND hDlg) {
+    std::wstring text = SymbolStatus::Describe(ConfigManager::symbols);
+    wchar_t shown[512];
+    GetDlgItemText(hDlg, IDC_SYMBOL_STATUS, shown, 512);
+    if (text != shown) {
+        SetDlgItemText(hDlg, IDC_SYMBOL_STATUS, text.c_str());
+    }
+}
+
 // Function declarations
 LRESULT CALLBACK ConfigDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
 
@@ -36,9 +53,11 @@ LRESULT CALLBACK ConfigDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARAM
         std::wstring symbolsText;
         for (size_t i = 0; i < ConfigManager::symbols.size(); i++) {
             if (i > 0) symbolsText += L",";
-            symbolsText += ConfigManager::symbols[i];
+            symbolsText += Utf8::ToWide(ConfigManager::symbols[i]);
         }
         SetDlgItemText(hDlg, IDC_SYMBOLS_EDIT, symbolsText.c_str());
+        UpdateSymbolStatus(hDlg);
+        SetTimer(hDlg, SYMBOL_STATUS_TIMER, SYMBOL_STATUS_INTERVAL_MS, nullptr);
 
         SetDlgItemInt(hDlg, IDC_REFRESH_EDIT, ConfigManager::refreshInterval, FALSE);
 
@@ -114,12 +133,13 @@ LRESULT CALLBACK ConfigDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARAM
             lf.lfOutPrecision = OUT_DEFAULT_PRECIS;
             lf.lfClipPrecision = CLIP_DEFAULT_PRECIS;
             lf.lfQuality = DEFAULT_QUALITY;
-            lf.lfPitchAndFamily = DEFAULT_PITCH | FF_DONTCARE;
+            lf.lfPitchAndFamily = FIXED_PITCH | FF_MODERN;
 
             cf.lStructSize = sizeof(CHOOSEFONT);
             cf.hwndOwner = hDlg;
             cf.lpLogFont = &lf;
-            cf.Flags = CF_SCREENFONTS | CF_INITTOLOGFONTSTRUCT;
+            // The tape lays text out in fixed cells; offer only faces that fit
+            cf.Flags = CF_SCREENFONTS | CF_INITTOLOGFONTSTRUCT | CF_FIXEDPITCHONLY;
             cf.rgbColors = selectedTextColor;
 
             if (ChooseFont(&cf)) {
@@ -149,7 +169,7 @@ LRESULT CALLBACK ConfigDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARAM
                 symbol.erase(0, symbol.find_first_not_of(L" \t"));
                 symbol.erase(symbol.find_last_not_of(L" \t") + 1);
                 if (!symbol.empty()) {
-                    ConfigManager::symbols.push_back(symbol);
+                    ConfigManager::symbols.push_back(Utf8::FromWide(symbol));
                 }
             }
 
@@ -204,8 +224,10 @@ LRESULT CALLBACK ConfigDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARAM
                 (GetGValue(selectedBgColor) << 8) |
                 GetBValue(selectedBgColor);
 
-            // Save configuration
+            // Save configuration and apply it to the running tapes
             ConfigManager::SaveConfig();
+            ConfigManager::Publish();
+            ApplyConfigChanges();
 
             if (LOWORD(wParam) == IDC_OK) {
                 EndDialog(hDlg, IDOK);
@@ -223,9 +245,30 @@ LRESULT CALLBACK ConfigDialogProc(HWND hDlg, UINT message, WPARAM wParam, LPARAM
         }
         break;
 
+    case WM_TIMER:
+        if (wParam == SYMBOL_STATUS_TIMER) {
+            UpdateSymbolStatus(hDlg);
+            return TRUE;
+        }
+        break;
+
+    case WM_CTLCOLORSTATIC:
+        // Flagged symbols in red on the dialog's own background
+        if (reinterpret_cast<HWND>(lParam) == GetDlgItem(hDlg, IDC_SYMBOL_STATUS)) {
+            HDC hdc = reinterpret_cast<HDC>(wParam);
+            SetTextColor(hdc, SYMBOL_FLAG_COLOR);
+            SetBkMode(hdc, TRANSPARENT);
+            return reinterpret_cast<LRESULT>(GetSysColorBrush(COLOR_BTNFACE));
+        }
+        break;
+
     case WM_CLOSE:
         EndDialog(hDlg, IDCANCEL);
         return TRUE;
+
+    case WM_DESTROY:
+        KillTimer(hDlg, SYMBOL_STATUS_TIMER);
+        break;
     }
     return FALSE;
 }
\ No newline at end of file
@@ -14,3 +14,4 @@ void ShowConfigDialog(HWND hWnd);
 void RecalculateCharWidth(HWND hWnd);
 void UpdateWindowSize(HWND hWnd);
 void UpdateLayeredDisplay(HWND hWnd);
+void ApplyConfigChanges();
@@ -1,23 +1,45 @@
+#ifndef NOMINMAX
 #define NOMINMAX
+#endif
 #include <windows.h>
 #include "ConfigManager.h"
+#include "QuoteConflator.h"
+#include "Log.h"
+#include "Utf8.h"
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <algorithm>
 #include <ShlObj.h>
 #include <filesystem>
+#include <atomic>
 
 // Static member definitions
-std::vector<std::wstring> ConfigManager::symbols;
+std::vector<std::string> ConfigManager::symbols;
 int ConfigManager::refreshInterval = 60;
+int ConfigManager::fetchTimeout = 10;
 double ConfigManager::scrollSpeed = 2.0;
 int ConfigManager::windowHeight = 30;
 int ConfigManager::fontSize = 16;
-std::wstring ConfigManager::fontName = L"Arial";
+std::wstring ConfigManager::fontName = L"Consolas";
 DWORD ConfigManager::textColor = 0x00FF00; // Green
 DWORD ConfigManager::bgColor = 0x000000;   // Black
+int ConfigManager::opacity = 100;
+int ConfigManager::edgeFade = 0;
 std::wstring ConfigManager::configPath;
-std::wstring ConfigManager::colorScheme = L"Green";
+std::vector<TapeConfig> ConfigManager::extraTapes;
+std::wstring ConfigManager::metricsFile;
+std::wstring ConfigManager::traceFile;
+std::wstring ConfigManager::apiHost = API_HOST;
+int ConfigManager::apiPort = API_PORT;
+bool ConfigManager::apiHttps = true;
+bool ConfigManager::localFeed = false;
+bool ConfigManager::exportQuotes = false;
+std::wstring ConfigManager::colorScheme = L"Classic";
+std::wstring ConfigManager::tapeFormat = DEFAULT_TAPE_FORMAT;
+
+static std::atomic<std::shared_ptr<const ConfigSnapshot>> g_current;
+static unsigned long long g_version = 0;
 
 
 std::wstring ConfigManager::GetConfigPath() {
@@ -51,60 +73,191 @@ std::wstring ConfigManager::Trim(const std::wstring& str) {
     return str.substr(start, end - start + 1);
 }
 
+std::vector<std::string> ConfigManager::ParseSymbols(const std::wstring& value) {
+    std::vector<std::string> result;
+    std::wstringstream ss(value);
+    std::wstring symbol;
+    while (std::getline(ss, symbol, L',')) {
+        symbol = Trim(symbol);
+        if (!symbol.empty()) {
+            result.push_back(Utf8::FromWide(symbol));
+        }
+    }
+    return result;
+}
+
+std::vector<TapeConfig> ConfigManager::GetTapeConfigs() {
+    std::vector<TapeConfig> tapes;
+    tapes.push_back({ symbols, scrollSpeed, 0, L"" });
+    tapes.insert(tapes.end(), extraTapes.begin(), extraTapes.end());
+    return tapes;
+}
+
+std::wstring ConfigManager::ResolvePath(const std::wstring& file) {
+    if (file.empty()) return file;
+
+    // Relative output paths land next to config.ini
+    std::filesystem::path path(file);
+    if (path.is_relative()) {
+        path = std::filesystem::path(GetConfigPath()).parent_path() / path;
+    }
+    return path.wstring();
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigManager::Publish() {
+    auto snapshot = std::make_shared<ConfigSnapshot>();
+    snapshot->version = ++g_version;
+    snapshot->tapes = GetTapeConfigs();
+    snapshot->refreshInterval = refreshInterval;
+    snapshot->fetchTimeout = fetchTimeout;
+    snapshot->windowHeight = windowHeight;
+    snapshot->fontSize = fontSize;
+    snapshot->fontName = fontName;
+    snapshot->textColor = textColor;
+    snapshot->bgColor = bgColor;
+    snapshot->opacity = opacity;
+    snapshot->edgeFade = edgeFade;
+    snapshot->palette = GetPalette();
+    snapshot->tapeFormat = tapeFormat;
+    std::wstring error;
+    if (!snapshot->tapeTemplate.Compile(tapeFormat, &error)) {
+        LOG_WARN("Config: tapeFormat \"{}\" {}, using the default", tapeFormat, error);
+    }
+    snapshot->apiHost = apiHost;
+    snapshot->apiPort = apiPort;
+    snapshot->apiHttps = apiHttps;
+    snapshot->localFeed = localFeed;
+    snapshot->exportQuotes = exportQuotes;
+    snapshot->metricsFile = ResolvePath(metricsFile);
+    snapshot->traceFile = ResolvePath(traceFile);
+
+    std::shared_ptr<const ConfigSnapshot> published = std::move(snapshot);
+    g_current.store(published);
+    return published;
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigManager::Current() {
+    std::shared_ptr<const ConfigSnapshot> snapshot = g_current.load();
+    if (!snapshot) {
+        // Nothing loaded yet: built-in defaults
+        static const auto defaults = std::make_shared<const ConfigSnapshot>();
+        return defaults;
+    }
+    return snapshot;
+}
+
 void ConfigManager::SetDefaults() {
     symbols.clear();
-    symbols.push_back(L"AAPL");
-    symbols.push_back(L"GOOGL");
-    symbols.push_back(L"MSFT");
-    symbols.push_back(L"TSLA");
+    symbols.push_back("AAPL");
+    symbols.push_back("GOOGL");
+    symbols.push_back("MSFT");
+    symbols.push_back("TSLA");
 
     refreshInterval = 60;
+    fetchTimeout = 10;
     scrollSpeed = 2.0;
     windowHeight = 30;
     fontSize = 16;
-    fontName = L"Arial";
+    fontName = L"Consolas";
     textColor = 0x00FF00; // Green
     bgColor = 0x000000;   // Black
-    colorScheme = L"Green";
+    opacity = 100;
+    edgeFade = 0;
+    colorScheme = L"Classic";
+    metricsFile.clear();
+    traceFile.clear();
+    apiHost = API_HOST;
+    apiPort = API_PORT;
+    apiHttps = true;
+    localFeed = false;
+    exportQuotes = false;
+    tapeFormat = DEFAULT_TAPE_FORMAT;
+    extraTapes.clear();
+}
+
+Palette ConfigManager::GetPalette() {
+    if (colorScheme == L"Mono") {
+        return { textColor, textColor, textColor, textColor };
+    }
+    if (colorScheme == L"HighContrast") {
+        // Blue/orange stays distinguishable with red-green color blindness
+        return { textColor, 0x40A0FF, 0xFF8000, 0xFFFFFF };
+    }
+    // Classic; older single-color scheme names fall back to it as well
+    return { textColor, 0x00E050, 0xFF4040, 0xFFFF00 };
 }
 
 void ConfigManager::LoadConfig() {
     SetDefaults(); // Set defaults first
 
-    std::wifstream file(GetConfigPath());
-    if (!file.is_open()) {
+    std::ifstream bytes(std::filesystem::path(GetConfigPath()), std::ios::in | std::ios::binary);
+    if (!bytes.is_open()) {
         // Config file doesn't exist, create it with defaults
         SaveConfig();
+        Publish();
         return;
     }
 
+    // config.ini is UTF-8 (a BOM from Notepad is skipped); converting it
+    // whole keeps non-ASCII symbols and text intact whatever the C locale
+    std::string text((std::istreambuf_iterator<char>(bytes)), std::istreambuf_iterator<char>());
+    bytes.close();
+    if (text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.erase(0, 3);
+    std::wistringstream file(Utf8::ToWide(text));
+
     std::wstring line;
+    bool inTapeSection = false;
+    TapeConfig* tape = nullptr; // Current [tape] section (null once over MAX_TAPES)
     while (std::getline(file, line)) {
         line = Trim(line);
         if (line.empty() || line[0] == L'#' || line[0] == L';') {
             continue; // Skip empty lines and comments
         }
 
+        if (line == L"[tape]") {
+            inTapeSection = true;
+            if (extraTapes.size() + 1 >= MAX_TAPES) {
+                tape = nullptr;
+                continue;
+            }
+            extraTapes.push_back({ {}, scrollSpeed, 0, L"" });
+            tape = &extraTapes.back();
+            continue;
+        }
+
         size_t pos = line.find(L'=');
         if (pos == std::wstring::npos) continue;
 
         std::wstring key = Trim(line.substr(0, pos));
         std::wstring value = Trim(line.substr(pos + 1));
 
-        if (key == L"symbols") {
-            symbols.clear();
-            std::wstringstream ss(value);
-            std::wstring symbol;
-            while (std::getline(ss, symbol, L',')) {
-                symbol = Trim(symbol);
-                if (!symbol.empty()) {
-                    symbols.push_back(symbol);
-                }
+        if (inTapeSection) {
+            // Keys inside a [tape] section only configure that tape
+            if (!tape) continue;
+            if (key == L"symbols") {
+                tape->symbols = ParseSymbols(value);
+            }
+            else if (key == L"scrollSpeed") {
+                tape->scrollSpeed = std::max(0.1, _wtof(value.c_str()));
             }
+            else if (key == L"monitor") {
+                tape->monitor = std::max(0, _wtoi(value.c_str()));
+            }
+            else if (key == L"dock") {
+                tape->dock = value;
+            }
+            continue;
+        }
+
+        if (key == L"symbols") {
+            symbols = ParseSymbols(value);
         }
         else if (key == L"refreshInterval") {
             refreshInterval = std::max(1, _wtoi(value.c_str()));
         }
+        else if (key == L"fetchTimeout") {
+            fetchTimeout = std::max(1, _wtoi(value.c_str()));
+        }
         else if (key == L"scrollSpeed") {
             scrollSpeed = std::max(0.1, _wtof(value.c_str()));
         }
@@ -125,25 +278,66 @@ void ConfigManager::LoadConfig() {
         else if (key == L"bgColor") {
             bgColor = wcstoul(value.c_str(), nullptr, 16);
         }
+        else if (key == L"opacity") {
+            opacity = std::clamp(_wtoi(value.c_str()), 0, 100);
+        }
+        else if (key == L"edgeFade") {
+            edgeFade = std::max(0, _wtoi(value.c_str()));
+        }
         else if (key == L"colorScheme") {
             colorScheme = value;
         }
+        else if (key == L"metricsFile") {
+            metricsFile = value;
+        }
+        else if (key == L"traceFile") {
+            traceFile = value;
+        }
+        else if (key == L"apiHost") {
+            if (!value.empty()) {
+                apiHost = value;
+            }
+        }
+        else if (key == L"apiPort") {
+            apiPort = std::clamp(_wtoi(value.c_str()), 1, 65535);
+        }
+        else if (key == L"apiHttps") {
+            apiHttps = _wtoi(value.c_str()) != 0;
+        }
+        else if (key == L"localFeed") {
+            localFeed = _wtoi(value.c_str()) != 0;
+        }
+        else if (key == L"exportQuotes") {
+            exportQuotes = _wtoi(value.c_str()) != 0;
+        }
+        else if (key == L"tapeFormat") {
+            if (!value.empty()) {
+                tapeFormat = value;
+            }
+        }
     }
 
-    file.close();
-
     // Ensure we have at least one symbol
     if (symbols.empty()) {
-        symbols.push_back(L"AAPL");
+        symbols.push_back("AAPL");
     }
+
+    // Drop tapes without a watchlist
+    extraTapes.erase(std::remove_if(extraTapes.begin(), extraTapes.end(),
+        [](const TapeConfig& t) { return t.symbols.empty(); }), extraTapes.end());
+
+    Publish();
 }
 
 void ConfigManager::SaveConfig() {
-    std::wofstream file(GetConfigPath());
-    if (!file.is_open()) {
+    std::ofstream bytes(std::filesystem::path(GetConfigPath()), std::ios::out | std::ios::trunc);
+    if (!bytes.is_open()) {
         return; // Unable to save
     }
 
+    // Composed as UTF-16, written as UTF-8
+    std::wostringstream file;
+
     file << L"# ARP Ticker Tape Configuration File\n";
     file << L"# This file is automatically generated. You can edit it manually if needed.\n\n";
 
@@ -151,27 +345,67 @@ void ConfigManager::SaveConfig() {
     file << L"symbols=";
     for (size_t i = 0; i < symbols.size(); ++i) {
         if (i > 0) file << L",";
-        file << symbols[i];
+        file << Utf8::ToWide(symbols[i]);
     }
     file << L"\n";
 
     // Save other settings
     file << L"refreshInterval=" << refreshInterval << L"\n";
+    file << L"fetchTimeout=" << fetchTimeout << L"\n";
     file << L"scrollSpeed=" << scrollSpeed << L"\n";
     file << L"windowHeight=" << windowHeight << L"\n";
     file << L"fontSize=" << fontSize << L"\n";
     file << L"fontName=" << fontName << L"\n";
     file << L"colorScheme=" << colorScheme << L"\n";
+    file << L"tapeFormat=" << tapeFormat << L"\n";
+    file << L"opacity=" << opacity << L"\n";
+    file << L"edgeFade=" << edgeFade << L"\n";
+    file << L"metricsFile=" << metricsFile << L"\n";
+    file << L"traceFile=" << traceFile << L"\n";
+    file << L"apiHost=" << apiHost << L"\n";
+    file << L"apiPort=" << apiPort << L"\n";
+    file << L"apiHttps=" << (apiHttps ? 1 : 0) << L"\n";
+    file << L"localFeed=" << (localFeed ? 1 : 0) << L"\n";
+    file << L"exportQuotes=" << (exportQuotes ? 1 : 0) << L"\n";
 
     // Save colors as hex
     file << L"textColor=" << std::hex << std::uppercase << textColor << L"\n";
     file << L"bgColor=" << std::hex << std::uppercase << bgColor << L"\n";
 
-    file << L"\n# Color format: RRGGBB (hexadecimal)\n";
+    file << L"\n# Symbols: up to " << std::dec << MAX_SYMBOLS << L" different symbols per run across all tapes; a symbol\n";
+    file << L"#   removed while running still counts until the tape restarts\n";
+    file << L"# Font name: a fixed-pitch face; a proportional one is replaced by Consolas\n";
+    file << L"# Color format: RRGGBB (hexadecimal)\n";
     file << L"# Example: FF0000 = Red, 00FF00 = Green, 0000FF = Blue\n";
     file << L"# Scroll speed: pixels per frame (typically 0.1 to 5.0)\n";
     file << L"# Refresh interval: seconds between API calls (minimum 1)\n";
-    file << L"# Color scheme: Green, Red, Blue, Yellow, Cyan, Magenta, White\n";
+    file << L"# Fetch timeout: seconds one quote request may take, including DNS, connect and TLS (minimum 1)\n";
+    file << L"# Color scheme: Classic (green up / red down), HighContrast (blue up / orange down), Mono\n";
+    file << L"# Tape format: {sym}, {cur} (currency sign), {price}, {chg} and {spark} (intraday sparkline); number formats are\n";
+    file << L"#   .N for N decimals or auto (by symbol), and for {chg} a leading + and a trailing % for percent\n";
+    file << L"# Opacity: background opacity in percent (0 to 100), text stays opaque\n";
+    file << L"# Edge fade: pixels over which the tape fades out at each edge (0 = off)\n";
+    file << L"# Metrics file: fetch metrics in Prometheus text format, rewritten after every fetch pass (empty = off)\n";
+    file << L"# Trace file: record frames, fetches and lock waits, written on exit in Chrome trace format (empty = off)\n";
+    file << L"# API host/port/https: quote server, e.g. apiHost=localhost, apiPort=8080, apiHttps=0 for a local mock server\n";
+    file << L"# Local feed: 1 = accept quotes pushed by local programs through shared memory (see QuoteFeed.h)\n";
+    file << L"# Export quotes: 1 = share the latest quotes with local programs through shared memory (see QuoteExport.h)\n";
+    file << L"# Extra tapes: add [tape] sections with symbols, scrollSpeed, monitor (0 = primary) and dock (top/bottom)\n";
+
+    for (const auto& tape : extraTapes) {
+        file << L"\n[tape]\n";
+        file << L"symbols=";
+        for (size_t i = 0; i < tape.symbols.size(); ++i) {
+            if (i > 0) file << L",";
+            file << Utf8::ToWide(tape.symbols[i]);
+        }
+        file << L"\n";
+        file << L"scrollSpeed=" << std::dec << tape.scrollSpeed << L"\n";
+        file << L"monitor=" << std::dec << tape.monitor << L"\n";
+        if (!tape.dock.empty()) {
+            file << L"dock=" << tape.dock << L"\n";
+        }
+    }
 
-    file.close();
+    bytes << Utf8::FromWide(file.str());
 }
@@ -1,28 +1,118 @@
 ﻿#pragma once
 #include <vector>
 #include <string>
+#include <memory>
 #include <windows.h>  // Make sure this is included
+#include "ApiFetcher.h"
+#include "TapeTemplate.h"
 
+// Colors (0xRRGGBB) used for the tape's styled runs
+struct Palette {
+    DWORD neutral;  // Unchanged or unknown move, status text
+    DWORD up;       // Above previous close
+    DWORD down;     // Below previous close
+    DWORD flash;    // Price just ticked
+};
+
+// Upper bound on tape windows hosted by one process
+#define MAX_TAPES 8
+
+// Per-tape settings. The first tape comes from the global keys; each [tape]
+// section in config.ini adds another one.
+struct TapeConfig {
+    std::vector<std::string> symbols;   // UTF-8
+    double scrollSpeed;
+    int monitor;          // Monitor index, 0 = primary
+    std::wstring dock;    // "top", "bottom" or empty for a floating tape
+};
+
+// Immutable view of the configuration. A new snapshot is published after
+// every load or edit; threads other than the UI thread read settings only
+// through snapshots, never through ConfigManager's statics.
+struct ConfigSnapshot {
+    unsigned long long version = 0;  // Increases with every publish
+    std::vector<TapeConfig> tapes;   // Primary first
+    int refreshInterval = 60;
+    int fetchTimeout = 10;
+    int windowHeight = 30;
+    int fontSize = 16;
+    std::wstring fontName = L"Consolas";
+    DWORD textColor = 0x00FF00;
+    DWORD bgColor = 0x000000;
+    int opacity = 100;
+    int edgeFade = 0;
+    Palette palette = { 0x00FF00, 0x00E050, 0xFF4040, 0xFFFF00 };
+    std::wstring tapeFormat = DEFAULT_TAPE_FORMAT;
+    TapeTemplate tapeTemplate;  // tapeFormat compiled; the default if it does not compile
+    std::wstring metricsFile;   // Absolute path of the metrics dump, empty = off
+    std::wstring traceFile;     // Absolute path of the trace written on exit, empty = off
+    std::wstring apiHost = API_HOST;
+    int apiPort = API_PORT;
+    bool apiHttps = true;
+    bool localFeed = false;
+    bool exportQuotes = false;
+};
+
+// The statics below are the UI thread's working copy: LoadConfig and the
+// settings dialog edit them and then publish a snapshot for everyone else.
 class ConfigManager {
 public:
-    static std::vector<std::wstring> symbols;
+    static std::vector<std::string> symbols;   // UTF-8, like all symbols past the dialog and file
     static int refreshInterval;
+    static int fetchTimeout;    // Seconds allowed for one quote request
     static double scrollSpeed;
     static int windowHeight;
     static int fontSize;
     static std::wstring fontName;
     static DWORD textColor;
     static DWORD bgColor;
+    static int opacity;     // Background opacity in percent (0-100)
+    static int edgeFade;    // Width of the fade-out at each edge in pixels
     static std::wstring configPath;
+    static std::vector<TapeConfig> extraTapes;
+    static std::wstring metricsFile;   // Relative paths are next to config.ini
+    static std::wstring traceFile;     // Likewise; tracing is on while set
+
+    // Quote server; point these at a local mock server to test the pipeline
+    static std::wstring apiHost;
+    static int apiPort;
+    static bool apiHttps;
+
+    // Accept quotes pushed by local processes through the shared ring in
+    // QuoteFeed.h
+    static bool localFeed;
 
-    // ADD THIS LINE to your existing ConfigManager.h:
+    // Share the latest quotes with local processes through the region in
+    // QuoteExport.h
+    static bool exportQuotes;
+
+    // Palette name: Classic, HighContrast or Mono
     static std::wstring colorScheme;
 
+    // Text of each symbol on the tape, e.g. "{sym} {price:auto} {chg:+.2%}"
+    static std::wstring tapeFormat;
+
+    // Load config.ini into the statics and publish a new snapshot
     static void LoadConfig();
     static void SaveConfig();
     static void SetDefaults();
 
-private:
+    // Resolve colorScheme to a palette. Neutral text always uses textColor.
+    static Palette GetPalette();
+
+    // All tapes, primary first
+    static std::vector<TapeConfig> GetTapeConfigs();
+
+    // Publish the statics as a new immutable snapshot (UI thread only)
+    static std::shared_ptr<const ConfigSnapshot> Publish();
+
+    // Latest published snapshot; safe to call from any thread
+    static std::shared_ptr<const ConfigSnapshot> Current();
+
     static std::wstring GetConfigPath();
+
+private:
     static std::wstring Trim(const std::wstring& str);
+    static std::vector<std::string> ParseSymbols(const std::wstring& value);
+    static std::wstring ResolvePath(const std::wstring& file);
 };
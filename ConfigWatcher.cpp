@@ -0,0 +1,70 @@
+#include "ConfigWatcher.h"
+
+#include <thread>
+
+// Editors often write a file in several steps; wait for them to settle
+#define SETTLE_DELAY_MS 250
+
+static std::thread g_watcherThread;
+static HANDLE g_stopEvent = nullptr;
+
+static bool GetLastWriteTime(const std::wstring& path, FILETIME& time) {
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) return false;
+    time = data.ftLastWriteTime;
+    return true;
+}
+
+static void WatchLoop(std::wstring path, HWND hWnd, UINT message, HANDLE hChange) {
+    FILETIME lastWrite = {};
+    GetLastWriteTime(path, lastWrite);
+
+    HANDLE handles[2] = { g_stopEvent, hChange };
+    for (;;) {
+        if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) break;
+
+        // Coalesce the burst of notifications from a single save
+        if (WaitForSingleObject(g_stopEvent, SETTLE_DELAY_MS) == WAIT_OBJECT_0) break;
+        FindNextChangeNotification(hChange);
+
+        // The directory also holds other files; only react to ours
+        FILETIME writeTime = {};
+        if (GetLastWriteTime(path, writeTime) && CompareFileTime(&writeTime, &lastWrite) != 0) {
+            lastWrite = writeTime;
+            PostMessage(hWnd, message, 0, 0);
+        }
+    }
+}
+
+bool ConfigWatcher::Start(const std::wstring& path, HWND hWnd, UINT message) {
+    if (g_watcherThread.joinable()) return true;
+
+    size_t slash = path.find_last_of(L"\\/");
+    std::wstring directory = slash == std::wstring::npos ? L"." : path.substr(0, slash);
+
+    HANDLE hChange = FindFirstChangeNotificationW(directory.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (hChange == INVALID_HANDLE_VALUE) return false;
+
+    g_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!g_stopEvent) {
+        FindCloseChangeNotification(hChange);
+        return false;
+    }
+
+    g_watcherThread = std::thread([path, hWnd, message, hChange]() {
+        WatchLoop(path, hWnd, message, hChange);
+        FindCloseChangeNotification(hChange);
+    });
+    return true;
+}
+
+void ConfigWatcher::Stop() {
+    if (!g_watcherThread.joinable()) return;
+
+    SetEvent(g_stopEvent);
+    g_watcherThread.join();
+
+    CloseHandle(g_stopEvent);
+    g_stopEvent = nullptr;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#ifndef CONFIG_WATCHER_H
+#define CONFIG_WATCHER_H
+
+#include <windows.h>
+#include <string>
+
+// Watches config.ini for edits made outside the application and posts a
+// message to a window when its contents may have changed, so the UI thread
+// can reload it without a restart.
+class ConfigWatcher {
+public:
+    // Start watching path; message is posted to hWnd after each change
+    // (bursts of writes are coalesced)
+    static bool Start(const std::wstring& path, HWND hWnd, UINT message);
+
+    // Stop and join the watcher thread
+    static void Stop();
+};
+
+#endif
@@ -0,0 +1,287 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "FetchMetrics.h"
+#include "Trace.h"
+#include "StartupTimeline.h"
+#include "QuoteConflator.h"
+
+#include <windows.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+// Statuses are counted by exact code; anything else lands in slot 0
+#define MAX_HTTP_STATUS 600
+
+#define PHASE_COUNT 5
+#define GROUP_COUNT static_cast<int>(SymbolGroup::Count)
+#define ERROR_COUNT (static_cast<int>(FetchError::Parse) + 1)
+
+static const char* const g_phaseNames[PHASE_COUNT] = { "dns", "connect", "tls", "ttfb", "total" };
+static const char* const g_groupNames[GROUP_COUNT] = { "equity", "index", "crypto", "currency", "future" };
+static const char* const g_errorNames[ERROR_COUNT] = {
+    "ok", "cancelled", "timeout", "network", "http_status", "blocked", "parse"
+};
+
+struct GroupMetrics {
+    Histogram phases[PHASE_COUNT];
+    Histogram responseBytes;
+    Histogram parseMicros;
+    std::atomic<uint64_t> statuses[MAX_HTTP_STATUS];
+    std::atomic<uint64_t> results[ERROR_COUNT];
+};
+
+static GroupMetrics g_groups[GROUP_COUNT];
+static std::mutex g_hostMutex;
+static std::string g_host;
+
+// Series added by other modules, dumped after the fetch metrics
+struct ExtraSeries {
+    const char* name;
+    const char* help;
+    const char* type;
+    FetchMetrics::SeriesReader read;
+};
+
+static std::mutex g_seriesMutex;
+static std::vector<ExtraSeries> g_series;
+static std::atomic<int> g_nextShard(0);
+
+static int ThreadShard() {
+    thread_local int shard = g_nextShard.fetch_add(1, std::memory_order_relaxed) % Histogram::SHARDS;
+    return shard;
+}
+
+int Histogram::BucketOf(uint64_t value) {
+    const uint64_t limit = (1ULL << MAX_VALUE_BITS) - 1;
+    value = std::min(value, limit);
+    if (value < (1ULL << SUB_BUCKET_BITS)) return static_cast<int>(value);
+
+    int msb = 63 - std::countl_zero(value);
+    int sub = static_cast<int>((value >> (msb - SUB_BUCKET_BITS)) & ((1ULL << SUB_BUCKET_BITS) - 1));
+    return ((msb - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + sub;
+}
+
+uint64_t Histogram::BucketFloor(int bucket) {
+    const int subBuckets = 1 << SUB_BUCKET_BITS;
+    if (bucket < subBuckets) return static_cast<uint64_t>(bucket);
+
+    int msb = (bucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket & (subBuckets - 1));
+    return (subBuckets + sub) << (msb - SUB_BUCKET_BITS);
+}
+
+void Histogram::Record(uint64_t value) {
+    Shard& shard = m_shards[ThreadShard()];
+    shard.buckets[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+void Histogram::Read(Totals& totals) const {
+    totals = {};
+    for (const Shard& shard : m_shards) {
+        for (int i = 0; i < BUCKETS; ++i) {
+            totals.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        totals.count += shard.count.load(std::memory_order_relaxed);
+        totals.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+}
+
+uint64_t Histogram::Quantile(const Totals& totals, double quantile) {
+    if (totals.count == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(totals.count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += totals.buckets[i];
+        if (seen >= rank) return i + 1 < BUCKETS ? BucketFloor(i + 1) - 1 : BucketFloor(i);
+    }
+    return BucketFloor(BUCKETS - 1);
+}
+
+uint64_t FetchMetrics::NowMicros() {
+    return Trace::NowMicros();
+}
+
+void FetchMetrics::RecordRequest(SymbolGroup group, const RequestTiming& timing,
+    uint64_t bytes, int httpStatus) {
+    GroupMetrics& metrics = g_groups[static_cast<int>(group)];
+    const uint64_t phases[PHASE_COUNT] = {
+        timing.dnsUs, timing.connectUs, timing.tlsUs, timing.ttfbUs, timing.totalUs
+    };
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        if (phases[i] > 0) metrics.phases[i].Record(phases[i]);
+    }
+    if (httpStatus > 0) metrics.responseBytes.Record(bytes);
+
+    int status = httpStatus > 0 && httpStatus < MAX_HTTP_STATUS ? httpStatus : 0;
+    metrics.statuses[status].fetch_add(1, std::memory_order_relaxed);
+}
+
+void FetchMetrics::RecordParse(SymbolGroup group, uint64_t micros) {
+    g_groups[static_cast<int>(group)].parseMicros.Record(micros);
+}
+
+void FetchMetrics::RecordResult(SymbolGroup group, FetchError error) {
+    g_groups[static_cast<int>(group)].results[static_cast<int>(error)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void FetchMetrics::AddSeries(const char* name, const char* help, const char* type, SeriesReader read) {
+    std::lock_guard<std::mutex> lock(g_seriesMutex);
+    for (ExtraSeries& series : g_series) {
+        if (strcmp(series.name, name) == 0) {
+            series = { name, help, type, read };
+            return;
+        }
+    }
+    g_series.push_back({ name, help, type, read });
+}
+
+void FetchMetrics::SetHost(const std::wstring& host) {
+    // Host names are ASCII (IDN hosts arrive punycoded)
+    std::string ascii;
+    for (wchar_t c : host) ascii += c < 0x80 && c != L'"' && c != L'\\' ? static_cast<char>(c) : '_';
+
+    std::lock_guard<std::mutex> lock(g_hostMutex);
+    g_host = ascii;
+}
+
+// Labels shared by every series of one group
+static std::string GroupLabels(const std::string& host, int group) {
+    return "host=\"" + host + "\",group=\"" + g_groupNames[group] + "\"";
+}
+
+// One histogram series with cumulative buckets at powers of two from
+// 2^minBits to 2^maxBits, which fall exactly on bucket edges
+static void WriteHistogram(std::ostringstream& out, const char* name, const std::string& labels,
+    const Histogram::Totals& totals, int minBits, int maxBits) {
+    uint64_t cumulative = 0;
+    int bucket = 0;
+    for (int bits = minBits; bits <= maxBits; ++bits) {
+        uint64_t bound = 1ULL << bits;
+        while (bucket < Histogram::BUCKETS && Histogram::BucketFloor(bucket) < bound) {
+            cumulative += totals.buckets[bucket++];
+        }
+        out << name << "_bucket{" << labels << ",le=\"" << bound << "\"} " << cumulative << "\n";
+    }
+    out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << totals.count << "\n";
+    out << name << "_sum{" << labels << "} " << totals.sum << "\n";
+    out << name << "_count{" << labels << "} " << totals.count << "\n";
+}
+
+std::string FetchMetrics::FormatPrometheus() {
+    std::string host;
+    {
+        std::lock_guard<std::mutex> lock(g_hostMutex);
+        host = g_host;
+    }
+
+    std::ostringstream out;
+    auto totals = std::make_unique<Histogram::Totals>();
+
+    out << "# HELP quote_request_phase_microseconds Time spent in each phase of a quote request\n";
+    out << "# TYPE quote_request_phase_microseconds histogram\n";
+    for (int group = 0; group < GROUP_COUNT; ++group) {
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            g_groups[group].phases[phase].Read(*totals);
+            if (totals->count == 0) continue;
+            WriteHistogram(out, "quote_request_phase_microseconds",
+                GroupLabels(host, group) + ",phase=\"" + g_phaseNames[phase] + "\"", *totals, 7, 25);
+        }
+    }
+
+    out << "# HELP quote_request_phase_quantile_microseconds Latency quantiles from the fine-grained histograms\n";
+    out << "# TYPE quote_request_phase_quantile_microseconds gauge\n";
+    for (int group = 0; group < GROUP_COUNT; ++group) {
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            g_groups[group].phases[phase].Read(*totals);
+            if (totals->count == 0) continue;
+            for (double quantile : { 0.5, 0.9, 0.99 }) {
+                out << "quote_request_phase_quantile_microseconds{" << GroupLabels(host, group)
+                    << ",phase=\"" << g_phaseNames[phase] << "\",quantile=\"" << quantile << "\"} "
+                    << Histogram::Quantile(*totals, quantile) << "\n";
+            }
+        }
+    }
+
+    out << "# HELP quote_response_bytes Size of quote response bodies\n";
+    out << "# TYPE quote_response_bytes histogram\n";
+    for (int group = 0; group < GROUP_COUNT; ++group) {
+        g_groups[group].responseBytes.Read(*totals);
+        if (totals->count == 0) continue;
+        WriteHistogram(out, "quote_response_bytes", GroupLabels(host, group), *totals, 6, 22);
+    }
+
+    out << "# HELP quote_parse_microseconds Time spent parsing one response\n";
+    out << "# TYPE quote_parse_microseconds histogram\n";
+    for (int group = 0; group < GROUP_COUNT; ++group) {
+        g_groups[group].parseMicros.Read(*totals);
+        if (totals->count == 0) continue;
+        WriteHistogram(out, "quote_parse_microseconds", GroupLabels(host, group), *totals, 0, 16);
+    }
+
+    out << "# HELP quote_http_responses_total HTTP responses by status code (0 = no response)\n";
+    out << "# TYPE quote_http_responses_total counter\n";
+    for (int group = 0; group < GROUP_COUNT; ++group) {
+        for (int status = 0; status < MAX_HTTP_STATUS; ++status) {
+            uint64_t count = g_groups[group].statuses[status].load(std::memory_order_relaxed);
+            if (count == 0) continue;
+            out << "quote_http_responses_total{" << GroupLabels(host, group) << ",code=\"" << status << "\"} "
+                << count << "\n";
+        }
+    }
+
+    out << "# HELP quote_fetch_results_total Outcome of each symbol fetch\n";
+    out << "# TYPE quote_fetch_results_total counter\n";
+    for (int group = 0; group < GROUP_COUNT; ++group) {
+        for (int error = 0; error < ERROR_COUNT; ++error) {
+            uint64_t count = g_groups[group].results[error].load(std::memory_order_relaxed);
+            if (count == 0) continue;
+            out << "quote_fetch_results_total{" << GroupLabels(host, group) << ",result=\"" << g_errorNames[error]
+                << "\"} " << count << "\n";
+        }
+    }
+    out << "# HELP startup_phase_microseconds Time from process creation to each startup milestone\n";
+    out << "# TYPE startup_phase_microseconds gauge\n";
+    for (int phase = 0; phase < static_cast<int>(StartupPhase::Count); ++phase) {
+        uint64_t micros = StartupTimeline::GetMicros(static_cast<StartupPhase>(phase));
+        if (micros == 0) continue;
+        out << "startup_phase_microseconds{phase=\"" << StartupTimeline::GetName(static_cast<StartupPhase>(phase))
+            << "\"} " << micros << "\n";
+    }
+
+    out << "# HELP quote_updates_published_total Quotes published to the conflator, from fetches and the local feed\n";
+    out << "# TYPE quote_updates_published_total counter\n";
+    out << "quote_updates_published_total " << QuoteConflator::GetUpdatesPublished() << "\n";
+    out << "# HELP quote_updates_conflated_total Published quotes overwritten by a newer one before the render thread drained them\n";
+    out << "# TYPE quote_updates_conflated_total counter\n";
+    out << "quote_updates_conflated_total " << QuoteConflator::GetUpdatesConflated() << "\n";
+
+    std::lock_guard<std::mutex> lock(g_seriesMutex);
+    for (const ExtraSeries& series : g_series) {
+        out << "# HELP " << series.name << " " << series.help << "\n";
+        out << "# TYPE " << series.name << " " << series.type << "\n";
+        out << series.name << " " << series.read() << "\n";
+    }
+    return out.str();
+}
+
+bool FetchMetrics::WriteFile(const std::wstring& path) {
+    std::wstring temp = path + L".tmp";
+    {
+        std::ofstream file(std::filesystem::path(temp), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file << FormatPrometheus();
+        if (!file.good()) return false;
+    }
+    return MoveFileExW(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#ifndef FETCH_METRICS_H
+#define FETCH_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "ApiFetcher.h"
+#include "SymbolGroup.h"
+
+// Histogram with HDR-style log-linear buckets: 8 linear sub-buckets per
+// power of two, so any value is counted within 12.5% of its true size.
+// Recording is one relaxed atomic add on the recording thread's own shard;
+// readers sum the shards.
+class Histogram {
+public:
+    static const int SUB_BUCKET_BITS = 3;
+    static const int MAX_VALUE_BITS = 36;   // Larger values are clamped
+    static const int BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+    static const int SHARDS = 4;
+
+    void Record(uint64_t value);
+
+    // Merged view of all shards
+    struct Totals {
+        uint64_t buckets[BUCKETS];
+        uint64_t count;
+        uint64_t sum;
+    };
+    void Read(Totals& totals) const;
+
+    static int BucketOf(uint64_t value);
+
+    // Smallest value counted in a bucket
+    static uint64_t BucketFloor(int bucket);
+
+    // Value below which the given fraction of recorded values fall
+    static uint64_t Quantile(const Totals& totals, double quantile);
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> buckets[BUCKETS];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+    };
+    Shard m_shards[SHARDS];
+};
+
+// Request phases timed by the HTTP client, in microseconds. A phase that
+// did not happen (DNS and connect on a reused connection, TLS over plain
+// HTTP) is 0.
+struct RequestTiming {
+    uint64_t dnsUs = 0;
+    uint64_t connectUs = 0;
+    uint64_t tlsUs = 0;
+    uint64_t ttfbUs = 0;     // Send started -> response headers
+    uint64_t totalUs = 0;    // Send started -> last byte
+    uint64_t startedUs = 0;  // FetchMetrics::NowMicros() when the send started
+};
+
+// Quote fetch metrics, exported in the Prometheus text format. All
+// recording is lock-free and safe from any thread.
+class FetchMetrics {
+public:
+    // Quote server named in the host label of every series
+    static void SetHost(const std::wstring& host);
+
+    // One HTTP request (a retried fetch records each attempt)
+    static void RecordRequest(SymbolGroup group, const RequestTiming& timing,
+        uint64_t bytes, int httpStatus);
+
+    // Time spent parsing one response body
+    static void RecordParse(SymbolGroup group, uint64_t micros);
+
+    // Final outcome of one symbol's fetch
+    static void RecordResult(SymbolGroup group, FetchError error);
+
+    // Add a series from outside the fetch path to every dump, e.g. the
+    // render thread's frame counters. read is called at dump time; type is
+    // "counter" or "gauge". Adding a name again replaces it.
+    typedef unsigned long long (*SeriesReader)();
+    static void AddSeries(const char* name, const char* help, const char* type, SeriesReader read);
+
+    // All metrics in the Prometheus text exposition format
+    static std::string FormatPrometheus();
+
+    // Write FormatPrometheus() to path, replacing the file atomically so a
+    // scraper never reads half a dump
+    static bool WriteFile(const std::wstring& path);
+
+    // Microsecond clock for timing phases (the trace timeline)
+    static uint64_t NowMicros();
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "FrameComposer.h"
+#include "Compositor.h"
+
+#include <algorithm>
+
+static uint32_t ToneColor(SegmentTone tone, bool flash, const FrameStyle& style, bool flashing) {
+    if (flashing && flash) return style.flash;
+    switch (tone) {
+    case SegmentTone::Up: return style.up;
+    case SegmentTone::Down: return style.down;
+    default: return style.neutral;
+    }
+}
+
+// Blend the glyph mask in each visible run's color. Runs repeat every cycle;
+// adjacent runs resolving to the same color are merged, so the number of
+// blends depends on visible color changes, not on the number of symbols.
+static int BlendRuns(uint32_t* pixels, const uint32_t* mask, int width, int height,
+    const TapeSnapshot& tape, double offset, int charWidth,
+    const FrameStyle& style, bool flashing) {
+    if (tape.cycleLength <= 0 || tape.runs.empty() || charWidth <= 0) return 0;
+
+    const int scroll = static_cast<int>(offset);
+
+    // Visible character range in tape coordinates
+    int firstChar = scroll / charWidth;
+    int lastChar = (scroll + width + charWidth - 1) / charWidth;
+
+    size_t runIndex = 0;
+    int cycleBase = (firstChar / tape.cycleLength) * tape.cycleLength;
+    while (runIndex < tape.runs.size() &&
+        cycleBase + tape.runs[runIndex].start + tape.runs[runIndex].length <= firstChar) {
+        ++runIndex;
+    }
+
+    int drawCalls = 0;
+    int spanStart = -1;
+    int spanEnd = 0;
+    uint32_t spanColor = 0;
+
+    auto flush = [&]() {
+        if (spanStart < 0) return;
+        int x0 = std::max(0, spanStart * charWidth - scroll);
+        int x1 = std::min(width, spanEnd * charWidth - scroll);
+        if (x1 > x0) {
+            Compositor::BlendCoverage(pixels + x0, width, mask + x0, width,
+                x1 - x0, height, spanColor, 255);
+            ++drawCalls;
+        }
+    };
+
+    for (int pos = firstChar; pos < lastChar;) {
+        if (runIndex == tape.runs.size()) {
+            runIndex = 0;
+            cycleBase += tape.cycleLength;
+        }
+        const StyledRun& run = tape.runs[runIndex++];
+        int runStart = cycleBase + run.start;
+        int runEnd = runStart + run.length;
+        uint32_t color = ToneColor(run.tone, run.flash, style, flashing);
+
+        if (spanStart >= 0 && color == spanColor) {
+            spanEnd = runEnd;
+        }
+        else {
+            flush();
+            spanStart = runStart;
+            spanEnd = runEnd;
+            spanColor = color;
+        }
+        pos = runEnd;
+    }
+    flush();
+
+    return drawCalls;
+}
+
+// Blend each visible cached sparkline at its cells, vertically centered.
+// Stamps repeat every cycle like runs; only those overlapping the window are
+// touched.
+static int BlendSparklines(uint32_t* pixels, int width, int height,
+    const TapeSnapshot& tape, double offset, int charWidth,
+    const FrameStyle& style, bool flashing) {
+    if (tape.cycleLength <= 0 || tape.sparklines.empty() || charWidth <= 0) return 0;
+
+    const int scroll = static_cast<int>(offset);
+    const int firstChar = scroll / charWidth;
+    const int lastChar = (scroll + width + charWidth - 1) / charWidth;
+
+    int drawCalls = 0;
+    for (int cycleBase = (firstChar / tape.cycleLength) * tape.cycleLength; cycleBase < lastChar;
+        cycleBase += tape.cycleLength) {
+        // Skip stamps ending before the window in the first cycle
+        auto it = std::partition_point(tape.sparklines.begin(), tape.sparklines.end(),
+            [&](const SparklineStamp& stamp) { return cycleBase + stamp.start + SPARKLINE_CELLS <= firstChar; });
+
+        for (; it != tape.sparklines.end() && cycleBase + it->start < lastChar; ++it) {
+            const SparklineBitmap& bitmap = *it->bitmap;
+            int left = (cycleBase + it->start) * charWidth - scroll;
+            int top = (height - bitmap.height) / 2;
+            int x0 = std::max(0, left);
+            int x1 = std::min(width, left + bitmap.width);
+            int y0 = std::max(0, top);
+            int y1 = std::min(height, top + bitmap.height);
+            if (x1 <= x0 || y1 <= y0) continue;
+
+            Compositor::BlendCoverage(pixels + static_cast<size_t>(y0) * width + x0, width,
+                bitmap.mask.data() + static_cast<size_t>(y0 - top) * bitmap.width + (x0 - left), bitmap.width,
+                x1 - x0, y1 - y0, ToneColor(it->tone, it->flash, style, flashing), 255);
+            ++drawCalls;
+        }
+    }
+    return drawCalls;
+}
+
+int FrameComposer::Compose(uint32_t* pixels, const uint32_t* mask, int width, int height,
+    const TapeSnapshot& tape, double offset, int charWidth,
+    const FrameStyle& style, unsigned long long now) {
+    if (!pixels || width <= 0 || height <= 0) return 0;
+
+    Compositor::Fill(pixels, width, width, height,
+        Compositor::Premultiply(style.background, style.backgroundAlpha));
+
+    int drawCalls = 0;
+    if (mask) {
+        drawCalls = BlendRuns(pixels, mask, width, height, tape, offset, charWidth,
+            style, now < tape.flashUntil);
+    }
+    drawCalls += BlendSparklines(pixels, width, height, tape, offset, charWidth,
+        style, now < tape.flashUntil);
+
+    Compositor::FadeEdges(pixels, width, width, height, style.edgeFade);
+    return drawCalls;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef FRAME_COMPOSER_H
+#define FRAME_COMPOSER_H
+
+#include <cstdint>
+#include "TapeModel.h"
+
+// Colors and effects for one frame, resolved from the config by the caller
+struct FrameStyle {
+    uint32_t neutral;          // 0xRRGGBB run colors
+    uint32_t up;
+    uint32_t down;
+    uint32_t flash;
+    uint32_t background;       // 0xRRGGBB
+    uint8_t backgroundAlpha;
+    int edgeFade;              // Pixels faded at each end, 0 = none
+};
+
+// Turns a glyph mask and a tape snapshot into a finished premultiplied BGRA
+// frame. Platform independent: used by the render thread and the headless
+// renderer alike.
+class FrameComposer {
+public:
+    // Compose one frame into pixels (stride = width). now is the tick count
+    // compared against the snapshot's flashUntil. The snapshot's cached
+    // sparklines are blended over their cells after the text. Returns the
+    // number of colored blends issued.
+    static int Compose(uint32_t* pixels, const uint32_t* mask, int width, int height,
+        const TapeSnapshot& tape, double offset, int charWidth,
+        const FrameStyle& style, unsigned long long now);
+};
+
+#endif
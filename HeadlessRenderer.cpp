@@ -0,0 +1,205 @@
+#include "HeadlessRenderer.h"
+
+#include <algorithm>
+#include <fstream>
+
+#define GLYPH_COLUMNS 5
+#define GLYPH_ROWS 7
+#define CELL_WIDTH 6
+#define CELL_HEIGHT 8
+
+// 5x7 glyphs for 0x20-0x7E, one byte per row top to bottom, bit 4 is the
+// leftmost column
+static const uint8_t g_glyphs[95][GLYPH_ROWS] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // !
+    { 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 }, // "
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // #
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // $
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // &
+    { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 }, // '
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // *
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // +
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ,
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ;
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // <
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // =
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // >
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // ?
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // @
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // A
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // Y
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+    { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // [
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // backslash
+    { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ]
+    { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // _
+    { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00 }, // `
+    { 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F }, // a
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E }, // b
+    { 0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E }, // c
+    { 0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F }, // d
+    { 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E }, // e
+    { 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08 }, // f
+    { 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // g
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11 }, // h
+    { 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E }, // i
+    { 0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C }, // j
+    { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12 }, // k
+    { 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // l
+    { 0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11 }, // m
+    { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11 }, // n
+    { 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E }, // o
+    { 0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10 }, // p
+    { 0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01 }, // q
+    { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10 }, // r
+    { 0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E }, // s
+    { 0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06 }, // t
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D }, // u
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // v
+    { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A }, // w
+    { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11 }, // x
+    { 0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // y
+    { 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F }, // z
+    { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02 }, // {
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // |
+    { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08 }, // }
+    { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00 }, // ~
+};
+
+static const uint8_t* GlyphFor(wchar_t ch) {
+    if (ch < 0x20 || ch > 0x7E) ch = L'?';
+    return g_glyphs[ch - 0x20];
+}
+
+BitmapFontRasterizer::BitmapFontRasterizer(int scale)
+    : m_scale(std::max(1, scale)) {
+}
+
+int BitmapFontRasterizer::GetCellWidth() {
+    return CELL_WIDTH * m_scale;
+}
+
+int BitmapFontRasterizer::GetGlyphHeight() const {
+    return CELL_HEIGHT * m_scale;
+}
+
+const uint32_t* BitmapFontRasterizer::RenderMask(const std::wstring& text, double offset,
+    int width, int height, int charWidth) {
+    if (width <= 0 || height <= 0 || charWidth <= 0) return nullptr;
+
+    m_mask.assign(static_cast<size_t>(width) * height, 0xFF000000);
+
+    // Vertical centering, as the GDI backend does
+    int yPos = (height - GetGlyphHeight()) / 2;
+
+    // Same visible slice as Renderer::RenderMask
+    int scroll = static_cast<int>(offset);
+    size_t first = static_cast<size_t>(scroll / charWidth);
+    if (first >= text.length()) return m_mask.data();
+    size_t count = std::min(text.length() - first, static_cast<size_t>(width / charWidth + 2));
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* glyph = GlyphFor(text[first + i]);
+        int cellX = static_cast<int>(first + i) * charWidth - scroll;
+
+        for (int row = 0; row < GLYPH_ROWS; ++row) {
+            if (!glyph[row]) continue;
+            for (int col = 0; col < GLYPH_COLUMNS; ++col) {
+                if (!(glyph[row] & (0x10 >> col))) continue;
+
+                // Clip the scaled pixel against the mask
+                int x0 = std::max(0, cellX + col * m_scale);
+                int x1 = std::min(width, cellX + (col + 1) * m_scale);
+                int y0 = std::max(0, yPos + row * m_scale);
+                int y1 = std::min(height, yPos + (row + 1) * m_scale);
+                for (int y = y0; y < y1; ++y) {
+                    std::fill(m_mask.begin() + static_cast<size_t>(y) * width + x0,
+                        m_mask.begin() + static_cast<size_t>(y) * width + std::max(x0, x1),
+                        0xFFFFFFFF);
+                }
+            }
+        }
+    }
+
+    return m_mask.data();
+}
+
+HeadlessRenderer::HeadlessRenderer(int width, int height, int scale)
+    : m_width(std::max(1, width)),
+    m_height(std::max(1, height)),
+    m_lastDrawCalls(0),
+    m_rasterizer(scale),
+    m_frame(static_cast<size_t>(m_width) * m_height, 0) {
+}
+
+const uint32_t* HeadlessRenderer::RenderFrame(const TapeSnapshot& tape, double offset,
+    const FrameStyle& style, unsigned long long now) {
+    int charWidth = m_rasterizer.GetCellWidth();
+    const uint32_t* mask = m_rasterizer.RenderMask(tape.text, offset, m_width, m_height, charWidth);
+
+    m_lastDrawCalls = FrameComposer::Compose(m_frame.data(), mask, m_width, m_height,
+        tape, offset, charWidth, style, now);
+    return m_frame.data();
+}
+
+bool HeadlessRenderer::WritePpm(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    file << "P6\n" << m_width << " " << m_height << "\n255\n";
+
+    std::vector<char> row(static_cast<size_t>(m_width) * 3);
+    for (int y = 0; y < m_height; ++y) {
+        const uint32_t* src = m_frame.data() + static_cast<size_t>(y) * m_width;
+        for (int x = 0; x < m_width; ++x) {
+            row[x * 3 + 0] = static_cast<char>(src[x] >> 16); // R
+            row[x * 3 + 1] = static_cast<char>(src[x] >> 8);  // G
+            row[x * 3 + 2] = static_cast<char>(src[x]);       // B
+        }
+        file.write(row.data(), row.size());
+    }
+
+    return file.good();
+}
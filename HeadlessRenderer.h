@@ -0,0 +1,59 @@
+#pragma once
+#ifndef HEADLESS_RENDERER_H
+#define HEADLESS_RENDERER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "TapeRasterizer.h"
+#include "FrameComposer.h"
+
+// Rasterizer using an embedded 5x7 bitmap font (printable ASCII; anything
+// else draws as '?'). Each glyph sits in a 6x8 cell scaled by an integer
+// factor. Needs no OS support, so frames are reproducible across machines.
+class BitmapFontRasterizer : public TapeRasterizer {
+public:
+    explicit BitmapFontRasterizer(int scale = 2);
+
+    int GetCellWidth() override;
+    const uint32_t* RenderMask(const std::wstring& text, double offset,
+        int width, int height, int charWidth) override;
+
+    int GetGlyphHeight() const;
+
+private:
+    int m_scale;
+    std::vector<uint32_t> m_mask;
+};
+
+// Renders complete tape frames into memory without a window, GDI or a
+// render thread, for benchmarking and golden-image comparison.
+class HeadlessRenderer {
+public:
+    HeadlessRenderer(int width, int height, int scale = 2);
+
+    // Compose one frame; the returned buffer is premultiplied BGRA
+    // (stride = width) and stays valid until the next call
+    const uint32_t* RenderFrame(const TapeSnapshot& tape, double offset,
+        const FrameStyle& style, unsigned long long now);
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetCellWidth() { return m_rasterizer.GetCellWidth(); }
+
+    // Colored blends issued for the last frame
+    int GetLastFrameDrawCalls() const { return m_lastDrawCalls; }
+
+    // Write the last frame as a binary PPM (P6). Alpha is dropped, which
+    // is the frame composited over black since pixels are premultiplied.
+    bool WritePpm(const std::string& path) const;
+
+private:
+    int m_width;
+    int m_height;
+    int m_lastDrawCalls;
+    BitmapFontRasterizer m_rasterizer;
+    std::vector<uint32_t> m_frame;
+};
+
+#endif
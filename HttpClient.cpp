@@ -0,0 +1,413 @@
+#include "HttpClient.h"
+#include "Trace.h"
+#include "Log.h"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <winhttp.h>
+#include <algorithm>
+#include <climits>
+#include <coroutine>
+#include <mutex>
+
+#ifdef _MSC_VER
+#pragma comment(lib, "winhttp.lib")
+#endif
+
+void CancelToken::Cancel() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cancelled = true;
+    for (void* hRequest : m_requests) {
+        WinHttpCloseHandle(hRequest);
+    }
+    m_requests.clear();
+}
+
+void CancelToken::Reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cancelled = false;
+}
+
+bool CancelToken::Attach(void* hRequest) {
+    auto lock = TracedLock(m_mutex, "CancelToken");
+    if (m_cancelled.load()) return false;
+    m_requests.push_back(hRequest);
+    return true;
+}
+
+void CancelToken::Release(void* hRequest) {
+    auto lock = TracedLock(m_mutex, "CancelToken");
+    auto it = std::find(m_requests.begin(), m_requests.end(), hRequest);
+    if (it != m_requests.end()) {
+        WinHttpCloseHandle(hRequest);
+        m_requests.erase(it);
+    }
+}
+
+// State of one request, living in its coroutine frame. The request handle's
+// context value points here so the status callback can find the coroutine.
+struct RequestContext {
+    HINTERNET hRequest = nullptr;
+    std::coroutine_handle<> waiter;   // Coroutine suspended on an operation
+    DWORD error = 0;                  // Win32 error of the last operation
+    DWORD bytes = 0;                  // DATA_AVAILABLE size or bytes read
+    bool secure = false;
+
+    // FetchMetrics::NowMicros() at each milestone, 0 until it happens
+    uint64_t started = 0;
+    uint64_t resolved = 0;
+    uint64_t connected = 0;
+    uint64_t sending = 0;
+    uint64_t headers = 0;
+
+    // HANDLE_CLOSING is the last callback for the handle; the frame must
+    // outlive it
+    std::mutex mutex;
+    bool closed = false;
+    std::coroutine_handle<> closeWaiter;
+};
+
+// Resume whichever coroutine waits on an operation. Nothing may touch ctx
+// after this: the coroutine can run to completion and free it.
+static void ResumeWaiter(RequestContext* ctx) {
+    std::coroutine_handle<> waiter;
+    {
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        waiter = std::exchange(ctx->waiter, nullptr);
+    }
+    if (waiter) waiter.resume();
+}
+
+static void CALLBACK StatusCallback(HINTERNET, DWORD_PTR context, DWORD status,
+    LPVOID info, DWORD infoLength) {
+    RequestContext* ctx = reinterpret_cast<RequestContext*>(context);
+    if (!ctx) return;
+
+    switch (status) {
+    // Progress notifications only timestamp the phases; the first one wins
+    // if a redirect repeats them
+    case WINHTTP_CALLBACK_STATUS_NAME_RESOLVED:
+        if (!ctx->resolved) ctx->resolved = FetchMetrics::NowMicros();
+        break;
+    case WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER:
+        if (!ctx->connected) ctx->connected = FetchMetrics::NowMicros();
+        break;
+    case WINHTTP_CALLBACK_STATUS_SENDING_REQUEST:
+        if (!ctx->sending) ctx->sending = FetchMetrics::NowMicros();
+        break;
+    case WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE:
+        ResumeWaiter(ctx);
+        break;
+    case WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE:
+        ctx->headers = FetchMetrics::NowMicros();
+        ResumeWaiter(ctx);
+        break;
+    case WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE:
+        ctx->bytes = *static_cast<DWORD*>(info);
+        ResumeWaiter(ctx);
+        break;
+    case WINHTTP_CALLBACK_STATUS_READ_COMPLETE:
+        ctx->bytes = infoLength;
+        ResumeWaiter(ctx);
+        break;
+    case WINHTTP_CALLBACK_STATUS_REQUEST_ERROR:
+        ctx->error = static_cast<WINHTTP_ASYNC_RESULT*>(info)->dwError;
+        ResumeWaiter(ctx);
+        break;
+    case WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING: {
+        // A cancel can close the handle under a pending operation; fail
+        // that operation rather than leave the coroutine suspended
+        std::coroutine_handle<> waiter, closeWaiter;
+        {
+            std::lock_guard<std::mutex> lock(ctx->mutex);
+            ctx->closed = true;
+            closeWaiter = std::exchange(ctx->closeWaiter, nullptr);
+            waiter = std::exchange(ctx->waiter, nullptr);
+            if (waiter) ctx->error = ERROR_WINHTTP_OPERATION_CANCELLED;
+        }
+        if (waiter) waiter.resume();
+        else if (closeWaiter) closeWaiter.resume();
+        break;
+    }
+    }
+}
+
+// Suspend on one WinHTTP call whose completion arrives through
+// StatusCallback; resumes with the Win32 error (0 on success)
+template <typename Start>
+struct AsyncOperation {
+    RequestContext& ctx;
+    Start start;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        {
+            std::lock_guard<std::mutex> lock(ctx.mutex);
+            ctx.error = 0;
+            ctx.bytes = 0;
+            ctx.waiter = h;
+        }
+        if (start()) return true;
+
+        // Failed synchronously, so no completion will come. A concurrent
+        // cancel may still have claimed and resumed the coroutine through
+        // HANDLE_CLOSING; then it must not be resumed twice.
+        DWORD error = GetLastError();
+        std::lock_guard<std::mutex> lock(ctx.mutex);
+        if (ctx.waiter != h) return true;
+        ctx.waiter = nullptr;
+        ctx.error = error;
+        return false;
+    }
+
+    DWORD await_resume() const noexcept { return ctx.error; }
+};
+
+template <typename Start>
+static AsyncOperation<Start> Async(RequestContext& ctx, Start start) {
+    return { ctx, std::move(start) };
+}
+
+// Close the request handle and wait for HANDLE_CLOSING, after which
+// WinHTTP no longer references the context
+template <typename Close>
+struct CloseAwaiter {
+    RequestContext& ctx;
+    Close close;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        {
+            std::lock_guard<std::mutex> lock(ctx.mutex);
+            if (ctx.closed) return false;
+            ctx.closeWaiter = h;
+        }
+        // The callback may resume the coroutine before close() returns, so
+        // nothing here is touched after it starts
+        close();
+        return true;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+template <typename Close>
+static CloseAwaiter<Close> CloseRequest(RequestContext& ctx, Close close) {
+    return { ctx, std::move(close) };
+}
+
+// Map a failed WinHTTP call to a fetch error
+static FetchError ClassifyError(DWORD error, CancelToken* token) {
+    if (token && token->IsCancelled()) return FetchError::Cancelled;
+    switch (error) {
+    case ERROR_WINHTTP_TIMEOUT: return FetchError::Timeout;
+    case ERROR_WINHTTP_OPERATION_CANCELLED: return FetchError::Cancelled;
+    default: return FetchError::Network;
+    }
+}
+
+// Give the next phase whatever is left of the deadline; false if none is
+static bool ArmTimeouts(HINTERNET hRequest, unsigned long long deadline) {
+    ULONGLONG now = GetTickCount64();
+    if (now >= deadline) return false;
+
+    int remaining = static_cast<int>(std::min<ULONGLONG>(deadline - now, INT_MAX));
+    WinHttpSetTimeouts(hRequest, remaining, remaining, remaining, remaining);
+    return true;
+}
+
+HttpClient::HttpClient(const std::wstring& host, int port, bool secure, int maxConnections)
+    : m_session(nullptr), m_connect(nullptr), m_host(host), m_port(port), m_secure(secure),
+    m_freeConnections(std::max(1, maxConnections)) {
+    m_session = WinHttpOpen(API_USER_AGENT, WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+        WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, WINHTTP_FLAG_ASYNC);
+    if (!m_session) {
+        LOG_ERROR("HttpClient: WinHttpOpen failed ({})", GetLastError());
+        return;
+    }
+
+    // Get() already keeps requests within the limit; WinHTTP's own cap
+    // matches it so its pool never opens more
+    DWORD connections = static_cast<DWORD>(maxConnections);
+    WinHttpSetOption(m_session, WINHTTP_OPTION_MAX_CONNS_PER_SERVER, &connections, sizeof(connections));
+
+    m_connect = WinHttpConnect(m_session, host.c_str(), static_cast<INTERNET_PORT>(port), 0);
+    if (!m_connect) {
+        LOG_ERROR("HttpClient: WinHttpConnect({}:{}) failed ({})", host, port, GetLastError());
+    }
+}
+
+HttpClient::~HttpClient() {
+    if (m_connect) WinHttpCloseHandle(m_connect);
+    if (m_session) WinHttpCloseHandle(m_session);
+}
+
+bool HttpClient::ConnectionAwaiter::await_ready() {
+    std::lock_guard<std::mutex> lock(client.m_connectionMutex);
+    if (client.m_freeConnections == 0) return false;
+    --client.m_freeConnections;
+    return true;
+}
+
+bool HttpClient::ConnectionAwaiter::await_suspend(std::coroutine_handle<> h) {
+    // A connection may have been released since await_ready()
+    std::lock_guard<std::mutex> lock(client.m_connectionMutex);
+    if (client.m_freeConnections > 0) {
+        --client.m_freeConnections;
+        return false;
+    }
+    client.m_connectionWaiters.push_back(h);
+    return true;
+}
+
+void HttpClient::ReleaseConnection() {
+    std::coroutine_handle<> next;
+    {
+        std::lock_guard<std::mutex> lock(m_connectionMutex);
+        if (m_connectionWaiters.empty()) {
+            ++m_freeConnections;
+            return;
+        }
+        next = m_connectionWaiters.front();
+        m_connectionWaiters.pop_front();
+    }
+    // The waiter runs here until its first network step suspends
+    next.resume();
+}
+
+// Turn the context's milestones into phase durations. DNS and connect are
+// absent on a reused connection; TLS spans connected -> first send.
+static RequestTiming PhaseTiming(const RequestContext& ctx, uint64_t finished) {
+    RequestTiming timing;
+    if (!ctx.started) return timing;
+
+    uint64_t connectStart = ctx.resolved ? ctx.resolved : ctx.started;
+    if (ctx.resolved) timing.dnsUs = ctx.resolved - ctx.started;
+    if (ctx.connected) timing.connectUs = ctx.connected - connectStart;
+    if (ctx.connected && ctx.sending && ctx.secure) timing.tlsUs = ctx.sending - ctx.connected;
+    if (ctx.headers) timing.ttfbUs = ctx.headers - ctx.started;
+    timing.totalUs = finished - ctx.started;
+    timing.startedUs = ctx.started;
+    return timing;
+}
+
+// Send the request and read the whole response into body
+static CoTask<FetchError> Transfer(RequestContext& ctx, HttpResponse& response, std::string& body,
+    CancelToken* token, unsigned long long deadline) {
+    // DNS, connect, TLS handshake and send
+    if (!ArmTimeouts(ctx.hRequest, deadline)) co_return FetchError::Timeout;
+    ctx.started = FetchMetrics::NowMicros();
+    DWORD error = co_await Async(ctx, [&]() {
+        return WinHttpSendRequest(ctx.hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
+            WINHTTP_NO_REQUEST_DATA, 0, 0, reinterpret_cast<DWORD_PTR>(&ctx));
+    });
+    if (error) co_return ClassifyError(error, token);
+
+    if (!ArmTimeouts(ctx.hRequest, deadline)) co_return FetchError::Timeout;
+    error = co_await Async(ctx, [&]() { return WinHttpReceiveResponse(ctx.hRequest, nullptr); });
+    if (error) co_return ClassifyError(error, token);
+
+    // Headers are already here, so this query completes synchronously
+    DWORD status = 0;
+    DWORD statusSize = sizeof(status);
+    if (WinHttpQueryHeaders(ctx.hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+        WINHTTP_HEADER_NAME_BY_INDEX, &status, &statusSize, WINHTTP_NO_HEADER_INDEX)) {
+        response.status = static_cast<int>(status);
+        if (status != 200) co_return FetchError::HttpStatus;
+    }
+
+    // Read straight into the caller's buffer, growing it only past its
+    // capacity
+    for (;;) {
+        if (!ArmTimeouts(ctx.hRequest, deadline)) co_return FetchError::Timeout;
+        error = co_await Async(ctx, [&]() { return WinHttpQueryDataAvailable(ctx.hRequest, nullptr); });
+        if (error) co_return ClassifyError(error, token);
+
+        DWORD available = ctx.bytes;
+        if (available == 0) co_return FetchError::None;
+
+        size_t used = body.size();
+        body.resize(used + available);
+        error = co_await Async(ctx, [&]() {
+            return WinHttpReadData(ctx.hRequest, body.data() + used, available, nullptr);
+        });
+        if (error) co_return ClassifyError(error, token);
+        body.resize(used + ctx.bytes);
+    }
+}
+
+CoTask<HttpResponse> HttpClient::Get(const std::wstring& path, std::string& body, CancelToken* token,
+    int timeoutMs, unsigned long long passDeadline) {
+    HttpResponse response;
+    body.clear();
+    if (token && token->IsCancelled()) {
+        response.error = FetchError::Cancelled;
+        co_return response;
+    }
+    if (!m_connect) {
+        response.error = FetchError::Network;
+        co_return response;
+    }
+
+    // The request's own time starts once it has a connection. A cancel
+    // while waiting lets the running requests finish early and hand theirs
+    // on, so waiters see it promptly.
+    co_await AcquireConnection();
+    response = co_await Exchange(path, body, token,
+        std::min<unsigned long long>(passDeadline, GetTickCount64() + std::max(0, timeoutMs)));
+    ReleaseConnection();
+
+    if (response.error != FetchError::None) body.clear();
+    co_return response;
+}
+
+// One request on an acquired connection
+CoTask<HttpResponse> HttpClient::Exchange(const std::wstring& path, std::string& body, CancelToken* token,
+    unsigned long long deadline) {
+    HttpResponse response;
+    if (token && token->IsCancelled()) {
+        response.error = FetchError::Cancelled;
+        co_return response;
+    }
+
+    RequestContext ctx;
+    ctx.secure = m_secure;
+    ctx.hRequest = WinHttpOpenRequest(m_connect, L"GET", path.c_str(), nullptr, WINHTTP_NO_REFERER,
+        WINHTTP_DEFAULT_ACCEPT_TYPES, m_secure ? WINHTTP_FLAG_SECURE : 0);
+    if (!ctx.hRequest) {
+        response.error = FetchError::Network;
+        co_return response;
+    }
+
+    RequestContext* context = &ctx;
+    WinHttpSetOption(ctx.hRequest, WINHTTP_OPTION_CONTEXT_VALUE, &context, sizeof(context));
+    WinHttpSetStatusCallback(ctx.hRequest, StatusCallback,
+        WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_HANDLES |
+        WINHTTP_CALLBACK_FLAG_RESOLVE_NAME | WINHTTP_CALLBACK_FLAG_CONNECT_TO_SERVER |
+        WINHTTP_CALLBACK_FLAG_SEND_REQUEST, 0);
+    WinHttpAddRequestHeaders(ctx.hRequest, L"Accept: application/json", (DWORD)-1, WINHTTP_ADDREQ_FLAG_ADD);
+
+    // From here on the token owns the request handle. A cancel may already
+    // have closed it, in which case Release() does nothing.
+    HINTERNET hRequest = ctx.hRequest;
+    if (token && !token->Attach(hRequest)) {
+        response.error = FetchError::Cancelled;
+        co_await CloseRequest(ctx, [hRequest]() { WinHttpCloseHandle(hRequest); });
+        co_return response;
+    }
+
+    response.error = co_await Transfer(ctx, response, body, token, deadline);
+    response.timing = PhaseTiming(ctx, FetchMetrics::NowMicros());
+    co_await CloseRequest(ctx, [hRequest, token]() {
+        if (token) token->Release(hRequest);
+        else WinHttpCloseHandle(hRequest);
+    });
+    co_return response;
+}
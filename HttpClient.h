@@ -0,0 +1,107 @@
+#pragma once
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ApiFetcher.h"
+#include "CoTask.h"
+#include "FetchMetrics.h"
+
+// Lets another thread abort fetches. Cancel() closes the request handles of
+// all fetches in progress with this token, which fails their pending
+// WinHTTP operations at once; later fetches with the token fail
+// immediately until Reset(). One token may be shared by concurrent fetches.
+class CancelToken {
+public:
+    void Cancel();
+    void Reset();
+    bool IsCancelled() const { return m_cancelled.load(); }
+
+private:
+    friend class HttpClient;
+
+    // Track a fetch's request handle; false if already cancelled
+    bool Attach(void* hRequest);
+
+    // Stop tracking the handle and close it unless Cancel() already did
+    void Release(void* hRequest);
+
+    std::mutex m_mutex;
+    std::atomic<bool> m_cancelled{ false };
+    std::vector<void*> m_requests;
+};
+
+struct HttpResponse {
+    FetchError error = FetchError::None;
+    int status = 0;      // HTTP status code once headers arrived
+    RequestTiming timing;
+};
+
+// Asynchronous HTTP client over WinHTTP's async mode. Requests are
+// coroutines: every network step suspends, and the WinHTTP status
+// callback resumes the coroutine when it completes, so any number of
+// requests in flight cost no threads of our own.
+//
+//     HttpResponse response = co_await client.Get(path, body, &token, timeoutMs, passDeadline);
+class HttpClient {
+public:
+    HttpClient(const std::wstring& host, int port, bool secure, int maxConnections);
+
+    // All requests must have completed before the client is destroyed
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    bool IsOpen() const { return m_connect != nullptr; }
+
+    // The server this client talks to
+    bool Targets(const std::wstring& host, int port, bool secure) const {
+        return host == m_host && port == m_port && secure == m_secure;
+    }
+
+    // GET path into body, which is cleared first but keeps its capacity, so
+    // a caller reusing one buffer per request stops allocating once it has
+    // seen its largest response. path and body must outlive the request;
+    // body is left empty on failure. At most maxConnections requests run at
+    // once and the rest wait their turn; a request's timeoutMs starts when
+    // it gets a connection, so time spent waiting is not charged to it.
+    // passDeadline, a GetTickCount64() value, caps it regardless. Each
+    // phase gets the time left when it starts. The coroutine resumes on a
+    // WinHTTP callback thread.
+    CoTask<HttpResponse> Get(const std::wstring& path, std::string& body, CancelToken* token,
+        int timeoutMs, unsigned long long passDeadline);
+
+private:
+    // co_await AcquireConnection() suspends until a connection is free
+    struct ConnectionAwaiter {
+        HttpClient& client;
+        bool await_ready();
+        bool await_suspend(std::coroutine_handle<> h);
+        void await_resume() const noexcept {}
+    };
+    ConnectionAwaiter AcquireConnection() { return { *this }; }
+
+    // Hand the connection to the longest waiting request, or free it
+    void ReleaseConnection();
+
+    CoTask<HttpResponse> Exchange(const std::wstring& path, std::string& body, CancelToken* token,
+        unsigned long long deadline);
+
+    void* m_session;
+    void* m_connect;
+    std::wstring m_host;
+    int m_port;
+    bool m_secure;
+
+    std::mutex m_connectionMutex;
+    int m_freeConnections;
+    std::deque<std::coroutine_handle<>> m_connectionWaiters;
+};
+
+#endif
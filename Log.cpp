@@ -0,0 +1,266 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "Log.h"
+
+#include <windows.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+// Slots in the ring; a full ring drops new messages rather than block
+#define LOG_RING_SIZE 1024
+
+// The log file is rotated to .1, .2, ... once it reaches this size
+#define LOG_MAX_FILE_BYTES (1024 * 1024)
+#define LOG_KEEP_FILES 3
+
+// The sink wakes this often; producers never signal it, so logging costs
+// no kernel transition
+#define LOG_FLUSH_INTERVAL_MS 50
+
+// Bounded MPSC ring after Vyukov: each cell's sequence says whether it is
+// free for the producer at that position or holds a record for the
+// consumer. Producers claim positions with a CAS on the head.
+struct LogCell {
+    std::atomic<size_t> sequence;
+    LogRecord record;
+};
+
+static LogCell g_cells[LOG_RING_SIZE];
+alignas(64) static std::atomic<size_t> g_head(0);
+alignas(64) static size_t g_tail = 0;   // Consumer only
+static std::atomic<unsigned long long> g_dropped(0);
+
+static std::thread g_sinkThread;
+static HANDLE g_stopEvent = nullptr;
+static std::wstring g_path;
+
+static bool InitCells() {
+    for (size_t i = 0; i < LOG_RING_SIZE; ++i) {
+        g_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    return true;
+}
+static const bool g_cellsReady = InitCells();
+
+LogRecord* Log::Reserve(size_t& position) {
+    size_t pos = g_head.load(std::memory_order_relaxed);
+    for (;;) {
+        LogCell& cell = g_cells[pos % LOG_RING_SIZE];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (g_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        }
+        else if (diff < 0) {
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        else {
+            pos = g_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    position = pos;
+    LogRecord* record = &g_cells[pos % LOG_RING_SIZE].record;
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    record->time = (static_cast<unsigned long long>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    record->threadId = GetCurrentThreadId();
+    return record;
+}
+
+void Log::Commit(size_t position) {
+    g_cells[position % LOG_RING_SIZE].sequence.store(position + 1, std::memory_order_release);
+}
+
+void Log::CaptureText(LogRecord& record, LogArgType type, const void* data, size_t bytes) {
+    LogArg& arg = record.args[record.argCount++];
+    arg.type = type;
+
+    // Long strings are cut to what is left of the payload, on a whole
+    // code unit
+    size_t unit = type == LogArgType::WideText ? sizeof(wchar_t) : 1;
+    size_t room = LOG_PAYLOAD_BYTES - record.payloadUsed;
+    bytes = std::min(bytes, room) / unit * unit;
+
+    memcpy(record.payload + record.payloadUsed, data, bytes);
+    arg.text.offset = record.payloadUsed;
+    arg.text.length = static_cast<uint16_t>(bytes);
+    record.payloadUsed = static_cast<uint16_t>(record.payloadUsed + bytes);
+}
+
+bool Log::Admit(LogSite& site) {
+    unsigned long long now = GetTickCount64();
+    unsigned long long start = site.windowStart.load(std::memory_order_relaxed);
+    if (now - start >= LOG_REPEAT_WINDOW_MS &&
+        site.windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        site.windowCount.store(0, std::memory_order_relaxed);
+    }
+
+    if (site.windowCount.fetch_add(1, std::memory_order_relaxed) < LOG_REPEAT_BURST) return true;
+    site.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+unsigned long long Log::GetDropped() {
+    return g_dropped.load();
+}
+
+static void AppendArg(std::string& out, const LogRecord& record, const LogArg& arg) {
+    char number[32];
+    switch (arg.type) {
+    case LogArgType::Int:
+        snprintf(number, sizeof(number), "%lld", static_cast<long long>(arg.i));
+        out += number;
+        break;
+    case LogArgType::UInt:
+        snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(arg.u));
+        out += number;
+        break;
+    case LogArgType::Double:
+        snprintf(number, sizeof(number), "%.6g", arg.d);
+        out += number;
+        break;
+    case LogArgType::Text:
+        out.append(record.payload + arg.text.offset, arg.text.length);
+        break;
+    case LogArgType::WideText: {
+        std::wstring wide(arg.text.length / sizeof(wchar_t), L'\0');
+        memcpy(wide.data(), record.payload + arg.text.offset, arg.text.length);
+        int size = WideCharToMultiByte(CP_UTF8, 0, wide.c_str(), static_cast<int>(wide.size()),
+            nullptr, 0, nullptr, nullptr);
+        if (size > 0) {
+            size_t at = out.size();
+            out.resize(at + size);
+            WideCharToMultiByte(CP_UTF8, 0, wide.c_str(), static_cast<int>(wide.size()),
+                &out[at], size, nullptr, nullptr);
+        }
+        break;
+    }
+    }
+}
+
+// "2026-01-31T12:00:00.000Z WARN  [1234] message (ApiFetcher.cpp:42)"
+static std::string FormatRecord(const LogRecord& record) {
+    static const char* const levels[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+    FILETIME fileTime;
+    fileTime.dwLowDateTime = static_cast<DWORD>(record.time);
+    fileTime.dwHighDateTime = static_cast<DWORD>(record.time >> 32);
+    SYSTEMTIME utc = {};
+    FileTimeToSystemTime(&fileTime, &utc);
+
+    char header[96];
+    snprintf(header, sizeof(header), "%04u-%02u-%02uT%02u:%02u:%02u.%03uZ %s [%lu] ",
+        utc.wYear, utc.wMonth, utc.wDay, utc.wHour, utc.wMinute, utc.wSecond, utc.wMilliseconds,
+        levels[static_cast<int>(record.site->level)], static_cast<unsigned long>(record.threadId));
+
+    std::string line = header;
+    int next = 0;
+    for (const char* c = record.site->format; *c; ++c) {
+        if (c[0] == '{' && c[1] == '}') {
+            if (next < record.argCount) AppendArg(line, record, record.args[next++]);
+            ++c;
+        }
+        else {
+            line += *c;
+        }
+    }
+
+    const char* file = record.site->file;
+    const char* slash = strrchr(file, '\\');
+    if (!slash) slash = strrchr(file, '/');
+    if (slash) file = slash + 1;
+
+    char footer[128];
+    if (record.suppressed) {
+        snprintf(footer, sizeof(footer), " (%s:%d, %u repeats suppressed)\n", file, record.site->line, record.suppressed);
+    }
+    else {
+        snprintf(footer, sizeof(footer), " (%s:%d)\n", file, record.site->line);
+    }
+    line += footer;
+    return line;
+}
+
+// Append mode writes at the end; seeking there too makes tellp() the size
+static void OpenLog(std::ofstream& file) {
+    file.open(std::filesystem::path(g_path), std::ios::binary | std::ios::app);
+    file.seekp(0, std::ios::end);
+}
+
+static std::wstring RotatedName(int index) {
+    return g_path + L"." + std::to_wstring(index);
+}
+
+static void Rotate(std::ofstream& file) {
+    file.close();
+    for (int i = LOG_KEEP_FILES - 1; i >= 1; --i) {
+        MoveFileExW(RotatedName(i).c_str(), RotatedName(i + 1).c_str(), MOVEFILE_REPLACE_EXISTING);
+    }
+    MoveFileExW(g_path.c_str(), RotatedName(1).c_str(), MOVEFILE_REPLACE_EXISTING);
+    OpenLog(file);
+}
+
+// Format and write every committed record; returns false when none was
+// waiting
+static bool DrainRing(std::ofstream& file, bool debugger) {
+    bool any = false;
+    for (;;) {
+        LogCell& cell = g_cells[g_tail % LOG_RING_SIZE];
+        if (cell.sequence.load(std::memory_order_acquire) != g_tail + 1) break;
+
+        std::string line = FormatRecord(cell.record);
+        cell.sequence.store(g_tail + LOG_RING_SIZE, std::memory_order_release);
+        ++g_tail;
+        any = true;
+
+        if (debugger) OutputDebugStringA(line.c_str());
+        if (!file.is_open()) continue;
+
+        file << line;
+        if (file.tellp() >= LOG_MAX_FILE_BYTES) Rotate(file);
+    }
+    if (any) file.flush();
+    return any;
+}
+
+static void SinkThread() {
+    std::ofstream file;
+    OpenLog(file);
+    for (;;) {
+        bool stopping = WaitForSingleObject(g_stopEvent, LOG_FLUSH_INTERVAL_MS) == WAIT_OBJECT_0;
+        bool debugger = IsDebuggerPresent() != FALSE;
+        DrainRing(file, debugger);
+        if (stopping) break;
+    }
+
+    unsigned long long dropped = g_dropped.load();
+    if (dropped > 0 && file.is_open()) {
+        file << "Log: " << dropped << " messages dropped because the ring was full\n";
+    }
+}
+
+bool Log::Start(const std::wstring& path) {
+    if (g_sinkThread.joinable()) return true;
+
+    g_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!g_stopEvent) return false;
+
+    g_path = path;
+    g_sinkThread = std::thread(SinkThread);
+    return true;
+}
+
+void Log::Stop() {
+    if (!g_sinkThread.joinable()) return;
+
+    SetEvent(g_stopEvent);
+    g_sinkThread.join();
+    CloseHandle(g_stopEvent);
+    g_stopEvent = nullptr;
+}
@@ -0,0 +1,185 @@
+#pragma once
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Structured asynchronous logger.
+//
+//     LOG_WARN("{}: {} (HTTP {})", symbol, ApiFetcher::DescribeError(error), status);
+//
+// A call copies its arguments into a slot of a lock-free multi-producer
+// ring and returns; a background thread formats the message and appends it
+// to a rotating log file (and to the debugger output when one is attached).
+// Levels below LOG_MIN_LEVEL compile away entirely. Each call site allows a
+// burst of LOG_REPEAT_BURST messages per LOG_REPEAT_WINDOW_MS; repeats
+// beyond that are counted and reported with the site's next message. The
+// limit is per call site, not per message text: a site that logs for many
+// symbols shares one burst among them, so after a burst a different
+// symbol's message is suppressed too.
+//
+// Formats must be string literals with "{}" placeholders. Arguments may be
+// integers, enums, floating point, bool, and narrow or wide strings.
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error
+};
+
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL 1   // Info
+#else
+#define LOG_MIN_LEVEL 0   // Debug
+#endif
+#endif
+
+#define LOG_MAX_ARGS 6
+#define LOG_PAYLOAD_BYTES 192
+#define LOG_REPEAT_WINDOW_MS 10000
+#define LOG_REPEAT_BURST 5
+
+// Static state of one LOG_* call site
+struct LogSite {
+    LogLevel level;
+    const char* format;
+    const char* file;
+    int line;
+    std::atomic<unsigned long long> windowStart{ 0 };
+    std::atomic<unsigned> windowCount{ 0 };
+    std::atomic<unsigned> suppressed{ 0 };
+};
+
+enum class LogArgType : uint8_t {
+    Int,
+    UInt,
+    Double,
+    Text,       // UTF-8 bytes in the payload
+    WideText    // UTF-16 code units in the payload
+};
+
+struct LogArg {
+    LogArgType type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        struct {
+            uint16_t offset;
+            uint16_t length;   // Bytes
+        } text;
+    };
+};
+
+// One message as captured on the calling thread; formatted later
+struct LogRecord {
+    const LogSite* site;
+    unsigned long long time;   // FILETIME ticks (UTC)
+    uint32_t threadId;
+    uint32_t suppressed;       // Repeats dropped at this site before this one
+    uint8_t argCount;
+    uint16_t payloadUsed;
+    LogArg args[LOG_MAX_ARGS];
+    char payload[LOG_PAYLOAD_BYTES];
+};
+
+class Log {
+public:
+    // Start the background sink writing to path (rotated at LOG_MAX_FILE_BYTES).
+    // Messages logged before Start() wait in the ring.
+    static bool Start(const std::wstring& path);
+
+    // Drain the ring and stop the sink
+    static void Stop();
+
+    // Messages dropped because the ring was full
+    static unsigned long long GetDropped();
+
+    // Rate limit for one call site, whatever its arguments; false if the
+    // message is suppressed
+    static bool Admit(LogSite& site);
+
+    template <typename... Args>
+    static void Write(LogSite& site, const Args&... args) {
+        static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+
+        size_t position;
+        LogRecord* record = Reserve(position);
+        if (!record) return;
+
+        record->site = &site;
+        record->suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+        record->argCount = 0;
+        record->payloadUsed = 0;
+        (Capture(*record, args), ...);
+        Commit(position);
+    }
+
+private:
+    // Claim a ring slot and stamp its time and thread; nullptr when full
+    static LogRecord* Reserve(size_t& position);
+    static void Commit(size_t position);
+
+    static void CaptureText(LogRecord& record, LogArgType type, const void* data, size_t bytes);
+
+    template <typename T>
+    static void Capture(LogRecord& record, const T& value) {
+        LogArg& arg = record.args[record.argCount++];
+        if constexpr (std::is_same_v<T, bool>) {
+            arg.type = LogArgType::Int;
+            arg.i = value ? 1 : 0;
+        }
+        else if constexpr (std::is_enum_v<T>) {
+            arg.type = LogArgType::Int;
+            arg.i = static_cast<int64_t>(value);
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            arg.type = LogArgType::Int;
+            arg.i = value;
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            arg.type = LogArgType::UInt;
+            arg.u = value;
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            arg.type = LogArgType::Double;
+            arg.d = value;
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            std::string_view text(value);
+            record.argCount--;
+            CaptureText(record, LogArgType::Text, text.data(), text.size());
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::wstring_view>) {
+            std::wstring_view text(value);
+            record.argCount--;
+            CaptureText(record, LogArgType::WideText, text.data(), text.size() * sizeof(wchar_t));
+        }
+        else {
+            static_assert(sizeof(T) == 0, "Unsupported log argument type");
+        }
+    }
+};
+
+// (+ 1 spares GCC's always-true warning when LOG_MIN_LEVEL is 0)
+#define LOG_AT(level, format, ...)                                                  \
+    do {                                                                            \
+        if constexpr (static_cast<int>(level) + 1 > LOG_MIN_LEVEL) {                \
+            static LogSite logSite{ level, format, __FILE__, __LINE__ };            \
+            if (Log::Admit(logSite)) Log::Write(logSite, ##__VA_ARGS__);            \
+        }                                                                           \
+    } while (0)
+
+#define LOG_DEBUG(format, ...) LOG_AT(LogLevel::Debug, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) LOG_AT(LogLevel::Info, format, ##__VA_ARGS__)
+#define LOG_WARN(format, ...) LOG_AT(LogLevel::Warn, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) LOG_AT(LogLevel::Error, format, ##__VA_ARGS__)
+
+#endif
@@ -0,0 +1,198 @@
+#include "Price.h"
+
+#include <algorithm>
+
+// Largest magnitude of units; the scale takes the low bits
+#define PRICE_MAX_UNITS ((INT64_C(1) << (63 - 5)) - 1)
+
+static const int64_t g_pow10[19] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+    1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+    100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+    1000000000000000000LL
+};
+
+// "00" to "99", so the formatter emits two digits per division
+static const char g_digitPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// value / divisor rounded half up; value >= 0
+static int64_t RoundedDivide(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    if (value % divisor * 2 >= divisor) ++quotient;
+    return quotient;
+}
+
+// Write value as exactly count digits, zero padded, ending at end
+static void WriteDigits(char* end, uint64_t value, int count) {
+    for (; count >= 2; count -= 2) {
+        const char* pair = g_digitPairs + value % 100 * 2;
+        value /= 100;
+        end -= 2;
+        end[0] = pair[0];
+        end[1] = pair[1];
+    }
+    if (count) *--end = static_cast<char>('0' + value % 10);
+}
+
+static int CountDigits(uint64_t value) {
+    int digits = 1;
+    while (digits < 19 && value >= static_cast<uint64_t>(g_pow10[digits])) ++digits;
+    return digits;
+}
+
+// Bring two prices to a common scale; false if either would overflow
+static bool Align(Price a, Price b, int64_t& unitsA, int64_t& unitsB) {
+    unitsA = a.GetUnits();
+    unitsB = b.GetUnits();
+    int shift = a.GetScale() - b.GetScale();
+    int64_t& widened = shift < 0 ? unitsA : unitsB;
+    int64_t factor = g_pow10[shift < 0 ? -shift : shift];
+    if (widened > PRICE_MAX_UNITS / factor || widened < -PRICE_MAX_UNITS / factor) return false;
+    widened *= factor;
+    return true;
+}
+
+bool Price::Parse(const char* first, const char* last, Price& price) {
+    const char* p = first;
+    bool negative = p < last && *p == '-';
+    if (negative) ++p;
+
+    int64_t units = 0;
+    int scale = 0;
+    bool any = false;
+    for (; p < last && IsDigit(*p); ++p) {
+        int digit = *p - '0';
+        if (units > (PRICE_MAX_UNITS - digit) / 10) return false;
+        units = units * 10 + digit;
+        any = true;
+    }
+
+    // Fraction digits beyond what fits are rounded off at the first one
+    bool dropped = false;
+    bool roundUp = false;
+    if (p < last && *p == '.') {
+        for (++p; p < last && IsDigit(*p); ++p) {
+            int digit = *p - '0';
+            any = true;
+            if (dropped) continue;
+            if (scale < PRICE_MAX_SCALE && units <= (PRICE_MAX_UNITS - digit) / 10) {
+                units = units * 10 + digit;
+                ++scale;
+            }
+            else {
+                dropped = true;
+                roundUp = digit >= 5;
+            }
+        }
+    }
+    if (!any) return false;
+    if (roundUp) {
+        if (units == PRICE_MAX_UNITS) return false;
+        ++units;
+    }
+
+    // An exponent only moves the decimal point
+    int exponent = 0;
+    if (p < last && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = p < last && *p == '-';
+        if (p < last && (*p == '-' || *p == '+')) ++p;
+        if (p >= last || !IsDigit(*p)) return false;
+        for (; p < last && IsDigit(*p); ++p) {
+            if (exponent < 1000) exponent = exponent * 10 + (*p - '0');
+        }
+        if (negativeExponent) exponent = -exponent;
+    }
+
+    scale -= exponent;
+    if (scale < 0) {
+        if (units != 0 && (-scale > 18 || units > PRICE_MAX_UNITS / g_pow10[-scale])) return false;
+        if (units != 0) units *= g_pow10[-scale];
+        scale = 0;
+    }
+    else if (scale > PRICE_MAX_SCALE) {
+        int drop = scale - PRICE_MAX_SCALE;
+        units = drop > 18 ? 0 : RoundedDivide(units, g_pow10[drop]);
+        scale = PRICE_MAX_SCALE;
+    }
+
+    price = FromUnits(negative ? -units : units, scale);
+    return true;
+}
+
+Price Price::FromUnits(int64_t units, int scale) {
+    scale = std::clamp(scale, 0, PRICE_MAX_SCALE);
+    units = std::clamp(units, -PRICE_MAX_UNITS, PRICE_MAX_UNITS);
+    if (units == 0) return Price();
+
+    while (scale > 0 && units % 10 == 0) {
+        units /= 10;
+        --scale;
+    }
+    return Price(static_cast<int64_t>(static_cast<uint64_t>(units) << SCALE_BITS) | scale);
+}
+
+double Price::ToDouble() const {
+    // Powers of ten up to 10^22 are exact doubles, so this rounds once
+    return static_cast<double>(GetUnits()) / static_cast<double>(g_pow10[GetScale()]);
+}
+
+int Price::Compare(Price other) const {
+    int64_t a, b;
+    if (!Align(*this, other, a, b)) {
+        double x = ToDouble(), y = other.ToDouble();
+        return x < y ? -1 : (x > y ? 1 : 0);
+    }
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+bool Price::Subtract(Price a, Price b, Price& difference) {
+    int64_t unitsA, unitsB;
+    if (!Align(a, b, unitsA, unitsB)) return false;
+
+    int64_t units = unitsA - unitsB;
+    if (units > PRICE_MAX_UNITS || units < -PRICE_MAX_UNITS) return false;
+    difference = FromUnits(units, std::max(a.GetScale(), b.GetScale()));
+    return true;
+}
+
+char* Price::Format(char* out, int decimals) const {
+    decimals = std::clamp(decimals, 0, PRICE_MAX_SCALE);
+    int64_t units = GetUnits();
+    int scale = GetScale();
+    uint64_t magnitude = units < 0 ? 0 - static_cast<uint64_t>(units) : static_cast<uint64_t>(units);
+
+    if (decimals < scale) {
+        uint64_t divisor = static_cast<uint64_t>(g_pow10[scale - decimals]);
+        uint64_t rest = magnitude % divisor;
+        magnitude /= divisor;
+        if (rest * 2 >= divisor) ++magnitude;
+        scale = decimals;
+    }
+    if (units < 0 && magnitude != 0) *out++ = '-';
+
+    uint64_t whole = magnitude / g_pow10[scale];
+    uint64_t fraction = magnitude % g_pow10[scale];
+    int digits = CountDigits(whole);
+    WriteDigits(out + digits, whole, digits);
+    out += digits;
+
+    if (decimals > 0) {
+        *out++ = '.';
+        WriteDigits(out + scale, fraction, scale);
+        out += scale;
+        for (int i = scale; i < decimals; ++i) {
+            *out++ = '0';
+        }
+    }
+    return out;
+}
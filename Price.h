@@ -0,0 +1,63 @@
+#pragma once
+#ifndef PRICE_H
+#define PRICE_H
+
+#include <cstdint>
+
+// Most decimals a price keeps; further digits are rounded off when parsing
+#define PRICE_MAX_SCALE 12
+
+// Buffer size that fits any formatted price
+#define PRICE_MAX_CHARS 48
+
+// Exact decimal price: a count of 10^-scale units, packed with the scale
+// into 64 bits. Prices are parsed straight from their decimal digits, so
+// "0.1" is exactly one tenth, and each value keeps the scale its source
+// quoted it in. Values are canonical (no trailing fractional zeros), so
+// equal prices have equal bits and == is a single integer compare.
+class Price {
+public:
+    constexpr Price() : m_bits(0) {}
+
+    // Parse the JSON number at the start of [first, last); false if there
+    // is none or its integer part does not fit
+    static bool Parse(const char* first, const char* last, Price& price);
+
+    // units * 10^-scale, scale in [0, PRICE_MAX_SCALE]
+    static Price FromUnits(int64_t units, int scale);
+
+    // Raw representation, e.g. for an atomic slot
+    static Price FromBits(int64_t bits) { return Price(bits); }
+    int64_t GetBits() const { return m_bits; }
+
+    int64_t GetUnits() const { return m_bits >> SCALE_BITS; }
+    int GetScale() const { return static_cast<int>(m_bits & SCALE_MASK); }
+
+    bool IsZero() const { return m_bits == 0; }
+    bool IsPositive() const { return m_bits > 0; }
+    double ToDouble() const;
+
+    // -1, 0 or 1
+    int Compare(Price other) const;
+
+    // a - b; false if the exact difference does not fit
+    static bool Subtract(Price a, Price b, Price& difference);
+
+    // Write the value rounded half away from zero to decimals places (at
+    // most PRICE_MAX_SCALE) into out, which holds PRICE_MAX_CHARS; returns
+    // the end of the text. A value that rounds to zero has no minus sign.
+    char* Format(char* out, int decimals) const;
+
+    bool operator==(Price other) const { return m_bits == other.m_bits; }
+    bool operator!=(Price other) const { return m_bits != other.m_bits; }
+
+private:
+    static constexpr int SCALE_BITS = 5;
+    static constexpr int64_t SCALE_MASK = (1 << SCALE_BITS) - 1;
+
+    explicit constexpr Price(int64_t bits) : m_bits(bits) {}
+
+    int64_t m_bits;   // units << SCALE_BITS | scale
+};
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "QuoteConflator.h"
+#include "QuoteExporter.h"
+#include "Trace.h"
+#include "Log.h"
+
+#include <windows.h>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <map>
+#include <vector>
+
+#define DIRTY_WORDS (MAX_SYMBOLS / 64)
+
+// One producer thread's copy of a symbol's latest value, behind a
+// single-writer sequence lock: only its thread writes it, making the
+// sequence odd while it does; readers retry until they see the same even
+// sequence before and after
+struct QuoteRecord {
+    std::atomic<uint32_t> sequence{ 0 };
+    std::atomic<int64_t> price{ 0 };           // Price bits
+    std::atomic<int64_t> previousClose{ 0 };
+    std::atomic<unsigned long long> time{ 0 };
+};
+
+// A producer thread's records, one per id
+struct ProducerBuffer {
+    QuoteRecord records[MAX_SYMBOLS];
+};
+
+// The record holding a symbol's latest value. Publishing swings it to the
+// producer's own record with one store, so producers of a symbol never
+// wait for each other. Each slot has its own cache line.
+struct alignas(64) QuoteSlot {
+    std::atomic<const QuoteRecord*> latest{ nullptr };
+};
+
+static QuoteSlot g_slots[MAX_SYMBOLS];
+static std::atomic<uint64_t> g_dirty[DIRTY_WORDS];
+static std::atomic<unsigned long long> g_published(0);
+static std::atomic<unsigned long long> g_conflated(0);
+
+// Id table; append-only so GetSymbol needs no lock once an id is handed out
+static std::mutex g_symbolMutex;
+static std::map<std::string, int, std::less<>> g_ids;
+static std::string g_symbols[MAX_SYMBOLS];
+static std::atomic<int> g_symbolCount(0);
+
+// Slots may point into the buffer of a thread that has exited, so buffers
+// are never freed; a new producer thread takes over one an exited thread
+// left, becoming its single writer
+static std::mutex g_buffersMutex;
+static std::vector<ProducerBuffer*> g_freeBuffers;
+
+struct ProducerHandle {
+    ProducerBuffer* buffer = nullptr;
+
+    ~ProducerHandle() {
+        if (!buffer) return;
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        g_freeBuffers.push_back(buffer);
+    }
+};
+
+static thread_local ProducerHandle t_producer;
+
+static ProducerBuffer* ThreadBuffer() {
+    if (!t_producer.buffer) {
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        if (g_freeBuffers.empty()) {
+            t_producer.buffer = new ProducerBuffer();
+        }
+        else {
+            t_producer.buffer = g_freeBuffers.back();
+            g_freeBuffers.pop_back();
+        }
+    }
+    return t_producer.buffer;
+}
+
+// Copy a symbol's latest value; false if none was published
+static bool ReadSlot(int id, ConflatedQuote& quote) {
+    const QuoteRecord* record = g_slots[id].latest.load(std::memory_order_acquire);
+    if (!record) return false;
+
+    uint32_t before, after;
+    quote.id = id;
+    do {
+        before = record->sequence.load(std::memory_order_acquire);
+        quote.price = Price::FromBits(record->price.load(std::memory_order_relaxed));
+        quote.previousClose = Price::FromBits(record->previousClose.load(std::memory_order_relaxed));
+        quote.time = record->time.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = record->sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return true;
+}
+
+int QuoteConflator::Intern(std::string_view symbol) {
+    auto lock = TracedLock(g_symbolMutex, "QuoteConflator symbols");
+    auto it = g_ids.find(symbol);
+    if (it != g_ids.end()) return it->second;
+
+    int id = g_symbolCount.load(std::memory_order_relaxed);
+    if (id >= MAX_SYMBOLS) {
+        LOG_ERROR("QuoteConflator: {} symbols seen since start, {} not shown; restart the tape to reset the table",
+            MAX_SYMBOLS, symbol);
+        return -1;
+    }
+    g_symbols[id] = symbol;
+    g_ids.emplace(symbol, id);
+    g_symbolCount.store(id + 1, std::memory_order_release);
+    QuoteExporter::AddSymbol(id, symbol);
+    return id;
+}
+
+int QuoteConflator::Find(std::string_view symbol) {
+    auto lock = TracedLock(g_symbolMutex, "QuoteConflator symbols");
+    auto it = g_ids.find(symbol);
+    return it != g_ids.end() ? it->second : -1;
+}
+
+const std::string& QuoteConflator::GetSymbol(int id) {
+    static const std::string empty;
+    if (id < 0 || id >= g_symbolCount.load(std::memory_order_acquire)) return empty;
+    return g_symbols[id];
+}
+
+int QuoteConflator::GetSymbolCount() {
+    return g_symbolCount.load(std::memory_order_acquire);
+}
+
+void QuoteConflator::Publish(int id, Price price, Price previousClose) {
+    if (id < 0 || id >= MAX_SYMBOLS) return;
+
+    // This thread is the record's only writer, so taking it is a plain store
+    QuoteRecord& record = ThreadBuffer()->records[id];
+    uint32_t sequence = record.sequence.load(std::memory_order_relaxed);
+    record.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.price.store(price.GetBits(), std::memory_order_relaxed);
+    record.previousClose.store(previousClose.GetBits(), std::memory_order_relaxed);
+    record.time.store(GetTickCount64(), std::memory_order_relaxed);
+    record.sequence.store(sequence + 2, std::memory_order_release);
+    g_slots[id].latest.store(&record, std::memory_order_release);
+
+    // Still dirty: the value it replaces was never drained
+    uint64_t bit = 1ULL << (id % 64);
+    if (g_dirty[id / 64].fetch_or(bit, std::memory_order_release) & bit) {
+        g_conflated.fetch_add(1, std::memory_order_relaxed);
+    }
+    g_published.fetch_add(1, std::memory_order_relaxed);
+    QuoteExporter::Publish(id);
+}
+
+bool QuoteConflator::Read(int id, ConflatedQuote& quote) {
+    if (id < 0 || id >= MAX_SYMBOLS) return false;
+    return ReadSlot(id, quote);
+}
+
+size_t QuoteConflator::Drain(std::vector<ConflatedQuote>& out) {
+    size_t count = 0;
+    for (int word = 0; word < DIRTY_WORDS; ++word) {
+        if (g_dirty[word].load(std::memory_order_relaxed) == 0) continue;
+        uint64_t bits = g_dirty[word].exchange(0, std::memory_order_acquire);
+
+        while (bits) {
+            int bit = std::countr_zero(bits);
+            bits &= bits - 1;
+
+            int id = word * 64 + bit;
+            ConflatedQuote quote;
+            if (!ReadSlot(id, quote)) continue;
+            out.push_back(quote);
+            ++count;
+        }
+    }
+    return count;
+}
+
+unsigned long long QuoteConflator::GetUpdatesPublished() {
+    return g_published.load();
+}
+
+unsigned long long QuoteConflator::GetUpdatesConflated() {
+    return g_conflated.load();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef QUOTE_CONFLATOR_H
+#define QUOTE_CONFLATOR_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Price.h"
+
+// Most symbols the conflator can track in one run. Ids are never reused,
+// so a symbol dropped from every tape still holds its id until restart.
+#define MAX_SYMBOLS 1024
+
+// Latest value of one symbol as drained by the consumer
+struct ConflatedQuote {
+    int id;
+    Price price;
+    Price previousClose;
+    unsigned long long time;   // GetTickCount64() of the update
+};
+
+// Conflation between the quote feed and the renderer: one latest-value slot
+// and one dirty bit per symbol. Each producer thread writes its own copy of
+// a quote and points the symbol's slot at it with one store, so producers
+// never wait for each other, not even on the same symbol; the consumer
+// drains only the symbols that changed since its last drain, so a burst of
+// ticks on one symbol costs one layout.
+class QuoteConflator {
+public:
+    // Id of a (UTF-8) symbol, assigned on first use; -1 once MAX_SYMBOLS
+    // are taken
+    static int Intern(std::string_view symbol);
+
+    // Id of a symbol interned before, or -1; never assigns one
+    static int Find(std::string_view symbol);
+
+    // Symbol of an id returned by Intern
+    static const std::string& GetSymbol(int id);
+
+    // Ids handed out so far: 0 to GetSymbolCount() - 1
+    static int GetSymbolCount();
+
+    // Overwrite a symbol's latest value and mark it dirty (lock-free)
+    static void Publish(int id, Price price, Price previousClose);
+
+    // Copy a symbol's latest value into quote without draining it; false if
+    // it has none. Any thread.
+    static bool Read(int id, ConflatedQuote& quote);
+
+    // Append the latest value of every symbol updated since the previous
+    // drain to out. Single consumer only. Returns the number appended.
+    static size_t Drain(std::vector<ConflatedQuote>& out);
+
+    // Updates published, and updates overwritten by a newer value before a
+    // drain saw them. Both only ever grow.
+    static unsigned long long GetUpdatesPublished();
+    static unsigned long long GetUpdatesConflated();
+};
+
+#endif
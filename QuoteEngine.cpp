@@ -0,0 +1,302 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "QuoteEngine.h"
+#include "ApiFetcher.h"
+#include "ConfigManager.h"
+#include "QuoteConflator.h"
+#include "QuoteFeedReader.h"
+#include "Sparkline.h"
+#include "SymbolGroup.h"
+#include "SymbolStatus.h"
+#include "TaskPool.h"
+#include "HttpClient.h"
+#include "CoTask.h"
+#include "FetchMetrics.h"
+#include "Trace.h"
+#include "Log.h"
+
+#include <thread>
+#include <latch>
+#include <atomic>
+#include <bitset>
+#include <algorithm>
+
+// Connections to the quote server; further requests wait in HttpClient
+#define MAX_CONNECTIONS 8
+
+static std::thread g_engineThread;
+static std::atomic<bool> g_running(false);
+static std::atomic<bool> g_refreshRequested(false);
+static HANDLE g_wakeEvent = nullptr;
+static CancelToken g_cancel;  // Aborts the fetches in progress on Stop()
+static std::unique_ptr<TaskPool> g_pool;  // Parses responses off WinHTTP's threads
+static std::unique_ptr<HttpClient> g_http;  // Every fetch is in flight on it at once
+
+// One symbol's fetch state, indexed by conflator id and kept from pass to
+// pass: the request path is built once (again only if the tape format
+// starts or stops needing series) and the receive and series buffers keep
+// their capacity, so a pass over symbols fetched before allocates nothing
+struct SymbolFetch {
+    std::wstring path;
+    bool pathSeries = false;   // path asks for the intraday series
+    std::string body;
+    std::vector<float> series;
+};
+
+static SymbolFetch g_fetches[MAX_SYMBOLS];
+
+// Engine-thread bookkeeping reused from pass to pass
+struct EngineState {
+    std::bitset<MAX_SYMBOLS> known;   // Fetched at least once
+    std::vector<int> watched;         // Every watched symbol once, in tape order
+    std::vector<int> pending;         // The current batch
+    bool fetched[MAX_SYMBOLS] = {};   // Batch results, one slot per fetch
+};
+
+// Count one HTTP request in the metrics and, when tracing, lay its phases
+// out on their own track
+static void RecordRequest(SymbolGroup group, const HttpResponse& response, size_t bytes) {
+    const RequestTiming& timing = response.timing;
+    FetchMetrics::RecordRequest(group, timing, bytes, response.status);
+    if (!Trace::IsEnabled() || !timing.startedUs) return;
+
+    uint64_t id = Trace::NewAsyncId();
+    uint64_t connectStart = timing.startedUs + timing.dnsUs;
+    uint64_t tlsStart = connectStart + timing.connectUs;
+    Trace::Async("fetch", "Request", id, timing.startedUs, timing.totalUs);
+    if (timing.dnsUs) Trace::Async("fetch", "DNS", id, timing.startedUs, timing.dnsUs);
+    if (timing.connectUs) Trace::Async("fetch", "Connect", id, connectStart, timing.connectUs);
+    if (timing.tlsUs) Trace::Async("fetch", "TLS", id, tlsStart, timing.tlsUs);
+    if (timing.ttfbUs) Trace::Async("fetch", "TTFB", id, timing.startedUs, timing.ttfbUs);
+}
+
+// Fetch and parse one symbol, and hand a good quote to the conflator the
+// moment it arrives. The network steps suspend on WinHTTP and cost no
+// thread. Each request gets timeoutMs from when it has a connection, within
+// the pass deadline; a transport failure is retried once if the pass
+// deadline allows.
+// Parsing moves to the pool, off WinHTTP's callback threads. A failed
+// fetch publishes nothing, so the tape keeps the last good price; a symbol
+// the server rejects goes into the negative cache. The intraday series is
+// requested only when series is set, i.e. the tape shows sparklines.
+// Returns whether the fetch ran to completion (even if it failed).
+static CoTask<bool> FetchSymbol(int id, bool series, int timeoutMs, unsigned long long passDeadline) {
+    const std::string& symbol = QuoteConflator::GetSymbol(id);
+    const SymbolGroup group = SymbolGroups::Of(symbol);
+    SymbolFetch& fetch = g_fetches[id];
+    if (fetch.path.empty() || fetch.pathSeries != series) {
+        fetch.path = ApiFetcher::ChartPath(symbol, series);
+        fetch.pathSeries = series;
+    }
+
+    HttpResponse response = co_await g_http->Get(fetch.path, fetch.body, &g_cancel, timeoutMs, passDeadline);
+    RecordRequest(group, response, fetch.body.size());
+    if (response.error == FetchError::Network && GetTickCount64() < passDeadline) {
+        response = co_await g_http->Get(fetch.path, fetch.body, &g_cancel, timeoutMs, passDeadline);
+        RecordRequest(group, response, fetch.body.size());
+    }
+
+    if (response.error != FetchError::None) {
+        if (response.error == FetchError::Cancelled) co_return false;
+        FetchMetrics::RecordResult(group, response.error);
+        if (response.status == 404 || response.status == 400) {
+            SymbolStatus::RecordRejected(id, response.status == 404 ? SymbolState::NotFound : SymbolState::Invalid,
+                GetTickCount64());
+        }
+        else {
+            LOG_WARN("{}: {} (HTTP {})", symbol, ApiFetcher::DescribeError(response.error), response.status);
+        }
+        co_return true;
+    }
+
+    co_await ResumeOn(*g_pool);
+    uint64_t parseStart = FetchMetrics::NowMicros();
+    Quote quote = ApiFetcher::ParseQuote(fetch.body);
+    uint64_t parseMicros = FetchMetrics::NowMicros() - parseStart;
+    FetchMetrics::RecordParse(group, parseMicros);
+    Trace::Complete("fetch", "ParseQuote", parseStart, parseMicros);
+    FetchMetrics::RecordResult(group, quote.error);
+
+    if (quote.Ok() && quote.price.IsPositive()) {
+        SymbolStatus::RecordFound(id);
+        QuoteConflator::Publish(id, quote.price, quote.previousClose);
+        if (series && ApiFetcher::ParseSeries(fetch.body, fetch.series)) {
+            Sparkline::Publish(id, fetch.series);
+        }
+    }
+    co_return true;
+}
+
+// Point the HTTP client at the configured quote server, replacing it when
+// the endpoint changed. Only called between batches, when no request is in
+// flight.
+static void UpdateClient(const ConfigSnapshot& config) {
+    if (g_http && g_http->Targets(config.apiHost, config.apiPort, config.apiHttps)) return;
+
+    g_http = std::make_unique<HttpClient>(config.apiHost, config.apiPort, config.apiHttps, MAX_CONNECTIONS);
+    FetchMetrics::SetHost(config.apiHost);
+}
+
+// Ids of the union of all watchlists in tape order, each symbol once.
+// Symbols beyond MAX_SYMBOLS are left out.
+static void WatchedSymbols(const ConfigSnapshot& config, std::vector<int>& ids) {
+    std::bitset<MAX_SYMBOLS> seen;
+    ids.clear();
+    for (const auto& tape : config.tapes) {
+        for (const auto& symbol : tape.symbols) {
+            int id = QuoteConflator::Intern(symbol);
+            if (id < 0 || seen.test(id)) continue;
+            seen.set(id);
+            ids.push_back(id);
+        }
+    }
+}
+
+// Fetch what one pass needs: every symbol on a full pass, otherwise only
+// symbols never fetched before. All of a pass's fetches are in flight at
+// once as coroutines on the async HTTP client. If the config changes
+// mid-pass the rest of the pass follows the new snapshot, which is
+// returned. A pass never outlives its refresh interval: symbols it could
+// not reach keep their previous values.
+static std::shared_ptr<const ConfigSnapshot> FetchPass(std::shared_ptr<const ConfigSnapshot> config,
+    EngineState& state, bool fullPass) {
+    TRACE_SCOPE("engine", "FetchPass");
+    const ULONGLONG passDeadline = GetTickCount64() + config->refreshInterval * 1000ULL;
+    std::bitset<MAX_SYMBOLS> done;
+
+    while (g_running.load()) {
+        WatchedSymbols(*config, state.watched);
+        state.pending.clear();
+        const ULONGLONG now = GetTickCount64();
+        for (int id : state.watched) {
+            if (done.test(id) || (!fullPass && state.known.test(id))) continue;
+            if (!SymbolStatus::ShouldFetch(id, now)) continue;
+            // Symbols the local feed keeps current need no request
+            if (config->localFeed && QuoteFeedReader::IsFed(id, config->refreshInterval * 2000ULL)) continue;
+            state.pending.push_back(id);
+        }
+        if (state.pending.empty()) break;
+        UpdateClient(*config);
+
+        // Every fetch writes only its own slot, then counts down; nothing
+        // is touched after the count down
+        std::latch finished(static_cast<std::ptrdiff_t>(state.pending.size()));
+        const int timeoutMs = config->fetchTimeout * 1000;
+        const bool series = config->tapeTemplate.HasSparkline();
+        for (int id : state.pending) {
+            state.fetched[id] = false;
+            Spawn(FetchSymbol(id, series, timeoutMs, passDeadline), [&state, &finished, id](bool fetched) {
+                state.fetched[id] = fetched;
+                finished.count_down();
+            });
+        }
+        finished.wait();
+
+        for (int id : state.pending) {
+            if (!state.fetched[id]) continue;
+            state.known.set(id);
+            done.set(id);
+        }
+
+        if (GetTickCount64() >= passDeadline) {
+            LOG_INFO("QuoteEngine: pass deadline reached, remaining symbols keep their prices");
+            break;
+        }
+
+        // Follow a config published during the pass; otherwise done
+        std::shared_ptr<const ConfigSnapshot> latest = ConfigManager::Current();
+        if (latest->version == config->version) break;
+        config = latest;
+    }
+    return config;
+}
+
+static void EngineThread() {
+    EngineState state;
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::Current();
+    bool fullPass = true;
+    ULONGLONG nextFullPass = 0;
+
+    while (g_running.load()) {
+        config = FetchPass(config, state, fullPass);
+        if (!g_running.load()) return;
+
+        // Forget symbols no tape shows any more, so re-adding one fetches
+        // and checks it afresh, and give back their receive buffers
+        WatchedSymbols(*config, state.watched);
+        std::bitset<MAX_SYMBOLS> wanted;
+        for (int id : state.watched) {
+            wanted.set(id);
+        }
+        for (int id = 0; id < MAX_SYMBOLS; ++id) {
+            if (wanted.test(id)) continue;
+            SymbolStatus::Forget(id);
+            if (!state.known.test(id)) continue;
+            state.known.reset(id);
+            std::string().swap(g_fetches[id].body);
+        }
+
+        if (fullPass) {
+            nextFullPass = GetTickCount64() + config->refreshInterval * 1000ULL;
+        }
+
+        if (!config->metricsFile.empty() && !FetchMetrics::WriteFile(config->metricsFile)) {
+            LOG_WARN("QuoteEngine: could not write the metrics file {}", config->metricsFile);
+        }
+
+        // Sleep until the next full pass; stop, config changes and refresh
+        // requests all wake the engine at once
+        for (;;) {
+            ULONGLONG now = GetTickCount64();
+            DWORD timeout = nextFullPass > now ? static_cast<DWORD>(nextFullPass - now) : 0;
+            WaitForSingleObject(g_wakeEvent, timeout);
+            if (!g_running.load()) return;
+
+            std::shared_ptr<const ConfigSnapshot> latest = ConfigManager::Current();
+            fullPass = g_refreshRequested.exchange(false) || GetTickCount64() >= nextFullPass;
+            if (fullPass || latest->version != config->version) {
+                config = latest;
+                break;
+            }
+        }
+    }
+}
+
+void QuoteEngine::Start() {
+    if (g_running.load()) return;
+
+    g_wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!g_wakeEvent) return;
+
+    g_cancel.Reset();
+    g_pool = std::make_unique<TaskPool>();
+    g_running = true;
+    g_engineThread = std::thread(EngineThread);
+}
+
+void QuoteEngine::Stop() {
+    // Wake the engine whether it is sleeping or blocked in a request, so
+    // shutdown never waits for a refresh interval or a stalled server
+    g_running = false;
+    g_cancel.Cancel();
+    if (g_wakeEvent) SetEvent(g_wakeEvent);
+    if (g_engineThread.joinable()) {
+        g_engineThread.join();
+    }
+    g_http.reset();
+    g_pool.reset();
+    if (g_wakeEvent) {
+        CloseHandle(g_wakeEvent);
+        g_wakeEvent = nullptr;
+    }
+}
+
+void QuoteEngine::Reconfigure() {
+    if (g_wakeEvent) SetEvent(g_wakeEvent);
+}
+
+void QuoteEngine::RefreshNow() {
+    g_refreshRequested = true;
+    if (g_wakeEvent) SetEvent(g_wakeEvent);
+}
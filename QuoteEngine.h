@@ -0,0 +1,26 @@
+#pragma once
+#ifndef QUOTE_ENGINE_H
+#define QUOTE_ENGINE_H
+
+// Shared fetch engine for all tapes. Each pass fetches the union of every
+// tape's watchlist, so a symbol shown on several tapes is requested once,
+// and hands each quote to the QuoteConflator as it arrives; the render
+// thread lays out the tapes from there.
+class QuoteEngine {
+public:
+    static void Start();
+
+    // Stop and join the worker. Returns promptly even while a request is
+    // in flight: the request is cancelled rather than awaited.
+    static void Stop();
+
+    // Apply the latest config snapshot now instead of at the next pass:
+    // only newly added symbols are fetched (the render thread re-lays out
+    // the tapes from the values it already has)
+    static void Reconfigure();
+
+    // Start a full fetch pass now instead of waiting for the interval
+    static void RefreshNow();
+};
+
+#endif
@@ -0,0 +1,158 @@
+#pragma once
+#ifndef QUOTE_EXPORT_H
+#define QUOTE_EXPORT_H
+
+/*
+ * Quote export: the tape's latest quote of every symbol in named shared
+ * memory, so other programs in the same session can read them instead of
+ * polling the quote server themselves. Plain C so any reader can include
+ * it; the tape creates the region while exportQuotes=1 in config.ini.
+ *
+ * The region is a header, a directory of symbols and one fixed-size row
+ * per directory entry; entry i's quote is row i. Symbols are only ever
+ * appended. Each row is a sequence lock: the tape makes the sequence odd
+ * while it writes and readers retry until they see the same even sequence
+ * before and after their copy, so a read is a few loads and never a
+ * system call. Prices are exact decimals: value * 10^-scale.
+ */
+
+#include <windows.h>
+#include <stdint.h>
+#include <string.h>
+
+#define QUOTE_EXPORT_NAME L"Local\\ARPTickerTapeQuotes"
+#define QUOTE_EXPORT_MAGIC 0x31585451u   /* "QTX1" */
+#define QUOTE_EXPORT_VERSION 1
+#define QUOTE_EXPORT_CAPACITY 1024       /* Directory entries and rows */
+#define QUOTE_EXPORT_SYMBOL_BYTES 24     /* UTF-8 including the NUL */
+
+/* Start of the shared memory */
+typedef struct QuoteExportHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t symbolBytes;
+    uint32_t rowSize;
+    volatile LONG symbolCount;   /* Directory entries written so far */
+    volatile LONG writerAlive;   /* 0 while the tape is not exporting; look
+                                    symbols up again once it is back to 1 */
+    uint8_t reserved[36];
+} QuoteExportHeader;
+
+/* Directory entry: empty for a symbol too long to export */
+typedef struct QuoteExportSymbol {
+    char symbol[QUOTE_EXPORT_SYMBOL_BYTES];
+} QuoteExportSymbol;
+
+/* One symbol's latest quote, one cache line */
+typedef struct QuoteExportRow {
+    volatile LONG sequence;      /* Odd while the tape writes; 0 = no quote yet */
+    volatile int8_t priceScale;
+    volatile int8_t previousCloseScale;
+    uint8_t reserved0[2];
+    volatile int64_t price;
+    volatile int64_t previousClose;   /* 0 when unknown */
+    volatile uint64_t timestamp;      /* Unix time of the update in milliseconds */
+    uint8_t reserved1[32];
+} QuoteExportRow;
+
+/* A consistent copy of one row */
+typedef struct QuoteExportQuote {
+    int64_t price;
+    int priceScale;
+    int64_t previousClose;
+    int previousCloseScale;
+    uint64_t timestamp;
+} QuoteExportQuote;
+
+#define QUOTE_EXPORT_DIRECTORY_OFFSET sizeof(QuoteExportHeader)
+#define QUOTE_EXPORT_ROWS_OFFSET \
+    ((QUOTE_EXPORT_DIRECTORY_OFFSET + QUOTE_EXPORT_CAPACITY * sizeof(QuoteExportSymbol) + 63) & ~(size_t)63)
+#define QUOTE_EXPORT_BYTES (QUOTE_EXPORT_ROWS_OFFSET + QUOTE_EXPORT_CAPACITY * sizeof(QuoteExportRow))
+
+static __inline QuoteExportSymbol* QuoteExportDirectory(QuoteExportHeader* header) {
+    return (QuoteExportSymbol*)((char*)header + QUOTE_EXPORT_DIRECTORY_OFFSET);
+}
+
+static __inline QuoteExportRow* QuoteExportRows(QuoteExportHeader* header) {
+    return (QuoteExportRow*)((char*)header + QUOTE_EXPORT_ROWS_OFFSET);
+}
+
+/* Reader side */
+
+typedef struct QuoteExportReader {
+    HANDLE mapping;
+    QuoteExportHeader* header;
+} QuoteExportReader;
+
+/* Map the tape's region read-only. Returns 0 if the tape is not running
+   with exportQuotes=1 or is a different version; retry later. */
+static __inline int QuoteExportOpen(QuoteExportReader* reader) {
+    memset(reader, 0, sizeof(*reader));
+    reader->mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, QUOTE_EXPORT_NAME);
+    if (!reader->mapping) return 0;
+
+    reader->header = (QuoteExportHeader*)MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, QUOTE_EXPORT_BYTES);
+    if (!reader->header || reader->header->magic != QUOTE_EXPORT_MAGIC ||
+        reader->header->version != QUOTE_EXPORT_VERSION || reader->header->capacity != QUOTE_EXPORT_CAPACITY ||
+        reader->header->symbolBytes != QUOTE_EXPORT_SYMBOL_BYTES || reader->header->rowSize != sizeof(QuoteExportRow)) {
+        if (reader->header) UnmapViewOfFile(reader->header);
+        CloseHandle(reader->mapping);
+        memset(reader, 0, sizeof(*reader));
+        return 0;
+    }
+    return 1;
+}
+
+static __inline void QuoteExportClose(QuoteExportReader* reader) {
+    if (reader->header) UnmapViewOfFile(reader->header);
+    if (reader->mapping) CloseHandle(reader->mapping);
+    memset(reader, 0, sizeof(*reader));
+}
+
+/* Number of directory entries; entries below it never change */
+static __inline int QuoteExportCount(const QuoteExportReader* reader) {
+    LONG count = ReadAcquire(&reader->header->symbolCount);
+    return count < QUOTE_EXPORT_CAPACITY ? (int)count : QUOTE_EXPORT_CAPACITY;
+}
+
+/* Row of a UTF-8 symbol, or -1 if the tape does not show it. Rows never
+   move, so look a symbol up once and keep its row. */
+static __inline int QuoteExportFind(const QuoteExportReader* reader, const char* symbol) {
+    const QuoteExportSymbol* directory = QuoteExportDirectory(reader->header);
+    int count = QuoteExportCount(reader);
+    int i;
+    for (i = 0; i < count; ++i) {
+        if (strncmp(directory[i].symbol, symbol, QUOTE_EXPORT_SYMBOL_BYTES) == 0 && directory[i].symbol[0]) return i;
+    }
+    return -1;
+}
+
+/* Copy row's latest quote into quote. Returns 0 if it has none yet. */
+static __inline int QuoteExportRead(const QuoteExportReader* reader, int row, QuoteExportQuote* quote) {
+    const QuoteExportRow* slot;
+    LONG before, after;
+    int spins = 0;
+    if (row < 0 || row >= QuoteExportCount(reader)) return 0;
+
+    slot = &QuoteExportRows(reader->header)[row];
+    for (;;) {
+        before = ReadAcquire(&slot->sequence);
+        if (before & 1) {
+            /* The tape is mid-write; give way if it was preempted there */
+            if (++spins < 100) YieldProcessor();
+            else SwitchToThread();
+            continue;
+        }
+        quote->price = slot->price;
+        quote->priceScale = slot->priceScale;
+        quote->previousClose = slot->previousClose;
+        quote->previousCloseScale = slot->previousCloseScale;
+        quote->timestamp = slot->timestamp;
+        MemoryBarrier();
+        after = ReadNoFence(&slot->sequence);
+        if (before == after) return before != 0;
+    }
+}
+
+#endif
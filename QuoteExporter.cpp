@@ -0,0 +1,145 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "QuoteExporter.h"
+#include "QuoteExport.h"
+#include "QuoteConflator.h"
+#include "Log.h"
+
+#include <atomic>
+#include <mutex>
+#include <cstring>
+
+static_assert(sizeof(QuoteExportHeader) == 64, "QuoteExportHeader layout changed");
+static_assert(sizeof(QuoteExportRow) == 64, "QuoteExportRow must fill one cache line");
+static_assert(QUOTE_EXPORT_CAPACITY >= MAX_SYMBOLS, "Every conflator id needs a row");
+
+// Unix epoch in FILETIME units (100 ns since 1601)
+#define UNIX_EPOCH_FILETIME 116444736000000000ULL
+
+static HANDLE g_mapping = nullptr;
+static QuoteExportHeader* g_view = nullptr;              // Mapped for the process lifetime
+static std::atomic<QuoteExportHeader*> g_header(nullptr);   // g_view while exporting
+static std::mutex g_directoryMutex;
+static std::atomic<unsigned long long> g_exported(0);
+static std::atomic<bool> g_pending[QUOTE_EXPORT_CAPACITY];   // An update waits for its row's writer
+
+static uint64_t UnixMillis() {
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    uint64_t ticks = (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    return (ticks - UNIX_EPOCH_FILETIME) / 10000;
+}
+
+// Caller holds g_directoryMutex
+static void WriteSymbol(QuoteExportHeader* header, int id, std::string_view symbol) {
+    if (id < 0 || id >= QUOTE_EXPORT_CAPACITY) return;
+
+    // Too long to export: the entry stays empty and no reader finds it
+    if (symbol.size() < QUOTE_EXPORT_SYMBOL_BYTES) {
+        QuoteExportSymbol& entry = QuoteExportDirectory(header)[id];
+        memcpy(entry.symbol, symbol.data(), symbol.size());
+        entry.symbol[symbol.size()] = 0;
+    }
+    if (header->symbolCount <= id) WriteRelease(&header->symbolCount, id + 1);
+}
+
+bool QuoteExporter::Start() {
+    std::lock_guard<std::mutex> lock(g_directoryMutex);
+    if (g_header.load()) return true;
+
+    if (!g_view) {
+        // Page-file backed; the default security limits it to this user
+        g_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+            0, static_cast<DWORD>(QUOTE_EXPORT_BYTES), QUOTE_EXPORT_NAME);
+        if (g_mapping) {
+            g_view = static_cast<QuoteExportHeader*>(MapViewOfFile(g_mapping,
+                FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, QUOTE_EXPORT_BYTES));
+        }
+        if (!g_view) {
+            LOG_ERROR("QuoteExport: could not create the shared region (error {})", GetLastError());
+            if (g_mapping) CloseHandle(g_mapping);
+            g_mapping = nullptr;
+            return false;
+        }
+    }
+
+    // Lay the region out afresh: ids may differ from a previous run whose
+    // region a reader kept open. Readers see writerAlive go 0 -> 1 and look
+    // their symbols up again.
+    WriteRelease(&g_view->writerAlive, 0);
+    WriteRelease(&g_view->symbolCount, 0);
+    memset(QuoteExportDirectory(g_view), 0, QUOTE_EXPORT_CAPACITY * sizeof(QuoteExportSymbol));
+    QuoteExportRow* rows = QuoteExportRows(g_view);
+    for (int i = 0; i < QUOTE_EXPORT_CAPACITY; ++i) {
+        WriteRelease(&rows[i].sequence, 0);   // No quote yet
+    }
+    g_view->magic = QUOTE_EXPORT_MAGIC;
+    g_view->version = QUOTE_EXPORT_VERSION;
+    g_view->capacity = QUOTE_EXPORT_CAPACITY;
+    g_view->symbolBytes = QUOTE_EXPORT_SYMBOL_BYTES;
+    g_view->rowSize = sizeof(QuoteExportRow);
+
+    // Symbols interned from here on arrive through AddSymbol, which waits
+    // for this lock. Rows fill as quotes arrive.
+    g_header.store(g_view);
+    int count = QuoteConflator::GetSymbolCount();
+    for (int id = 0; id < count; ++id) {
+        WriteSymbol(g_view, id, QuoteConflator::GetSymbol(id));
+    }
+    WriteRelease(&g_view->writerAlive, 1);
+
+    LOG_INFO("QuoteExport: exporting {} symbols", count);
+    return true;
+}
+
+void QuoteExporter::Stop() {
+    std::lock_guard<std::mutex> lock(g_directoryMutex);
+    if (!g_header.exchange(nullptr)) return;
+
+    WriteRelease(&g_view->writerAlive, 0);
+    LOG_INFO("QuoteExport: stopped after {} quotes", g_exported.load());
+}
+
+void QuoteExporter::AddSymbol(int id, std::string_view symbol) {
+    if (!g_header.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(g_directoryMutex);
+    QuoteExportHeader* header = g_header.load();
+    if (header) WriteSymbol(header, id, symbol);
+}
+
+void QuoteExporter::Publish(int id) {
+    QuoteExportHeader* header = g_header.load(std::memory_order_acquire);
+    if (!header || id < 0 || id >= QUOTE_EXPORT_CAPACITY) return;
+
+    // Leave the update to a writer already in the row: it checks the flag
+    // after every write. Setting the flag, then reading the sequence, pairs
+    // with the writer's release, then flag check; both are full barriers.
+    QuoteExportRow& row = QuoteExportRows(header)[id];
+    g_pending[id].store(true);
+    for (;;) {
+        LONG sequence = ReadAcquire(&row.sequence);
+        if (sequence & 1) return;
+        if (InterlockedCompareExchange(&row.sequence, sequence + 1, sequence) != sequence) continue;
+
+        // Odd while writing; the exchange is a full barrier, so no field
+        // store becomes visible before it. Every update flagged before the
+        // flag is cleared is in the value read after.
+        g_pending[id].store(false);
+        ConflatedQuote quote = { id, Price(), Price(), 0 };
+        QuoteConflator::Read(id, quote);   // Published before this call
+        row.price = quote.price.GetUnits();
+        row.priceScale = static_cast<int8_t>(quote.price.GetScale());
+        row.previousClose = quote.previousClose.GetUnits();
+        row.previousCloseScale = static_cast<int8_t>(quote.previousClose.GetScale());
+        row.timestamp = UnixMillis();
+        InterlockedExchange(&row.sequence, sequence + 2);
+        g_exported.fetch_add(1, std::memory_order_relaxed);
+        if (!g_pending[id].load()) return;
+    }
+}
+
+unsigned long long QuoteExporter::GetQuotesExported() {
+    return g_exported.load();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef QUOTE_EXPORTER_H
+#define QUOTE_EXPORTER_H
+
+#include <string_view>
+
+// The tape's side of the quote export (see QuoteExport.h). Mirrors the
+// QuoteConflator into shared memory: directory entry and row i belong to
+// conflator id i, so every published quote is written straight into its
+// row. Costs a pointer check per quote while the export is off.
+class QuoteExporter {
+public:
+    // Create the region, or take over the one a reader kept open, and
+    // export every symbol interned so far; false if it cannot be created
+    static bool Start();
+
+    // Stop exporting. The region stays mapped until the process exits so a
+    // producer that is mid-write never touches an unmapped view.
+    static void Stop();
+
+    // Called by the QuoteConflator under its symbol lock, in id order
+    static void AddSymbol(int id, std::string_view symbol);
+
+    // Called by the QuoteConflator after it published a quote of id: copy
+    // the symbol's latest value into its row. Concurrent calls for one row
+    // combine; whichever holds the row writes again for the others.
+    static void Publish(int id);
+
+    // Quotes written to the region
+    static unsigned long long GetQuotesExported();
+};
+
+#endif
@@ -0,0 +1,161 @@
+#pragma once
+#ifndef QUOTE_FEED_H
+#define QUOTE_FEED_H
+
+/*
+ * Local quote feed: a named shared-memory ring through which other
+ * processes in the same session push prices into the tape, bypassing the
+ * internet quote server. Plain C so any producer can include it; the tape
+ * creates the ring while localFeed=1 in config.ini.
+ *
+ * Any number of producers push fixed-size records; the tape is the single
+ * consumer and reads them in place. A full ring refuses the push (counted
+ * in dropped) rather than block a producer. Only symbols on a tape are
+ * shown; others are skipped. Prices are exact decimals: value * 10^-scale.
+ *
+ * The tape reads records strictly in order, so a producer must finish
+ * every push it starts. One that dies between claiming a slot and
+ * publishing it leaves the tape waiting at that slot for good: every later
+ * record stays unread and, once the ring fills, every push is refused.
+ * Only a fresh ring recovers, which takes every process that has it open,
+ * the tape included, closing it.
+ */
+
+#include <windows.h>
+#include <stdint.h>
+#include <string.h>
+
+#define QUOTE_FEED_NAME L"Local\\ARPTickerTapeQuoteFeed"
+#define QUOTE_FEED_EVENT_NAME L"Local\\ARPTickerTapeQuoteFeedReady"
+#define QUOTE_FEED_MAGIC 0x31465451u   /* "QTF1" */
+#define QUOTE_FEED_VERSION 1
+#define QUOTE_FEED_CAPACITY 4096       /* Records; a power of two */
+#define QUOTE_FEED_SYMBOL_BYTES 24     /* UTF-8 including the NUL */
+#define QUOTE_FEED_MAX_SCALE 12
+
+/* One quote, one cache line */
+typedef struct QuoteFeedRecord {
+    volatile LONG64 sequence;   /* Slot state: position + 1 once written */
+    int64_t price;
+    int64_t previousClose;      /* 0 when unknown: no change is shown */
+    uint64_t timestamp;         /* Producer's Unix time in milliseconds */
+    int8_t priceScale;          /* 0..QUOTE_FEED_MAX_SCALE */
+    int8_t previousCloseScale;
+    uint8_t reserved[6];
+    char symbol[QUOTE_FEED_SYMBOL_BYTES];
+} QuoteFeedRecord;
+
+/* Start of the shared memory, followed by QUOTE_FEED_CAPACITY records.
+   Producer and consumer counters sit on separate cache lines. */
+typedef struct QuoteFeedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t recordSize;
+    volatile LONG consumerWaiting;   /* The tape sleeps until signalled */
+    uint8_t reserved0[44];
+    volatile LONG64 head;            /* Next position producers claim */
+    volatile LONG64 dropped;         /* Pushes refused on a full ring */
+    uint8_t reserved1[48];
+    volatile LONG64 tail;            /* Next position the tape reads */
+    uint8_t reserved2[56];
+} QuoteFeedHeader;
+
+#define QUOTE_FEED_BYTES (sizeof(QuoteFeedHeader) + QUOTE_FEED_CAPACITY * sizeof(QuoteFeedRecord))
+
+static __inline QuoteFeedRecord* QuoteFeedRecords(QuoteFeedHeader* header) {
+    return (QuoteFeedRecord*)(header + 1);
+}
+
+/* Producer side */
+
+typedef struct QuoteFeedProducer {
+    HANDLE mapping;
+    HANDLE ready;
+    QuoteFeedHeader* header;
+} QuoteFeedProducer;
+
+/* Attach to the tape's ring. Returns 0 if the tape is not running with
+   localFeed=1 or is a different version; retry later. */
+static __inline int QuoteFeedOpen(QuoteFeedProducer* producer) {
+    memset(producer, 0, sizeof(*producer));
+    producer->mapping = OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, QUOTE_FEED_NAME);
+    if (!producer->mapping) return 0;
+
+    producer->header = (QuoteFeedHeader*)MapViewOfFile(producer->mapping,
+        FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, QUOTE_FEED_BYTES);
+    producer->ready = OpenEventW(EVENT_MODIFY_STATE, FALSE, QUOTE_FEED_EVENT_NAME);
+    if (!producer->header || !producer->ready ||
+        producer->header->magic != QUOTE_FEED_MAGIC || producer->header->version != QUOTE_FEED_VERSION ||
+        producer->header->capacity != QUOTE_FEED_CAPACITY || producer->header->recordSize != sizeof(QuoteFeedRecord)) {
+        if (producer->header) UnmapViewOfFile(producer->header);
+        if (producer->ready) CloseHandle(producer->ready);
+        CloseHandle(producer->mapping);
+        memset(producer, 0, sizeof(*producer));
+        return 0;
+    }
+    return 1;
+}
+
+static __inline void QuoteFeedClose(QuoteFeedProducer* producer) {
+    if (producer->header) UnmapViewOfFile(producer->header);
+    if (producer->ready) CloseHandle(producer->ready);
+    if (producer->mapping) CloseHandle(producer->mapping);
+    memset(producer, 0, sizeof(*producer));
+}
+
+/* Push one quote; safe from any number of threads and processes at once.
+   symbol is UTF-8, at most QUOTE_FEED_SYMBOL_BYTES - 1 bytes. Returns 0 if
+   the ring is full or the arguments are invalid. */
+static __inline int QuoteFeedPush(QuoteFeedProducer* producer, const char* symbol,
+    int64_t price, int priceScale, int64_t previousClose, int previousCloseScale, uint64_t timestamp) {
+    QuoteFeedHeader* header = producer->header;
+    QuoteFeedRecord* records;
+    QuoteFeedRecord* record;
+    size_t length;
+    LONG64 position;
+
+    if (!header || !symbol) return 0;
+    length = strlen(symbol);
+    if (length == 0 || length >= QUOTE_FEED_SYMBOL_BYTES) return 0;
+    if (priceScale < 0 || priceScale > QUOTE_FEED_MAX_SCALE ||
+        previousCloseScale < 0 || previousCloseScale > QUOTE_FEED_MAX_SCALE) return 0;
+
+    /* Claim a free slot: its sequence equals the position once the tape
+       has read the record a lap ago */
+    records = QuoteFeedRecords(header);
+    position = header->head;
+    for (;;) {
+        LONG64 difference;
+        record = &records[position & (QUOTE_FEED_CAPACITY - 1)];
+        difference = record->sequence - position;
+        if (difference == 0) {
+            if (InterlockedCompareExchange64(&header->head, position + 1, position) == position) break;
+            position = header->head;
+        }
+        else if (difference < 0) {
+            InterlockedIncrement64(&header->dropped);
+            return 0;
+        }
+        else {
+            position = header->head;
+        }
+    }
+
+    record->price = price;
+    record->previousClose = previousClose;
+    record->timestamp = timestamp;
+    record->priceScale = (int8_t)priceScale;
+    record->previousCloseScale = (int8_t)previousCloseScale;
+    memset(record->symbol, 0, sizeof(record->symbol));
+    memcpy(record->symbol, symbol, length);
+
+    /* Publish (a full barrier), then wake the tape if it went to sleep */
+    InterlockedExchange64(&record->sequence, position + 1);
+    if (header->consumerWaiting && InterlockedExchange(&header->consumerWaiting, 0)) {
+        SetEvent(producer->ready);
+    }
+    return 1;
+}
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "QuoteFeedReader.h"
+#include "QuoteFeed.h"
+#include "QuoteConflator.h"
+#include "Price.h"
+#include "Log.h"
+
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <string_view>
+
+// Longest the reader sleeps without a wake-up, in case one was missed
+#define FEED_POLL_MS 100
+
+// Records handled between updates of the shared tail
+#define FEED_BATCH 256
+
+static_assert(sizeof(QuoteFeedRecord) == 64, "QuoteFeedRecord must fill one cache line");
+static_assert(sizeof(QuoteFeedHeader) == 192, "QuoteFeedHeader layout changed");
+static_assert((QUOTE_FEED_CAPACITY & (QUOTE_FEED_CAPACITY - 1)) == 0, "QUOTE_FEED_CAPACITY must be a power of two");
+
+static std::thread g_readerThread;
+static std::atomic<bool> g_running(false);
+static HANDLE g_mapping = nullptr;
+static HANDLE g_readyEvent = nullptr;
+static HANDLE g_stopEvent = nullptr;
+static QuoteFeedHeader* g_header = nullptr;
+
+static std::atomic<unsigned long long> g_published(0);
+static std::atomic<unsigned long long> g_malformed(0);
+static std::atomic<unsigned long long> g_unknown(0);
+static std::atomic<unsigned long long> g_stale(0);
+
+// Per symbol: producer timestamp of the latest record (reader thread only)
+// and when the feed last published it
+static uint64_t g_lastTimestamp[MAX_SYMBOLS];
+static std::atomic<unsigned long long> g_lastFed[MAX_SYMBOLS];
+
+// Publish one record, read in place. Producers are other processes, so
+// nothing in it is trusted.
+static void Consume(const QuoteFeedRecord& record) {
+    const char* end = static_cast<const char*>(memchr(record.symbol, 0, QUOTE_FEED_SYMBOL_BYTES));
+    if (!end || end == record.symbol || record.price <= 0 ||
+        record.priceScale < 0 || record.priceScale > QUOTE_FEED_MAX_SCALE ||
+        record.previousCloseScale < 0 || record.previousCloseScale > QUOTE_FEED_MAX_SCALE) {
+        g_malformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    int id = QuoteConflator::Find(std::string_view(record.symbol, end - record.symbol));
+    if (id < 0) {
+        g_unknown.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Producers race each other; never let an older quote replace a newer one
+    if (record.timestamp < g_lastTimestamp[id]) {
+        g_stale.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    g_lastTimestamp[id] = record.timestamp;
+
+    Price previousClose = record.previousClose > 0 ?
+        Price::FromUnits(record.previousClose, record.previousCloseScale) : Price();
+    QuoteConflator::Publish(id, Price::FromUnits(record.price, record.priceScale), previousClose);
+    g_lastFed[id].store(GetTickCount64(), std::memory_order_relaxed);
+    g_published.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Consume up to FEED_BATCH written records from tail on, handing each slot
+// back to the producers as soon as it is read. Returns the number consumed.
+static size_t Drain(LONG64& tail) {
+    QuoteFeedRecord* records = QuoteFeedRecords(g_header);
+    size_t count = 0;
+    for (; count < FEED_BATCH; ++count) {
+        QuoteFeedRecord& record = records[tail & (QUOTE_FEED_CAPACITY - 1)];
+        if (ReadAcquire64(&record.sequence) != tail + 1) break;
+
+        Consume(record);
+        WriteRelease64(&record.sequence, tail + QUOTE_FEED_CAPACITY);
+        ++tail;
+    }
+    if (count) WriteRelease64(&g_header->tail, tail);
+    return count;
+}
+
+static void ReaderThread() {
+    LONG64 tail = g_header->tail;
+    HANDLE handles[2] = { g_stopEvent, g_readyEvent };
+
+    while (g_running.load()) {
+        if (Drain(tail)) continue;
+
+        // Announce the sleep, then look once more: a producer that wrote
+        // before seeing the flag is caught here, one after it signals
+        InterlockedExchange(&g_header->consumerWaiting, 1);
+        if (Drain(tail)) {
+            InterlockedExchange(&g_header->consumerWaiting, 0);
+            continue;
+        }
+        WaitForMultipleObjects(2, handles, FALSE, FEED_POLL_MS);
+        InterlockedExchange(&g_header->consumerWaiting, 0);
+    }
+}
+
+// Lay out an empty ring. Producers check the magic last.
+static void InitializeRing(QuoteFeedHeader* header) {
+    memset(header, 0, sizeof(QuoteFeedHeader));
+    header->version = QUOTE_FEED_VERSION;
+    header->capacity = QUOTE_FEED_CAPACITY;
+    header->recordSize = sizeof(QuoteFeedRecord);
+
+    QuoteFeedRecord* records = QuoteFeedRecords(header);
+    for (LONG64 i = 0; i < QUOTE_FEED_CAPACITY; ++i) {
+        records[i].sequence = i;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = QUOTE_FEED_MAGIC;
+}
+
+static void ReleaseRing() {
+    if (g_header) UnmapViewOfFile(g_header);
+    if (g_mapping) CloseHandle(g_mapping);
+    if (g_readyEvent) CloseHandle(g_readyEvent);
+    if (g_stopEvent) CloseHandle(g_stopEvent);
+    g_header = nullptr;
+    g_mapping = nullptr;
+    g_readyEvent = nullptr;
+    g_stopEvent = nullptr;
+}
+
+bool QuoteFeedReader::Start() {
+    if (g_running.load()) return true;
+
+    // Page-file backed; the default security limits it to this user
+    g_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        0, static_cast<DWORD>(QUOTE_FEED_BYTES), QUOTE_FEED_NAME);
+    bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+    if (g_mapping) {
+        g_header = static_cast<QuoteFeedHeader*>(MapViewOfFile(g_mapping,
+            FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, QUOTE_FEED_BYTES));
+    }
+    g_readyEvent = CreateEventW(nullptr, FALSE, FALSE, QUOTE_FEED_EVENT_NAME);
+    g_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!g_header || !g_readyEvent || !g_stopEvent) {
+        LOG_ERROR("QuoteFeed: could not create the shared ring (error {})", GetLastError());
+        ReleaseRing();
+        return false;
+    }
+
+    // A producer kept the ring of an earlier run open: carry on reading it
+    if (existed) {
+        if (g_header->magic != QUOTE_FEED_MAGIC || g_header->version != QUOTE_FEED_VERSION ||
+            g_header->capacity != QUOTE_FEED_CAPACITY || g_header->recordSize != sizeof(QuoteFeedRecord)) {
+            LOG_ERROR("QuoteFeed: an incompatible ring is already open");
+            ReleaseRing();
+            return false;
+        }
+    }
+    else {
+        InitializeRing(g_header);
+    }
+
+    g_running = true;
+    g_readerThread = std::thread(ReaderThread);
+    LOG_INFO("QuoteFeed: accepting local quotes");
+    return true;
+}
+
+void QuoteFeedReader::Stop() {
+    if (!g_readerThread.joinable()) return;
+
+    g_running = false;
+    SetEvent(g_stopEvent);
+    g_readerThread.join();
+
+    LOG_INFO("QuoteFeed: {} published; skipped {} malformed, {} for symbols on no tape, {} out of order; "
+        "{} refused by a full ring", g_published.load(), g_malformed.load(), g_unknown.load(),
+        g_stale.load(), static_cast<long long>(g_header->dropped));
+    ReleaseRing();
+}
+
+bool QuoteFeedReader::IsFed(int id, unsigned long long maxAgeMs) {
+    if (id < 0 || id >= MAX_SYMBOLS) return false;
+    unsigned long long fed = g_lastFed[id].load(std::memory_order_relaxed);
+    return fed != 0 && GetTickCount64() - fed < maxAgeMs;
+}
+
+unsigned long long QuoteFeedReader::GetRecordsPublished() {
+    return g_published.load();
+}
+
+unsigned long long QuoteFeedReader::GetRecordsSkipped() {
+    return g_malformed.load() + g_unknown.load() + g_stale.load();
+}
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef QUOTE_FEED_READER_H
+#define QUOTE_FEED_READER_H
+
+// The tape's side of the local quote feed (see QuoteFeed.h). Creates the
+// shared ring and drains it on its own thread, straight from the shared
+// records into the QuoteConflator: the symbol is looked up in place and the
+// price converted from its fixed-point fields, so nothing is copied or
+// allocated per record. The thread sleeps while the ring is empty and
+// producers wake it.
+class QuoteFeedReader {
+public:
+    // Create the ring and start draining it; false if it cannot be created
+    static bool Start();
+
+    // Stop draining and release the ring (safe to call more than once)
+    static void Stop();
+
+    // Whether the feed updated a symbol in the last maxAgeMs milliseconds;
+    // the quote engine leaves such symbols to the feed
+    static bool IsFed(int id, unsigned long long maxAgeMs);
+
+    // Records published to the tape, and records skipped: malformed, for a
+    // symbol on no tape, or older than the symbol's latest
+    static unsigned long long GetRecordsPublished();
+    static unsigned long long GetRecordsSkipped();
+};
+
+#endif
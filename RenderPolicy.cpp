@@ -0,0 +1,217 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "RenderPolicy.h"
+#include "RenderThread.h"
+#include "Log.h"
+
+#include <wtsapi32.h>
+#include <shellapi.h>
+#include <atomic>
+#include <algorithm>
+
+#pragma comment(lib, "wtsapi32.lib")
+
+// GUID_CONSOLE_DISPLAY_STATE, spelled out so no GUID library is needed
+static const GUID g_displayStateGuid =
+    { 0x6fe69556, 0x704a, 0x47a0, { 0x8f, 0x24, 0xc2, 0x8d, 0x93, 0x6f, 0xda, 0x47 } };
+
+// Written by the UI thread, read by the render thread
+static std::atomic<bool> g_locked(false);
+static std::atomic<bool> g_disconnected(false);
+static std::atomic<bool> g_displayOff(false);
+static std::atomic<HMONITOR> g_coveredMonitor(nullptr);
+
+// UI thread only
+static HPOWERNOTIFY g_displayNotify = nullptr;
+static HWINEVENTHOOK g_foregroundHook = nullptr;
+static HWINEVENTHOOK g_locationHook = nullptr;   // Scoped to the foreground window's thread
+
+// Render thread accounting
+static std::atomic<unsigned long long> g_framesSkipped(0);
+static std::atomic<unsigned long long> g_cpuSavedMicros(0);
+static double g_skippedCarry = 0.0;
+static uint64_t g_fullCpuMicros = 0;
+static uint64_t g_fullWakes = 0;
+
+// Ask the render thread to re-evaluate the policy and redraw every tape
+static void WakeRenderer() {
+    RenderThread::Post(RenderCommandType::Redraw);
+}
+
+// Monitor a full-screen foreground window hides the tapes on, if any. The
+// tapes are topmost, so an ordinary full-screen window such as a maximized
+// browser stays below them; only a topmost one or an exclusive Direct3D
+// application covers them.
+static HMONITOR CoveredMonitor(HWND foreground) {
+    if (!foreground) return nullptr;
+    DWORD process = 0;
+    GetWindowThreadProcessId(foreground, &process);
+    if (process == GetCurrentProcessId()) return nullptr;
+
+    QUERY_USER_NOTIFICATION_STATE state = QUNS_ACCEPTS_NOTIFICATIONS;
+    bool above = (GetWindowLongPtrW(foreground, GWL_EXSTYLE) & WS_EX_TOPMOST) != 0 ||
+        (SUCCEEDED(SHQueryUserNotificationState(&state)) && state == QUNS_RUNNING_D3D_FULL_SCREEN);
+    if (!above) return nullptr;
+
+    HMONITOR monitor = MonitorFromWindow(foreground, MONITOR_DEFAULTTONULL);
+    MONITORINFO info = {};
+    info.cbSize = sizeof(info);
+    RECT rect = {};
+    if (!monitor || !GetMonitorInfoW(monitor, &info) || !GetWindowRect(foreground, &rect)) return nullptr;
+
+    bool covers = rect.left <= info.rcMonitor.left && rect.top <= info.rcMonitor.top &&
+        rect.right >= info.rcMonitor.right && rect.bottom >= info.rcMonitor.bottom;
+    return covers ? monitor : nullptr;
+}
+
+static void UpdateForeground(HWND foreground) {
+    HMONITOR monitor = CoveredMonitor(foreground);
+    if (g_coveredMonitor.exchange(monitor) == monitor) return;
+
+    LOG_DEBUG("RenderPolicy: full-screen window {}", monitor ? "covers a monitor" : "gone");
+    WakeRenderer();
+}
+
+static void CALLBACK OnWinEvent(HWINEVENTHOOK hook, DWORD event, HWND hWnd,
+    LONG idObject, LONG idChild, DWORD thread, DWORD time);
+
+// Follow moves and resizes of the foreground window only, so a window
+// entering full screen in place is noticed without a system-wide hook
+static void WatchLocation(HWND foreground) {
+    if (g_locationHook) {
+        UnhookWinEvent(g_locationHook);
+        g_locationHook = nullptr;
+    }
+
+    DWORD process = 0;
+    DWORD thread = foreground ? GetWindowThreadProcessId(foreground, &process) : 0;
+    if (!thread || process == GetCurrentProcessId()) return;
+    g_locationHook = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE,
+        nullptr, OnWinEvent, process, thread, WINEVENT_OUTOFCONTEXT);
+}
+
+// Runs on the UI thread, which installed the hooks
+static void CALLBACK OnWinEvent(HWINEVENTHOOK, DWORD event, HWND hWnd,
+    LONG idObject, LONG idChild, DWORD, DWORD) {
+    if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !hWnd) return;
+
+    if (event == EVENT_SYSTEM_FOREGROUND) {
+        WatchLocation(hWnd);
+        UpdateForeground(hWnd);
+    }
+    else if (hWnd == GetForegroundWindow()) {
+        UpdateForeground(hWnd);
+    }
+}
+
+void RenderPolicy::Start(HWND hWnd) {
+    if (!WTSRegisterSessionNotification(hWnd, NOTIFY_FOR_THIS_SESSION)) {
+        LOG_WARN("RenderPolicy: no session notifications (error {})", GetLastError());
+    }
+
+    // Reports the current display state right away
+    g_displayNotify = RegisterPowerSettingNotification(hWnd, &g_displayStateGuid, DEVICE_NOTIFY_WINDOW_HANDLE);
+
+    g_foregroundHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND,
+        nullptr, OnWinEvent, 0, 0, WINEVENT_OUTOFCONTEXT);
+    HWND foreground = GetForegroundWindow();
+    WatchLocation(foreground);
+    UpdateForeground(foreground);
+}
+
+void RenderPolicy::Stop(HWND hWnd) {
+    WTSUnRegisterSessionNotification(hWnd);
+    if (g_displayNotify) {
+        UnregisterPowerSettingNotification(g_displayNotify);
+        g_displayNotify = nullptr;
+    }
+    if (g_locationHook) {
+        UnhookWinEvent(g_locationHook);
+        g_locationHook = nullptr;
+    }
+    if (g_foregroundHook) {
+        UnhookWinEvent(g_foregroundHook);
+        g_foregroundHook = nullptr;
+    }
+}
+
+void RenderPolicy::HandleMessage(UINT message, WPARAM wParam, LPARAM lParam) {
+    bool changed = false;
+    if (message == WM_WTSSESSION_CHANGE) {
+        switch (wParam) {
+        case WTS_SESSION_LOCK:
+            changed = !g_locked.exchange(true);
+            break;
+        case WTS_SESSION_UNLOCK:
+            changed = g_locked.exchange(false);
+            break;
+        case WTS_CONSOLE_DISCONNECT:
+        case WTS_REMOTE_DISCONNECT:
+            changed = !g_disconnected.exchange(true);
+            break;
+        case WTS_CONSOLE_CONNECT:
+        case WTS_REMOTE_CONNECT:
+            changed = g_disconnected.exchange(false);
+            break;
+        default:
+            break;
+        }
+    }
+    else if (message == WM_POWERBROADCAST && wParam == PBT_POWERSETTINGCHANGE) {
+        const POWERBROADCAST_SETTING* setting = reinterpret_cast<const POWERBROADCAST_SETTING*>(lParam);
+        if (setting && IsEqualGUID(setting->PowerSetting, g_displayStateGuid) &&
+            setting->DataLength >= sizeof(DWORD)) {
+            // 0 off, 1 on, 2 dimmed (still readable)
+            bool off = *reinterpret_cast<const DWORD*>(setting->Data) == 0;
+            changed = g_displayOff.exchange(off) != off;
+        }
+    }
+
+    if (changed) {
+        LOG_INFO("RenderPolicy: session {}", IsSessionActive() ? "active, rendering" : "inactive, not rendering");
+        WakeRenderer();
+    }
+}
+
+bool RenderPolicy::IsSessionActive() {
+    return !g_locked.load(std::memory_order_relaxed) && !g_disconnected.load(std::memory_order_relaxed) &&
+        !g_displayOff.load(std::memory_order_relaxed);
+}
+
+bool RenderPolicy::IsOccluded(HWND hWnd) {
+    HMONITOR covered = g_coveredMonitor.load(std::memory_order_relaxed);
+    return covered && MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST) == covered;
+}
+
+RenderRate RenderPolicy::Choose(bool anyShown, bool anyScrolling) {
+    if (!anyShown || !IsSessionActive()) return RenderRate::Stopped;
+    return anyScrolling ? RenderRate::Full : RenderRate::Idle;
+}
+
+void RenderPolicy::RecordWake(RenderRate rate, double frames, uint64_t cpuMicros) {
+    if (rate == RenderRate::Full) {
+        g_fullCpuMicros += cpuMicros;
+        ++g_fullWakes;
+        return;
+    }
+
+    // The wake-up itself renders one of the intervals
+    double skipped = g_skippedCarry + std::max(frames - 1.0, 0.0);
+    unsigned long long whole = static_cast<unsigned long long>(skipped);
+    g_skippedCarry = skipped - static_cast<double>(whole);
+    if (whole == 0) return;
+
+    g_framesSkipped.fetch_add(whole, std::memory_order_relaxed);
+    if (g_fullWakes) {
+        g_cpuSavedMicros.fetch_add(whole * g_fullCpuMicros / g_fullWakes, std::memory_order_relaxed);
+    }
+}
+
+unsigned long long RenderPolicy::GetFramesSkipped() {
+    return g_framesSkipped.load();
+}
+
+unsigned long long RenderPolicy::GetCpuSavedMs() {
+    return g_cpuSavedMicros.load() / 1000;
+}
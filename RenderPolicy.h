@@ -0,0 +1,57 @@
+#pragma once
+#ifndef RENDER_POLICY_H
+#define RENDER_POLICY_H
+
+#include <windows.h>
+#include <cstdint>
+
+// Frame interval while no shown tape scrolls: quotes that arrive still
+// appear within this time
+#define IDLE_FRAME_INTERVAL_MS 250
+
+// How often the render thread wakes up
+enum class RenderRate {
+    Full,      // A shown tape is scrolling: every frame
+    Idle,      // Tapes are shown but static: IDLE_FRAME_INTERVAL_MS
+    Stopped    // Nothing can be seen: no timer, only commands wake the thread
+};
+
+// Decides how often the render thread renders. Nothing is drawn while the
+// session is locked or disconnected, the display is off, or every tape is
+// hidden or covered by a full-screen application on its monitor; a static
+// tape is only checked for new quotes at the idle rate. The UI thread feeds
+// the session, display and foreground window state in and the render
+// thread is woken the moment any of it changes, so rendering resumes on
+// the next frame.
+class RenderPolicy {
+public:
+    // Subscribe hWnd to session and display notifications and start
+    // watching the foreground window. UI thread only; Stop undoes it.
+    static void Start(HWND hWnd);
+    static void Stop(HWND hWnd);
+
+    // Forward WM_WTSSESSION_CHANGE and WM_POWERBROADCAST from hWnd's
+    // window procedure
+    static void HandleMessage(UINT message, WPARAM wParam, LPARAM lParam);
+
+    // Render thread: session unlocked and connected with the display on
+    static bool IsSessionActive();
+
+    // Render thread: a full-screen application covers hWnd's monitor
+    static bool IsOccluded(HWND hWnd);
+
+    // Render thread: rate for the frames after this one
+    static RenderRate Choose(bool anyShown, bool anyScrolling);
+
+    // Render thread: account one wake-up that ended frames full-rate frame
+    // intervals after the previous one while running at rate, and the
+    // thread's CPU time over them
+    static void RecordWake(RenderRate rate, double frames, uint64_t cpuMicros);
+
+    // Full-rate frames not rendered, and the render thread CPU time they
+    // would have cost at the average cost of a full-rate frame
+    static unsigned long long GetFramesSkipped();
+    static unsigned long long GetCpuSavedMs();
+};
+
+#endif
@@ -0,0 +1,650 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "RenderThread.h"
+#include "Renderer.h"
+#include "ConfigManager.h"
+#include "SpscQueue.h"
+#include "Compositor.h"
+#include "FetchMetrics.h"
+#include "FrameComposer.h"
+#include "QuoteConflator.h"
+#include "Sparkline.h"
+#include "RenderPolicy.h"
+#include "StartupTimeline.h"
+#include "Trace.h"
+#include "Log.h"
+
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
+#define FRAME_INTERVAL_MS 33
+
+// How long a segment stays highlighted after its price ticks
+#define FLASH_DURATION_MS 1500
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+static std::thread g_renderThread;
+static std::atomic<bool> g_running(false);
+static HANDLE g_wakeEvent = nullptr;
+static HANDLE g_removedEvent = nullptr;
+static SpscQueue<RenderCommand, 64> g_commands;
+static std::atomic<std::shared_ptr<const TapeSnapshot>> g_snapshots[MAX_TAPES];
+static std::atomic<unsigned long long> g_framesRendered(0);
+static std::atomic<unsigned long long> g_framesDropped(0);
+static std::atomic<int> g_lastFrameDrawCalls(0);
+
+// 32bpp top-down DIB section selected into a memory DC.
+// Created, used and destroyed only on the render thread.
+struct BackBuffer {
+    HDC hdc = nullptr;
+    HBITMAP hbm = nullptr;
+    HGDIOBJ hOldBmp = nullptr;
+    void* bits = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+static void DestroyBackBuffer(BackBuffer& bb) {
+    if (bb.hdc) {
+        SelectObject(bb.hdc, bb.hOldBmp);
+        DeleteDC(bb.hdc);
+    }
+    if (bb.hbm) DeleteObject(bb.hbm);
+    bb = BackBuffer();
+}
+
+static bool CreateBackBuffer(BackBuffer& bb, HDC hdcScreen, int width, int height) {
+    DestroyBackBuffer(bb);
+    if (width <= 0 || height <= 0) return false;
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height; // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    bb.hdc = CreateCompatibleDC(hdcScreen);
+    if (!bb.hdc) return false;
+
+    bb.hbm = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &bb.bits, nullptr, 0);
+    if (!bb.hbm) {
+        DestroyBackBuffer(bb);
+        return false;
+    }
+
+    bb.hOldBmp = SelectObject(bb.hdc, bb.hbm);
+    bb.width = width;
+    bb.height = height;
+    return true;
+}
+
+// Per-tape state, owned by the render thread
+struct TapeTarget {
+    HWND hWnd = nullptr;
+    bool paused = false;
+    bool visible = true;
+    double speed = 0.0;
+    double offset = 0.0;
+    BackBuffer bb;
+    std::unique_ptr<GdiRasterizer> rasterizer;
+};
+
+// Resolve the current config snapshot into a frame style
+static FrameStyle CurrentStyle() {
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::Current();
+
+    FrameStyle style = {};
+    style.neutral = config->palette.neutral;
+    style.up = config->palette.up;
+    style.down = config->palette.down;
+    style.flash = config->palette.flash;
+    style.background = config->bgColor;
+    style.backgroundAlpha = static_cast<uint8_t>(config->opacity * 255 / 100);
+    style.edgeFade = config->edgeFade;
+    return style;
+}
+
+// Latest state of one symbol as laid out on the tapes
+struct SymbolEntry {
+    TapeSegment segment;
+    Price price;
+    Price previousClose;
+    std::shared_ptr<SparklineBitmap> sparkline;   // Latest series rasterized, null until one arrives
+    unsigned long long flashUntil = 0;
+    bool valid = false;     // Has had a good quote
+    bool changed = false;   // Segment changed in this frame's drain
+};
+
+// Tape layout state, owned by the render thread. Symbols are indexed by
+// their conflator id.
+struct TapeLayout {
+    std::vector<SymbolEntry> symbols;
+    std::vector<int> tapeSymbols[MAX_TAPES];
+    std::vector<ConflatedQuote> updates;
+    std::vector<int> seriesUpdates;   // Symbols with a new intraday series
+    std::vector<int> changedIds;      // Symbols with changed set, this frame
+    std::vector<float> series;        // Scratch for one symbol's series
+    std::vector<SparkPoint> points;   // Scratch for its downsampled points
+    unsigned long long configVersion = ~0ULL;
+    std::wstring tapeFormat;   // Format the segments were laid out with
+    int sparklineCharWidth = 0;   // Cell width the sparklines were rasterized for
+
+    // Each tape alternates between two snapshots: the published one, and
+    // the previous one, rebuilt in place once no reader holds it any more
+    std::shared_ptr<TapeSnapshot> buffers[MAX_TAPES][2];
+    int published[MAX_TAPES] = {};
+};
+
+// Snapshot to rebuild tape i into: the one not published, recycled if the
+// renderer and every other reader have let go of it
+static TapeSnapshot& SpareSnapshot(TapeLayout& layout, int i) {
+    std::shared_ptr<TapeSnapshot>& spare = layout.buffers[i][layout.published[i] ^ 1];
+    if (!spare || spare.use_count() > 1) spare = std::make_shared<TapeSnapshot>();
+    return *spare;
+}
+
+static void PublishSpareSnapshot(TapeLayout& layout, int i) {
+    layout.published[i] ^= 1;
+    g_snapshots[i].store(layout.buffers[i][layout.published[i]]);
+}
+
+static SymbolEntry& EntryOf(TapeLayout& layout, int id) {
+    if (id >= static_cast<int>(layout.symbols.size())) {
+        layout.symbols.resize(id + 1);
+    }
+    return layout.symbols[id];
+}
+
+static void MarkChanged(TapeLayout& layout, int id) {
+    SymbolEntry& entry = layout.symbols[id];
+    if (entry.changed) return;
+    entry.changed = true;
+    layout.changedIds.push_back(id);
+}
+
+// Downsample a symbol's latest series to the sparkline's pixel width and
+// rasterize it into the symbol's cached bitmap, in place unless a snapshot
+// still shows the old one. Runs only when the series or the font changes;
+// frames just blend the bitmap.
+static void RasterizeSparkline(TapeLayout& layout, int id, int charWidth) {
+    TRACE_SCOPE("render", "RasterizeSparkline");
+    Sparkline::Read(id, layout.series);
+    if (layout.series.empty()) return;
+
+    Sparkline::Downsample(layout.series.data(), layout.series.size(),
+        Sparkline::PlotWidth(charWidth), layout.points);
+    SymbolEntry& entry = layout.symbols[id];
+    if (!entry.sparkline || entry.sparkline.use_count() > 1) {
+        entry.sparkline = std::make_shared<SparklineBitmap>();
+    }
+    Sparkline::Rasterize(layout.points, charWidth, *entry.sparkline);
+    MarkChanged(layout, id);
+}
+
+// Drain the conflator and the sparkline series once per frame and rebuild
+// only the tapes showing a symbol whose value or series changed; a config
+// change rebuilds every tape. However many ticks arrived since the last
+// frame, each tape is laid out at most once.
+static void UpdateLayout(TapeLayout& layout, bool (&redraw)[MAX_TAPES], int charWidth) {
+    TRACE_SCOPE("render", "UpdateLayout");
+    bool dirty[MAX_TAPES] = {};
+    bool anyDirty = false;
+
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::Current();
+    if (config->version != layout.configVersion) {
+        layout.configVersion = config->version;
+        for (int i = 0; i < MAX_TAPES; ++i) {
+            layout.tapeSymbols[i].clear();
+            if (i < static_cast<int>(config->tapes.size())) {
+                for (const auto& symbol : config->tapes[i].symbols) {
+                    int id = QuoteConflator::Intern(symbol);
+                    if (id >= 0) layout.tapeSymbols[i].push_back(id);
+                }
+            }
+            dirty[i] = true;
+        }
+        anyDirty = true;
+
+        // A new tape format re-lays out every symbol already shown
+        if (config->tapeFormat != layout.tapeFormat) {
+            layout.tapeFormat = config->tapeFormat;
+            for (size_t id = 0; id < layout.symbols.size(); ++id) {
+                SymbolEntry& entry = layout.symbols[id];
+                if (!entry.valid) continue;
+                TapeModel::FormatQuote(config->tapeTemplate, QuoteConflator::GetSymbol(static_cast<int>(id)),
+                    entry.price, entry.previousClose, entry.sparkline != nullptr, entry.segment);
+            }
+        }
+    }
+
+    // A new cell width re-rasterizes every cached sparkline
+    if (charWidth != layout.sparklineCharWidth) {
+        layout.sparklineCharWidth = charWidth;
+        for (size_t id = 0; id < layout.symbols.size(); ++id) {
+            if (layout.symbols[id].sparkline) RasterizeSparkline(layout, static_cast<int>(id), charWidth);
+        }
+    }
+
+    layout.updates.clear();
+    layout.seriesUpdates.clear();
+    QuoteConflator::Drain(layout.updates);
+    Sparkline::Drain(layout.seriesUpdates);
+    if (layout.updates.empty() && layout.seriesUpdates.empty() && layout.changedIds.empty() && !anyDirty) return;
+
+    unsigned long long now = GetTickCount64();
+    for (const ConflatedQuote& update : layout.updates) {
+        SymbolEntry& entry = EntryOf(layout, update.id);
+
+        // A refetch of the same value needs no layout
+        if (entry.valid && entry.price == update.price && entry.previousClose == update.previousClose) continue;
+
+        if (entry.valid && entry.price != update.price) {
+            entry.flashUntil = now + FLASH_DURATION_MS;
+        }
+        entry.valid = true;
+        entry.price = update.price;
+        entry.previousClose = update.previousClose;
+        MarkChanged(layout, update.id);
+    }
+    for (int id : layout.seriesUpdates) {
+        EntryOf(layout, id);
+        RasterizeSparkline(layout, id, charWidth);
+    }
+
+    for (int id : layout.changedIds) {
+        SymbolEntry& entry = layout.symbols[id];
+        if (!entry.valid) continue;
+        TapeModel::FormatQuote(config->tapeTemplate, QuoteConflator::GetSymbol(id),
+            entry.price, entry.previousClose, entry.sparkline != nullptr, entry.segment);
+    }
+
+    for (int i = 0; i < MAX_TAPES; ++i) {
+        for (int id : layout.tapeSymbols[i]) {
+            if (id < static_cast<int>(layout.symbols.size()) && layout.symbols[id].changed) {
+                dirty[i] = true;
+                break;
+            }
+        }
+    }
+    for (int id : layout.changedIds) {
+        layout.symbols[id].changed = false;
+    }
+    layout.changedIds.clear();
+
+    for (int i = 0; i < MAX_TAPES; ++i) {
+        if (!dirty[i]) continue;
+
+        // Tapes with nothing to show keep their status text
+        bool any = false;
+        for (int id : layout.tapeSymbols[i]) {
+            if (id < static_cast<int>(layout.symbols.size()) && layout.symbols[id].valid) {
+                any = true;
+                break;
+            }
+        }
+        if (!any) continue;
+
+        TapeSnapshot& snapshot = SpareSnapshot(layout, i);
+        unsigned long long flashUntil = 0;
+        TapeModel::Begin(snapshot);
+        for (int id : layout.tapeSymbols[i]) {
+            if (id >= static_cast<int>(layout.symbols.size()) || !layout.symbols[id].valid) continue;
+            const SymbolEntry& entry = layout.symbols[id];
+            bool flash = now < entry.flashUntil;
+            TapeModel::Append(snapshot, entry.segment.text, entry.segment.tone, flash,
+                entry.segment.sparkline, entry.sparkline);
+            if (flash) flashUntil = std::max(flashUntil, entry.flashUntil);
+        }
+
+        // The snapshot repeats the text to create a seamless endless loop
+        TapeModel::Finish(snapshot, flashUntil);
+        PublishSpareSnapshot(layout, i);
+        redraw[i] = true;
+    }
+}
+
+static void PresentFrame(HWND hWnd, HDC hdcScreen, BackBuffer& bb, GdiRasterizer& rasterizer,
+    const TapeSnapshot& tape, double offset, int charWidth) {
+    // GDI only rasterizes the glyph coverage; everything else is composited
+    // in software so the background can be translucent
+    const uint32_t* mask = nullptr;
+    {
+        TRACE_SCOPE("render", "RenderMask");
+        mask = rasterizer.RenderMask(tape.text, offset, bb.width, bb.height, charWidth);
+    }
+    {
+        TRACE_SCOPE("render", "Compose");
+        g_lastFrameDrawCalls += FrameComposer::Compose(static_cast<uint32_t*>(bb.bits), mask,
+            bb.width, bb.height, tape, offset, charWidth, CurrentStyle(), GetTickCount64());
+    }
+
+    BLENDFUNCTION bf = { 0 };
+    bf.BlendOp = AC_SRC_OVER;
+    bf.SourceConstantAlpha = 255;
+    bf.AlphaFormat = AC_SRC_ALPHA;
+
+    SIZE sizeWnd = { bb.width, bb.height };
+    POINT ptSrc = { 0, 0 };
+
+    // The window position is owned by the UI thread, so never pass a
+    // destination point here; we only replace the contents.
+    TRACE_SCOPE("render", "UpdateLayeredWindow");
+    UpdateLayeredWindow(hWnd, hdcScreen, nullptr, &sizeWnd,
+        bb.hdc, &ptSrc, 0, &bf, ULW_ALPHA);
+}
+
+static void ResizeTarget(TapeTarget& target, HDC hdcScreen, int width, int height) {
+    if (width == target.bb.width && height == target.bb.height) return;
+    CreateBackBuffer(target.bb, hdcScreen, width, height);
+}
+
+static void ReleaseTarget(TapeTarget& target) {
+    DestroyBackBuffer(target.bb);
+    target = TapeTarget();
+}
+
+// Run the frame timer at a rate's interval, or stop it
+static void ArmTimer(HANDLE hTimer, RenderRate rate) {
+    if (rate == RenderRate::Stopped) {
+        CancelWaitableTimer(hTimer);
+        return;
+    }
+
+    int interval = rate == RenderRate::Full ? FRAME_INTERVAL_MS : IDLE_FRAME_INTERVAL_MS;
+    LARGE_INTEGER due;
+    due.QuadPart = -10000LL * interval;
+    SetWaitableTimer(hTimer, &due, interval, nullptr, nullptr, FALSE);
+}
+
+// User plus kernel time of the calling thread
+static uint64_t ThreadCpuMicros() {
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0;
+    uint64_t total = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime) +
+        (static_cast<uint64_t>(user.dwHighDateTime) << 32 | user.dwLowDateTime);
+    return total / 10;
+}
+
+static void RenderLoop() {
+    HANDLE hTimer = CreateWaitableTimerExW(nullptr, nullptr,
+        CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!hTimer) {
+        // High resolution timers need Windows 10 1803 or later
+        hTimer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+    }
+    if (!hTimer) return;
+
+    RenderRate rate = RenderRate::Full;
+    ArmTimer(hTimer, rate);
+
+    HDC hdcScreen = GetDC(nullptr);
+    TapeTarget targets[MAX_TAPES];
+
+    Renderer::Init(nullptr);
+    GdiRasterizer metrics;
+    int charWidth = metrics.GetCellWidth();
+
+    LARGE_INTEGER freq, lastTick;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&lastTick);
+    const double ticksPerFrame = freq.QuadPart * (FRAME_INTERVAL_MS / 1000.0);
+    LARGE_INTEGER lastWake = lastTick;
+    uint64_t lastCpu = ThreadCpuMicros();
+
+    HANDLE handles[2] = { g_wakeEvent, hTimer };
+    TapeLayout layout;
+
+    while (g_running.load()) {
+        DWORD wait = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+        TRACE_SCOPE("render", "Frame");
+        bool redraw[MAX_TAPES] = {};
+
+        RenderCommand cmd;
+        while (g_commands.TryPop(cmd)) {
+            if (cmd.type == RenderCommandType::Stop) {
+                g_running = false;
+                continue;
+            }
+            if (cmd.type == RenderCommandType::FontChanged) {
+                Renderer::Init(nullptr);
+                charWidth = metrics.GetCellWidth();
+                std::fill(std::begin(redraw), std::end(redraw), true);
+                continue;
+            }
+
+            int first = cmd.tape == ALL_TAPES ? 0 : cmd.tape;
+            int last = cmd.tape == ALL_TAPES ? MAX_TAPES - 1 : cmd.tape;
+            for (int i = std::max(first, 0); i <= last && i < MAX_TAPES; ++i) {
+                TapeTarget& target = targets[i];
+                switch (cmd.type) {
+                case RenderCommandType::AddTape: {
+                    ReleaseTarget(target);
+                    target.hWnd = cmd.hWnd;
+                    target.speed = cmd.value;
+                    target.rasterizer.reset(new GdiRasterizer());
+                    layout.configVersion = ~0ULL;  // Lay the new tape out on this frame
+                    RECT clientRect = {};
+                    GetClientRect(target.hWnd, &clientRect);
+                    ResizeTarget(target, hdcScreen, clientRect.right - clientRect.left,
+                        clientRect.bottom - clientRect.top);
+                    redraw[i] = true;
+                    break;
+                }
+                case RenderCommandType::RemoveTape:
+                    ReleaseTarget(target);
+                    SetEvent(g_removedEvent);
+                    break;
+                case RenderCommandType::Pause:
+                    target.paused = true;
+                    break;
+                case RenderCommandType::Resume:
+                    target.paused = false;
+                    break;
+                case RenderCommandType::Show:
+                    target.visible = true;
+                    redraw[i] = true;
+                    break;
+                case RenderCommandType::Hide:
+                    target.visible = false;
+                    break;
+                case RenderCommandType::Resize:
+                    ResizeTarget(target, hdcScreen, cmd.width, cmd.height);
+                    redraw[i] = true;
+                    break;
+                case RenderCommandType::SetSpeed:
+                    target.speed = cmd.value;
+                    break;
+                case RenderCommandType::Redraw:
+                    redraw[i] = true;
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        if (!g_running.load()) break;
+
+        UpdateLayout(layout, redraw, charWidth);
+
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        double frames = 0.0;
+        if (wait == WAIT_OBJECT_0 + 1) {
+            // Advance by wall-clock time so a late frame catches up instead
+            // of slowing the tape down
+            frames = (now.QuadPart - lastTick.QuadPart) / ticksPerFrame;
+            lastTick = now;
+        }
+
+        const bool sessionActive = RenderPolicy::IsSessionActive();
+        bool anyShown = false;
+        bool anyMoving = false;
+        bool anyScrolling = false;
+        g_lastFrameDrawCalls = 0;
+        for (int i = 0; i < MAX_TAPES; ++i) {
+            TapeTarget& target = targets[i];
+            if (!target.hWnd || !target.visible || !target.bb.hdc || !target.rasterizer) continue;
+
+            // A tape nobody can see neither scrolls nor draws
+            if (!sessionActive || !IsWindowVisible(target.hWnd) || RenderPolicy::IsOccluded(target.hWnd)) continue;
+            anyShown = true;
+            if (!target.paused && target.speed != 0.0) anyMoving = true;
+
+            if (frames > 0.0 && !target.paused) {
+                target.offset += target.speed * frames;
+                redraw[i] = true;
+                anyScrolling = true;
+            }
+            if (!redraw[i]) continue;
+
+            std::shared_ptr<const TapeSnapshot> tape = g_snapshots[i].load();
+            if (!tape) continue;
+
+            // Calculate the width of one complete cycle of tickers
+            int singleCycleWidth = tape->cycleLength * charWidth;
+            if (singleCycleWidth > 0 && target.offset >= singleCycleWidth) {
+                target.offset = fmod(target.offset, singleCycleWidth);
+            }
+
+            PresentFrame(target.hWnd, hdcScreen, target.bb, *target.rasterizer, *tape, target.offset, charWidth);
+            StartupTimeline::Mark(StartupPhase::FirstFrame);
+            if (tape == layout.buffers[i][layout.published[i]]) {
+                StartupTimeline::Mark(StartupPhase::FirstPrice);   // Not the status text
+            }
+        }
+
+        if (anyScrolling) {
+            if (frames >= 2.0) {
+                g_framesDropped += static_cast<unsigned long long>(frames) - 1;
+            }
+            ++g_framesRendered;
+        }
+
+        uint64_t cpu = ThreadCpuMicros();
+        RenderPolicy::RecordWake(rate, (now.QuadPart - lastWake.QuadPart) / ticksPerFrame, cpu - lastCpu);
+        lastWake = now;
+        lastCpu = cpu;
+
+        RenderRate next = RenderPolicy::Choose(anyShown, anyMoving);
+        if (next != rate) {
+            // Scroll on from where the tapes stopped rather than catching up
+            if (next == RenderRate::Full) lastTick = now;
+            ArmTimer(hTimer, next);
+            rate = next;
+        }
+    }
+
+    for (auto& target : targets) {
+        ReleaseTarget(target);
+    }
+    Renderer::Cleanup();
+    ReleaseDC(nullptr, hdcScreen);
+    CancelWaitableTimer(hTimer);
+    CloseHandle(hTimer);
+}
+
+// Wait for a render thread handle while still dispatching messages sent to
+// our windows: UpdateLayeredWindow may SendMessage to the window's thread
+static void WaitDispatchingSentMessages(HANDLE handle) {
+    while (MsgWaitForMultipleObjects(1, &handle, FALSE, INFINITE, QS_SENDMESSAGE) == WAIT_OBJECT_0 + 1) {
+        MSG msg;
+        PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE | PM_QS_SENDMESSAGE);
+    }
+}
+
+bool RenderThread::Start() {
+    if (g_running.load()) return true;
+
+    FetchMetrics::AddSeries("render_frames_total", "Frames presented while a tape scrolled", "counter",
+        GetFramesRendered);
+    FetchMetrics::AddSeries("render_frames_dropped_total", "Frame intervals a late wake-up skipped", "counter",
+        GetFramesDropped);
+    FetchMetrics::AddSeries("render_last_frame_draw_calls", "Colored blends issued for the last frame", "gauge",
+        [] { return static_cast<unsigned long long>(GetLastFrameDrawCalls()); });
+
+    g_wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    g_removedEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!g_wakeEvent || !g_removedEvent) return false;
+
+    g_running = true;
+    g_renderThread = std::thread(RenderLoop);
+    return true;
+}
+
+void RenderThread::Stop() {
+    if (!g_renderThread.joinable()) return;
+
+    Post(RenderCommandType::Stop);
+    WaitDispatchingSentMessages(g_renderThread.native_handle());
+    g_renderThread.join();
+
+    CloseHandle(g_wakeEvent);
+    CloseHandle(g_removedEvent);
+    g_wakeEvent = nullptr;
+    g_removedEvent = nullptr;
+
+    LOG_INFO("Render: {} frames presented, {} dropped ({} compositor), {} skipped while idle (~{} ms CPU saved)",
+        g_framesRendered.load(), g_framesDropped.load(), Compositor::GetKernelName(),
+        RenderPolicy::GetFramesSkipped(), RenderPolicy::GetCpuSavedMs());
+}
+
+bool RenderThread::AddTape(int tape, HWND hWnd, double scrollSpeed) {
+    if (tape < 0 || tape >= MAX_TAPES || !g_wakeEvent) return false;
+
+    RenderCommand cmd = { RenderCommandType::AddTape, tape, hWnd, 0, 0, scrollSpeed };
+    if (!g_commands.TryPush(cmd)) return false;
+    SetEvent(g_wakeEvent);
+    return true;
+}
+
+void RenderThread::RemoveTape(int tape) {
+    if (tape < 0 || tape >= MAX_TAPES || !g_renderThread.joinable()) return;
+
+    ResetEvent(g_removedEvent);
+    if (Post(RenderCommandType::RemoveTape, tape)) {
+        WaitDispatchingSentMessages(g_removedEvent);
+    }
+    g_snapshots[tape].store(nullptr);
+}
+
+bool RenderThread::Post(RenderCommandType type, int tape, int width, int height, double value) {
+    if (!g_wakeEvent) return false;
+
+    RenderCommand cmd = { type, tape, nullptr, width, height, value };
+    if (!g_commands.TryPush(cmd)) {
+        if (type != RenderCommandType::Stop) return false;
+        // Never lose a stop request
+        g_running = false;
+    }
+    SetEvent(g_wakeEvent);
+    return true;
+}
+
+void RenderThread::PublishText(const std::wstring& text) {
+    // One shared snapshot serves every tape
+    auto snapshot = std::make_shared<const TapeSnapshot>(TapeModel::FromText(text));
+    for (auto& slot : g_snapshots) {
+        slot.store(snapshot);
+    }
+}
+
+unsigned long long RenderThread::GetFramesRendered() {
+    return g_framesRendered.load();
+}
+
+unsigned long long RenderThread::GetFramesDropped() {
+    return g_framesDropped.load();
+}
+
+int RenderThread::GetLastFrameDrawCalls() {
+    return g_lastFrameDrawCalls.load();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <windows.h>
+#include <string>
+#include "TapeModel.h"
+
+// Addresses every tape in RenderThread::Post
+#define ALL_TAPES (-1)
+
+// Control messages posted from the UI thread to the render thread
+enum class RenderCommandType {
+    AddTape,      // hWnd is the tape window, value its scroll speed
+    RemoveTape,
+    Pause,
+    Resume,
+    Show,
+    Hide,
+    Resize,       // width/height carry the new client size
+    SetSpeed,     // value carries pixels per frame
+    FontChanged,  // Recreate the font and re-measure glyphs (all tapes)
+    Redraw,       // Present a frame even if nothing is scrolling
+    Stop
+};
+
+struct RenderCommand {
+    RenderCommandType type;
+    int tape;     // Tape index or ALL_TAPES
+    HWND hWnd;
+    int width;
+    int height;
+    double value;
+};
+
+class RenderThread {
+public:
+    // Start the render thread. It owns the font, every tape's back buffer and
+    // all UpdateLayeredWindow calls from here on; one thread serves all tapes.
+    // Once per frame it drains the QuoteConflator and re-lays out only the
+    // tapes whose symbols changed. Frames run at the rate RenderPolicy
+    // picks: none while no tape can be seen, few while none scrolls.
+    static bool Start();
+
+    // Stop and join the render thread (safe to call more than once)
+    static void Stop();
+
+    // Attach a tape window. Must be called from the thread that owns hWnd.
+    static bool AddTape(int tape, HWND hWnd, double scrollSpeed);
+
+    // Detach a tape and wait until the render thread no longer uses its
+    // window, so the caller can destroy it safely
+    static void RemoveTape(int tape);
+
+    // Post a control message (lock-free, never blocks the caller). Only the
+    // UI thread may post.
+    static bool Post(RenderCommandType type, int tape = ALL_TAPES,
+        int width = 0, int height = 0, double value = 0.0);
+
+    // Publish plain neutral text (status messages such as "Loading...") to
+    // every tape, until quotes for it arrive
+    static void PublishText(const std::wstring& text);
+
+    // Frame statistics
+    static unsigned long long GetFramesRendered();
+    static unsigned long long GetFramesDropped();
+
+    // Colored blends issued for the last frame across all tapes
+    static int GetLastFrameDrawCalls();
+};
+
+#endif
@@ -1,5 +1,13 @@
-﻿#include "Renderer.h"
+﻿#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "Renderer.h"
 #include "ConfigManager.h"
+#include "Log.h"
+#include <algorithm>
+
+// Face used when the configured one is not fixed-pitch
+#define FALLBACK_FONT_NAME L"Consolas"
 
 static HFONT g_font = nullptr;
 
@@ -7,24 +15,25 @@ HFONT Renderer::GetFont() {
     return g_font;
 }
 
-COLORREF Renderer::GetTextColor() {
-    // Use the textColor from ConfigManager directly
-    DWORD color = ConfigManager::textColor;
-    return RGB(
-        (color >> 16) & 0xFF,  // Red
-        (color >> 8) & 0xFF,   // Green
-        color & 0xFF           // Blue
+// Create the tape font at a size; a null face lets GDI pick any fixed-pitch one
+static HFONT CreateTapeFont(int height, const wchar_t* face) {
+    return CreateFontW(
+        height, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+        DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+        ANTIALIASED_QUALITY, FIXED_PITCH | FF_MODERN, // Grayscale AA: used as coverage
+        face
     );
 }
 
-COLORREF Renderer::GetBackgroundColor() {
-    // Use the bgColor from ConfigManager directly
-    DWORD color = ConfigManager::bgColor;
-    return RGB(
-        (color >> 16) & 0xFF,  // Red
-        (color >> 8) & 0xFF,   // Green
-        color & 0xFF           // Blue
-    );
+// Whether a font's glyphs all advance by the same width. GDI asks for
+// FIXED_PITCH only as a hint and honors a named proportional face anyway.
+static bool IsFixedPitch(HDC hdc, HFONT font) {
+    HGDIOBJ hOldFont = SelectObject(hdc, font);
+    TEXTMETRIC tm = {};
+    GetTextMetrics(hdc, &tm);
+    SelectObject(hdc, hOldFont);
+    // Despite its name, a set TMPF_FIXED_PITCH bit means variable pitch
+    return (tm.tmPitchAndFamily & TMPF_FIXED_PITCH) == 0;
 }
 
 void Renderer::Init(HWND hWnd) {
@@ -35,15 +44,25 @@ void Renderer::Init(HWND hWnd) {
 
     HDC hdc = GetDC(hWnd);
     int dpiY = GetDeviceCaps(hdc, LOGPIXELSY);
-    ReleaseDC(hWnd, hdc);
 
-    int scaledSize = -MulDiv(ConfigManager::fontSize, dpiY, 72);
-    g_font = CreateFontW(
-        scaledSize, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-        DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-        CLEARTYPE_QUALITY, FIXED_PITCH | FF_MODERN,
-        ConfigManager::fontName.c_str()
-    );
+    // Runs on the render thread, so read the published snapshot
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::Current();
+    int scaledSize = -MulDiv(config->fontSize, dpiY, 72);
+    g_font = CreateTapeFont(scaledSize, config->fontName.c_str());
+
+    // Runs and clipping are in whole character cells, which a proportional
+    // face would drift out of
+    if (g_font && !IsFixedPitch(hdc, g_font)) {
+        LOG_WARN("Renderer: font \"{}\" is not fixed-pitch, using {} instead", config->fontName,
+            FALLBACK_FONT_NAME);
+        DeleteObject(g_font);
+        g_font = CreateTapeFont(scaledSize, FALLBACK_FONT_NAME);
+        if (g_font && !IsFixedPitch(hdc, g_font)) {
+            DeleteObject(g_font);
+            g_font = CreateTapeFont(scaledSize, nullptr);
+        }
+    }
+    ReleaseDC(hWnd, hdc);
 
     if (!g_font) {
         g_font = (HFONT)GetStockObject(ANSI_FIXED_FONT);
@@ -57,45 +76,99 @@ void Renderer::Cleanup() {
     }
 }
 
-void Renderer::Render(HDC hdcWindow, const std::wstring& text, double offset, int width, int height, int charWidth) {
-    if (!hdcWindow || width <= 0 || height <= 0 || text.empty()) return;
-
-    HDC hdcMem = CreateCompatibleDC(hdcWindow);
-    if (!hdcMem) return;
+void Renderer::RenderMask(HDC hdc, const std::wstring& text, double offset, int width, int height, int charWidth) {
+    if (!hdc || width <= 0 || height <= 0 || charWidth <= 0) return;
 
-    HBITMAP hbmMem = CreateCompatibleBitmap(hdcWindow, width, height);
-    if (!hbmMem) {
-        DeleteDC(hdcMem);
-        return;
-    }
-
-    HGDIOBJ hOldBmp = SelectObject(hdcMem, hbmMem);
-    HGDIOBJ hOldFont = SelectObject(hdcMem, g_font);
-
-    // Clear background
     RECT rect = { 0, 0, width, height };
-    HBRUSH hBrush = CreateSolidBrush(GetBackgroundColor());
-    FillRect(hdcMem, &rect, hBrush);
-    DeleteObject(hBrush);
+    FillRect(hdc, &rect, (HBRUSH)GetStockObject(BLACK_BRUSH));
+    if (text.empty()) return;
 
-    // Set text properties
-    SetTextColor(hdcMem, GetTextColor());
-    SetBkMode(hdcMem, TRANSPARENT);
+    HGDIOBJ hOldFont = SelectObject(hdc, g_font);
+    SetTextColor(hdc, RGB(255, 255, 255));
+    SetBkMode(hdc, TRANSPARENT);
 
     // Calculate vertical centering
     TEXTMETRIC tm = {};
-    GetTextMetrics(hdcMem, &tm);
+    GetTextMetrics(hdc, &tm);
     int yPos = (height - tm.tmHeight) / 2;
 
-    // Draw the text with scrolling offset
-    TextOutW(hdcMem, -static_cast<int>(offset), yPos, text.c_str(), static_cast<int>(text.length()));
+    // Fixed pitch font: the visible slice is a simple character range
+    int scroll = static_cast<int>(offset);
+    size_t first = static_cast<size_t>(scroll / charWidth);
+    if (first < text.length()) {
+        size_t count = std::min(text.length() - first, static_cast<size_t>(width / charWidth + 2));
+        TextOutW(hdc, static_cast<int>(first) * charWidth - scroll, yPos,
+            text.c_str() + first, static_cast<int>(count));
+    }
+
+    SelectObject(hdc, hOldFont);
+}
+
+GdiRasterizer::GdiRasterizer()
+    : m_hdc(CreateCompatibleDC(nullptr)),
+    m_hbm(nullptr),
+    m_hOldBmp(nullptr),
+    m_bits(nullptr),
+    m_width(0),
+    m_height(0) {
+}
+
+GdiRasterizer::~GdiRasterizer() {
+    ReleaseBitmap();
+    if (m_hdc) DeleteDC(m_hdc);
+}
+
+void GdiRasterizer::ReleaseBitmap() {
+    if (m_hbm) {
+        SelectObject(m_hdc, m_hOldBmp);
+        DeleteObject(m_hbm);
+    }
+    m_hbm = nullptr;
+    m_hOldBmp = nullptr;
+    m_bits = nullptr;
+    m_width = 0;
+    m_height = 0;
+}
+
+bool GdiRasterizer::Resize(int width, int height) {
+    if (m_hbm && width == m_width && height == m_height) return true;
+    ReleaseBitmap();
+    if (!m_hdc || width <= 0 || height <= 0) return false;
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height; // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    m_hbm = CreateDIBSection(m_hdc, &bmi, DIB_RGB_COLORS, &m_bits, nullptr, 0);
+    if (!m_hbm) return false;
+
+    m_hOldBmp = SelectObject(m_hdc, m_hbm);
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+int GdiRasterizer::GetCellWidth() {
+    if (!m_hdc) return 10;
+
+    HGDIOBJ hOldFont = SelectObject(m_hdc, g_font);
+    SIZE size = {};
+    GetTextExtentPoint32W(m_hdc, L"A", 1, &size);
+    SelectObject(m_hdc, hOldFont);
+    return size.cx > 0 ? size.cx : 10;
+}
+
+const uint32_t* GdiRasterizer::RenderMask(const std::wstring& text, double offset,
+    int width, int height, int charWidth) {
+    if (!Resize(width, height)) return nullptr;
 
-    // Copy to the target DC
-    BitBlt(hdcWindow, 0, 0, width, height, hdcMem, 0, 0, SRCCOPY);
+    Renderer::RenderMask(m_hdc, text, offset, width, height, charWidth);
 
-    // Cleanup
-    SelectObject(hdcMem, hOldFont);
-    SelectObject(hdcMem, hOldBmp);
-    DeleteObject(hbmMem);
-    DeleteDC(hdcMem);
+    // Make sure GDI has finished writing the bits before they are read
+    GdiFlush();
+    return static_cast<const uint32_t*>(m_bits);
 }
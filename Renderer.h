@@ -4,27 +4,53 @@
 
 #include <windows.h>
 #include <string>
+#include "TapeRasterizer.h"
 
 class Renderer {
 public:
-    // Initialize resources (font)
+    // Initialize resources (font). hWnd may be null to use the screen DPI.
+    // The tape lays text out in fixed character cells, so a proportional
+    // fontName is replaced by a fixed-pitch face.
     static void Init(HWND hWnd);
 
     // Clean up GDI resources
     static void Cleanup();
 
-    // Render the ticker text
-    // Note: scrollOffset is now double for sub-pixel scrolling support
-    static void Render(HDC hdcWindow, const std::wstring& text, double offset,
+    // Render the ticker text white-on-black as a glyph coverage mask for
+    // the compositor (see Compositor::BlendCoverage). Only the characters
+    // that intersect the window are drawn, so the cost follows the window
+    // width rather than the length of the tape.
+    static void RenderMask(HDC hdc, const std::wstring& text, double offset,
         int width, int height, int charWidth);
 
     // Accessor for font (used in text measurement)
     static HFONT GetFont();
+};
+
+// GDI backend of TapeRasterizer. Draws Renderer's font into a private DIB
+// section; create and use it on a single thread after Renderer::Init.
+class GdiRasterizer : public TapeRasterizer {
+public:
+    GdiRasterizer();
+    ~GdiRasterizer() override;
+
+    GdiRasterizer(const GdiRasterizer&) = delete;
+    GdiRasterizer& operator=(const GdiRasterizer&) = delete;
+
+    int GetCellWidth() override;
+    const uint32_t* RenderMask(const std::wstring& text, double offset,
+        int width, int height, int charWidth) override;
 
 private:
-    // Color helpers (based on ConfigManager)
-    static COLORREF GetTextColor();
-    static COLORREF GetBackgroundColor();
+    bool Resize(int width, int height);
+    void ReleaseBitmap();
+
+    HDC m_hdc;
+    HBITMAP m_hbm;
+    HGDIOBJ m_hOldBmp;
+    void* m_bits;
+    int m_width;
+    int m_height;
 };
 
 #endif
@@ -0,0 +1,199 @@
+#include "Sparkline.h"
+#include "QuoteConflator.h"
+#include "Trace.h"
+
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+
+#define DIRTY_WORDS (MAX_SYMBOLS / 64)
+
+// One symbol's latest series. Series change once per fetch at most, so a
+// plain lock per slot is enough; the worker and the render thread only
+// meet on the same symbol.
+struct SeriesSlot {
+    std::mutex mutex;
+    std::vector<float> values;
+};
+
+static SeriesSlot g_series[MAX_SYMBOLS];
+static std::atomic<uint64_t> g_dirty[DIRTY_WORDS];
+
+void Sparkline::Publish(int id, const std::vector<float>& series) {
+    if (id < 0 || id >= MAX_SYMBOLS) return;
+    SeriesSlot& slot = g_series[id];
+    {
+        auto lock = TracedLock(slot.mutex, "Sparkline series");
+        if (slot.values == series) return;   // No new points
+        slot.values.assign(series.begin(), series.end());
+    }
+    g_dirty[id / 64].fetch_or(1ULL << (id % 64), std::memory_order_release);
+}
+
+size_t Sparkline::Drain(std::vector<int>& out) {
+    size_t count = 0;
+    for (int word = 0; word < DIRTY_WORDS; ++word) {
+        if (g_dirty[word].load(std::memory_order_relaxed) == 0) continue;
+        uint64_t bits = g_dirty[word].exchange(0, std::memory_order_acquire);
+
+        while (bits) {
+            int bit = std::countr_zero(bits);
+            bits &= bits - 1;
+            out.push_back(word * 64 + bit);
+            ++count;
+        }
+    }
+    return count;
+}
+
+void Sparkline::Read(int id, std::vector<float>& out) {
+    out.clear();
+    if (id < 0 || id >= MAX_SYMBOLS) return;
+    SeriesSlot& slot = g_series[id];
+    auto lock = TracedLock(slot.mutex, "Sparkline series");
+    out.assign(slot.values.begin(), slot.values.end());
+}
+
+void Sparkline::Downsample(const float* values, size_t count, size_t threshold,
+    std::vector<SparkPoint>& out) {
+    out.clear();
+    if (count == 0 || threshold == 0) return;
+
+    if (threshold >= count) {
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back({ static_cast<float>(i), values[i] });
+        }
+        return;
+    }
+    out.push_back({ 0.0f, values[0] });
+    if (threshold < 3) {
+        if (threshold == 2) out.push_back({ static_cast<float>(count - 1), values[count - 1] });
+        return;
+    }
+
+    // The first and last point stay; the rest is split into threshold - 2
+    // buckets, and each bucket keeps the point forming the largest triangle
+    // with the point kept before it and the average of the next bucket
+    const double every = static_cast<double>(count - 2) / (threshold - 2);
+    size_t kept = 0;
+    for (size_t i = 0; i < threshold - 2; ++i) {
+        size_t nextStart = static_cast<size_t>((i + 1) * every) + 1;
+        size_t nextEnd = std::min(static_cast<size_t>((i + 2) * every) + 1, count);
+        double averageX = 0.0;
+        double averageY = 0.0;
+        for (size_t j = nextStart; j < nextEnd; ++j) {
+            averageX += static_cast<double>(j);
+            averageY += values[j];
+        }
+        averageX /= static_cast<double>(nextEnd - nextStart);
+        averageY /= static_cast<double>(nextEnd - nextStart);
+
+        size_t start = static_cast<size_t>(i * every) + 1;
+        size_t end = nextStart;
+        const double keptX = static_cast<double>(kept);
+        const double keptY = values[kept];
+        double largest = -1.0;
+        size_t chosen = start;
+        for (size_t j = start; j < end; ++j) {
+            // Twice the triangle's area; the factor does not change the pick
+            double area = std::fabs((keptX - averageX) * (values[j] - keptY) -
+                (keptX - static_cast<double>(j)) * (averageY - keptY));
+            if (area > largest) {
+                largest = area;
+                chosen = j;
+            }
+        }
+
+        out.push_back({ static_cast<float>(chosen), values[chosen] });
+        kept = chosen;
+    }
+    out.push_back({ static_cast<float>(count - 1), values[count - 1] });
+}
+
+int Sparkline::PlotWidth(int charWidth) {
+    // Half a cell of margin on either side keeps the line off the text
+    return std::max(1, (SPARKLINE_CELLS - 1) * charWidth);
+}
+
+// Raise a pixel's coverage to at least coverage (0..1)
+static void Plot(SparklineBitmap& bitmap, int x, int y, float coverage) {
+    if (x < 0 || x >= bitmap.width || y < 0 || y >= bitmap.height || coverage <= 0.0f) return;
+    uint32_t value = static_cast<uint32_t>(std::min(coverage, 1.0f) * 255.0f + 0.5f);
+    uint32_t& pixel = bitmap.mask[static_cast<size_t>(y) * bitmap.width + x];
+    if (value > ((pixel >> 8) & 0xFF)) pixel = 0xFF000000 | value * 0x010101;
+}
+
+// Antialiased one pixel line (Xiaolin Wu): step along the major axis and
+// split each step's coverage between the two pixels it straddles
+static void DrawLine(SparklineBitmap& bitmap, float x0, float y0, float x1, float y1) {
+    const bool steep = std::fabs(y1 - y0) > std::fabs(x1 - x0);
+    if (steep) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    const float gradient = x1 > x0 ? (y1 - y0) / (x1 - x0) : 0.0f;
+    const int first = static_cast<int>(std::lround(x0));
+    const int last = static_cast<int>(std::lround(x1));
+    for (int major = first; major <= last; ++major) {
+        float minor = y0 + gradient * (static_cast<float>(major) - x0);
+        int low = static_cast<int>(std::floor(minor));
+        float fraction = minor - static_cast<float>(low);
+        if (steep) {
+            Plot(bitmap, low, major, 1.0f - fraction);
+            Plot(bitmap, low + 1, major, fraction);
+        }
+        else {
+            Plot(bitmap, major, low, 1.0f - fraction);
+            Plot(bitmap, major, low + 1, fraction);
+        }
+    }
+}
+
+void Sparkline::Rasterize(const std::vector<SparkPoint>& points, int charWidth,
+    SparklineBitmap& bitmap) {
+    // About the height of a capital in a monospaced font
+    int width = SPARKLINE_CELLS * std::max(charWidth, 1);
+    int height = std::max(charWidth * 7 / 6, 3);
+    if (bitmap.width != width || bitmap.height != height) {
+        bitmap.width = width;
+        bitmap.height = height;
+        bitmap.mask.resize(static_cast<size_t>(width) * height);
+    }
+    std::fill(bitmap.mask.begin(), bitmap.mask.end(), 0xFF000000);
+    if (points.empty()) return;
+
+    float low = points.front().y;
+    float high = points.front().y;
+    for (const SparkPoint& point : points) {
+        low = std::min(low, point.y);
+        high = std::max(high, point.y);
+    }
+    const float firstX = points.front().x;
+    const float spanX = points.back().x - firstX;
+    const float margin = static_cast<float>(charWidth / 2);
+    const float plotWidth = static_cast<float>(PlotWidth(charWidth) - 1);
+    const float plotHeight = static_cast<float>(height - 2);
+
+    // Prices rise upwards; a flat series is a line through the middle
+    auto toX = [&](float x) {
+        return margin + (spanX > 0.0f ? (x - firstX) / spanX * plotWidth : plotWidth * 0.5f);
+    };
+    auto toY = [&](float y) {
+        return high > low ? 0.5f + (high - y) / (high - low) * plotHeight : (height - 1) * 0.5f;
+    };
+
+    if (points.size() == 1) {
+        DrawLine(bitmap, toX(points[0].x), toY(points[0].y), toX(points[0].x), toY(points[0].y));
+        return;
+    }
+    for (size_t i = 1; i < points.size(); ++i) {
+        DrawLine(bitmap, toX(points[i - 1].x), toY(points[i - 1].y), toX(points[i].x), toY(points[i].y));
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef SPARKLINE_H
+#define SPARKLINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Character cells a sparkline takes on the tape ({spark} in tapeFormat)
+#define SPARKLINE_CELLS 8
+
+// A point of a downsampled series: x is the index into the full series
+struct SparkPoint {
+    float x;
+    float y;
+};
+
+// A rasterized sparkline in the glyph mask format (BGRA, white-on-black,
+// green channel is coverage), drawn in the color of its symbol's run
+struct SparklineBitmap {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> mask;
+};
+
+// Intraday series behind the sparklines. The fetch workers publish each
+// symbol's series under its conflator id; the render thread drains the ids
+// whose series changed, downsamples each once with Largest-Triangle-Three-
+// Buckets to the sparkline's pixel width and rasterizes it once into a
+// cached bitmap. Frames only blend the cached bitmaps.
+class Sparkline {
+public:
+    // Store a symbol's series and mark it changed, unless it equals the
+    // stored one. The slot keeps its capacity between fetches.
+    static void Publish(int id, const std::vector<float>& series);
+
+    // Append the ids whose series changed since the previous drain to out.
+    // Single consumer only. Returns the number appended.
+    static size_t Drain(std::vector<int>& out);
+
+    // Copy a symbol's latest series into out; empty if none was published
+    static void Read(int id, std::vector<float>& out);
+
+    // Downsample values to at most threshold points with LTTB, keeping the
+    // first and last point and the visually significant extremes in between
+    static void Downsample(const float* values, size_t count, size_t threshold,
+        std::vector<SparkPoint>& out);
+
+    // Size bitmap for a cell width and draw the antialiased polyline
+    // through points into it, scaled to the series' range. The mask keeps
+    // its capacity when the size is unchanged.
+    static void Rasterize(const std::vector<SparkPoint>& points, int charWidth,
+        SparklineBitmap& bitmap);
+
+    // Pixels left for the line between the bitmap's side margins
+    static int PlotWidth(int charWidth);
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "StartupTimeline.h"
+#include "Trace.h"
+#include "Log.h"
+
+#include <windows.h>
+#include <atomic>
+#include <cstdio>
+
+#define PHASE_COUNT static_cast<int>(StartupPhase::Count)
+
+static const char* const g_phaseNames[PHASE_COUNT] = {
+    "instance", "config", "window", "first_frame", "first_price", "deferred"
+};
+
+static uint64_t g_launchMicros = 0;   // Process creation -> Begin()
+static uint64_t g_beginClock = 0;     // Trace::NowMicros() at Begin()
+static std::atomic<uint64_t> g_marks[PHASE_COUNT];   // Trace::NowMicros() of each mark, 0 = not reached
+
+static uint64_t FileTimeMicros(const FILETIME& time) {
+    return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10;
+}
+
+// Startup is done: log the timeline and lay it out in the trace, one span
+// from Begin() to each milestone
+static void Report() {
+    LOG_INFO("Startup: {}", StartupTimeline::Describe());
+    if (!Trace::IsEnabled()) return;
+
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        uint64_t mark = g_marks[i].load(std::memory_order_acquire);
+        if (mark) Trace::Complete("startup", g_phaseNames[i], g_beginClock, mark - g_beginClock);
+    }
+}
+
+void StartupTimeline::Begin() {
+    g_beginClock = Trace::NowMicros();
+
+    FILETIME creation, exit, kernel, user, now;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        GetSystemTimePreciseAsFileTime(&now);
+        uint64_t created = FileTimeMicros(creation);
+        uint64_t started = FileTimeMicros(now);
+        g_launchMicros = started > created ? started - created : 0;
+    }
+}
+
+void StartupTimeline::Mark(StartupPhase phase) {
+    std::atomic<uint64_t>& mark = g_marks[static_cast<int>(phase)];
+    if (mark.load(std::memory_order_relaxed)) return;
+
+    uint64_t unset = 0;
+    if (mark.compare_exchange_strong(unset, Trace::NowMicros(), std::memory_order_acq_rel) &&
+        phase == StartupPhase::FirstPrice) {
+        Report();
+    }
+}
+
+uint64_t StartupTimeline::GetMicros(StartupPhase phase) {
+    uint64_t mark = g_marks[static_cast<int>(phase)].load(std::memory_order_acquire);
+    return mark ? g_launchMicros + (mark - g_beginClock) : 0;
+}
+
+const char* StartupTimeline::GetName(StartupPhase phase) {
+    return g_phaseNames[static_cast<int>(phase)];
+}
+
+std::string StartupTimeline::Describe() {
+    std::string text;
+    char buffer[64];
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        uint64_t micros = GetMicros(static_cast<StartupPhase>(i));
+        if (!micros) continue;
+        snprintf(buffer, sizeof(buffer), "%s%s %.1f ms", text.empty() ? "" : ", ", g_phaseNames[i], micros / 1000.0);
+        text += buffer;
+    }
+    return text;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef STARTUP_TIMELINE_H
+#define STARTUP_TIMELINE_H
+
+#include <cstdint>
+#include <string>
+
+// Startup milestones in the order they are normally reached
+enum class StartupPhase {
+    Instance,     // Single-instance check done
+    Config,       // config.ini loaded and the log started
+    Window,       // Every tape window created
+    FirstFrame,   // First frame on screen (the "Loading..." text)
+    FirstPrice,   // First frame showing a quote
+    Deferred,     // Menus, tray icon, hotkeys and config watcher set up
+    Count
+};
+
+// Time from process creation to each startup milestone, so the loader and
+// C runtime are counted too. The first price completes startup: the
+// timeline is then logged, and added to the trace when tracing is on.
+// FetchMetrics exports it with the fetch metrics.
+class StartupTimeline {
+public:
+    // First thing in wWinMain
+    static void Begin();
+
+    // Record a milestone; later marks of the same phase are ignored. Safe
+    // from any thread and cheap enough to call every frame.
+    static void Mark(StartupPhase phase);
+
+    // Microseconds from process creation to phase, or 0 if not reached
+    static uint64_t GetMicros(StartupPhase phase);
+
+    // Label of a phase in logs and metrics, e.g. "first_price"
+    static const char* GetName(StartupPhase phase);
+
+    // Phases reached so far, e.g. "instance 1.2 ms, config 3.4 ms"
+    static std::string Describe();
+};
+
+#endif
@@ -0,0 +1,13 @@
+#include "SymbolGroup.h"
+
+SymbolGroup SymbolGroups::Of(std::string_view symbol) {
+    auto endsWith = [&](std::string_view suffix) {
+        return symbol.size() >= suffix.size() && symbol.substr(symbol.size() - suffix.size()) == suffix;
+    };
+
+    if (!symbol.empty() && symbol[0] == '^') return SymbolGroup::Index;
+    if (endsWith("=X")) return SymbolGroup::Currency;
+    if (endsWith("=F")) return SymbolGroup::Future;
+    if (endsWith("-USD") || endsWith("-EUR") || endsWith("-USDT")) return SymbolGroup::Crypto;
+    return SymbolGroup::Equity;
+}
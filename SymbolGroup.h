@@ -0,0 +1,24 @@
+#pragma once
+#ifndef SYMBOL_GROUP_H
+#define SYMBOL_GROUP_H
+
+#include <string_view>
+
+// Coarse class of a ticker, told apart by Yahoo's symbol conventions. The
+// tape template picks currency signs and price precision by it, and the
+// fetch metrics tag series with it instead of keeping one per symbol.
+enum class SymbolGroup {
+    Equity,
+    Index,      // ^GSPC
+    Crypto,     // BTC-USD
+    Currency,   // EURUSD=X
+    Future,     // CL=F
+    Count
+};
+
+class SymbolGroups {
+public:
+    static SymbolGroup Of(std::string_view symbol);
+};
+
+#endif
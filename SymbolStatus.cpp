@@ -0,0 +1,127 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "SymbolStatus.h"
+#include "QuoteConflator.h"
+#include "Utf8.h"
+#include "Log.h"
+
+#include <windows.h>
+#include <atomic>
+#include <algorithm>
+#include <climits>
+
+// Written by the engine thread only; read from any thread
+struct SymbolEntry {
+    std::atomic<SymbolState> state{ SymbolState::Unchecked };
+    std::atomic<unsigned long long> retryAt{ 0 };
+    int rejections = 0;   // Engine thread only
+};
+
+static SymbolEntry g_entries[MAX_SYMBOLS];
+
+static void SetState(int id, SymbolState state, unsigned long long retryAt) {
+    SymbolEntry& entry = g_entries[id];
+    entry.retryAt.store(retryAt, std::memory_order_relaxed);
+    entry.state.store(state, std::memory_order_release);
+}
+
+// Nothing that cannot be a ticker: controls, spaces and URL syntax. Other
+// bytes, including non-ASCII UTF-8, are left for the server to judge.
+static bool IsWellFormed(std::string_view symbol) {
+    if (symbol.empty() || symbol.size() > SYMBOL_MAX_BYTES) return false;
+    for (char c : symbol) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (byte <= ' ' || byte == 0x7F) return false;
+        if (std::string_view("/?#&%\"\\").find(c) != std::string_view::npos) return false;
+    }
+    return true;
+}
+
+bool SymbolStatus::ShouldFetch(int id, unsigned long long now) {
+    if (id < 0 || id >= MAX_SYMBOLS) return false;
+    SymbolEntry& entry = g_entries[id];
+
+    switch (entry.state.load(std::memory_order_relaxed)) {
+    case SymbolState::Unchecked:
+        if (IsWellFormed(QuoteConflator::GetSymbol(id))) return true;
+        LOG_WARN("{}: not a valid symbol, not requested", QuoteConflator::GetSymbol(id));
+        SetState(id, SymbolState::Invalid, ULLONG_MAX);
+        return false;
+    case SymbolState::Valid:
+        return true;
+    default:
+        return now >= entry.retryAt.load(std::memory_order_relaxed);
+    }
+}
+
+void SymbolStatus::RecordFound(int id) {
+    if (id < 0 || id >= MAX_SYMBOLS) return;
+    SymbolEntry& entry = g_entries[id];
+    if (entry.rejections) {
+        LOG_INFO("{}: found again after {} rejections", QuoteConflator::GetSymbol(id), entry.rejections);
+    }
+    entry.rejections = 0;
+    SetState(id, SymbolState::Valid, 0);
+}
+
+void SymbolStatus::RecordRejected(int id, SymbolState state, unsigned long long now) {
+    if (id < 0 || id >= MAX_SYMBOLS) return;
+    SymbolEntry& entry = g_entries[id];
+    int doublings = std::min(entry.rejections++, 20);
+    unsigned long long delay = std::min(SYMBOL_RETRY_MIN_MS << doublings, SYMBOL_RETRY_MAX_MS);
+
+    LOG_WARN("{}: {} by the quote server, next try in {} s", QuoteConflator::GetSymbol(id),
+        state == SymbolState::NotFound ? "not found" : "refused", delay / 1000);
+    SetState(id, state, now + delay);
+}
+
+void SymbolStatus::Forget(int id) {
+    if (id < 0 || id >= MAX_SYMBOLS) return;
+    SymbolEntry& entry = g_entries[id];
+    if (entry.state.load(std::memory_order_relaxed) == SymbolState::Unchecked) return;
+    entry.rejections = 0;
+    SetState(id, SymbolState::Unchecked, 0);
+}
+
+SymbolState SymbolStatus::Get(std::string_view symbol, unsigned long long* retryAt) {
+    int id = QuoteConflator::Find(symbol);
+    if (id < 0) return SymbolState::Unchecked;
+
+    SymbolState state = g_entries[id].state.load(std::memory_order_acquire);
+    if (retryAt) *retryAt = g_entries[id].retryAt.load(std::memory_order_relaxed);
+    return state;
+}
+
+std::wstring SymbolStatus::Describe(const std::vector<std::string>& symbols) {
+    std::wstring notFound;
+    std::wstring invalid;
+    unsigned long long nextTry = ULLONG_MAX;
+
+    for (const auto& symbol : symbols) {
+        unsigned long long retryAt = 0;
+        SymbolState state = Get(symbol, &retryAt);
+        if (state == SymbolState::NotFound) {
+            if (!notFound.empty()) notFound += L", ";
+            notFound += Utf8::ToWide(symbol);
+            nextTry = std::min(nextTry, retryAt);
+        }
+        else if (state == SymbolState::Invalid) {
+            if (!invalid.empty()) invalid += L", ";
+            invalid += Utf8::ToWide(symbol);
+        }
+    }
+
+    std::wstring text;
+    if (!notFound.empty()) {
+        text = L"Not found: " + notFound;
+        unsigned long long now = GetTickCount64();
+        unsigned long long minutes = nextTry > now ? (nextTry - now + 59999) / 60000 : 0;
+        text += minutes ? L" (next try in " + std::to_wstring(minutes) + L" min)" : L" (retrying)";
+    }
+    if (!invalid.empty()) {
+        if (!text.empty()) text += L"   ";
+        text += L"Invalid: " + invalid;
+    }
+    return text;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#ifndef SYMBOL_STATUS_H
+#define SYMBOL_STATUS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Longest symbol sent to the quote server, in UTF-8 bytes
+#define SYMBOL_MAX_BYTES 32
+
+// Retry interval after the quote server first rejects a symbol; it doubles
+// with every further rejection up to SYMBOL_RETRY_MAX_MS
+#define SYMBOL_RETRY_MIN_MS 60000ULL
+#define SYMBOL_RETRY_MAX_MS (6 * 3600 * 1000ULL)
+
+enum class SymbolState {
+    Unchecked,   // Not answered for yet
+    Valid,       // The server returned a quote
+    NotFound,    // The server does not know it (HTTP 404): mistyped or delisted
+    Invalid      // Malformed, or refused by the server as a request (HTTP 400)
+};
+
+// Negative cache of the quote engine, by conflator id. A symbol the server
+// rejected is not requested again until its retry time, which backs off
+// exponentially, so a mistyped or delisted symbol stops costing a round
+// trip every pass. A malformed symbol is never requested. The engine
+// thread records results; the settings dialog reads them to flag symbols.
+class SymbolStatus {
+public:
+    // Engine thread: whether id is due for a request at now (GetTickCount64).
+    // Checks a symbol's form the first time it is asked about.
+    static bool ShouldFetch(int id, unsigned long long now);
+
+    // Engine thread: record a server's answer for id
+    static void RecordFound(int id);
+    static void RecordRejected(int id, SymbolState state, unsigned long long now);
+
+    // Engine thread: id left every tape; adding it back checks it afresh
+    static void Forget(int id);
+
+    // Any thread: the state of a (UTF-8) symbol, and for a rejected one the
+    // GetTickCount64() of its next request
+    static SymbolState Get(std::string_view symbol, unsigned long long* retryAt = nullptr);
+
+    // Flag line for the settings dialog listing the rejected symbols among
+    // symbols, e.g. "Not found: AAPLL (next try in 4 min)"; empty if none
+    static std::wstring Describe(const std::vector<std::string>& symbols);
+};
+
+#endif
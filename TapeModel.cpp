@@ -0,0 +1,72 @@
+#include "TapeModel.h"
+#include "Utf8.h"
+
+void TapeModel::Begin(TapeSnapshot& snapshot) {
+    snapshot.text.clear();
+    snapshot.runs.clear();
+    snapshot.sparklines.clear();
+    snapshot.cycleLength = 0;
+    snapshot.flashUntil = 0;
+}
+
+void TapeModel::Append(TapeSnapshot& snapshot, std::string_view text, SegmentTone tone, bool flash,
+    int sparklineAt, const std::shared_ptr<const SparklineBitmap>& sparkline) {
+    if (text.empty()) return;
+
+    // Until Finish() the text holds exactly one cycle
+    int start = static_cast<int>(snapshot.text.length());
+    Utf8::AppendWide(text, snapshot.text);
+    int length = static_cast<int>(snapshot.text.length()) - start;
+
+    if (sparkline && sparklineAt >= 0 && sparklineAt < length) {
+        snapshot.sparklines.push_back({ start + sparklineAt, tone, flash, sparkline });
+    }
+
+    if (!snapshot.runs.empty()) {
+        StyledRun& last = snapshot.runs.back();
+        if (last.tone == tone && last.flash == flash) {
+            last.length += length;
+            return;
+        }
+    }
+    snapshot.runs.push_back({ start, length, tone, flash });
+}
+
+void TapeModel::Finish(TapeSnapshot& snapshot, unsigned long long flashUntil) {
+    snapshot.flashUntil = flashUntil;
+    snapshot.cycleLength = static_cast<int>(snapshot.text.length());
+
+    // Reserving first keeps data() valid while the cycle is appended to itself
+    size_t cycle = snapshot.text.length();
+    snapshot.text.reserve(cycle * 3);
+    for (int i = 1; i < 3; ++i) {
+        snapshot.text.append(snapshot.text.data(), cycle);
+    }
+}
+
+void TapeModel::FormatQuote(const TapeTemplate& format, std::string_view symbol, Price price,
+    Price previousClose, bool sparkline, TapeSegment& segment) {
+    segment.text.clear();
+    size_t sparklineAt = format.Format(symbol, price, previousClose, sparkline, segment.text);
+    segment.sparkline = sparklineAt == std::string::npos ? -1 :
+        static_cast<int>(Utf8::Utf16Length(std::string_view(segment.text).substr(0, sparklineAt)));
+    segment.text += TAPE_SEPARATOR;
+
+    segment.tone = SegmentTone::Neutral;
+    segment.flash = false;
+    if (previousClose.IsPositive()) {
+        int move = price.Compare(previousClose);
+        if (move > 0) segment.tone = SegmentTone::Up;
+        else if (move < 0) segment.tone = SegmentTone::Down;
+    }
+}
+
+TapeSnapshot TapeModel::FromText(const std::wstring& text) {
+    TapeSnapshot snapshot;
+    snapshot.text = text;
+    if (!text.empty()) {
+        snapshot.runs.push_back({ 0, static_cast<int>(text.length()), SegmentTone::Neutral, false });
+    }
+    Finish(snapshot, 0);
+    return snapshot;
+}
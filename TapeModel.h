@@ -0,0 +1,82 @@
+#pragma once
+#ifndef TAPE_MODEL_H
+#define TAPE_MODEL_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TapeTemplate.h"
+#include "Sparkline.h"
+
+// Gap after each symbol on the tape
+#define TAPE_SEPARATOR "   "
+
+// Direction of a symbol's move since the previous close
+enum class SegmentTone : uint8_t {
+    Neutral,
+    Up,
+    Down
+};
+
+// One symbol's entry on the tape as produced by the worker
+struct TapeSegment {
+    std::string text;   // UTF-8
+    SegmentTone tone;
+    bool flash;   // Price ticked since the last fetch pass
+    int sparkline = -1;   // Character (UTF-16) offset of the sparkline cells in text, -1 if none
+};
+
+// A span of characters drawn in a single style
+struct StyledRun {
+    int start;    // First character (within one cycle)
+    int length;
+    SegmentTone tone;
+    bool flash;
+};
+
+// A cached sparkline placed over its blank cells
+struct SparklineStamp {
+    int start;    // First character (within one cycle)
+    SegmentTone tone;
+    bool flash;
+    std::shared_ptr<const SparklineBitmap> bitmap;
+};
+
+// Immutable tape contents handed to the render thread. The text is UTF-16
+// because GDI draws it and runs index its characters; segments are
+// converted when they are appended.
+struct TapeSnapshot {
+    std::wstring text;              // One cycle repeated three times for seamless wrap
+    int cycleLength = 0;            // Characters in one cycle
+    std::vector<StyledRun> runs;    // Cover [0, cycleLength), sorted, adjacent styles differ
+    std::vector<SparklineStamp> sparklines;   // Sorted by start, within one cycle
+    unsigned long long flashUntil = 0; // GetTickCount64() at which flash highlights end
+};
+
+class TapeModel {
+public:
+    // Lay a snapshot out in place: Begin, Append each segment, then Finish.
+    // Adjacent segments with the same style are merged into one run so draw
+    // calls track style changes, not the number of symbols. The text, runs
+    // and sparklines keep their capacity, so a rebuild no larger than the
+    // last one allocates nothing. A segment's sparkline bitmap, if given, is
+    // drawn over the cells starting at character sparklineAt of its text.
+    static void Begin(TapeSnapshot& snapshot);
+    static void Append(TapeSnapshot& snapshot, std::string_view text, SegmentTone tone, bool flash,
+        int sparklineAt = -1, const std::shared_ptr<const SparklineBitmap>& sparkline = nullptr);
+    static void Finish(TapeSnapshot& snapshot, unsigned long long flashUntil);
+
+    // Format a symbol's price and change since the previous close (zero
+    // when not reported) into its tape segment with the configured template,
+    // reusing the segment's text buffer. sparkline says whether the symbol
+    // has a sparkline to leave cells for.
+    static void FormatQuote(const TapeTemplate& format, std::string_view symbol, Price price,
+        Price previousClose, bool sparkline, TapeSegment& segment);
+
+    // Plain neutral text such as "Loading..."
+    static TapeSnapshot FromText(const std::wstring& text);
+};
+
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+#ifndef TAPE_RASTERIZER_H
+#define TAPE_RASTERIZER_H
+
+#include <cstdint>
+#include <string>
+
+// Backend-neutral glyph rasterizer. A backend turns the visible slice of the
+// tape text into a coverage mask for FrameComposer; everything after that is
+// plain pixel work shared by all backends.
+class TapeRasterizer {
+public:
+    virtual ~TapeRasterizer() {}
+
+    // Advance of one character cell in pixels (the tape is fixed pitch)
+    virtual int GetCellWidth() = 0;
+
+    // Rasterize text scrolled by offset into a width x height mask owned by
+    // the rasterizer: BGRA, white-on-black, green channel is coverage. The
+    // mask stays valid until the next call. Returns null on failure.
+    virtual const uint32_t* RenderMask(const std::wstring& text, double offset,
+        int width, int height, int charWidth) = 0;
+};
+
+#endif
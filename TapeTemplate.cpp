@@ -0,0 +1,261 @@
+#include "TapeTemplate.h"
+#include "Sparkline.h"
+#include "SymbolGroup.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+// UTF-8 currency signs
+#define EURO_SIGN "\xE2\x82\xAC"
+#define YEN_SIGN "\xC2\xA5"
+
+// Currency of a stock exchange, by Yahoo symbol suffix
+struct ExchangeCurrency {
+    std::string_view suffix;
+    const char* currency;   // UTF-8
+};
+
+static const ExchangeCurrency g_exchanges[] = {
+    { ".L", "" },        // London quotes in pence
+    { ".DE", EURO_SIGN },
+    { ".PA", EURO_SIGN },
+    { ".AS", EURO_SIGN },
+    { ".MI", EURO_SIGN },
+    { ".MC", EURO_SIGN },
+    { ".SW", "CHF " },
+    { ".T", YEN_SIGN },
+    { ".HK", "HK$" },
+    { ".TO", "C$" },
+    { ".AX", "A$" },
+};
+
+static bool EndsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// Prefix of a symbol's price: none for indices, FX rates and futures,
+// whose prices are points or ratios
+static const char* CurrencyOf(SymbolGroup group, std::string_view symbol) {
+    switch (group) {
+    case SymbolGroup::Equity:
+        for (const ExchangeCurrency& exchange : g_exchanges) {
+            if (EndsWith(symbol, exchange.suffix)) return exchange.currency;
+        }
+        return "$";
+    case SymbolGroup::Crypto:
+        return EndsWith(symbol, "-EUR") ? EURO_SIGN : "$";
+    default:
+        return "";
+    }
+}
+
+// Decimals when the template leaves them to the symbol: FX rates to the
+// pip, everything else to the cent, and prices under 1 with three
+// significant digits
+static int AutoPrecision(SymbolGroup group, double price) {
+    double magnitude = std::fabs(price);
+    if (group == SymbolGroup::Currency) return magnitude >= 20.0 ? 3 : 4;
+    if (magnitude >= 1.0 || magnitude == 0.0 || !std::isfinite(magnitude)) return 2;
+    return std::min(static_cast<int>(std::ceil(-std::log10(magnitude))) + 2, 10);
+}
+
+static void AppendNumber(std::string& out, double value, int precision, bool sign) {
+    char buffer[64];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+        std::chars_format::fixed, precision);
+    if (result.ec != std::errc()) {
+        result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific, precision);
+        if (result.ec != std::errc()) return;
+    }
+
+    // Like Price::Format, a value that rounds to zero has no minus sign, so
+    // an unchanged quote reads +0.00 and +0.00% alike
+    char* first = buffer;
+    if (*first == '-' && std::all_of(first + 1, result.ptr, [](char c) { return c == '0' || c == '.'; })) {
+        ++first;
+    }
+
+    if (sign && *first != '-') out += '+';
+    out.append(first, result.ptr);
+}
+
+static void AppendPrice(std::string& out, Price price, int precision, bool sign) {
+    char buffer[PRICE_MAX_CHARS];
+    char* end = price.Format(buffer, precision);
+    if (sign && buffer[0] != '-') out += '+';
+    out.append(buffer, end);
+}
+
+// Parse a number field's spec: [+][.N|auto][%], sign and percent only for
+// a change
+static bool ParseSpec(std::string_view spec, TemplateOp& op, bool change) {
+    size_t pos = 0;
+    if (change && pos < spec.size() && spec[pos] == '+') {
+        op.sign = true;
+        ++pos;
+    }
+
+    if (spec.substr(pos, 4) == "auto") {
+        pos += 4;
+    }
+    else if (pos < spec.size() && spec[pos] == '.') {
+        int digits = 0;
+        int precision = 0;
+        for (++pos; pos < spec.size() && spec[pos] >= '0' && spec[pos] <= '9' && digits < 2; ++pos, ++digits) {
+            precision = precision * 10 + (spec[pos] - '0');
+        }
+        if (digits == 0 || precision > 10) return false;
+        op.precision = static_cast<int8_t>(precision);
+    }
+
+    if (change && pos < spec.size() && spec[pos] == '%') {
+        op.percent = true;
+        ++pos;
+    }
+    return pos == spec.size();
+}
+
+TapeTemplate::TapeTemplate() {
+    Compile(DEFAULT_TAPE_FORMAT);
+}
+
+bool TapeTemplate::Compile(const std::wstring& wideFormat, std::wstring* error) {
+    auto fail = [error](const std::string& message) {
+        if (error) *error = Utf8::ToWide(message);
+        return false;
+    };
+    if (wideFormat.size() > MAX_TAPE_FORMAT) {
+        return fail("longer than " + std::to_string(MAX_TAPE_FORMAT) + " characters");
+    }
+
+    // Braces are ASCII, so the UTF-8 form parses byte by byte
+    const std::string format = Utf8::FromWide(wideFormat);
+    std::vector<TemplateOp> ops;
+    std::string literals;
+    auto addLiteral = [&](char c) {
+        if (ops.empty() || ops.back().type != TemplateOpType::Literal) {
+            TemplateOp op;
+            op.type = TemplateOpType::Literal;
+            op.offset = static_cast<uint16_t>(literals.size());
+            ops.push_back(op);
+        }
+        literals += c;
+        ops.back().length++;
+    };
+
+    for (size_t i = 0; i < format.size(); ++i) {
+        char c = format[i];
+        bool doubled = i + 1 < format.size() && format[i + 1] == c;
+        if (c == '}') {
+            if (!doubled) return fail("unmatched '}'");
+            addLiteral(c);
+            ++i;
+            continue;
+        }
+        if (c != '{') {
+            addLiteral(c);
+            continue;
+        }
+        if (doubled) {
+            addLiteral(c);
+            ++i;
+            continue;
+        }
+
+        size_t close = format.find('}', i);
+        if (close == std::string::npos) return fail("unterminated '{'");
+        std::string field = format.substr(i + 1, close - i - 1);
+        i = close;
+
+        size_t colon = field.find(':');
+        std::string_view name = std::string_view(field).substr(0, colon);
+        std::string_view spec = colon == std::string::npos ? std::string_view() : std::string_view(field).substr(colon + 1);
+
+        TemplateOp op;
+        if (name == "sym" || name == "cur" || name == "spark") {
+            op.type = name == "sym" ? TemplateOpType::Symbol :
+                name == "cur" ? TemplateOpType::Currency : TemplateOpType::Sparkline;
+            if (!spec.empty()) return fail("{" + field + "} takes no format");
+            if (op.type == TemplateOpType::Sparkline &&
+                std::any_of(ops.begin(), ops.end(), [](const TemplateOp& o) { return o.type == TemplateOpType::Sparkline; })) {
+                return fail("more than one {spark}");
+            }
+        }
+        else if (name == "price" || name == "chg") {
+            op.type = name == "price" ? TemplateOpType::Price : TemplateOpType::Change;
+            if (!ParseSpec(spec, op, op.type == TemplateOpType::Change)) {
+                return fail("bad format in {" + field + "}");
+            }
+        }
+        else {
+            return fail("unknown field {" + field + "}");
+        }
+        ops.push_back(op);
+    }
+
+    m_sparkline = std::any_of(ops.begin(), ops.end(),
+        [](const TemplateOp& o) { return o.type == TemplateOpType::Sparkline; });
+    m_ops = std::move(ops);
+    m_literals = std::move(literals);
+    return true;
+}
+
+size_t TapeTemplate::Format(std::string_view symbol, Price price, Price previousClose,
+    bool sparkline, std::string& out) const {
+    const SymbolGroup group = SymbolGroups::Of(symbol);
+    const bool hasChange = previousClose.IsPositive();
+    const int autoPrecision = AutoPrecision(group, price.ToDouble());
+    size_t sparklineAt = std::string::npos;
+
+    auto prints = [&](const TemplateOp& op) {
+        if (op.type == TemplateOpType::Change) return hasChange;
+        if (op.type == TemplateOpType::Sparkline) return sparkline;
+        return true;
+    };
+
+    for (size_t i = 0; i < m_ops.size(); ++i) {
+        const TemplateOp& op = m_ops[i];
+        switch (op.type) {
+        case TemplateOpType::Literal:
+            // The text leading into a field that prints nothing goes with it
+            if (i + 1 < m_ops.size() && !prints(m_ops[i + 1])) break;
+            out.append(m_literals, op.offset, op.length);
+            break;
+        case TemplateOpType::Symbol:
+            out += symbol;
+            break;
+        case TemplateOpType::Currency:
+            out += CurrencyOf(group, symbol);
+            break;
+        case TemplateOpType::Price:
+            AppendPrice(out, price, op.precision >= 0 ? op.precision : autoPrecision, false);
+            break;
+        case TemplateOpType::Change: {
+            if (!hasChange) break;
+            Price change;
+            bool exact = Price::Subtract(price, previousClose, change);
+            if (op.percent) {
+                double ratio = (price.ToDouble() - previousClose.ToDouble()) / previousClose.ToDouble();
+                AppendNumber(out, ratio * 100.0, op.precision >= 0 ? op.precision : 2, op.sign);
+                out += '%';
+            }
+            else if (exact) {
+                AppendPrice(out, change, op.precision >= 0 ? op.precision : autoPrecision, op.sign);
+            }
+            else {
+                AppendNumber(out, price.ToDouble() - previousClose.ToDouble(),
+                    op.precision >= 0 ? op.precision : autoPrecision, op.sign);
+            }
+            break;
+        }
+        case TemplateOpType::Sparkline:
+            if (!sparkline) break;
+            sparklineAt = out.size();
+            out.append(SPARKLINE_CELLS, ' ');
+            break;
+        }
+    }
+    return sparklineAt;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef TAPE_TEMPLATE_H
+#define TAPE_TEMPLATE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Price.h"
+
+// Layout of one symbol's tape text when config.ini sets no tapeFormat
+#define DEFAULT_TAPE_FORMAT L"{sym}: {cur}{price:.2} {spark} {chg:+.2%}"
+
+// Longest tapeFormat accepted
+#define MAX_TAPE_FORMAT 256
+
+enum class TemplateOpType : uint8_t {
+    Literal,
+    Symbol,     // {sym}
+    Currency,   // {cur}: "$" for US equities and USD crypto, none for indices and FX
+    Price,      // {price}, {price:auto}, {price:.4}
+    Change,     // {chg}, {chg:+.2}, {chg:+.2%} (percent of the previous close)
+    Sparkline   // {spark}: SPARKLINE_CELLS blank cells the intraday sparkline is drawn over
+};
+
+struct TemplateOp {
+    TemplateOpType type;
+    bool sign = false;       // Change: print + for a rise
+    bool percent = false;    // Change: relative to the previous close
+    int8_t precision = -1;   // Decimals; -1 picks them per symbol from the price
+    uint16_t offset = 0;     // Literal: position and length in the literal pool (bytes)
+    uint16_t length = 0;
+};
+
+// A tapeFormat compiled into a flat list of ops, so formatting a quote runs
+// no format-string parser. Prices and changes are formatted exactly from
+// their fixed-point digits, the percent change with std::to_chars; neither
+// depends on the C locale. A change field prints nothing while the
+// previous close is unknown, a sparkline field nothing until the symbol has
+// a series, and neither does the literal text right before them. "{{" and
+// "}}" are literal braces.
+class TapeTemplate {
+public:
+    // Compiled DEFAULT_TAPE_FORMAT
+    TapeTemplate();
+
+    // Replace the template with format; on a syntax error returns false,
+    // describes it in error and keeps the current template
+    bool Compile(const std::wstring& format, std::wstring* error = nullptr);
+
+    // Append the symbol's UTF-8 text to out, which keeps its capacity
+    // between quotes. previousClose is zero when not reported. Returns the
+    // byte offset in out of the sparkline's cells, or std::string::npos if
+    // there are none (no {spark}, or sparkline is false).
+    size_t Format(std::string_view symbol, Price price, Price previousClose, bool sparkline,
+        std::string& out) const;
+
+    // Whether the template has a {spark} field, i.e. needs intraday series
+    bool HasSparkline() const { return m_sparkline; }
+
+private:
+    std::vector<TemplateOp> m_ops;
+    std::string m_literals;   // UTF-8
+    bool m_sparkline = false;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "TaskPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Index of the calling thread's queue in its pool, -1 outside any pool
+static thread_local const TaskPool* t_pool = nullptr;
+static thread_local int t_workerIndex = -1;
+
+TaskPool::TaskPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threads; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&TaskPool::WorkerLoop, this, i);
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void TaskPool::Submit(Task task) {
+    unsigned index = (t_pool == this)
+        ? static_cast<unsigned>(t_workerIndex)
+        : m_nextQueue.fetch_add(1) % static_cast<unsigned>(m_queues.size());
+
+    {
+        // Count under the queue lock so a thief can never see the task
+        // before it is counted
+        auto lock = TracedLock(m_queues[index]->mutex, "TaskPool queue");
+        m_queues[index]->tasks.push_back(std::move(task));
+        ++m_queued;
+    }
+
+    // Taking the sleep lock orders this against a worker's predicate check,
+    // so the notification cannot fall between its check and its wait
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_wake.notify_one();
+}
+
+bool TaskPool::PopOrSteal(int self, Task& task) {
+    const int count = static_cast<int>(m_queues.size());
+
+    // Own queue first, newest task
+    if (self >= 0) {
+        WorkerQueue& own = *m_queues[self];
+        auto lock = TracedLock(own.mutex, "TaskPool queue");
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --m_queued;
+            return true;
+        }
+    }
+
+    // Then steal the oldest task from the others
+    int start = self >= 0 ? self + 1 : 0;
+    for (int i = 0; i < count; ++i) {
+        WorkerQueue& victim = *m_queues[(start + i) % count];
+        auto lock = TracedLock(victim.mutex, "TaskPool steal");
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskPool::TryRunOne() {
+    Task task;
+    if (!PopOrSteal(t_pool == this ? t_workerIndex : -1, task)) return false;
+    task();
+    return true;
+}
+
+void TaskPool::WorkerLoop(unsigned index) {
+    t_pool = this;
+    t_workerIndex = static_cast<int>(index);
+
+    for (;;) {
+        Task task;
+        if (PopOrSteal(t_workerIndex, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() { return m_stopping.load() || m_queued.load() > 0; });
+
+        // Stop only once every accepted task has run
+        if (m_stopping.load() && m_queued.load() == 0) return;
+    }
+}
+
+void TaskPool::ParallelFor(size_t begin, size_t end, size_t grain,
+    const std::function<void(size_t)>& body) {
+    if (begin >= end) return;
+    grain = std::max<size_t>(1, grain);
+
+    TaskGroup group(*this);
+    for (size_t chunk = begin; chunk < end; chunk += grain) {
+        size_t chunkEnd = std::min(end, chunk + grain);
+        group.Run([&body, chunk, chunkEnd]() {
+            for (size_t i = chunk; i < chunkEnd; ++i) {
+                body(i);
+            }
+        });
+    }
+    group.Wait();
+}
+
+void TaskGroup::Run(TaskPool::Task task) {
+    ++m_pending;
+    m_pool.Submit([this, task = std::move(task)]() {
+        task();
+
+        // The last touch of the group happens under its lock; Wait() takes
+        // the lock before returning, so the group outlives this access
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0) m_done.notify_all();
+    });
+}
+
+void TaskGroup::Wait() {
+    while (m_pending.load() > 0) {
+        if (m_pool.TryRunOne()) continue;
+
+        // Nothing to help with: the remaining tasks are running elsewhere
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait_for(lock, std::chrono::milliseconds(1),
+            [this]() { return m_pending.load() == 0; });
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+}
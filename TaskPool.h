@@ -0,0 +1,87 @@
+#pragma once
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: tasks it submits go
+// to the back of its own deque and are popped LIFO (cache-warm
+// continuations), while idle workers steal FIFO from the front of the
+// others. Tasks submitted from outside the pool are spread round-robin.
+class TaskPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads = 0 sizes the pool to the number of hardware threads
+    explicit TaskPool(unsigned threads = 0);
+
+    // Runs the tasks still queued, then joins the workers
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void Submit(Task task);
+
+    // Run one queued task on the calling thread if there is any; lets
+    // waiting threads help instead of blocking
+    bool TryRunOne();
+
+    // Call body(i) for every i in [begin, end), split into chunks of grain
+    // indices spread over the pool. The caller helps and returns when all
+    // chunks are done.
+    void ParallelFor(size_t begin, size_t end, size_t grain,
+        const std::function<void(size_t)>& body);
+
+    unsigned GetThreadCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+private:
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(unsigned index);
+    bool PopOrSteal(int self, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_queued{ 0 };
+    std::atomic<unsigned> m_nextQueue{ 0 };
+    std::atomic<bool> m_stopping{ false };
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+};
+
+// A set of tasks that can be waited for as a whole. Tasks may add more
+// tasks to the group (e.g. a fetch chaining its parse step) and Wait()
+// returns only when the whole chain has finished.
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskPool& pool) : m_pool(pool) {}
+    ~TaskGroup() { Wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void Run(TaskPool::Task task);
+
+    // Block until every task in the group has run, helping meanwhile
+    void Wait();
+
+private:
+    TaskPool& m_pool;
+    std::atomic<size_t> m_pending{ 0 };
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+};
+
+#endif
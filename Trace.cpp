@@ -0,0 +1,161 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "Trace.h"
+#include "Log.h"
+
+#include <windows.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+// Events kept per thread; at 40 bytes each a full buffer is 640 KB
+#define TRACE_BUFFER_EVENTS 16384
+
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    uint64_t start;
+    uint64_t duration;
+    uint64_t id;      // Async id, 0 for spans on the thread
+};
+
+// Written only by its thread; the head is published with release so a
+// flush sees complete events
+struct TraceBuffer {
+    DWORD threadId = 0;
+    std::atomic<uint64_t> head{ 0 };
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+};
+
+std::atomic<bool> Trace::s_enabled(false);
+
+// A buffer outlives its thread, so a flush after the thread exits still
+// has its events, until a new thread takes the buffer over: there are only
+// ever as many buffers as threads traced at once
+static std::mutex g_buffersMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> g_buffers;
+static std::vector<TraceBuffer*> g_retired;   // Oldest first
+static std::atomic<uint64_t> g_nextAsyncId(1);
+
+// The calling thread's buffer, handed back when the thread exits
+struct BufferLease {
+    TraceBuffer* buffer = nullptr;
+
+    ~BufferLease() {
+        if (!buffer) return;
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        g_retired.push_back(buffer);
+    }
+};
+
+static thread_local BufferLease t_lease;
+
+static TraceBuffer* ThreadBuffer() {
+    if (!t_lease.buffer) {
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        if (!g_retired.empty()) {
+            t_lease.buffer = g_retired.front();
+            g_retired.erase(g_retired.begin());
+            t_lease.buffer->head.store(0, std::memory_order_release);
+        }
+        else {
+            g_buffers.push_back(std::make_unique<TraceBuffer>());
+            t_lease.buffer = g_buffers.back().get();
+        }
+        t_lease.buffer->threadId = GetCurrentThreadId();
+    }
+    return t_lease.buffer;
+}
+
+static void Record(TraceBuffer& buffer, const TraceEvent& event) {
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % TRACE_BUFFER_EVENTS] = event;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+uint64_t Trace::NowMicros() {
+    static const LONGLONG frequency = []() {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return f.QuadPart;
+    }();
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return static_cast<uint64_t>(now.QuadPart / frequency * 1000000 +
+        now.QuadPart % frequency * 1000000 / frequency);
+}
+
+void Trace::Complete(const char* category, const char* name, uint64_t start, uint64_t duration) {
+    if (!IsEnabled()) return;
+    Record(*ThreadBuffer(), { category, name, start, duration, 0 });
+}
+
+void Trace::Async(const char* category, const char* name, uint64_t id, uint64_t start, uint64_t duration) {
+    if (!IsEnabled()) return;
+    Record(*ThreadBuffer(), { category, name, start, duration, id });
+}
+
+uint64_t Trace::NewAsyncId() {
+    return g_nextAsyncId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Trace::Enable(bool enabled) {
+    if (enabled == IsEnabled()) return;
+    s_enabled.store(enabled, std::memory_order_relaxed);
+    LOG_INFO("Trace: recording {}", enabled ? "on" : "off");
+}
+
+// Names are literals chosen in this codebase; escape anyway so the output
+// is always valid JSON
+static void WriteJsonString(std::ofstream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+bool Trace::Flush(const std::wstring& path) {
+    std::ofstream out(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    DWORD processId = GetCurrentProcessId();
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    std::lock_guard<std::mutex> lock(g_buffersMutex);
+    for (const auto& buffer : g_buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t count = std::min<uint64_t>(head, TRACE_BUFFER_EVENTS);
+
+        for (uint64_t i = head - count; i < head; ++i) {
+            const TraceEvent& event = buffer->events[i % TRACE_BUFFER_EVENTS];
+            if (!first) out << ",\n";
+            first = false;
+
+            // Async spans become a begin/end pair on the id's own track
+            out << "{\"cat\":";
+            WriteJsonString(out, event.category);
+            out << ",\"name\":";
+            WriteJsonString(out, event.name);
+            out << ",\"pid\":" << processId << ",\"tid\":" << buffer->threadId << ",\"ts\":" << event.start;
+            if (event.id == 0) {
+                out << ",\"ph\":\"X\",\"dur\":" << event.duration << "}";
+            }
+            else {
+                out << ",\"ph\":\"b\",\"id\":" << event.id << "},\n{\"cat\":";
+                WriteJsonString(out, event.category);
+                out << ",\"name\":";
+                WriteJsonString(out, event.name);
+                out << ",\"pid\":" << processId << ",\"tid\":" << buffer->threadId
+                    << ",\"ts\":" << event.start + event.duration << ",\"ph\":\"e\",\"id\":" << event.id << "}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    return out.good();
+}
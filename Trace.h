@@ -0,0 +1,88 @@
+#pragma once
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Opt-in tracing in the Chrome trace_event format (load the output in
+// chrome://tracing or Perfetto). Events go into a ring buffer per thread, so
+// recording takes no lock; the oldest events are overwritten when a buffer
+// is full. A buffer is allocated the first time its thread records and
+// handed to the next new thread once its own exits. While tracing is off, a
+// scope costs one relaxed atomic load; ticker_bench measures both costs.
+//
+// Names and categories must be string literals: only the pointers are
+// stored.
+class Trace {
+public:
+    // Turn recording on or off
+    static void Enable(bool enabled);
+
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Microsecond timestamp on the QueryPerformanceCounter timeline
+    static uint64_t NowMicros();
+
+    // A span on the calling thread
+    static void Complete(const char* category, const char* name, uint64_t start, uint64_t duration);
+
+    // A span on its own track, for work that hops threads (a fetch phase).
+    // Spans with the same id nest on one track.
+    static void Async(const char* category, const char* name, uint64_t id,
+        uint64_t start, uint64_t duration);
+
+    // Id for a family of async spans
+    static uint64_t NewAsyncId();
+
+    // Write every buffered event as trace_event JSON. Events recorded while
+    // the dump runs may be missing.
+    static bool Flush(const std::wstring& path);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// Records the lifetime of the enclosing scope as a span
+class TraceScope {
+public:
+    TraceScope(const char* category, const char* name)
+        : m_category(category), m_name(name), m_start(Trace::IsEnabled() ? Trace::NowMicros() : 0) {}
+
+    ~TraceScope() {
+        if (m_start) Trace::Complete(m_category, m_name, m_start, Trace::NowMicros() - m_start);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    uint64_t m_start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// TRACE_SCOPE("render", "Compose") traces the rest of the enclosing block
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+
+// Lock a mutex, recording the wait as a "lock" span when tracing is on and
+// the mutex was contended. Uncontended acquisitions record nothing.
+template <typename Mutex>
+std::unique_lock<Mutex> TracedLock(Mutex& mutex, const char* name) {
+    if (!Trace::IsEnabled()) return std::unique_lock<Mutex>(mutex);
+
+    std::unique_lock<Mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        uint64_t start = Trace::NowMicros();
+        lock.lock();
+        Trace::Complete("lock", name, start, Trace::NowMicros() - start);
+    }
+    return lock;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include "Utf8.h"
+
+#include <windows.h>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#define UTF8_SSE2
+#endif
+
+// Widen the ASCII prefix of text into out, which has room for length
+// characters; returns the prefix length
+static size_t WidenAscii(const char* text, size_t length, wchar_t* out) {
+    size_t i = 0;
+#ifdef UTF8_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        if (_mm_movemask_epi8(chunk) != 0) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(chunk, zero));
+    }
+#endif
+    for (; i < length && static_cast<unsigned char>(text[i]) < 0x80; ++i) {
+        out[i] = static_cast<wchar_t>(text[i]);
+    }
+    return i;
+}
+
+// Narrow the ASCII prefix of text into out; returns the prefix length
+static size_t NarrowAscii(const wchar_t* text, size_t length, char* out) {
+    size_t i = 0;
+#ifdef UTF8_SSE2
+    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 8));
+        __m128i bits = _mm_and_si128(_mm_or_si128(low, high), nonAscii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(bits, zero)) != 0xFFFF) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < length && text[i] < 0x80; ++i) {
+        out[i] = static_cast<char>(text[i]);
+    }
+    return i;
+}
+
+void Utf8::AppendWide(std::string_view text, std::wstring& out) {
+    // No UTF-8 sequence takes fewer bytes than its UTF-16 form has units
+    size_t at = out.size();
+    out.resize(at + text.size());
+    size_t ascii = WidenAscii(text.data(), text.size(), &out[at]);
+    if (ascii == text.size()) return;
+
+    int rest = static_cast<int>(text.size() - ascii);
+    int written = MultiByteToWideChar(CP_UTF8, 0, text.data() + ascii, rest, &out[at + ascii], rest);
+    out.resize(at + ascii + std::max(written, 0));
+}
+
+void Utf8::AppendUtf8(std::wstring_view text, std::string& out) {
+    // A UTF-16 unit becomes at most three bytes (a surrogate pair four)
+    size_t at = out.size();
+    out.resize(at + text.size() * 3);
+    size_t ascii = NarrowAscii(text.data(), text.size(), &out[at]);
+    if (ascii == text.size()) {
+        out.resize(at + ascii);
+        return;
+    }
+
+    int rest = static_cast<int>(text.size() - ascii);
+    int written = WideCharToMultiByte(CP_UTF8, 0, text.data() + ascii, rest, &out[at + ascii], rest * 3,
+        nullptr, nullptr);
+    out.resize(at + ascii + std::max(written, 0));
+}
+
+std::wstring Utf8::ToWide(std::string_view text) {
+    std::wstring wide;
+    AppendWide(text, wide);
+    return wide;
+}
+
+std::string Utf8::FromWide(std::wstring_view text) {
+    std::string utf8;
+    AppendUtf8(text, utf8);
+    return utf8;
+}
+
+size_t Utf8::Utf16Length(std::string_view text) {
+    // Every lead byte starts a unit; four byte sequences become a surrogate pair
+    size_t length = 0;
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if ((byte & 0xC0) != 0x80) ++length;
+        if (byte >= 0xF0) ++length;
+    }
+    return length;
+}
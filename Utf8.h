@@ -0,0 +1,26 @@
+#pragma once
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <string>
+#include <string_view>
+
+// Conversion between the UTF-8 used for core data (symbols, tape segments)
+// and the UTF-16 Win32 wants. Only the Win32 edges call these: config file
+// and dialog text, request paths and the render snapshot. Pure ASCII, the
+// common case for symbols and prices, is converted 16 characters at a time
+// with SSE2; other text goes through the Win32 converters.
+class Utf8 {
+public:
+    // Append text converted to out; invalid sequences become U+FFFD
+    static void AppendWide(std::string_view text, std::wstring& out);
+    static void AppendUtf8(std::wstring_view text, std::string& out);
+
+    static std::wstring ToWide(std::string_view text);
+    static std::string FromWide(std::wstring_view text);
+
+    // UTF-16 units text converts to (valid UTF-8)
+    static size_t Utf16Length(std::string_view text);
+};
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal benchmark harness for ticker_bench. A BENCH body calls
+// Bench::Measure once per case; each case is timed in batches until its
+// time budget is spent and reported as one JSON line on stdout (for
+// scripts) and one table row on stderr (for people).
+//
+//   ticker_bench [--quick] [--filter text] [--list]
+//
+// --quick shrinks every budget for the ctest smoke run.
+
+// Name and value of a case parameter, e.g. { "symbols", 1000 }
+typedef std::pair<const char*, long long> BenchParam;
+
+class Bench {
+public:
+    // Time op, which handles items items per call, and report it under name
+    static void Measure(const char* name, std::initializer_list<BenchParam> params, size_t items,
+        const std::function<void()>& op);
+
+    // Report an externally measured case: per-operation samples in
+    // nanoseconds, e.g. latencies gathered across threads
+    static void Report(const char* name, std::initializer_list<BenchParam> params, size_t items,
+        std::vector<double>& samplesNs, double elapsedSeconds);
+
+    // Symbol counts the pipeline cases sweep: 10 to 10,000
+    static const std::vector<int>& SymbolCounts();
+
+    // Running with --quick
+    static bool IsQuick();
+
+    // Keep the compiler from discarding a result
+    template <typename T>
+    static void Keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    typedef void (*Function)();
+    static void Register(const char* name, Function function);
+};
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, Bench::Function function) { Bench::Register(name, function); }
+};
+
+#define BENCH(name) \
+    static void name(); \
+    static BenchRegistrar name##Registrar(#name, name); \
+    static void name()
+
+#endif
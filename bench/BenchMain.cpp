@@ -0,0 +1,128 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Time budget per case, and the shortest batch worth timing
+#define BENCH_BUDGET_MS 300
+#define BENCH_QUICK_BUDGET_MS 5
+#define BENCH_MIN_BATCH_NS 20000.0
+#define BENCH_MIN_SAMPLES 5
+
+struct BenchEntry {
+    const char* name;
+    Bench::Function function;
+};
+
+static std::vector<BenchEntry>& Entries() {
+    static std::vector<BenchEntry> entries;
+    return entries;
+}
+
+static bool g_quick = false;
+static const char* g_current = "";
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double SecondsSince(BenchClock::time_point start) {
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+static double Percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void Bench::Register(const char* name, Function function) {
+    Entries().push_back({ name, function });
+}
+
+bool Bench::IsQuick() {
+    return g_quick;
+}
+
+const std::vector<int>& Bench::SymbolCounts() {
+    static const std::vector<int> counts = { 10, 100, 1000, 10000 };
+    return counts;
+}
+
+void Bench::Report(const char* name, std::initializer_list<BenchParam> params, size_t items,
+    std::vector<double>& samplesNs, double elapsedSeconds) {
+    std::sort(samplesNs.begin(), samplesNs.end());
+    double total = 0.0;
+    for (double sample : samplesNs) total += sample;
+    double mean = samplesNs.empty() ? 0.0 : total / samplesNs.size();
+    double p50 = Percentile(samplesNs, 0.50);
+    double p99 = Percentile(samplesNs, 0.99);
+    double itemsPerSecond = p50 > 0.0 ? items * 1e9 / p50 : 0.0;
+
+    std::string label;
+    std::string json;
+    for (const BenchParam& param : params) {
+        char buffer[96];
+        snprintf(buffer, sizeof(buffer), "%s=%lld ", param.first, param.second);
+        label += buffer;
+        snprintf(buffer, sizeof(buffer), ",\"%s\":%lld", param.first, param.second);
+        json += buffer;
+    }
+
+    printf("{\"group\":\"%s\",\"bench\":\"%s\"%s,\"items\":%zu,\"samples\":%zu,\"seconds\":%.3f,"
+        "\"mean_ns\":%.1f,\"p50_ns\":%.1f,\"p99_ns\":%.1f,\"items_per_s\":%.0f}\n",
+        g_current, name, json.c_str(), items, samplesNs.size(), elapsedSeconds, mean, p50, p99, itemsPerSecond);
+    fflush(stdout);
+    fprintf(stderr, "%-28s %-44s %12.1f %12.1f %14.0f\n", name, label.c_str(), p50, p99, itemsPerSecond);
+}
+
+void Bench::Measure(const char* name, std::initializer_list<BenchParam> params, size_t items,
+    const std::function<void()>& op) {
+    // Warm up, then size batches so the clock's resolution does not matter
+    BenchClock::time_point start = BenchClock::now();
+    op();
+    double once = std::max(1.0, SecondsSince(start) * 1e9);
+    size_t batch = static_cast<size_t>(std::max(1.0, BENCH_MIN_BATCH_NS / once));
+
+    double budget = (g_quick ? BENCH_QUICK_BUDGET_MS : BENCH_BUDGET_MS) / 1000.0;
+    std::vector<double> samples;
+    start = BenchClock::now();
+    while (samples.size() < BENCH_MIN_SAMPLES || SecondsSince(start) < budget) {
+        BenchClock::time_point batchStart = BenchClock::now();
+        for (size_t i = 0; i < batch; ++i) op();
+        samples.push_back(SecondsSince(batchStart) * 1e9 / batch);
+    }
+    Report(name, params, items, samples, SecondsSince(start));
+}
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--quick") == 0) g_quick = true;
+        else if (strcmp(argv[i], "--list") == 0) list = true;
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--quick] [--filter text] [--list]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<BenchEntry> entries = Entries();
+    std::sort(entries.begin(), entries.end(),
+        [](const BenchEntry& a, const BenchEntry& b) { return strcmp(a.name, b.name) < 0; });
+
+    if (!list) fprintf(stderr, "%-28s %-44s %12s %12s %14s\n", "bench", "case", "p50 ns", "p99 ns", "items/s");
+    for (const BenchEntry& entry : entries) {
+        if (filter && !strstr(entry.name, filter)) continue;
+        if (list) {
+            printf("%s\n", entry.name);
+            continue;
+        }
+        g_current = entry.name;
+        entry.function();
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "Bench.h"
+#include "Compositor.h"
+
+#include <random>
+#include <vector>
+
+// Each compositing kernel on a full tape-sized buffer with every kernel set
+// the CPU can run, so the vector paths can be compared with scalar. Items
+// are pixels.
+
+#define COMPOSITOR_WIDTH 1920
+#define COMPOSITOR_HEIGHT 32
+#define COMPOSITOR_FADE 24
+
+static const char* const g_kernels[] = { "scalar", "sse2", "avx2" };
+
+BENCH(Compositor) {
+    const size_t pixels = static_cast<size_t>(COMPOSITOR_WIDTH) * COMPOSITOR_HEIGHT;
+    std::vector<uint32_t> dst(pixels);
+    std::vector<uint32_t> mask(pixels);
+    std::mt19937 random(11);
+    for (uint32_t& coverage : mask) coverage = (random() & 0xFF) * 0x01010101u;
+
+    for (int k = 0; k < 3; ++k) {
+        if (!Compositor::SelectKernel(g_kernels[k])) continue;
+        // The kernel set is the case's parameter: 0 scalar, 1 sse2, 2 avx2
+        Bench::Measure("compositor.fill", { { "kernel", k }, { "width", COMPOSITOR_WIDTH } }, pixels, [&] {
+            Compositor::Fill(dst.data(), COMPOSITOR_WIDTH, COMPOSITOR_WIDTH, COMPOSITOR_HEIGHT, 0xC8000000u);
+            Bench::Keep(dst[0]);
+        });
+        Bench::Measure("compositor.blend", { { "kernel", k }, { "width", COMPOSITOR_WIDTH } }, pixels, [&] {
+            Compositor::BlendCoverage(dst.data(), COMPOSITOR_WIDTH, mask.data(), COMPOSITOR_WIDTH,
+                COMPOSITOR_WIDTH, COMPOSITOR_HEIGHT, 0x00FF00, 255);
+            Bench::Keep(dst[0]);
+        });
+        Bench::Measure("compositor.fade", { { "kernel", k }, { "width", COMPOSITOR_WIDTH } },
+            static_cast<size_t>(COMPOSITOR_FADE) * 2 * COMPOSITOR_HEIGHT, [&] {
+            Compositor::FadeEdges(dst.data(), COMPOSITOR_WIDTH, COMPOSITOR_WIDTH, COMPOSITOR_HEIGHT,
+                COMPOSITOR_FADE);
+            Bench::Keep(dst[0]);
+        });
+    }
+    Compositor::SelectKernel(nullptr);
+}
@@ -0,0 +1,126 @@
+#include "Bench.h"
+#include "QuoteConflator.h"
+#include "QuoteExporter.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The conflator under a local feed's load: producer threads publish a
+// combined 100,000 updates a second across the symbols while the consumer
+// drains at 60 frames a second, with the export off and on. Reports the
+// time of one Publish and of one frame's Drain. The unpaced case has every
+// producer hammer the same symbol.
+
+#define FEED_RATE 100000
+#define FRAME_NS (1000000000LL / 60)
+#define CONFLATOR_PRODUCERS 4
+#define CONFLATOR_SYMBOLS 1000
+
+typedef std::chrono::steady_clock Clock;
+
+static long long NanosSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+static std::vector<int> InternSymbols(int count) {
+    std::vector<int> ids;
+    char symbol[16];
+    for (int i = 0; i < count; ++i) {
+        snprintf(symbol, sizeof(symbol), "CB%d", i);
+        ids.push_back(QuoteConflator::Intern(symbol));
+    }
+    return ids;
+}
+
+// Run producers at rate updates a second in total (0 = flat out) over ids
+// for seconds while the consumer drains every frame; collect the time of
+// every 64th Publish and of every Drain
+static void RunFeed(const std::vector<int>& ids, int producers, int rate, double seconds,
+    std::vector<double>& publishNs, std::vector<double>& drainNs, size_t& drained) {
+    std::atomic<bool> running(true);
+    std::vector<std::vector<double>> samples(producers);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            long long interval = rate ? 1000000000LL * producers / rate : 0;
+            Clock::time_point start = Clock::now();
+            unsigned long long n = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                if (interval && NanosSince(start) < static_cast<long long>(n) * interval) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                int id = ids[(n * producers + p) % ids.size()];
+                Price price = Price::FromUnits(100000 + static_cast<int64_t>(n % 1000), 2);
+                if (n % 64 == 0) {
+                    Clock::time_point before = Clock::now();
+                    QuoteConflator::Publish(id, price, Price::FromUnits(100000, 2));
+                    samples[p].push_back(static_cast<double>(NanosSince(before)));
+                }
+                else {
+                    QuoteConflator::Publish(id, price, Price::FromUnits(100000, 2));
+                }
+                ++n;
+            }
+        });
+    }
+
+    std::vector<ConflatedQuote> updates;
+    Clock::time_point start = Clock::now();
+    for (long long frame = 1; NanosSince(start) < static_cast<long long>(seconds * 1e9); ++frame) {
+        while (NanosSince(start) < frame * FRAME_NS) std::this_thread::yield();
+        updates.clear();
+        Clock::time_point before = Clock::now();
+        drained += QuoteConflator::Drain(updates);
+        drainNs.push_back(static_cast<double>(NanosSince(before)));
+    }
+
+    running = false;
+    for (std::thread& thread : threads) thread.join();
+    for (const auto& producer : samples) publishNs.insert(publishNs.end(), producer.begin(), producer.end());
+}
+
+BENCH(Conflator) {
+    std::vector<int> ids = InternSymbols(CONFLATOR_SYMBOLS);
+    double seconds = Bench::IsQuick() ? 0.1 : 2.0;
+
+    for (int exporting = 0; exporting <= 1; ++exporting) {
+        if (exporting && !QuoteExporter::Start()) continue;
+
+        std::vector<double> publishNs;
+        std::vector<double> drainNs;
+        size_t drained = 0;
+        unsigned long long published = QuoteConflator::GetUpdatesPublished();
+        Clock::time_point start = Clock::now();
+        RunFeed(ids, CONFLATOR_PRODUCERS, FEED_RATE, seconds, publishNs, drainNs, drained);
+        double elapsed = NanosSince(start) / 1e9;
+        published = QuoteConflator::GetUpdatesPublished() - published;
+
+        Bench::Report("conflator.publish", { { "producers", CONFLATOR_PRODUCERS }, { "symbols", CONFLATOR_SYMBOLS },
+            { "rate", FEED_RATE }, { "export", exporting } }, 1, publishNs, elapsed);
+        Bench::Report("conflator.drain_60fps", { { "symbols", CONFLATOR_SYMBOLS }, { "rate", FEED_RATE },
+            { "published", static_cast<long long>(published) }, { "export", exporting } },
+            drainNs.empty() ? 0 : drained / drainNs.size(), drainNs, elapsed);
+
+        if (exporting) QuoteExporter::Stop();
+    }
+
+    // Every producer on one symbol, flat out: the case a per-slot lock made
+    // producers spin on each other
+    std::vector<int> one(1, ids[0]);
+    for (int producers : { 1, 2, 4 }) {
+        std::vector<double> publishNs;
+        std::vector<double> drainNs;
+        size_t drained = 0;
+        Clock::time_point start = Clock::now();
+        RunFeed(one, producers, 0, seconds / 2, publishNs, drainNs, drained);
+        Bench::Report("conflator.publish_one_symbol", { { "producers", producers } }, 1, publishNs,
+            NanosSince(start) / 1e9);
+    }
+}
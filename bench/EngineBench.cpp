@@ -0,0 +1,79 @@
+#include "Bench.h"
+#include "StubServer.h"
+#include "ConfigManager.h"
+#include "QuoteConflator.h"
+#include "QuoteEngine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Time to first price: from QuoteEngine::Start() to the first quote it
+// publishes, against a stub quote server on loopback that answers at once
+// or after a simulated round trip. Every run starts cold, with a new HTTP
+// client and no symbol fetched yet; items are runs.
+
+#define FIRST_PRICE_TIMEOUT_MS 5000
+
+typedef std::chrono::steady_clock Clock;
+
+// Watchlist of count symbols, reusing ones earlier benches interned: the
+// conflator holds only MAX_SYMBOLS
+static std::vector<std::string> Watchlist(int count) {
+    std::vector<std::string> symbols;
+    char symbol[16];
+    for (int i = 0; i < count; ++i) {
+        if (i < QuoteConflator::GetSymbolCount()) {
+            symbols.push_back(QuoteConflator::GetSymbol(i));
+            continue;
+        }
+        snprintf(symbol, sizeof(symbol), "EF%d", i);
+        symbols.push_back(symbol);
+    }
+    return symbols;
+}
+
+BENCH(EngineFirstPrice) {
+    StubServer server;
+    if (!server.Port()) {
+        fprintf(stderr, "engine: could not start the stub server\n");
+        return;
+    }
+    int runs = Bench::IsQuick() ? 3 : 20;
+
+    for (int latencyMs : { 0, 50 }) {
+        server.SetDelay(latencyMs);
+        for (int count : { 1, 100 }) {
+            ConfigManager::SetDefaults();
+            ConfigManager::apiHost = L"127.0.0.1";
+            ConfigManager::apiPort = server.Port();
+            ConfigManager::apiHttps = false;
+            ConfigManager::symbols = Watchlist(count);
+            ConfigManager::Publish();
+
+            std::vector<double> samplesNs;
+            Clock::time_point begin = Clock::now();
+            for (int run = 0; run < runs; ++run) {
+                unsigned long long published = QuoteConflator::GetUpdatesPublished();
+                Clock::time_point start = Clock::now();
+                Clock::time_point deadline = start + std::chrono::milliseconds(FIRST_PRICE_TIMEOUT_MS);
+                QuoteEngine::Start();
+                while (QuoteConflator::GetUpdatesPublished() == published && Clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+                Clock::time_point first = Clock::now();
+                QuoteEngine::Stop();
+                if (first >= deadline) {
+                    fprintf(stderr, "engine: no price within %d ms\n", FIRST_PRICE_TIMEOUT_MS);
+                    return;
+                }
+                samplesNs.push_back(static_cast<double>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(first - start).count()));
+            }
+            Bench::Report("engine.first_price", { { "symbols", count }, { "latency_ms", latencyMs } }, 1,
+                samplesNs, std::chrono::duration<double>(Clock::now() - begin).count());
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include "Bench.h"
+#include "Log.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// What a LOG_* call costs the thread that makes it while other threads log
+// too, with the sink writing to a file in the background. Each producer
+// times every call. log.write goes through the ring: paced at a rate the
+// sink keeps up with, and flat out, where the ring fills and calls take
+// the drop path. log.suppressed is a call site over its repeat burst,
+// which only touches the site's counters.
+
+// Messages a second across all producers; the sink drains the 1024 slot
+// ring every 50 ms, so this leaves it headroom
+#define LOG_BENCH_RATE 10000
+
+typedef std::chrono::steady_clock Clock;
+
+static long long NanosSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// Run producers threads calling op for seconds, each at rate / producers
+// calls a second (0 = flat out), and collect the time of every call
+template <typename Op>
+static std::vector<double> RunProducers(int producers, int rate, double seconds, Op op) {
+    std::vector<std::vector<double>> samples(producers);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            long long interval = rate ? 1000000000LL * producers / rate : 0;
+            Clock::time_point start = Clock::now();
+            long long limit = static_cast<long long>(seconds * 1e9);
+            for (long long n = 0; NanosSince(start) < limit; ++n) {
+                while (interval && NanosSince(start) < n * interval) std::this_thread::yield();
+                Clock::time_point before = Clock::now();
+                op(p, n);
+                samples[p].push_back(static_cast<double>(NanosSince(before)));
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    std::vector<double> all;
+    for (const auto& producer : samples) all.insert(all.end(), producer.begin(), producer.end());
+    return all;
+}
+
+BENCH(Logging) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "ticker_log_bench.log";
+    if (!Log::Start(path.wstring())) return;
+
+    // Written straight to the ring, past the per-site rate limit
+    static LogSite site{ LogLevel::Info, "bench: producer {} message {} for {}", __FILE__, __LINE__ };
+    double seconds = Bench::IsQuick() ? 0.05 : 1.0;
+
+    for (int producers : { 1, 2, 4 }) {
+        for (int rate : { LOG_BENCH_RATE, 0 }) {
+            unsigned long long dropped = Log::GetDropped();
+            Clock::time_point start = Clock::now();
+            std::vector<double> samples = RunProducers(producers, rate, seconds, [](int p, long long n) {
+                Log::Write(site, p, n, "AAPL");
+            });
+            double elapsed = NanosSince(start) / 1e9;
+            Bench::Report("log.write", { { "producers", producers }, { "rate", rate },
+                { "dropped", static_cast<long long>(Log::GetDropped() - dropped) } }, 1, samples, elapsed);
+        }
+
+        Clock::time_point start = Clock::now();
+        std::vector<double> samples = RunProducers(producers, 0, seconds / 4, [](int p, long long n) {
+            LOG_INFO("bench: suppressed {} {}", p, n);
+        });
+        Bench::Report("log.suppressed", { { "producers", producers } }, 1, samples, NanosSince(start) / 1e9);
+    }
+
+    Log::Stop();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    for (int rotated = 1; rotated <= 3; ++rotated) {
+        std::filesystem::remove(path.string() + "." + std::to_string(rotated), error);
+    }
+}
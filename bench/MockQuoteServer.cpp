@@ -0,0 +1,319 @@
+// Stand-in quote server: replays recorded chart JSON over plain HTTP with a
+// configurable latency, rate limit and payload size, so fetch passes can be
+// measured and stressed without the internet. Point the tape at it with
+// apiHost=localhost, apiPort=<port> and apiHttps=0 in config.ini.
+//
+//   mock_quote_server [--port 8080] [--data dir] [--latency-ms 0] [--jitter-ms 0]
+//                     [--throttle-rps 0] [--payload-bytes 0] [--strict]
+//
+// A symbol with a recording gets it; any other symbol gets one of the
+// recordings with its symbol swapped in, so tapes of thousands of symbols
+// can be served, unless --strict answers them 404 like a mistyped ticker.
+// A request without interval= gets the quote without its intraday series.
+// Beyond --throttle-rps requests in a second, requests are answered 429.
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET Socket;
+#define CloseSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int Socket;
+#define INVALID_SOCKET (-1)
+#define CloseSocket close
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR "bench/data"
+#endif
+
+// Longest request head accepted
+#define MAX_REQUEST_BYTES 16384
+
+#define CHART_PREFIX "/v8/finance/chart/"
+
+struct Options {
+    int port = 8080;
+    std::string dataDir = BENCH_DATA_DIR;
+    int latencyMs = 0;
+    int jitterMs = 0;
+    int throttleRps = 0;   // 0 = unlimited
+    size_t payloadBytes = 0;
+    bool strict = false;
+};
+
+// A recorded response, with and without its intraday series
+struct Recording {
+    std::string symbol;
+    std::string full;
+    std::string quoteOnly;
+};
+
+static Options g_options;
+static std::vector<Recording> g_recordings;
+static std::map<std::string, size_t> g_bySymbol;
+
+static std::atomic<unsigned long long> g_requests(0);
+static std::atomic<unsigned long long> g_throttled(0);
+static std::atomic<unsigned long long> g_notFound(0);
+static std::atomic<long long> g_windowStart(0);   // Second the rate window counts
+static std::atomic<int> g_windowRequests(0);
+
+static long long NowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::string ExtractSymbol(const std::string& body) {
+    static const char needle[] = "\"symbol\":\"";
+    size_t start = body.find(needle);
+    if (start == std::string::npos) return std::string();
+    start += sizeof(needle) - 1;
+    size_t end = body.find('"', start);
+    return end == std::string::npos ? std::string() : body.substr(start, end - start);
+}
+
+static bool LoadRecordings(const std::string& dir) {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+        if (entry.path().extension() != ".json") continue;
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::string body((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        Recording recording;
+        recording.symbol = ExtractSymbol(body);
+        size_t series = body.find(",\"timestamp\":");
+        if (recording.symbol.empty() || series == std::string::npos) {
+            fprintf(stderr, "skipping %s: not a chart response\n", entry.path().string().c_str());
+            continue;
+        }
+        recording.quoteOnly = body.substr(0, series) + "}],\"error\":null}}";
+        recording.full = std::move(body);
+        g_bySymbol[recording.symbol] = g_recordings.size();
+        g_recordings.push_back(std::move(recording));
+    }
+    return !g_recordings.empty();
+}
+
+static std::string PercentDecode(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size()) {
+            out += static_cast<char>(strtol(text.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        }
+        else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+// The body for a chart request, or false for a symbol with none
+static bool ChartBody(const std::string& symbol, bool series, std::string& body) {
+    auto found = g_bySymbol.find(symbol);
+    if (found != g_bySymbol.end()) {
+        const Recording& recording = g_recordings[found->second];
+        body = series ? recording.full : recording.quoteOnly;
+    }
+    else {
+        if (g_options.strict) return false;
+        const Recording& recording = g_recordings[std::hash<std::string>()(symbol) % g_recordings.size()];
+        body = series ? recording.full : recording.quoteOnly;
+        std::string from = "\"symbol\":\"" + recording.symbol + "\"";
+        size_t at = body.find(from);
+        if (at != std::string::npos) body.replace(at, from.size(), "\"symbol\":\"" + symbol + "\"");
+    }
+
+    // Pad inside the top-level object so the body stays valid JSON
+    if (body.size() + 13 < g_options.payloadBytes) {
+        body.insert(body.size() - 1, ",\"padding\":\"" + std::string(g_options.payloadBytes - body.size() - 13, 'x') + "\"");
+    }
+    return true;
+}
+
+static bool Admit() {
+    if (g_options.throttleRps <= 0) return true;
+    long long now = NowSeconds();
+    long long window = g_windowStart.load();
+    if (window != now && g_windowStart.compare_exchange_strong(window, now)) g_windowRequests = 0;
+    return ++g_windowRequests <= g_options.throttleRps;
+}
+
+static bool SendAll(Socket socket, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int count = send(socket, data.data() + sent, static_cast<int>(data.size() - sent), 0);
+        if (count <= 0) return false;
+        sent += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+static std::string Response(int status, const char* reason, const std::string& body, bool keepAlive) {
+    char head[256];
+    snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n"
+        "Connection: %s\r\n%s\r\n", status, reason, body.size(), keepAlive ? "keep-alive" : "close",
+        status == 429 ? "Retry-After: 1\r\n" : "");
+    return head + body;
+}
+
+static std::string Handle(const std::string& target, bool keepAlive) {
+    g_requests.fetch_add(1, std::memory_order_relaxed);
+    if (!Admit()) {
+        g_throttled.fetch_add(1, std::memory_order_relaxed);
+        return Response(429, "Too Many Requests", "Too Many Requests", keepAlive);
+    }
+
+    std::string body;
+    size_t query = target.find('?');
+    std::string path = target.substr(0, query);
+    std::string parameters = query == std::string::npos ? std::string() : target.substr(query + 1);
+    if (path.compare(0, sizeof(CHART_PREFIX) - 1, CHART_PREFIX) != 0 ||
+        !ChartBody(PercentDecode(path.substr(sizeof(CHART_PREFIX) - 1)),
+            parameters.find("interval=") != std::string::npos, body)) {
+        g_notFound.fetch_add(1, std::memory_order_relaxed);
+        return Response(404, "Not Found", "{\"chart\":{\"result\":null,\"error\":{\"code\":\"Not Found\","
+            "\"description\":\"No data found, symbol may be delisted\"}}}", keepAlive);
+    }
+
+    if (g_options.latencyMs > 0 || g_options.jitterMs > 0) {
+        static thread_local std::mt19937 random(std::random_device{}());
+        int jitter = g_options.jitterMs > 0 ? static_cast<int>(random() % (g_options.jitterMs + 1)) : 0;
+        std::this_thread::sleep_for(std::chrono::milliseconds(g_options.latencyMs + jitter));
+    }
+    return Response(200, "OK", body, keepAlive);
+}
+
+// Serve one connection's requests until the client closes it
+static void ServeConnection(Socket socket) {
+    std::string buffer;
+    char chunk[4096];
+    for (;;) {
+        size_t end;
+        while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (buffer.size() > MAX_REQUEST_BYTES) {
+                CloseSocket(socket);
+                return;
+            }
+            int count = recv(socket, chunk, sizeof(chunk), 0);
+            if (count <= 0) {
+                CloseSocket(socket);
+                return;
+            }
+            buffer.append(chunk, static_cast<size_t>(count));
+        }
+
+        std::string head = buffer.substr(0, end);
+        buffer.erase(0, end + 4);
+
+        size_t space = head.find(' ');
+        size_t second = space == std::string::npos ? std::string::npos : head.find(' ', space + 1);
+        if (second == std::string::npos) break;
+        std::string target = head.substr(space + 1, second - space - 1);
+
+        std::string lower = head;
+        for (char& c : lower) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        bool keepAlive = lower.find("connection: close") == std::string::npos &&
+            lower.find("http/1.0") == std::string::npos;
+
+        if (!SendAll(socket, Handle(target, keepAlive)) || !keepAlive) break;
+    }
+    CloseSocket(socket);
+}
+
+static void ReportLoop() {
+    unsigned long long last = 0;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+        unsigned long long requests = g_requests.load();
+        if (requests == last) continue;
+        fprintf(stderr, "%llu requests (+%llu), %llu throttled, %llu not found\n",
+            requests, requests - last, g_throttled.load(), g_notFound.load());
+        last = requests;
+    }
+}
+
+static bool ParseOptions(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string name = argv[i];
+        if (name == "--strict") {
+            g_options.strict = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (name == "--port") g_options.port = atoi(value);
+        else if (name == "--data") g_options.dataDir = value;
+        else if (name == "--latency-ms") g_options.latencyMs = atoi(value);
+        else if (name == "--jitter-ms") g_options.jitterMs = atoi(value);
+        else if (name == "--throttle-rps") g_options.throttleRps = atoi(value);
+        else if (name == "--payload-bytes") g_options.payloadBytes = static_cast<size_t>(atoll(value));
+        else return false;
+    }
+    return g_options.port > 0 && g_options.port < 65536;
+}
+
+int main(int argc, char** argv) {
+    if (!ParseOptions(argc, argv)) {
+        fprintf(stderr, "usage: %s [--port 8080] [--data dir] [--latency-ms 0] [--jitter-ms 0] "
+            "[--throttle-rps 0] [--payload-bytes 0] [--strict]\n", argv[0]);
+        return 2;
+    }
+    if (!LoadRecordings(g_options.dataDir)) {
+        fprintf(stderr, "no chart recordings in %s\n", g_options.dataDir.c_str());
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+    Socket listener = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&yes), sizeof(yes));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<unsigned short>(g_options.port));
+    if (listener == INVALID_SOCKET || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 128) != 0) {
+        fprintf(stderr, "cannot listen on port %d\n", g_options.port);
+        return 1;
+    }
+
+    fprintf(stderr, "serving %zu recordings on http://localhost:%d (latency %d+%d ms, %d req/s, %zu byte payloads%s)\n",
+        g_recordings.size(), g_options.port, g_options.latencyMs, g_options.jitterMs, g_options.throttleRps,
+        g_options.payloadBytes, g_options.strict ? ", strict" : "");
+    std::thread(ReportLoop).detach();
+
+    for (;;) {
+        Socket client = accept(listener, nullptr, nullptr);
+        if (client == INVALID_SOCKET) continue;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&yes), sizeof(yes));
+        std::thread(ServeConnection, client).detach();
+    }
+}
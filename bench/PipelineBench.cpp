@@ -0,0 +1,194 @@
+#include "Bench.h"
+#include "ApiFetcher.h"
+#include "FrameComposer.h"
+#include "HeadlessRenderer.h"
+#include "Sparkline.h"
+#include "TapeModel.h"
+#include "TapeTemplate.h"
+#include "Utf8.h"
+
+#include <cstdio>
+#include <cwchar>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Every stage from a chart response to a finished frame, at 10 to 10,000
+// symbols: parse the recorded bodies, format each symbol with the default
+// template (and, as a baseline, with the swprintf call it replaced), lay
+// the tape out, composite a frame from a ready glyph mask, and render
+// whole headless frames while the tape scrolls, for one tape window and
+// for several served by one frame timer tick.
+
+#define PIPELINE_WIDTH 1920
+#define PIPELINE_HEIGHT 32
+#define PIPELINE_SCALE 2
+
+// One recorded chart response per kind of symbol
+static const char* const g_recorded[] = { "aapl", "msft", "gspc", "btc-usd", "eurusd", "gc" };
+#define RECORDED_COUNT (sizeof(g_recorded) / sizeof(g_recorded[0]))
+
+struct PipelineData {
+    std::vector<std::string> bodies;
+    std::vector<Quote> quotes;
+    std::vector<std::shared_ptr<const SparklineBitmap>> sparklines;
+};
+
+static const PipelineData& GetData() {
+    static PipelineData data;
+    if (!data.bodies.empty()) return data;
+
+    std::vector<float> series;
+    std::vector<SparkPoint> points;
+    BitmapFontRasterizer rasterizer(PIPELINE_SCALE);
+    int charWidth = rasterizer.GetCellWidth();
+    for (const char* name : g_recorded) {
+        std::string path = std::string(BENCH_DATA_DIR) + "/" + name + ".json";
+        std::ifstream file(path, std::ios::binary);
+        std::string body((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (body.empty()) fprintf(stderr, "missing recorded response %s\n", path.c_str());
+
+        data.quotes.push_back(ApiFetcher::ParseQuote(body));
+        auto bitmap = std::make_shared<SparklineBitmap>();
+        if (ApiFetcher::ParseSeries(body, series)) {
+            Sparkline::Downsample(series.data(), series.size(), Sparkline::PlotWidth(charWidth), points);
+            Sparkline::Rasterize(points, charWidth, *bitmap);
+        }
+        data.sparklines.push_back(bitmap);
+        data.bodies.push_back(std::move(body));
+    }
+    return data;
+}
+
+// Symbols of every kind the template treats differently
+static std::vector<std::string> MakeSymbols(int count) {
+    static const char* const patterns[RECORDED_COUNT] = { "Q%d", "M%d", "^I%d", "C%d-USD", "F%dUSD=X", "G%d=F" };
+    std::vector<std::string> symbols;
+    char buffer[32];
+    for (int i = 0; i < count; ++i) {
+        snprintf(buffer, sizeof(buffer), patterns[i % RECORDED_COUNT], i);
+        symbols.push_back(buffer);
+    }
+    return symbols;
+}
+
+static const FrameStyle g_style = { 0xFFFFFF, 0x00FF00, 0xFF4040, 0xFFFF00, 0x000000, 200, 24 };
+
+struct Tape {
+    std::vector<TapeSegment> segments;
+    std::vector<int> kinds;
+    TapeSnapshot snapshot;
+};
+
+static void FormatTape(const TapeTemplate& format, const std::vector<std::string>& symbols, Tape& tape) {
+    const PipelineData& data = GetData();
+    tape.segments.resize(symbols.size());
+    tape.kinds.resize(symbols.size());
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        const Quote& quote = data.quotes[i % RECORDED_COUNT];
+        tape.kinds[i] = static_cast<int>(i % RECORDED_COUNT);
+        TapeModel::FormatQuote(format, symbols[i], quote.price, quote.previousClose, true, tape.segments[i]);
+    }
+}
+
+static void LayOut(Tape& tape) {
+    const PipelineData& data = GetData();
+    TapeModel::Begin(tape.snapshot);
+    for (size_t i = 0; i < tape.segments.size(); ++i) {
+        const TapeSegment& segment = tape.segments[i];
+        TapeModel::Append(tape.snapshot, segment.text, segment.tone, segment.flash, segment.sparkline,
+            data.sparklines[tape.kinds[i]]);
+    }
+    TapeModel::Finish(tape.snapshot, 0);
+}
+
+BENCH(Pipeline) {
+    const PipelineData& data = GetData();
+    TapeTemplate format;
+
+    for (int count : Bench::SymbolCounts()) {
+        std::vector<std::string> symbols = MakeSymbols(count);
+        size_t items = static_cast<size_t>(count);
+
+        std::vector<float> series;
+        Bench::Measure("pipeline.parse", { { "symbols", count } }, items, [&] {
+            for (int i = 0; i < count; ++i) {
+                const std::string& body = data.bodies[i % RECORDED_COUNT];
+                Quote quote = ApiFetcher::ParseQuote(body);
+                ApiFetcher::ParseSeries(body, series);
+                Bench::Keep(quote);
+            }
+        });
+
+        Tape tape;
+        Bench::Measure("pipeline.template", { { "symbols", count } }, items, [&] {
+            FormatTape(format, symbols, tape);
+        });
+
+        // Baseline: the fixed swprintf layout the template replaced
+        std::vector<std::wstring> wideSymbols;
+        for (const std::string& symbol : symbols) wideSymbols.push_back(Utf8::ToWide(symbol));
+        std::vector<std::wstring> texts(symbols.size());
+        Bench::Measure("pipeline.template_swprintf", { { "symbols", count } }, items, [&] {
+            wchar_t buffer[96];
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                const Quote& quote = data.quotes[i % RECORDED_COUNT];
+                double price = quote.price.ToDouble();
+                double previousClose = quote.previousClose.ToDouble();
+                int length = previousClose > 0.0 ?
+                    swprintf(buffer, 96, L"%ls: $%.2f %+.2f%%   ", wideSymbols[i].c_str(), price,
+                        (price - previousClose) / previousClose * 100.0) :
+                    swprintf(buffer, 96, L"%ls: $%.2f   ", wideSymbols[i].c_str(), price);
+                texts[i].assign(buffer, length > 0 ? length : 0);
+            }
+        });
+
+        Bench::Measure("pipeline.layout", { { "symbols", count } }, items, [&] {
+            LayOut(tape);
+        });
+
+        // The mask is what a rasterizer hands the composer; reuse one
+        BitmapFontRasterizer rasterizer(PIPELINE_SCALE);
+        int charWidth = rasterizer.GetCellWidth();
+        const uint32_t* rendered = rasterizer.RenderMask(tape.snapshot.text, 0.0,
+            PIPELINE_WIDTH, PIPELINE_HEIGHT, charWidth);
+        std::vector<uint32_t> mask(rendered, rendered + PIPELINE_WIDTH * PIPELINE_HEIGHT);
+        std::vector<uint32_t> pixels(static_cast<size_t>(PIPELINE_WIDTH) * PIPELINE_HEIGHT);
+        Bench::Measure("pipeline.composite", { { "symbols", count }, { "width", PIPELINE_WIDTH } }, 1, [&] {
+            int blends = FrameComposer::Compose(pixels.data(), mask.data(), PIPELINE_WIDTH, PIPELINE_HEIGHT,
+                tape.snapshot, 0.0, charWidth, g_style, 0);
+            Bench::Keep(blends);
+        });
+
+        // Scroll a pixel per frame, as the render thread does at 60 fps
+        HeadlessRenderer renderer(PIPELINE_WIDTH, PIPELINE_HEIGHT, PIPELINE_SCALE);
+        double offset = 0.0;
+        double cycle = static_cast<double>(tape.snapshot.cycleLength) * renderer.GetCellWidth();
+        Bench::Measure("pipeline.frame", { { "symbols", count }, { "width", PIPELINE_WIDTH } }, 1, [&] {
+            const uint32_t* frame = renderer.RenderFrame(tape.snapshot, offset, g_style, 0);
+            Bench::Keep(frame);
+            offset += 1.0;
+            if (offset >= cycle) offset = 0.0;
+        });
+
+        // One frame timer tick serving several tape windows, each with its
+        // own back buffer; items are frames
+        for (int tapes : { 2, 4 }) {
+            std::vector<std::unique_ptr<HeadlessRenderer>> renderers;
+            for (int i = 0; i < tapes; ++i) {
+                renderers.push_back(std::make_unique<HeadlessRenderer>(PIPELINE_WIDTH, PIPELINE_HEIGHT, PIPELINE_SCALE));
+            }
+            offset = 0.0;
+            Bench::Measure("pipeline.tick", { { "symbols", count }, { "tapes", tapes } }, tapes, [&] {
+                for (auto& tapeRenderer : renderers) {
+                    const uint32_t* frame = tapeRenderer->RenderFrame(tape.snapshot, offset, g_style, 0);
+                    Bench::Keep(frame);
+                }
+                offset += 1.0;
+                if (offset >= cycle) offset = 0.0;
+            });
+        }
+    }
+}
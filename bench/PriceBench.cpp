@@ -0,0 +1,82 @@
+#include "Bench.h"
+#include "Price.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Parsing prices out of their JSON text and formatting them for the tape,
+// against strtod and snprintf("%.*f") as the double-based baseline they
+// replaced. Items are prices.
+
+#define PRICE_COUNT 4096
+
+static std::vector<std::string> PriceTexts() {
+    // Equity, FX, crypto and index style quotes
+    std::mt19937 random(2024);
+    auto next = [&random](unsigned bound) { return static_cast<unsigned>(random() % bound); };
+    std::vector<std::string> texts;
+    char buffer[64];
+    for (int i = 0; i < PRICE_COUNT; ++i) {
+        switch (i % 4) {
+        case 0: snprintf(buffer, sizeof(buffer), "%u.%02u", next(1000), next(100)); break;
+        case 1: snprintf(buffer, sizeof(buffer), "1.%05u", next(100000)); break;
+        case 2: snprintf(buffer, sizeof(buffer), "%u.%06u", 60000 + next(10000), next(1000000)); break;
+        default: snprintf(buffer, sizeof(buffer), "%u.%u", 4000 + next(2000), next(10)); break;
+        }
+        texts.push_back(buffer);
+    }
+    return texts;
+}
+
+BENCH(Prices) {
+    std::vector<std::string> texts = PriceTexts();
+    std::vector<Price> prices(texts.size());
+    std::vector<double> doubles(texts.size());
+    for (size_t i = 0; i < texts.size(); ++i) {
+        Price::Parse(texts[i].data(), texts[i].data() + texts[i].size(), prices[i]);
+        doubles[i] = prices[i].ToDouble();
+    }
+
+    Bench::Measure("price.parse", {}, texts.size(), [&] {
+        Price price;
+        for (const std::string& text : texts) {
+            Price::Parse(text.data(), text.data() + text.size(), price);
+            Bench::Keep(price);
+        }
+    });
+    Bench::Measure("price.parse_strtod", {}, texts.size(), [&] {
+        for (const std::string& text : texts) {
+            double value = strtod(text.c_str(), nullptr);
+            Bench::Keep(value);
+        }
+    });
+
+    char buffer[PRICE_MAX_CHARS];
+    for (int decimals : { 2, 6 }) {
+        Bench::Measure("price.format", { { "decimals", decimals } }, prices.size(), [&] {
+            for (Price price : prices) {
+                char* end = price.Format(buffer, decimals);
+                Bench::Keep(end);
+            }
+        });
+        Bench::Measure("price.format_snprintf", { { "decimals", decimals } }, doubles.size(), [&] {
+            for (double value : doubles) {
+                int length = snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+                Bench::Keep(length);
+            }
+        });
+    }
+
+    Price previous = prices[0];
+    Bench::Measure("price.compare_equal", {}, prices.size(), [&] {
+        int changed = 0;
+        for (Price price : prices) {
+            changed += price != previous;
+            previous = price;
+        }
+        Bench::Keep(changed);
+    });
+}
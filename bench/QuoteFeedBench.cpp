@@ -0,0 +1,118 @@
+#include "Bench.h"
+#include "QuoteConflator.h"
+#include "QuoteFeed.h"
+#include "QuoteFeedReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// The local feed's shared ring under a producer pacing 1,000,000 pushes a
+// second while the tape's reader drains it into the conflator. Reports the
+// time of one push, with the rate the reader sustained and the pushes a
+// full ring refused as parameters, and the consumer's lag: how long the
+// oldest record not yet handed back had been in the ring, sampled every
+// 100 us. The reader hands slots back in batches, so lag includes up to
+// one batch of records.
+
+#define QUOTEFEED_RATE 1000000
+#define QUOTEFEED_SYMBOLS 64
+#define QUOTEFEED_SAMPLE_US 100
+
+typedef std::chrono::steady_clock Clock;
+
+static long long NanosSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+BENCH(QuoteFeedRate) {
+    // Reuse symbols earlier benches interned: the conflator holds only
+    // MAX_SYMBOLS, and records for any other symbol would be skipped
+    char symbols[QUOTEFEED_SYMBOLS][QUOTE_FEED_SYMBOL_BYTES];
+    for (int i = 0; i < QUOTEFEED_SYMBOLS; ++i) {
+        if (i < QuoteConflator::GetSymbolCount()) {
+            snprintf(symbols[i], sizeof(symbols[i]), "%s", QuoteConflator::GetSymbol(i).c_str());
+        }
+        else {
+            snprintf(symbols[i], sizeof(symbols[i]), "QF%d", i);
+            QuoteConflator::Intern(symbols[i]);
+        }
+    }
+    if (!QuoteFeedReader::Start()) {
+        fprintf(stderr, "quotefeed: could not create the ring\n");
+        return;
+    }
+    QuoteFeedProducer producer;
+    if (!QuoteFeedOpen(&producer)) {
+        fprintf(stderr, "quotefeed: could not open the ring\n");
+        QuoteFeedReader::Stop();
+        return;
+    }
+
+    double seconds = Bench::IsQuick() ? 0.1 : 2.0;
+    std::atomic<bool> running(true);
+    std::vector<double> pushNs;
+    unsigned long long published = QuoteFeedReader::GetRecordsPublished();
+    long long dropped = producer.header->dropped;
+    Clock::time_point start = Clock::now();
+
+    std::thread feeder([&] {
+        const long long interval = 1000000000LL / QUOTEFEED_RATE;
+        unsigned long long n = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            if (NanosSince(start) < static_cast<long long>(n) * interval) {
+                std::this_thread::yield();
+                continue;
+            }
+            const char* symbol = symbols[n % QUOTEFEED_SYMBOLS];
+            int64_t price = 100000 + static_cast<int64_t>(n % 1000);
+            if (n % 64 == 0) {
+                Clock::time_point before = Clock::now();
+                QuoteFeedPush(&producer, symbol, price, 2, 100000, 2, n + 1);
+                pushNs.push_back(static_cast<double>(NanosSince(before)));
+            }
+            else {
+                QuoteFeedPush(&producer, symbol, price, 2, 100000, 2, n + 1);
+            }
+            ++n;
+        }
+    });
+
+    // When the head passed each sampled position, to date the oldest
+    // record still in the ring
+    std::vector<std::pair<long long, LONG64>> heads;
+    std::vector<double> lagNs;
+    while (NanosSince(start) < static_cast<long long>(seconds * 1e9)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(QUOTEFEED_SAMPLE_US));
+        LONG64 tail = producer.header->tail;
+        LONG64 head = producer.header->head;
+        long long now = NanosSince(start);
+        heads.emplace_back(now, head);
+
+        double lag = 0.0;
+        if (tail < head) {
+            auto passed = std::upper_bound(heads.begin(), heads.end(), tail,
+                [](LONG64 position, const std::pair<long long, LONG64>& sample) { return position < sample.second; });
+            lag = static_cast<double>(now - passed->first);
+        }
+        lagNs.push_back(lag);
+    }
+    running = false;
+    feeder.join();
+    double elapsed = NanosSince(start) / 1e9;
+
+    published = QuoteFeedReader::GetRecordsPublished() - published;
+    dropped = producer.header->dropped - dropped;
+    long long sustained = static_cast<long long>(published / elapsed);
+    Bench::Report("quotefeed.push", { { "rate", QUOTEFEED_RATE }, { "symbols", QUOTEFEED_SYMBOLS },
+        { "sustained", sustained }, { "dropped", dropped } }, 1, pushNs, elapsed);
+    Bench::Report("quotefeed.consumer_lag", { { "rate", QUOTEFEED_RATE }, { "sustained", sustained } }, 1,
+        lagNs, elapsed);
+
+    QuoteFeedClose(&producer);
+    QuoteFeedReader::Stop();
+}
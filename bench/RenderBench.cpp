@@ -0,0 +1,145 @@
+// Headless render driver: scrolls a tape of synthetic quotes through N
+// frames of HeadlessRenderer, the same FrameComposer path the render thread
+// takes with the GDI mask swapped for a bitmap font, and reports per-frame
+// times. The last frame can be written as a PPM to compare against a golden
+// image.
+//
+//   ticker_render_bench [--frames 600] [--symbols 50] [--width 1920] [--height 32]
+//                       [--scale 2] [--speed 1.5] [--ppm out.ppm]
+//
+// Prints one JSON line on stdout and a summary on stderr.
+
+#include "HeadlessRenderer.h"
+#include "Price.h"
+#include "Sparkline.h"
+#include "TapeModel.h"
+#include "TapeTemplate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+struct Options {
+    int frames = 600;
+    int symbols = 50;
+    int width = 1920;
+    int height = 32;
+    int scale = 2;
+    double speed = 1.5;   // Pixels per frame
+    const char* ppm = nullptr;
+};
+
+static bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* name = argv[i];
+        const char* value = argv[i + 1];
+        if (strcmp(name, "--frames") == 0) options.frames = atoi(value);
+        else if (strcmp(name, "--symbols") == 0) options.symbols = atoi(value);
+        else if (strcmp(name, "--width") == 0) options.width = atoi(value);
+        else if (strcmp(name, "--height") == 0) options.height = atoi(value);
+        else if (strcmp(name, "--scale") == 0) options.scale = atoi(value);
+        else if (strcmp(name, "--speed") == 0) options.speed = atof(value);
+        else if (strcmp(name, "--ppm") == 0) options.ppm = value;
+        else return false;
+    }
+    return argc % 2 == 1 && options.frames > 0 && options.symbols > 0 && options.width > 0 &&
+        options.height > 0 && options.scale > 0;
+}
+
+// A tape of symbols with seeded prices, changes and sparklines; every
+// fourth symbol is flashing
+static void BuildTape(int symbols, int charWidth, TapeSnapshot& snapshot) {
+    std::mt19937 random(20240610);
+    TapeTemplate format;
+    TapeSegment segment;
+    std::vector<float> series;
+    std::vector<SparkPoint> points;
+
+    TapeModel::Begin(snapshot);
+    for (int i = 0; i < symbols; ++i) {
+        char symbol[16];
+        snprintf(symbol, sizeof(symbol), "SYM%d", i);
+        int64_t cents = 1000 + static_cast<int64_t>(random() % 500000);
+        int64_t move = static_cast<int64_t>(random() % 2001) - 1000;
+        Price price = Price::FromUnits(cents, 2);
+        Price previousClose = Price::FromUnits(std::max<int64_t>(1, cents - cents * move / 20000), 2);
+
+        series.clear();
+        float value = static_cast<float>(previousClose.ToDouble());
+        for (int point = 0; point < 78; ++point) {
+            value *= 1.0f + (static_cast<float>(random() % 2001) - 1000.0f) / 250000.0f;
+            series.push_back(value);
+        }
+        auto bitmap = std::make_shared<SparklineBitmap>();
+        Sparkline::Downsample(series.data(), series.size(), Sparkline::PlotWidth(charWidth), points);
+        Sparkline::Rasterize(points, charWidth, *bitmap);
+
+        TapeModel::FormatQuote(format, symbol, price, previousClose, true, segment);
+        TapeModel::Append(snapshot, segment.text, segment.tone, i % 4 == 0, segment.sparkline, bitmap);
+    }
+    TapeModel::Finish(snapshot, ~0ULL);
+}
+
+static double Percentile(const std::vector<double>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--frames 600] [--symbols 50] [--width 1920] [--height 32] "
+            "[--scale 2] [--speed 1.5] [--ppm out.ppm]\n", argv[0]);
+        return 2;
+    }
+
+    HeadlessRenderer renderer(options.width, options.height, options.scale);
+    TapeSnapshot snapshot;
+    BuildTape(options.symbols, renderer.GetCellWidth(), snapshot);
+    const FrameStyle style = { 0xFFFFFF, 0x00FF00, 0xFF4040, 0xFFFF00, 0x000000, 200, 24 };
+
+    double cycle = static_cast<double>(snapshot.cycleLength) * renderer.GetCellWidth();
+    double offset = 0.0;
+    long long drawCalls = 0;
+    std::vector<double> frameNs;
+    frameNs.reserve(options.frames);
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < options.frames; ++frame) {
+        Clock::time_point frameStart = Clock::now();
+        renderer.RenderFrame(snapshot, offset, style, 0);
+        frameNs.push_back(std::chrono::duration<double, std::nano>(Clock::now() - frameStart).count());
+
+        drawCalls += renderer.GetLastFrameDrawCalls();
+        offset += options.speed;
+        if (offset >= cycle) offset -= cycle;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> sorted = frameNs;
+    std::sort(sorted.begin(), sorted.end());
+    double p50 = Percentile(sorted, 0.50);
+    double p99 = Percentile(sorted, 0.99);
+    double drawCallsPerFrame = static_cast<double>(drawCalls) / options.frames;
+
+    printf("{\"bench\":\"render.frame\",\"frames\":%d,\"symbols\":%d,\"width\":%d,\"height\":%d,\"scale\":%d,"
+        "\"p50_ns\":%.1f,\"p99_ns\":%.1f,\"max_ns\":%.1f,\"fps\":%.1f,\"draw_calls\":%.1f}\n",
+        options.frames, options.symbols, options.width, options.height, options.scale,
+        p50, p99, sorted.back(), options.frames / seconds, drawCallsPerFrame);
+    fprintf(stderr, "%d frames of %dx%d, %d symbols: p50 %.1f us, p99 %.1f us, max %.1f us, %.0f fps, "
+        "%.1f draw calls per frame\n", options.frames, options.width, options.height, options.symbols,
+        p50 / 1000.0, p99 / 1000.0, sorted.back() / 1000.0, options.frames / seconds, drawCallsPerFrame);
+
+    if (options.ppm && !renderer.WritePpm(options.ppm)) {
+        fprintf(stderr, "cannot write %s\n", options.ppm);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "Bench.h"
+#include "Sparkline.h"
+
+#include <random>
+#include <vector>
+
+// Downsampling a symbol's intraday series to the sparkline's width, alone
+// and with rasterizing (sparkline.build), which the render thread does once
+// per changed series. 78 points is a trading day of five minute bars, 390
+// of one minute bars and 1440 a day of crypto minutes. Items are input
+// points. sparkline.refresh is what a fetch pass costs the render thread
+// with 1000 symbols on the tapes: every symbol's own series is published
+// with a new bar, drained, read back, downsampled and rasterized into its
+// own cached bitmap. Its time is per refresh and its items are series.
+
+#define SPARKLINE_CHAR_WIDTH 16   // Cell width at 2x scale
+#define REFRESH_SERIES 1000
+#define REFRESH_POINTS 390
+
+BENCH(Sparklines) {
+    std::mt19937 random(45);
+    std::vector<SparkPoint> points;
+    SparklineBitmap bitmap;
+    const size_t threshold = static_cast<size_t>(Sparkline::PlotWidth(SPARKLINE_CHAR_WIDTH));
+
+    for (int count : { 78, 390, 1440 }) {
+        std::vector<float> values;
+        float value = 100.0f;
+        for (int i = 0; i < count; ++i) {
+            value += (static_cast<float>(random() % 2001) - 1000.0f) / 1000.0f;
+            values.push_back(value);
+        }
+
+        Bench::Measure("sparkline.downsample", { { "points", count }, { "threshold", static_cast<long long>(threshold) } },
+            values.size(), [&] {
+            Sparkline::Downsample(values.data(), values.size(), threshold, points);
+            Bench::Keep(points.back());
+        });
+        Bench::Measure("sparkline.build", { { "points", count }, { "char_width", SPARKLINE_CHAR_WIDTH } },
+            values.size(), [&] {
+            Sparkline::Downsample(values.data(), values.size(), threshold, points);
+            Sparkline::Rasterize(points, SPARKLINE_CHAR_WIDTH, bitmap);
+            Bench::Keep(bitmap.mask[0]);
+        });
+    }
+
+    // One random walk per symbol; each refresh appends a bar to all of them
+    std::vector<std::vector<float>> series(REFRESH_SERIES);
+    for (std::vector<float>& values : series) {
+        float value = 100.0f;
+        for (int i = 0; i < REFRESH_POINTS; ++i) {
+            value += (static_cast<float>(random() % 2001) - 1000.0f) / 1000.0f;
+            values.push_back(value);
+        }
+    }
+    std::vector<SparklineBitmap> bitmaps(REFRESH_SERIES);
+    std::vector<int> changed;
+    std::vector<float> read;
+    Bench::Measure("sparkline.refresh", { { "series", REFRESH_SERIES }, { "points", REFRESH_POINTS },
+        { "char_width", SPARKLINE_CHAR_WIDTH } }, REFRESH_SERIES, [&] {
+        for (int id = 0; id < REFRESH_SERIES; ++id) {
+            std::vector<float>& values = series[id];
+            values.push_back(values.back() + (static_cast<float>(random() % 2001) - 1000.0f) / 1000.0f);
+            values.erase(values.begin());
+            Sparkline::Publish(id, values);
+        }
+        changed.clear();
+        Sparkline::Drain(changed);
+        for (int id : changed) {
+            Sparkline::Read(id, read);
+            Sparkline::Downsample(read.data(), read.size(), threshold, points);
+            Sparkline::Rasterize(points, SPARKLINE_CHAR_WIDTH, bitmaps[id]);
+        }
+        Bench::Keep(bitmaps.back().mask[0]);
+    });
+}
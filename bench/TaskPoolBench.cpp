@@ -0,0 +1,57 @@
+#include "Bench.h"
+#include "ApiFetcher.h"
+#include "Sparkline.h"
+#include "TaskPool.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// A replayed fetch/parse cycle over a 10,000 symbol watchlist spread with
+// ParallelFor on pools of 1, 2, 4 and 8 threads: each symbol's recorded
+// response is copied into its receive buffer as a fetch would leave it,
+// then its quote and intraday series are parsed and the series is
+// downsampled for its sparkline. Items are symbols.
+
+#define CYCLE_SYMBOLS 10000
+#define CYCLE_GRAIN 64
+#define CYCLE_PLOT_WIDTH 60
+
+static const char* const g_cycleRecorded[] = { "aapl", "msft", "gspc", "btc-usd", "eurusd", "gc" };
+#define CYCLE_RECORDED (sizeof(g_cycleRecorded) / sizeof(g_cycleRecorded[0]))
+
+// One symbol's buffers, kept from cycle to cycle as the engine keeps them
+struct CycleSlot {
+    std::string body;
+    std::vector<float> series;
+    std::vector<SparkPoint> points;
+    Quote quote;
+};
+
+BENCH(TaskPoolScaling) {
+    std::vector<std::string> recorded;
+    for (const char* name : g_cycleRecorded) {
+        std::string path = std::string(BENCH_DATA_DIR) + "/" + name + ".json";
+        std::ifstream file(path, std::ios::binary);
+        recorded.emplace_back((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (recorded.back().empty()) fprintf(stderr, "missing recorded response %s\n", path.c_str());
+    }
+
+    std::vector<CycleSlot> slots(CYCLE_SYMBOLS);
+    for (unsigned threads : { 1u, 2u, 4u, 8u }) {
+        TaskPool pool(threads);
+        Bench::Measure("taskpool.cycle", { { "symbols", CYCLE_SYMBOLS }, { "threads", threads } }, CYCLE_SYMBOLS, [&] {
+            pool.ParallelFor(0, slots.size(), CYCLE_GRAIN, [&](size_t i) {
+                CycleSlot& slot = slots[i];
+                slot.body = recorded[i % CYCLE_RECORDED];
+                slot.quote = ApiFetcher::ParseQuote(slot.body);
+                if (ApiFetcher::ParseSeries(slot.body, slot.series)) {
+                    Sparkline::Downsample(slot.series.data(), slot.series.size(), CYCLE_PLOT_WIDTH, slot.points);
+                }
+            });
+            Bench::Keep(slots.back().quote);
+        });
+    }
+}
@@ -0,0 +1,113 @@
+#include "Bench.h"
+#include "TapeModel.h"
+#include "TapeTemplate.h"
+#include "Utf8.h"
+
+#include <cstdio>
+#include <cwchar>
+#include <random>
+#include <string>
+#include <vector>
+
+// UTF-8 against UTF-16 core text on a 5000 symbol watchlist: copying the
+// watchlist, formatting every symbol's tape segment (the template into
+// UTF-8, and the swprintf layout into UTF-16 that it replaced), and
+// widening the UTF-8 segments for GDI, the one conversion left at the
+// edge. The bytes parameter is the memory the strings hold: the vector,
+// the string objects and any heap blocks, so text short enough for the
+// small-string buffer costs only its object. Items are symbols.
+
+#define TEXT_SYMBOLS 5000
+
+// Heap blocks carry one terminator beyond the capacity
+template <typename String>
+static long long Footprint(const std::vector<String>& strings) {
+    size_t bytes = strings.capacity() * sizeof(String);
+    for (const String& text : strings) {
+        const char* data = reinterpret_cast<const char*>(text.data());
+        const char* object = reinterpret_cast<const char*>(&text);
+        if (data < object || data >= object + sizeof(String)) {
+            bytes += (text.capacity() + 1) * sizeof(typename String::value_type);
+        }
+    }
+    return static_cast<long long>(bytes);
+}
+
+// Symbols of every kind the template treats differently, of typical length
+static std::vector<std::string> MakeWatchlist() {
+    static const char* const patterns[] = { "Q%d", "N%d.SW", "^I%d", "C%d-USD", "F%dUSD=X", "G%d=F" };
+    std::vector<std::string> symbols;
+    char buffer[32];
+    for (int i = 0; i < TEXT_SYMBOLS; ++i) {
+        snprintf(buffer, sizeof(buffer), patterns[i % 6], i);
+        symbols.push_back(buffer);
+    }
+    return symbols;
+}
+
+BENCH(Utf8Text) {
+    const std::vector<std::string> symbols = MakeWatchlist();
+    std::vector<std::wstring> wideSymbols;
+    for (const std::string& symbol : symbols) wideSymbols.push_back(Utf8::ToWide(symbol));
+
+    std::mt19937 random(44);
+    std::vector<Price> prices;
+    std::vector<Price> previousCloses;
+    for (int i = 0; i < TEXT_SYMBOLS; ++i) {
+        int64_t cents = 100 + static_cast<int64_t>(random() % 5000000);
+        prices.push_back(Price::FromUnits(cents, 2));
+        previousCloses.push_back(Price::FromUnits(cents + static_cast<int64_t>(random() % 201) - 100, 2));
+    }
+
+    std::vector<std::string> symbolsCopy;
+    Bench::Measure("text.symbols_copy", { { "symbols", TEXT_SYMBOLS }, { "utf16", 0 },
+        { "bytes", Footprint(symbols) } }, TEXT_SYMBOLS, [&] {
+        symbolsCopy = symbols;
+        Bench::Keep(symbolsCopy.back());
+        symbolsCopy.clear();
+        symbolsCopy.shrink_to_fit();
+    });
+    std::vector<std::wstring> wideSymbolsCopy;
+    Bench::Measure("text.symbols_copy", { { "symbols", TEXT_SYMBOLS }, { "utf16", 1 },
+        { "bytes", Footprint(wideSymbols) } }, TEXT_SYMBOLS, [&] {
+        wideSymbolsCopy = wideSymbols;
+        Bench::Keep(wideSymbolsCopy.back());
+        wideSymbolsCopy.clear();
+        wideSymbolsCopy.shrink_to_fit();
+    });
+
+    TapeTemplate format;
+    std::vector<TapeSegment> segments(TEXT_SYMBOLS);
+    auto formatUtf8 = [&] {
+        for (size_t i = 0; i < segments.size(); ++i) {
+            TapeModel::FormatQuote(format, symbols[i], prices[i], previousCloses[i], false, segments[i]);
+        }
+    };
+    formatUtf8();
+    std::vector<std::string> texts;
+    for (const TapeSegment& segment : segments) texts.push_back(segment.text);
+    Bench::Measure("text.format", { { "symbols", TEXT_SYMBOLS }, { "utf16", 0 },
+        { "bytes", Footprint(texts) } }, TEXT_SYMBOLS, formatUtf8);
+
+    std::vector<std::wstring> wideTexts(TEXT_SYMBOLS);
+    auto formatUtf16 = [&] {
+        wchar_t buffer[96];
+        for (size_t i = 0; i < wideTexts.size(); ++i) {
+            double price = prices[i].ToDouble();
+            double previousClose = previousCloses[i].ToDouble();
+            int length = swprintf(buffer, 96, L"%ls: $%.2f %+.2f%%   ", wideSymbols[i].c_str(), price,
+                (price - previousClose) / previousClose * 100.0);
+            wideTexts[i].assign(buffer, length > 0 ? length : 0);
+        }
+    };
+    formatUtf16();
+    Bench::Measure("text.format", { { "symbols", TEXT_SYMBOLS }, { "utf16", 1 },
+        { "bytes", Footprint(wideTexts) } }, TEXT_SYMBOLS, formatUtf16);
+
+    std::wstring tape;
+    Bench::Measure("text.widen", { { "symbols", TEXT_SYMBOLS } }, TEXT_SYMBOLS, [&] {
+        tape.clear();
+        for (const TapeSegment& segment : segments) Utf8::AppendWide(segment.text, tape);
+        Bench::Keep(tape.back());
+    });
+}
@@ -0,0 +1,23 @@
+#include "Bench.h"
+#include "Trace.h"
+
+#include <mutex>
+
+// What tracing adds to the code it covers: an empty TRACE_SCOPE with
+// tracing off and on, and an uncontended TracedLock. Measured here rather
+// than when tracing is turned on, which would stall the UI thread.
+
+BENCH(TraceOverhead) {
+    std::mutex mutex;
+    for (int enabled = 0; enabled <= 1; ++enabled) {
+        Trace::Enable(enabled != 0);
+        Bench::Measure("trace.scope", { { "enabled", enabled } }, 1, [] {
+            TRACE_SCOPE("bench", "scope");
+        });
+        Bench::Measure("trace.lock", { { "enabled", enabled } }, 1, [&] {
+            auto lock = TracedLock(mutex, "bench");
+            Bench::Keep(lock);
+        });
+    }
+    Trace::Enable(false);
+}
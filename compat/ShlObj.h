@@ -0,0 +1,26 @@
+#pragma once
+#ifndef COMPAT_SHLOBJ_H
+#define COMPAT_SHLOBJ_H
+
+// Known folders for ConfigManager on POSIX. There is no roaming profile, so
+// the lookup fails and config.ini falls back to the working directory;
+// tests set ConfigManager::configPath instead.
+
+#include <windows.h>
+
+typedef int32_t HRESULT;
+typedef int KNOWNFOLDERID;
+
+#define SUCCEEDED(hr) (static_cast<HRESULT>(hr) >= 0)
+#define E_FAIL static_cast<HRESULT>(0x80004005u)
+
+static const KNOWNFOLDERID FOLDERID_RoamingAppData = 0;
+
+inline HRESULT SHGetKnownFolderPath(KNOWNFOLDERID, DWORD, HANDLE, wchar_t** path) {
+    *path = nullptr;
+    return E_FAIL;
+}
+
+inline void CoTaskMemFree(void*) {}
+
+#endif
@@ -0,0 +1,563 @@
+#pragma once
+#ifndef COMPAT_WINDOWS_H
+#define COMPAT_WINDOWS_H
+
+// The slice of <windows.h> the portable modules use, on POSIX, so the core,
+// benches and tests build with CMake on Linux. CMakeLists.txt puts this
+// directory on the include path only when not building for Windows.
+// Semantics follow Win32 where the callers depend on them: LONG is 32-bit
+// so the shared-memory layouts match, wide strings hold UTF-16 units, and
+// named mappings and events are shared within the process only.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+typedef int BOOL;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef int64_t LONG64;
+typedef int64_t LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef uint16_t WORD;
+typedef unsigned int UINT;
+typedef void* HANDLE;
+typedef void* LPVOID;
+typedef uintptr_t DWORD_PTR;
+typedef const wchar_t* LPCWSTR;
+
+#define CALLBACK
+
+#define TRUE 1
+#define FALSE 0
+#define INFINITE 0xFFFFFFFFu
+#define WAIT_OBJECT_0 0u
+#define WAIT_TIMEOUT 258u
+#define WAIT_FAILED 0xFFFFFFFFu
+#define ERROR_ALREADY_EXISTS 183u
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(-1))
+#define CP_UTF8 65001u
+#define PAGE_READWRITE 0x04u
+#define FILE_MAP_WRITE 0x02u
+#define FILE_MAP_READ 0x04u
+#define EVENT_MODIFY_STATE 0x02u
+#define MOVEFILE_REPLACE_EXISTING 0x01u
+
+typedef union _LARGE_INTEGER {
+    struct {
+        DWORD LowPart;
+        LONG HighPart;
+    };
+    LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct _FILETIME {
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+} FILETIME;
+
+typedef struct _SYSTEMTIME {
+    WORD wYear;
+    WORD wMonth;
+    WORD wDayOfWeek;
+    WORD wDay;
+    WORD wHour;
+    WORD wMinute;
+    WORD wSecond;
+    WORD wMilliseconds;
+} SYSTEMTIME;
+
+namespace compat {
+
+inline DWORD& LastError() {
+    static thread_local DWORD error = 0;
+    return error;
+}
+
+// FILETIME counts 100 ns from 1601; the Unix epoch is this many later
+#define COMPAT_UNIX_EPOCH_FILETIME 116444736000000000ULL
+
+inline void ToFileTime(uint64_t ticks, FILETIME* time) {
+    time->dwLowDateTime = static_cast<DWORD>(ticks);
+    time->dwHighDateTime = static_cast<DWORD>(ticks >> 32);
+}
+
+// Named kernel objects, shared by the threads of this process
+struct Object {
+    virtual ~Object() = default;
+    std::wstring name;
+    int references = 1;
+};
+
+struct Mapping : Object {
+    char* memory = nullptr;
+    size_t size = 0;
+    ~Mapping() override { ::operator delete[](memory, std::align_val_t(4096)); }
+};
+
+struct Event : Object {
+    bool manualReset = false;
+    bool signaled = false;
+};
+
+struct Objects {
+    std::mutex lock;
+    std::condition_variable signal;   // Any event set
+    std::map<std::wstring, Object*> named;
+    std::map<void*, Mapping*> views;
+};
+
+inline Objects& GetObjects() {
+    static Objects* objects = new Objects();   // Outlives static destructors
+    return *objects;
+}
+
+// objects.lock held
+inline void Release(Objects& objects, Object* object) {
+    if (--object->references > 0) return;
+    if (!object->name.empty()) objects.named.erase(object->name);
+    delete object;
+}
+
+// objects.lock held; consumes an auto-reset event's signal
+inline bool TryAcquire(Object* object) {
+    Event* event = dynamic_cast<Event*>(object);
+    if (!event || !event->signaled) return false;
+    if (!event->manualReset) event->signaled = false;
+    return true;
+}
+
+}
+
+// Time
+
+inline unsigned long long GetTickCount64() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency) {
+    frequency->QuadPart = 1000000000LL;
+    return TRUE;
+}
+
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* counter) {
+    counter->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return TRUE;
+}
+
+inline void GetSystemTimePreciseAsFileTime(FILETIME* time) {
+    auto since = std::chrono::system_clock::now().time_since_epoch();
+    uint64_t ticks = std::chrono::duration_cast<std::chrono::nanoseconds>(since).count() / 100;
+    compat::ToFileTime(ticks + COMPAT_UNIX_EPOCH_FILETIME, time);
+}
+
+inline void GetSystemTimeAsFileTime(FILETIME* time) {
+    GetSystemTimePreciseAsFileTime(time);
+}
+
+inline BOOL FileTimeToSystemTime(const FILETIME* fileTime, SYSTEMTIME* systemTime) {
+    uint64_t ticks = (static_cast<uint64_t>(fileTime->dwHighDateTime) << 32) | fileTime->dwLowDateTime;
+    if (ticks < COMPAT_UNIX_EPOCH_FILETIME) return FALSE;
+    ticks -= COMPAT_UNIX_EPOCH_FILETIME;
+
+    time_t seconds = static_cast<time_t>(ticks / 10000000);
+    struct tm utc;
+    if (!gmtime_r(&seconds, &utc)) return FALSE;
+    systemTime->wYear = static_cast<WORD>(utc.tm_year + 1900);
+    systemTime->wMonth = static_cast<WORD>(utc.tm_mon + 1);
+    systemTime->wDayOfWeek = static_cast<WORD>(utc.tm_wday);
+    systemTime->wDay = static_cast<WORD>(utc.tm_mday);
+    systemTime->wHour = static_cast<WORD>(utc.tm_hour);
+    systemTime->wMinute = static_cast<WORD>(utc.tm_min);
+    systemTime->wSecond = static_cast<WORD>(utc.tm_sec);
+    systemTime->wMilliseconds = static_cast<WORD>(ticks / 10000 % 1000);
+    return TRUE;
+}
+
+// Processes and threads
+
+inline HANDLE GetCurrentProcess() {
+    return reinterpret_cast<HANDLE>(-1);
+}
+
+// Process creation time is not available; callers skip the loader time
+inline BOOL GetProcessTimes(HANDLE, FILETIME*, FILETIME*, FILETIME*, FILETIME*) {
+    return FALSE;
+}
+
+inline DWORD GetCurrentProcessId() {
+    return static_cast<DWORD>(getpid());
+}
+
+inline DWORD GetCurrentThreadId() {
+    return static_cast<DWORD>(syscall(SYS_gettid));
+}
+
+inline void Sleep(DWORD milliseconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+inline BOOL SwitchToThread() {
+    return sched_yield() == 0;
+}
+
+inline void YieldProcessor() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+inline BOOL IsDebuggerPresent() {
+    return FALSE;
+}
+
+inline void OutputDebugStringA(const char*) {}
+
+inline DWORD GetLastError() {
+    return compat::LastError();
+}
+
+// Files
+
+inline int _wtoi(const wchar_t* text) {
+    return static_cast<int>(wcstol(text, nullptr, 10));
+}
+
+inline double _wtof(const wchar_t* text) {
+    return wcstod(text, nullptr);
+}
+
+inline BOOL MoveFileExW(const wchar_t* from, const wchar_t* to, DWORD) {
+    std::error_code error;
+    std::filesystem::rename(std::filesystem::path(from), std::filesystem::path(to), error);
+    compat::LastError() = static_cast<DWORD>(error.value());
+    return !error;
+}
+
+// Interlocked operations: full barriers, as on Windows
+
+inline LONG InterlockedExchange(volatile LONG* target, LONG value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+inline LONG InterlockedCompareExchange(volatile LONG* target, LONG exchange, LONG comparand) {
+    __atomic_compare_exchange_n(target, &comparand, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return comparand;
+}
+
+inline LONG InterlockedIncrement(volatile LONG* target) {
+    return __atomic_add_fetch(target, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONG64 InterlockedExchange64(volatile LONG64* target, LONG64 value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+inline LONG64 InterlockedCompareExchange64(volatile LONG64* target, LONG64 exchange, LONG64 comparand) {
+    __atomic_compare_exchange_n(target, &comparand, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return comparand;
+}
+
+inline LONG64 InterlockedIncrement64(volatile LONG64* target) {
+    return __atomic_add_fetch(target, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONG ReadAcquire(const volatile LONG* source) {
+    return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+}
+
+inline LONG ReadNoFence(const volatile LONG* source) {
+    return __atomic_load_n(source, __ATOMIC_RELAXED);
+}
+
+inline void WriteRelease(volatile LONG* target, LONG value) {
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+}
+
+inline LONG64 ReadAcquire64(const volatile LONG64* source) {
+    return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+}
+
+inline void WriteRelease64(volatile LONG64* target, LONG64 value) {
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+}
+
+inline void MemoryBarrier() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+// UTF-8 <-> UTF-16 with the Win32 contract: lengths in units, -1 for a
+// NUL-terminated source, a null or empty destination asks for the size,
+// invalid input becomes U+FFFD. Wide strings hold UTF-16 units even where
+// wchar_t is 32 bits, as the callers size their buffers by that.
+
+inline int MultiByteToWideChar(UINT, DWORD, const char* text, int length, wchar_t* out, int capacity) {
+    if (length < 0) length = static_cast<int>(strlen(text)) + 1;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text);
+    int written = 0;
+    auto put = [&](uint32_t unit) {
+        if (out && capacity > 0 && written < capacity) out[written] = static_cast<wchar_t>(unit);
+        ++written;
+    };
+
+    for (int i = 0; i < length;) {
+        uint32_t lead = bytes[i];
+        int extra = lead < 0x80 ? 0 : lead >= 0xC2 && lead < 0xE0 ? 1 : lead >= 0xE0 && lead < 0xF0 ? 2 :
+            lead >= 0xF0 && lead < 0xF5 ? 3 : -1;
+        if (extra < 0) {
+            put(0xFFFD);
+            ++i;
+            continue;
+        }
+
+        // A sequence cut short by a bad byte or the end is one U+FFFD
+        uint32_t code = extra == 0 ? lead : lead & (0x3F >> extra);
+        int available = std::min(extra, length - i - 1);
+        int used = 1;
+        for (; used <= available; ++used) {
+            if ((bytes[i + used] & 0xC0) != 0x80) break;
+            code = (code << 6) | (bytes[i + used] & 0x3F);
+        }
+        static const uint32_t minimum[4] = { 0, 0x80, 0x800, 0x10000 };
+        if (used <= extra || code < minimum[extra] || code > 0x10FFFF || (code >= 0xD800 && code < 0xE000)) {
+            put(0xFFFD);
+            i += used <= extra ? used : extra + 1;
+            continue;
+        }
+
+        if (code >= 0x10000) {
+            put(0xD800 + ((code - 0x10000) >> 10));
+            put(0xDC00 + ((code - 0x10000) & 0x3FF));
+        }
+        else {
+            put(code);
+        }
+        i += extra + 1;
+    }
+
+    if (out && capacity > 0 && written > capacity) {
+        compat::LastError() = 122;   // ERROR_INSUFFICIENT_BUFFER
+        return 0;
+    }
+    return written;
+}
+
+inline int WideCharToMultiByte(UINT, DWORD, const wchar_t* text, int length, char* out, int capacity,
+    const char*, BOOL*) {
+    if (length < 0) {
+        length = 0;
+        while (text[length]) ++length;
+        ++length;
+    }
+    int written = 0;
+    auto put = [&](uint32_t byte) {
+        if (out && capacity > 0 && written < capacity) out[written] = static_cast<char>(byte);
+        ++written;
+    };
+
+    for (int i = 0; i < length; ++i) {
+        uint32_t code = static_cast<uint32_t>(text[i]) & 0xFFFF;
+        if (code >= 0xD800 && code < 0xDC00 && i + 1 < length &&
+            (static_cast<uint32_t>(text[i + 1]) & 0xFC00) == 0xDC00) {
+            code = 0x10000 + ((code - 0xD800) << 10) + ((static_cast<uint32_t>(text[i + 1]) & 0xFFFF) - 0xDC00);
+            ++i;
+        }
+        else if (code >= 0xD800 && code < 0xE000) {
+            code = 0xFFFD;
+        }
+
+        if (code < 0x80) {
+            put(code);
+        }
+        else if (code < 0x800) {
+            put(0xC0 | (code >> 6));
+            put(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000) {
+            put(0xE0 | (code >> 12));
+            put(0x80 | ((code >> 6) & 0x3F));
+            put(0x80 | (code & 0x3F));
+        }
+        else {
+            put(0xF0 | (code >> 18));
+            put(0x80 | ((code >> 12) & 0x3F));
+            put(0x80 | ((code >> 6) & 0x3F));
+            put(0x80 | (code & 0x3F));
+        }
+    }
+
+    if (out && capacity > 0 && written > capacity) {
+        compat::LastError() = 122;   // ERROR_INSUFFICIENT_BUFFER
+        return 0;
+    }
+    return written;
+}
+
+// Named file mappings: zeroed memory, shared by name within the process
+
+inline HANDLE CreateFileMappingW(HANDLE, void*, DWORD, DWORD sizeHigh, DWORD sizeLow, const wchar_t* name) {
+    compat::Objects& objects = compat::GetObjects();
+    std::lock_guard<std::mutex> hold(objects.lock);
+    compat::LastError() = 0;
+    if (name) {
+        auto found = objects.named.find(name);
+        if (found != objects.named.end()) {
+            compat::Mapping* existing = dynamic_cast<compat::Mapping*>(found->second);
+            if (!existing) return nullptr;
+            ++existing->references;
+            compat::LastError() = ERROR_ALREADY_EXISTS;
+            return existing;
+        }
+    }
+
+    compat::Mapping* mapping = new compat::Mapping();
+    mapping->size = (static_cast<size_t>(sizeHigh) << 32) | sizeLow;
+    mapping->memory = static_cast<char*>(::operator new[](mapping->size, std::align_val_t(4096)));
+    memset(mapping->memory, 0, mapping->size);
+    if (name) {
+        mapping->name = name;
+        objects.named[name] = mapping;
+    }
+    return mapping;
+}
+
+inline HANDLE OpenFileMappingW(DWORD, BOOL, const wchar_t* name) {
+    compat::Objects& objects = compat::GetObjects();
+    std::lock_guard<std::mutex> hold(objects.lock);
+    auto found = objects.named.find(name);
+    compat::Mapping* mapping = found != objects.named.end() ? dynamic_cast<compat::Mapping*>(found->second) : nullptr;
+    if (mapping) ++mapping->references;
+    return mapping;
+}
+
+inline void* MapViewOfFile(HANDLE handle, DWORD, DWORD, DWORD offset, size_t bytes) {
+    compat::Objects& objects = compat::GetObjects();
+    std::lock_guard<std::mutex> hold(objects.lock);
+    compat::Mapping* mapping = dynamic_cast<compat::Mapping*>(static_cast<compat::Object*>(handle));
+    if (!mapping || offset + bytes > mapping->size) return nullptr;
+    ++mapping->references;
+    objects.views[mapping->memory + offset] = mapping;
+    return mapping->memory + offset;
+}
+
+inline BOOL UnmapViewOfFile(const volatile void* view) {
+    compat::Objects& objects = compat::GetObjects();
+    std::lock_guard<std::mutex> hold(objects.lock);
+    auto found = objects.views.find(const_cast<void*>(view));
+    if (found == objects.views.end()) return FALSE;
+    compat::Mapping* mapping = found->second;
+    objects.views.erase(found);
+    compat::Release(objects, mapping);
+    return TRUE;
+}
+
+// Events, named or not
+
+inline HANDLE CreateEventW(void*, BOOL manualReset, BOOL initialState, const wchar_t* name) {
+    compat::Objects& objects = compat::GetObjects();
+    std::lock_guard<std::mutex> hold(objects.lock);
+    compat::LastError() = 0;
+    if (name) {
+        auto found = objects.named.find(name);
+        if (found != objects.named.end()) {
+            compat::Event* existing = dynamic_cast<compat::Event*>(found->second);
+            if (!existing) return nullptr;
+            ++existing->references;
+            compat::LastError() = ERROR_ALREADY_EXISTS;
+            return existing;
+        }
+    }
+
+    compat::Event* event = new compat::Event();
+    event->manualReset = manualReset != FALSE;
+    event->signaled = initialState != FALSE;
+    if (name) {
+        event->name = name;
+        objects.named[name] = event;
+    }
+    return event;
+}
+
+inline HANDLE OpenEventW(DWORD, BOOL, const wchar_t* name) {
+    compat::Objects& objects = compat::GetObjects();
+    std::lock_guard<std::mutex> hold(objects.lock);
+    auto found = objects.named.find(name);
+    compat::Event* event = found != objects.named.end() ? dynamic_cast<compat::Event*>(found->second) : nullptr;
+    if (event) ++event->references;
+    return event;
+}
+
+inline BOOL SetEvent(HANDLE handle) {
+    compat::Objects& objects = compat::GetObjects();
+    {
+        std::lock_guard<std::mutex> hold(objects.lock);
+        compat::Event* event = dynamic_cast<compat::Event*>(static_cast<compat::Object*>(handle));
+        if (!event) return FALSE;
+        event->signaled = true;
+    }
+    objects.signal.notify_all();
+    return TRUE;
+}
+
+inline BOOL ResetEvent(HANDLE handle) {
+    compat::Objects& objects = compat::GetObjects();
+    std::lock_guard<std::mutex> hold(objects.lock);
+    compat::Event* event = dynamic_cast<compat::Event*>(static_cast<compat::Object*>(handle));
+    if (!event) return FALSE;
+    event->signaled = false;
+    return TRUE;
+}
+
+// Wait for any one of the events (waitAll is not supported)
+inline DWORD WaitForMultipleObjects(DWORD count, const HANDLE* handles, BOOL, DWORD milliseconds) {
+    compat::Objects& objects = compat::GetObjects();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+    std::unique_lock<std::mutex> hold(objects.lock);
+    for (;;) {
+        for (DWORD i = 0; i < count; ++i) {
+            if (compat::TryAcquire(static_cast<compat::Object*>(handles[i]))) return WAIT_OBJECT_0 + i;
+        }
+        if (milliseconds == INFINITE) objects.signal.wait(hold);
+        else if (objects.signal.wait_until(hold, deadline) == std::cv_status::timeout) {
+            for (DWORD i = 0; i < count; ++i) {
+                if (compat::TryAcquire(static_cast<compat::Object*>(handles[i]))) return WAIT_OBJECT_0 + i;
+            }
+            return WAIT_TIMEOUT;
+        }
+    }
+}
+
+inline DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds) {
+    return WaitForMultipleObjects(1, &handle, FALSE, milliseconds);
+}
+
+inline BOOL CloseHandle(HANDLE handle) {
+    if (!handle || handle == INVALID_HANDLE_VALUE) return FALSE;
+    compat::Objects& objects = compat::GetObjects();
+    std::lock_guard<std::mutex> hold(objects.lock);
+    compat::Release(objects, static_cast<compat::Object*>(handle));
+    return TRUE;
+}
+
+#endif
@@ -0,0 +1,730 @@
+#pragma once
+#ifndef COMPAT_WINHTTP_H
+#define COMPAT_WINHTTP_H
+
+// The slice of WinHTTP's async mode HttpClient uses, over plain sockets, so
+// the quote engine runs against a local server on POSIX. One I/O thread
+// drives every request: it polls the sockets of all operations in
+// progress, advances each without blocking and delivers progress and
+// completions through the status callback, as WinHTTP's threads do, so
+// any number of requests in flight cost that one thread. Closing a request
+// abandons its pending operation, and HANDLE_CLOSING is always its last
+// callback. Plain HTTP/1.1 only, one connection per request and bodies
+// sized by Content-Length or the end of the connection: there is no TLS,
+// so secure requests fail. A connection handle's host is looked up once,
+// on the I/O thread, by its first request.
+
+#include <windows.h>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+typedef void* HINTERNET;
+typedef WORD INTERNET_PORT;
+typedef void (CALLBACK* WINHTTP_STATUS_CALLBACK)(HINTERNET, DWORD_PTR, DWORD, LPVOID, DWORD);
+
+typedef struct _WINHTTP_ASYNC_RESULT {
+    DWORD_PTR dwResult;   // API_* call that failed
+    DWORD dwError;
+} WINHTTP_ASYNC_RESULT;
+
+#define WINHTTP_ACCESS_TYPE_DEFAULT_PROXY 0u
+#define WINHTTP_NO_PROXY_NAME nullptr
+#define WINHTTP_NO_PROXY_BYPASS nullptr
+#define WINHTTP_NO_REFERER nullptr
+#define WINHTTP_DEFAULT_ACCEPT_TYPES nullptr
+#define WINHTTP_NO_ADDITIONAL_HEADERS nullptr
+#define WINHTTP_NO_REQUEST_DATA nullptr
+#define WINHTTP_HEADER_NAME_BY_INDEX nullptr
+#define WINHTTP_NO_HEADER_INDEX nullptr
+
+#define WINHTTP_FLAG_ASYNC 0x10000000u
+#define WINHTTP_FLAG_SECURE 0x00800000u
+#define WINHTTP_ADDREQ_FLAG_ADD 0x20000000u
+#define WINHTTP_QUERY_STATUS_CODE 19u
+#define WINHTTP_QUERY_FLAG_NUMBER 0x20000000u
+#define WINHTTP_OPTION_CONTEXT_VALUE 45u
+#define WINHTTP_OPTION_MAX_CONNS_PER_SERVER 73u
+
+#define WINHTTP_CALLBACK_STATUS_NAME_RESOLVED 0x00000002u
+#define WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER 0x00000008u
+#define WINHTTP_CALLBACK_STATUS_SENDING_REQUEST 0x00000010u
+#define WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING 0x00000800u
+#define WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE 0x00020000u
+#define WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE 0x00040000u
+#define WINHTTP_CALLBACK_STATUS_READ_COMPLETE 0x00080000u
+#define WINHTTP_CALLBACK_STATUS_REQUEST_ERROR 0x00200000u
+#define WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE 0x00400000u
+
+// A status is delivered when its own bit is in the callback's flags
+#define WINHTTP_CALLBACK_FLAG_RESOLVE_NAME 0x00000003u
+#define WINHTTP_CALLBACK_FLAG_CONNECT_TO_SERVER 0x0000000Cu
+#define WINHTTP_CALLBACK_FLAG_SEND_REQUEST 0x00000030u
+#define WINHTTP_CALLBACK_FLAG_HANDLES 0x00000C00u
+#define WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS 0x007E0000u
+
+#define API_RECEIVE_RESPONSE 1u
+#define API_QUERY_DATA_AVAILABLE 2u
+#define API_READ_DATA 3u
+#define API_SEND_REQUEST 5u
+
+#define ERROR_WINHTTP_TIMEOUT 12002u
+#define ERROR_WINHTTP_NAME_NOT_RESOLVED 12007u
+#define ERROR_WINHTTP_OPERATION_CANCELLED 12017u
+#define ERROR_WINHTTP_INCORRECT_HANDLE_STATE 12019u
+#define ERROR_WINHTTP_CONNECTION_ERROR 12030u
+#define ERROR_WINHTTP_CANNOT_CONNECT 12029u
+#define ERROR_WINHTTP_INVALID_SERVER_RESPONSE 12152u
+#define ERROR_WINHTTP_SECURE_FAILURE 12175u
+
+// Largest read from a socket at once
+#define COMPAT_HTTP_CHUNK 16384
+
+namespace compat {
+
+typedef std::chrono::steady_clock HttpClock;
+
+struct HttpHandle {
+    virtual ~HttpHandle() = default;
+};
+
+struct HttpSession : HttpHandle {
+    std::string agent;
+};
+
+struct HttpAddress {
+    sockaddr_storage address;
+    socklen_t length;
+};
+
+// Where a connection handle's requests go. I/O thread only once a request
+// has been sent.
+struct HttpEndpoint {
+    std::string host;
+    int port = 0;
+    bool resolved = false;
+    DWORD error = 0;
+    std::vector<HttpAddress> addresses;
+};
+
+struct HttpConnection : HttpHandle {
+    std::string agent;
+    std::shared_ptr<HttpEndpoint> endpoint;
+};
+
+enum class HttpOperation { None, Send, Receive, Query, Read };
+
+struct HttpRequest : HttpHandle {
+    std::shared_ptr<HttpEndpoint> endpoint;
+    std::string head;   // Request line and headers, without the blank line
+    bool secure = false;
+
+    WINHTTP_STATUS_CALLBACK callback = nullptr;
+    DWORD notifications = 0;
+    DWORD_PTR context = 0;
+    int connectMs = 60000;
+    int sendMs = 30000;
+    int receiveMs = 30000;
+
+    // Under the loop's lock: the operation the caller started, and whether
+    // the handle was closed
+    HttpOperation operation = HttpOperation::None;
+    void* readBuffer = nullptr;
+    DWORD readSize = 0;
+    std::atomic<bool> closing{ false };
+    bool queued = false;   // In the loop's incoming list
+
+    // I/O thread only
+    bool active = false;   // Its operation is being driven
+    bool ready = false;    // Worth stepping: just started, or its socket polled ready
+    short events = 0;      // What the operation waits for
+    HttpClock::time_point deadline;
+    int socket = -1;
+    size_t address = 0;    // Endpoint address being tried
+    bool connecting = false;
+    bool connected = false;
+    std::string outgoing;
+    size_t sent = 0;
+    std::string received;  // Body bytes received but not read yet
+    DWORD status = 0;
+    unsigned long long bodyLeft = ULLONG_MAX;   // Still to receive; ULLONG_MAX = until the server closes
+
+    ~HttpRequest() override {
+        if (socket >= 0) ::close(socket);
+    }
+};
+
+// How an operation ended, delivered once it is done
+struct HttpCompletion {
+    DWORD status = 0;
+    DWORD bytes = 0;                   // DATA_AVAILABLE size or READ_COMPLETE length
+    void* buffer = nullptr;            // READ_COMPLETE data
+    WINHTTP_ASYNC_RESULT result = {};  // REQUEST_ERROR
+};
+
+// The I/O thread and the requests handed to it
+struct HttpLoop {
+    std::mutex mutex;
+    std::vector<HttpRequest*> incoming;   // Started operations and closes
+    int wake[2] = { -1, -1 };             // Written to end the I/O thread's poll
+    std::vector<HttpRequest*> active;     // I/O thread only
+};
+
+inline HttpCompletion HttpFailed(DWORD api, DWORD error) {
+    HttpCompletion done;
+    done.status = WINHTTP_CALLBACK_STATUS_REQUEST_ERROR;
+    done.result.dwResult = api;
+    done.result.dwError = error;
+    return done;
+}
+
+inline HttpCompletion HttpDone(DWORD status, DWORD bytes = 0) {
+    HttpCompletion done;
+    done.status = status;
+    done.bytes = bytes;
+    return done;
+}
+
+inline DWORD HttpApiOf(HttpOperation operation) {
+    switch (operation) {
+    case HttpOperation::Send: return API_SEND_REQUEST;
+    case HttpOperation::Receive: return API_RECEIVE_RESPONSE;
+    case HttpOperation::Query: return API_QUERY_DATA_AVAILABLE;
+    default: return API_READ_DATA;
+    }
+}
+
+// Handles are HttpHandle pointers
+inline HINTERNET HttpHandleOf(HttpHandle* object) {
+    return object;
+}
+
+inline HttpRequest* HttpRequestOf(HINTERNET handle) {
+    return dynamic_cast<HttpRequest*>(static_cast<HttpHandle*>(handle));
+}
+
+// URLs, hosts and headers are ASCII
+inline std::string HttpNarrow(const wchar_t* text, size_t length = SIZE_MAX) {
+    std::string narrow;
+    for (size_t i = 0; i < length && text && text[i]; ++i) {
+        narrow += text[i] < 0x80 ? static_cast<char>(text[i]) : '?';
+    }
+    return narrow;
+}
+
+inline void HttpNotify(HttpRequest* request, DWORD status, void* info, DWORD length) {
+    if (request->callback && (request->notifications & status)) {
+        request->callback(HttpHandleOf(request), request->context, status, info, length);
+    }
+}
+
+inline bool HttpWouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+// A phase's deadline; a timeout of 0 or less never expires
+inline HttpClock::time_point HttpDeadline(int timeoutMs) {
+    if (timeoutMs <= 0) return HttpClock::time_point::max();
+    return HttpClock::now() + std::chrono::milliseconds(timeoutMs);
+}
+
+inline void HttpResolve(HttpEndpoint& endpoint) {
+    endpoint.resolved = true;
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(endpoint.host.c_str(), std::to_string(endpoint.port).c_str(), &hints, &found) != 0) {
+        endpoint.error = ERROR_WINHTTP_NAME_NOT_RESOLVED;
+        return;
+    }
+    for (addrinfo* entry = found; entry; entry = entry->ai_next) {
+        HttpAddress address = {};
+        memcpy(&address.address, entry->ai_addr, entry->ai_addrlen);
+        address.length = static_cast<socklen_t>(entry->ai_addrlen);
+        endpoint.addresses.push_back(address);
+    }
+    freeaddrinfo(found);
+}
+
+// Connect to the endpoint's addresses in turn: 0 once connected, EAGAIN
+// while a connect is in progress, or the error
+inline DWORD HttpConnectStep(HttpRequest* request) {
+    HttpEndpoint& endpoint = *request->endpoint;
+    if (!endpoint.resolved) HttpResolve(endpoint);
+    if (endpoint.error) return endpoint.error;
+
+    for (;;) {
+        if (request->connecting) {
+            pollfd entry = { request->socket, POLLOUT, 0 };
+            if (poll(&entry, 1, 0) == 0) return EAGAIN;
+            int failure = 0;
+            socklen_t size = sizeof(failure);
+            getsockopt(request->socket, SOL_SOCKET, SO_ERROR, &failure, &size);
+            request->connecting = false;
+            if (!failure) return 0;
+            ::close(request->socket);
+            request->socket = -1;
+            ++request->address;
+        }
+
+        if (request->address >= endpoint.addresses.size()) return ERROR_WINHTTP_CANNOT_CONNECT;
+        if (request->address == 0) HttpNotify(request, WINHTTP_CALLBACK_STATUS_NAME_RESOLVED, nullptr, 0);
+        const HttpAddress& address = endpoint.addresses[request->address];
+        request->socket = ::socket(address.address.ss_family, SOCK_STREAM, 0);
+        if (request->socket < 0) return ERROR_WINHTTP_CANNOT_CONNECT;
+        fcntl(request->socket, F_SETFL, fcntl(request->socket, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(request->socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        if (connect(request->socket, reinterpret_cast<const sockaddr*>(&address.address), address.length) == 0) {
+            return 0;
+        }
+        if (errno == EINPROGRESS) {
+            request->connecting = true;
+            continue;
+        }
+        ::close(request->socket);
+        request->socket = -1;
+        ++request->address;
+    }
+}
+
+inline bool HttpStepSend(HttpRequest* request, HttpCompletion& done) {
+    if (request->secure) {
+        done = HttpFailed(API_SEND_REQUEST, ERROR_WINHTTP_SECURE_FAILURE);
+        return true;
+    }
+    if (!request->connected) {
+        DWORD error = HttpConnectStep(request);
+        if (error == EAGAIN) {
+            request->events = POLLOUT;
+            return false;
+        }
+        if (error) {
+            done = HttpFailed(API_SEND_REQUEST, error);
+            return true;
+        }
+        request->connected = true;
+        request->deadline = HttpDeadline(request->sendMs);
+        request->outgoing = request->head + "\r\n";
+        request->sent = 0;
+        HttpNotify(request, WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER, nullptr, 0);
+        HttpNotify(request, WINHTTP_CALLBACK_STATUS_SENDING_REQUEST, nullptr, 0);
+    }
+
+    while (request->sent < request->outgoing.size()) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = send(request->socket, request->outgoing.data() + request->sent,
+            request->outgoing.size() - request->sent, MSG_NOSIGNAL);
+#else
+        ssize_t n = send(request->socket, request->outgoing.data() + request->sent,
+            request->outgoing.size() - request->sent, 0);
+#endif
+        if (n > 0) {
+            request->sent += static_cast<size_t>(n);
+        }
+        else if (n < 0 && HttpWouldBlock()) {
+            request->events = POLLOUT;
+            return false;
+        }
+        else {
+            done = HttpFailed(API_SEND_REQUEST, ERROR_WINHTTP_CONNECTION_ERROR);
+            return true;
+        }
+    }
+    done = HttpDone(WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE);
+    return true;
+}
+
+// Receive up to limit more bytes onto received: 1 if some came, 0 if the
+// server closed the connection, EAGAIN to wait, or -1 on error
+inline int HttpReceive(HttpRequest* request, size_t limit) {
+    char chunk[COMPAT_HTTP_CHUNK];
+    ssize_t n = recv(request->socket, chunk, std::min(limit, sizeof(chunk)), 0);
+    if (n > 0) {
+        request->received.append(chunk, static_cast<size_t>(n));
+        return 1;
+    }
+    if (n == 0) return 0;
+    if (HttpWouldBlock()) {
+        request->events = POLLIN;
+        return EAGAIN;
+    }
+    return -1;
+}
+
+inline bool HttpParseHead(HttpRequest* request, size_t end, HttpCompletion& done) {
+    std::string head = request->received.substr(0, end + 2);
+    request->received.erase(0, end + 4);
+    unsigned status = 0;
+    if (sscanf(head.c_str(), "HTTP/%*u.%*u %u", &status) != 1) {
+        done = HttpFailed(API_RECEIVE_RESPONSE, ERROR_WINHTTP_INVALID_SERVER_RESPONSE);
+        return true;
+    }
+    request->status = status;
+
+    for (char& c : head) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    if (head.find("\r\ntransfer-encoding:") != std::string::npos) {
+        done = HttpFailed(API_RECEIVE_RESPONSE, ERROR_WINHTTP_INVALID_SERVER_RESPONSE);
+        return true;
+    }
+    size_t length = head.find("\r\ncontent-length:");
+    if (length != std::string::npos) {
+        unsigned long long size = strtoull(head.c_str() + length + 17, nullptr, 10);
+        if (request->received.size() > size) request->received.resize(static_cast<size_t>(size));
+        request->bodyLeft = size - request->received.size();
+    }
+    done = HttpDone(WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE);
+    return true;
+}
+
+inline bool HttpStepReceive(HttpRequest* request, HttpCompletion& done) {
+    for (;;) {
+        size_t end = request->received.find("\r\n\r\n");
+        if (end != std::string::npos) return HttpParseHead(request, end, done);
+
+        int result = HttpReceive(request, COMPAT_HTTP_CHUNK);
+        if (result == EAGAIN) return false;
+        if (result <= 0) {
+            done = HttpFailed(API_RECEIVE_RESPONSE,
+                result == 0 ? ERROR_WINHTTP_INVALID_SERVER_RESPONSE : ERROR_WINHTTP_CONNECTION_ERROR);
+            return true;
+        }
+    }
+}
+
+inline bool HttpStepQuery(HttpRequest* request, HttpCompletion& done) {
+    if (request->received.empty() && request->bodyLeft > 0) {
+        size_t before = request->received.size();
+        int result = HttpReceive(request, static_cast<size_t>(
+            std::min<unsigned long long>(request->bodyLeft, COMPAT_HTTP_CHUNK)));
+        if (result == EAGAIN) return false;
+        if (result < 0) {
+            done = HttpFailed(API_QUERY_DATA_AVAILABLE, ERROR_WINHTTP_CONNECTION_ERROR);
+            return true;
+        }
+        if (result == 0) {
+            // Fine when the body runs to the end of the connection
+            if (request->bodyLeft != ULLONG_MAX) {
+                done = HttpFailed(API_QUERY_DATA_AVAILABLE, ERROR_WINHTTP_CONNECTION_ERROR);
+                return true;
+            }
+            request->bodyLeft = 0;
+        }
+        else if (request->bodyLeft != ULLONG_MAX) {
+            request->bodyLeft -= request->received.size() - before;
+        }
+    }
+    done = HttpDone(WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE, static_cast<DWORD>(request->received.size()));
+    return true;
+}
+
+// Advance a request's operation as far as it goes without blocking. True
+// when it is done, with its completion in done; otherwise events says what
+// it waits for.
+inline bool HttpStep(HttpRequest* request, HttpOperation operation, HttpCompletion& done) {
+    switch (operation) {
+    case HttpOperation::Send:
+        return HttpStepSend(request, done);
+    case HttpOperation::Receive:
+        return HttpStepReceive(request, done);
+    case HttpOperation::Query:
+        return HttpStepQuery(request, done);
+    default:
+        done = HttpDone(WINHTTP_CALLBACK_STATUS_READ_COMPLETE,
+            static_cast<DWORD>(std::min<size_t>(request->readSize, request->received.size())));
+        done.buffer = request->readBuffer;
+        memcpy(done.buffer, request->received.data(), done.bytes);
+        request->received.erase(0, done.bytes);
+        return true;
+    }
+}
+
+// Hand a finished operation's completion to the callback, which may start
+// the next operation or close the handle
+inline void HttpComplete(HttpLoop& loop, HttpRequest* request, HttpCompletion& done) {
+    {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        request->operation = HttpOperation::None;
+    }
+    // A close already queued delivers HANDLE_CLOSING instead
+    if (request->closing.load()) return;
+
+    switch (done.status) {
+    case WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE:
+        HttpNotify(request, done.status, &done.bytes, sizeof(done.bytes));
+        break;
+    case WINHTTP_CALLBACK_STATUS_READ_COMPLETE:
+        HttpNotify(request, done.status, done.buffer, done.bytes);
+        break;
+    case WINHTTP_CALLBACK_STATUS_REQUEST_ERROR:
+        HttpNotify(request, done.status, &done.result, sizeof(done.result));
+        break;
+    default:
+        HttpNotify(request, done.status, nullptr, 0);
+        break;
+    }
+}
+
+inline void HttpFinishClosing(HttpRequest* request) {
+    HINTERNET handle = HttpHandleOf(request);
+    HttpNotify(request, WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING, &handle, sizeof(handle));
+    delete request;
+}
+
+// Take the requests handed over since the last pass: finish closed ones,
+// and start driving newly started operations
+inline void HttpTakeIncoming(HttpLoop& loop) {
+    std::vector<HttpRequest*> incoming;
+    {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        incoming.swap(loop.incoming);
+    }
+
+    for (HttpRequest* request : incoming) {
+        HttpOperation operation;
+        {
+            // Cleared only now, so a request closed by a callback later in
+            // this pass is queued again rather than seen twice here
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            request->queued = false;
+            operation = request->operation;
+        }
+        if (request->closing.load()) {
+            if (request->active) {
+                loop.active.erase(std::find(loop.active.begin(), loop.active.end(), request));
+            }
+            HttpFinishClosing(request);
+            continue;
+        }
+        if (operation == HttpOperation::None || request->active) continue;
+
+        request->active = true;
+        request->ready = true;
+        request->deadline = HttpDeadline(operation == HttpOperation::Send ? request->connectMs : request->receiveMs);
+        loop.active.push_back(request);
+    }
+}
+
+inline void HttpRun(HttpLoop* loop) {
+    std::vector<HttpRequest*> waiting;
+    std::vector<pollfd> polled;
+    for (;;) {
+        char drain[64];
+        while (read(loop->wake[0], drain, sizeof(drain)) > 0) {}
+        HttpTakeIncoming(*loop);
+
+        // Step what is ready or out of time; completions go out as they come
+        HttpClock::time_point now = HttpClock::now();
+        waiting.clear();
+        std::vector<HttpRequest*> active;
+        active.swap(loop->active);
+        for (HttpRequest* request : active) {
+            if (request->closing.load() || (!request->ready && now < request->deadline)) {
+                waiting.push_back(request);
+                continue;
+            }
+            request->ready = false;
+
+            HttpOperation operation;
+            {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                operation = request->operation;
+            }
+            HttpCompletion done;
+            bool finished = HttpStep(request, operation, done);
+            if (!finished && HttpClock::now() >= request->deadline) {
+                done = HttpFailed(HttpApiOf(operation), ERROR_WINHTTP_TIMEOUT);
+                finished = true;
+            }
+            if (!finished) {
+                waiting.push_back(request);
+                continue;
+            }
+            request->active = false;
+            HttpComplete(*loop, request, done);
+        }
+        loop->active.swap(waiting);
+
+        // Sleep until a socket is ready, a deadline passes or a request is
+        // handed over
+        polled.clear();
+        polled.push_back({ loop->wake[0], POLLIN, 0 });
+        HttpClock::time_point next = HttpClock::time_point::max();
+        for (HttpRequest* request : loop->active) {
+            polled.push_back({ request->socket, request->events, 0 });
+            next = std::min(next, request->deadline);
+        }
+        int timeoutMs = -1;
+        if (next != HttpClock::time_point::max()) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(next - HttpClock::now()).count();
+            timeoutMs = static_cast<int>(std::clamp<long long>(left + 1, 0, INT_MAX));
+        }
+        if (poll(polled.data(), static_cast<nfds_t>(polled.size()), timeoutMs) <= 0) continue;
+        for (size_t i = 1; i < polled.size(); ++i) {
+            if (polled[i].revents) loop->active[i - 1]->ready = true;
+        }
+    }
+}
+
+inline HttpLoop& GetHttpLoop() {
+    static HttpLoop* loop = [] {
+        HttpLoop* created = new HttpLoop();   // Outlives static destructors, like its thread
+        if (pipe(created->wake) == 0) {
+            fcntl(created->wake[0], F_SETFL, fcntl(created->wake[0], F_GETFL) | O_NONBLOCK);
+            fcntl(created->wake[1], F_SETFL, fcntl(created->wake[1], F_GETFL) | O_NONBLOCK);
+        }
+        std::thread(HttpRun, created).detach();
+        return created;
+    }();
+    return *loop;
+}
+
+// loop.mutex held: hand the request to the I/O thread
+inline void HttpQueue(HttpLoop& loop, HttpRequest* request) {
+    if (!request->queued) {
+        request->queued = true;
+        loop.incoming.push_back(request);
+    }
+    char byte = 0;
+    if (write(loop.wake[1], &byte, 1) < 0) {
+        // Full: the I/O thread has a wake-up pending anyway
+    }
+}
+
+inline BOOL HttpStart(HttpRequest* request, HttpOperation operation, void* buffer = nullptr, DWORD size = 0) {
+    HttpLoop& loop = GetHttpLoop();
+    std::lock_guard<std::mutex> lock(loop.mutex);
+    if (request->closing.load() || request->operation != HttpOperation::None) {
+        LastError() = ERROR_WINHTTP_INCORRECT_HANDLE_STATE;
+        return FALSE;
+    }
+    request->operation = operation;
+    request->readBuffer = buffer;
+    request->readSize = size;
+    HttpQueue(loop, request);
+    return TRUE;
+}
+
+} // namespace compat
+
+inline HINTERNET WinHttpOpen(LPCWSTR agent, DWORD, LPCWSTR, LPCWSTR, DWORD) {
+    compat::HttpSession* session = new compat::HttpSession();
+    session->agent = compat::HttpNarrow(agent);
+    return compat::HttpHandleOf(session);
+}
+
+inline HINTERNET WinHttpConnect(HINTERNET session, LPCWSTR server, INTERNET_PORT port, DWORD) {
+    compat::HttpConnection* connection = new compat::HttpConnection();
+    connection->agent = dynamic_cast<compat::HttpSession*>(static_cast<compat::HttpHandle*>(session))->agent;
+    connection->endpoint = std::make_shared<compat::HttpEndpoint>();
+    connection->endpoint->host = compat::HttpNarrow(server);
+    connection->endpoint->port = port;
+    return compat::HttpHandleOf(connection);
+}
+
+inline HINTERNET WinHttpOpenRequest(HINTERNET connect, LPCWSTR verb, LPCWSTR object, LPCWSTR, LPCWSTR,
+    LPCWSTR*, DWORD flags) {
+    compat::HttpConnection* connection = dynamic_cast<compat::HttpConnection*>(static_cast<compat::HttpHandle*>(connect));
+    compat::HttpRequest* request = new compat::HttpRequest();
+    request->endpoint = connection->endpoint;
+    request->secure = (flags & WINHTTP_FLAG_SECURE) != 0;
+    request->head = compat::HttpNarrow(verb) + " " + compat::HttpNarrow(object) + " HTTP/1.1\r\n" +
+        "Host: " + connection->endpoint->host + ":" + std::to_string(connection->endpoint->port) + "\r\n" +
+        "User-Agent: " + connection->agent + "\r\n" +
+        "Connection: close\r\n";
+    return compat::HttpHandleOf(request);
+}
+
+inline BOOL WinHttpSetOption(HINTERNET handle, DWORD option, LPVOID buffer, DWORD length) {
+    compat::HttpRequest* request = compat::HttpRequestOf(handle);
+    if (option == WINHTTP_OPTION_CONTEXT_VALUE && request && length == sizeof(DWORD_PTR)) {
+        memcpy(&request->context, buffer, sizeof(DWORD_PTR));
+    }
+    return TRUE;
+}
+
+inline WINHTTP_STATUS_CALLBACK WinHttpSetStatusCallback(HINTERNET handle, WINHTTP_STATUS_CALLBACK callback,
+    DWORD notifications, DWORD_PTR) {
+    compat::HttpRequest* request = compat::HttpRequestOf(handle);
+    WINHTTP_STATUS_CALLBACK previous = request->callback;
+    request->callback = callback;
+    request->notifications = notifications;
+    return previous;
+}
+
+inline BOOL WinHttpAddRequestHeaders(HINTERNET handle, LPCWSTR headers, DWORD length, DWORD) {
+    compat::HttpRequest* request = compat::HttpRequestOf(handle);
+    request->head += compat::HttpNarrow(headers, length == static_cast<DWORD>(-1) ? SIZE_MAX : length) + "\r\n";
+    return TRUE;
+}
+
+inline BOOL WinHttpSetTimeouts(HINTERNET handle, int, int connectMs, int sendMs, int receiveMs) {
+    compat::HttpRequest* request = compat::HttpRequestOf(handle);
+    request->connectMs = connectMs;
+    request->sendMs = sendMs;
+    request->receiveMs = receiveMs;
+    return TRUE;
+}
+
+inline BOOL WinHttpSendRequest(HINTERNET handle, LPCWSTR, DWORD, LPVOID, DWORD, DWORD, DWORD_PTR context) {
+    compat::HttpRequest* request = compat::HttpRequestOf(handle);
+    if (context) request->context = context;
+    return compat::HttpStart(request, compat::HttpOperation::Send);
+}
+
+inline BOOL WinHttpReceiveResponse(HINTERNET handle, LPVOID) {
+    return compat::HttpStart(compat::HttpRequestOf(handle), compat::HttpOperation::Receive);
+}
+
+inline BOOL WinHttpQueryHeaders(HINTERNET handle, DWORD level, LPCWSTR, LPVOID buffer, DWORD* length, DWORD*) {
+    compat::HttpRequest* request = compat::HttpRequestOf(handle);
+    if (level != (WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER) || *length < sizeof(DWORD) ||
+        !request->status) {
+        compat::LastError() = ERROR_WINHTTP_INCORRECT_HANDLE_STATE;
+        return FALSE;
+    }
+    memcpy(buffer, &request->status, sizeof(DWORD));
+    *length = sizeof(DWORD);
+    return TRUE;
+}
+
+inline BOOL WinHttpQueryDataAvailable(HINTERNET handle, DWORD*) {
+    return compat::HttpStart(compat::HttpRequestOf(handle), compat::HttpOperation::Query);
+}
+
+inline BOOL WinHttpReadData(HINTERNET handle, LPVOID buffer, DWORD size, DWORD*) {
+    return compat::HttpStart(compat::HttpRequestOf(handle), compat::HttpOperation::Read, buffer, size);
+}
+
+// A request's HANDLE_CLOSING comes from the I/O thread once its pending
+// operation has been abandoned, as callers may hold locks while closing
+inline BOOL WinHttpCloseHandle(HINTERNET handle) {
+    compat::HttpRequest* request = compat::HttpRequestOf(handle);
+    if (!request) {
+        delete static_cast<compat::HttpHandle*>(handle);
+        return TRUE;
+    }
+
+    compat::HttpLoop& loop = compat::GetHttpLoop();
+    std::lock_guard<std::mutex> lock(loop.mutex);
+    if (request->closing.load()) return TRUE;
+    request->closing = true;
+    compat::HttpQueue(loop, request);
+    return TRUE;
+}
+
+#endif
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <fstream>
@@ -15,23 +16,44 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <filesystem>
 
 #include "TickerManager.h"
 #include "ApiFetcher.h"
 #include "ConfigManager.h"
 #include "Renderer.h"
+#include "RenderThread.h"
+#include "RenderPolicy.h"
+#include "QuoteEngine.h"
+#include "QuoteFeedReader.h"
+#include "QuoteExporter.h"
+#include "ConfigWatcher.h"
+#include "StartupTimeline.h"
+#include "Trace.h"
+#include "Log.h"
 #include "resource.h"
 #include "ConfigDialog.h"  // Include header instead of .cpp
 
-#define TIMER_SCROLL 1
 #define APPBAR_CALLBACK WM_APP + 1
 #define WM_TRAYICON WM_APP + 2
 #define WM_SHOW_EXISTING WM_APP + 3
-#define SCROLL_INTERVAL 33
+#define WM_CONFIG_FILE_CHANGED WM_APP + 4
+#define WM_FINISH_STARTUP WM_APP + 5
 
 // Single instance mutex name
 #define MUTEX_NAME L"ARPTickerTapeSingleInstance"
 
+// Per-window state of one tape. Tape 0 is the primary window: it owns the
+// tray icon and hotkeys, and closing it exits the application.
+struct TapeWindow {
+    int index;
+    HWND hWnd;
+    bool isPaused;
+    bool isHidden;
+    bool isDocked;
+    bool isDockedTop;
+};
+
 // Function declarations
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 void DockWindow(HWND hWnd, bool top);
@@ -44,30 +66,65 @@ void RemoveSystemTrayIcon();
 void CleanupAndExit();
 bool CheckSingleInstance();
 void ShowExistingInstance();
-void APIWorkerThread();
+HWND CreateTapeWindow(int index, const TapeConfig& config);
+void CreateExtraTapes();
+void DestroyExtraTapes();
+void HandleCommand(HWND hWnd, TapeWindow* tape, UINT id);
+void FinishStartup(HWND hWnd);
 
 // Global variables
-std::wstring tickerText;
-std::mutex textMutex;
-std::atomic<bool> appRunning(true);
-std::atomic<bool> dataUpdated(false);
 std::atomic<bool> forceExit(false);
-double scrollOffset = 0.0;
-int charWidth = 10;
-int windowWidth = 0;
-int windowHeight = 30;
-bool isPaused = false;
-bool isHidden = false;
+std::vector<std::unique_ptr<TapeWindow>> g_tapes;
 bool isMinimized = false;
 HMENU hMenu;
 HMENU hTrayMenu;
-bool isDocked = false;
-bool isDockedTop = true;
 NOTIFYICONDATA nid = { 0 };
 HINSTANCE g_hInstance;
 HWND g_hMainWnd = NULL;
 HANDLE g_hMutex = NULL;
+std::shared_ptr<const ConfigSnapshot> g_appliedConfig; // Config the windows currently reflect
+
+
+TapeWindow* FindTape(HWND hWnd) {
+    for (auto& tape : g_tapes) {
+        if (tape->hWnd == hWnd) return tape.get();
+    }
+    return nullptr;
+}
+
+static BOOL CALLBACK CollectMonitor(HMONITOR hMon, HDC, LPRECT, LPARAM lParam) {
+    MONITORINFO mi = { 0 };
+    mi.cbSize = sizeof(MONITORINFO);
+    if (GetMonitorInfo(hMon, &mi)) {
+        auto* monitors = reinterpret_cast<std::vector<RECT>*>(lParam);
+        // Keep the primary monitor at index 0
+        if (mi.dwFlags & MONITORINFOF_PRIMARY) monitors->insert(monitors->begin(), mi.rcMonitor);
+        else monitors->push_back(mi.rcMonitor);
+    }
+    return TRUE;
+}
 
+// Bounds of the monitor with the given index (0 = primary)
+RECT GetMonitorRect(int index) {
+    std::vector<RECT> monitors;
+    EnumDisplayMonitors(NULL, NULL, CollectMonitor, reinterpret_cast<LPARAM>(&monitors));
+
+    if (index >= 0 && index < (int)monitors.size()) {
+        return monitors[index];
+    }
+    RECT rc = { 0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN) };
+    return rc;
+}
+
+// Width of the monitor the window is currently on
+int GetWindowMonitorWidth(HWND hWnd) {
+    MONITORINFO mi = { 0 };
+    mi.cbSize = sizeof(MONITORINFO);
+    if (GetMonitorInfo(MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST), &mi)) {
+        return mi.rcMonitor.right - mi.rcMonitor.left;
+    }
+    return GetSystemMetrics(SM_CXSCREEN);
+}
 
 bool CheckSingleInstance() {
     // Create or open a named mutex
@@ -102,86 +159,139 @@ void ShowExistingInstance() {
     }
 }
 
-// Worker thread function
-void APIWorkerThread() {
-    while (appRunning.load()) {
-        std::wstring newText;
-        bool hasData = false;
-
-        for (const auto& symbol : ConfigManager::symbols) {
-            double price = ApiFetcher::FetchPrice(symbol);
-            if (price > 0.0) {
-                wchar_t buffer[64];
-                swprintf(buffer, 64, L"%s: $%.2f   ", symbol.c_str(), price);
-                newText += buffer;
-                hasData = true;
-            }
-        }
+HWND CreateTapeWindow(int index, const TapeConfig& config) {
+    RECT monitor = GetMonitorRect(config.monitor);
 
-        if (hasData) {
-            std::lock_guard<std::mutex> lock(textMutex);
-            // Create seamless endless loop by repeating the text multiple times
-            // This ensures smooth scrolling without visible gaps
-            tickerText = newText + newText + newText;
-            dataUpdated = true;
-        }
+    // The primary tape keeps its historical position; extra tapes stack
+    // below it on their monitor until docked or moved
+    int x = index == 0 ? 100 : monitor.left;
+    int y = monitor.top + 100 + index * (ConfigManager::windowHeight + 10);
+    int width = index == 0 ? GetSystemMetrics(SM_CXSCREEN) : monitor.right - monitor.left;
+
+    HWND hWnd = CreateWindowEx(
+        WS_EX_TOOLWINDOW | WS_EX_TOPMOST | WS_EX_LAYERED,
+        TEXT("TickerTapeClass"),
+        TEXT("TickerTape"),
+        WS_POPUP | WS_VISIBLE,
+        x, y, width, ConfigManager::windowHeight,
+        NULL, NULL, g_hInstance, NULL);
+    if (!hWnd) return NULL;
 
-        std::this_thread::sleep_for(std::chrono::seconds(ConfigManager::refreshInterval));
+    g_tapes.push_back(std::unique_ptr<TapeWindow>(new TapeWindow{ index, hWnd, false, false, false, true }));
+    RenderThread::AddTape(index, hWnd, config.scrollSpeed);
+
+    if (isMinimized) {
+        ShowWindow(hWnd, SW_HIDE);
+    }
+    if (config.dock == L"top" || config.dock == L"bottom") {
+        DockWindow(hWnd, config.dock == L"top");
     }
+    return hWnd;
 }
 
-int APIENTRY wWinMain(
-    _In_ HINSTANCE hInstance,
-    _In_opt_ HINSTANCE hPrevInstance,
-    _In_ LPWSTR lpCmdLine,
-    _In_ int nCmdShow) {
+void CreateExtraTapes() {
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::Current();
+    for (size_t i = 1; i < config->tapes.size() && i < MAX_TAPES; ++i) {
+        CreateTapeWindow((int)i, config->tapes[i]);
+    }
+}
 
-    // Check for single instance
-    if (!CheckSingleInstance()) {
-        // Another instance is running, show it and exit
-        ShowExistingInstance();
-        MessageBox(NULL, L"ARP Ticker Tape is already running. Check the system tray.",
-            L"ARP Ticker Tape", MB_OK | MB_ICONINFORMATION);
-        return 0;
+void DestroyExtraTapes() {
+    for (auto it = g_tapes.begin(); it != g_tapes.end();) {
+        TapeWindow* tape = it->get();
+        if (tape->index == 0) {
+            ++it;
+            continue;
+        }
+        if (tape->isDocked) UndockWindow(tape->hWnd);
+        RenderThread::RemoveTape(tape->index);
+        DestroyWindow(tape->hWnd);
+        it = g_tapes.erase(it);
     }
+}
 
-    g_hInstance = hInstance;
-    ConfigManager::LoadConfig();
+// Extra tape windows must be recreated when their count or placement changes
+static bool TapeLayoutChanged(const ConfigSnapshot& oldConfig, const ConfigSnapshot& newConfig) {
+    if (oldConfig.tapes.size() != newConfig.tapes.size()) return true;
+    for (size_t i = 1; i < newConfig.tapes.size(); ++i) {
+        if (oldConfig.tapes[i].monitor != newConfig.tapes[i].monitor ||
+            oldConfig.tapes[i].dock != newConfig.tapes[i].dock) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    // Initialize common controls
-    InitCommonControls();
+// Bring the windows and worker threads in line with the latest config
+// snapshot, touching only what differs from the one applied before
+void ApplyConfigChanges() {
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::Current();
+    std::shared_ptr<const ConfigSnapshot> old = g_appliedConfig;
+    g_appliedConfig = config;
+    Trace::Enable(!config->traceFile.empty());
+    if (!old || old == config) return;
+
+    bool recreated = TapeLayoutChanged(*old, *config);
+    if (recreated) {
+        DestroyExtraTapes();
+        CreateExtraTapes();
+    }
 
-    WNDCLASS wc = { 0 };
-    wc.style = CS_HREDRAW | CS_VREDRAW;
-    wc.lpfnWndProc = WndProc;
-    wc.hInstance = hInstance;
-    wc.hbrBackground = (HBRUSH)GetStockObject(BLACK_BRUSH);
-    wc.lpszClassName = TEXT("TickerTapeClass");
-    wc.hCursor = LoadCursor(NULL, IDC_ARROW);
-    wc.hIcon = LoadIcon(g_hInstance, MAKEINTRESOURCE(IDI_APPLICATION));
+    // New windows already got their speed when they were added
+    for (auto& tape : g_tapes) {
+        size_t i = tape->index;
+        if (i >= config->tapes.size() || (recreated && i > 0)) continue;
+        if (i >= old->tapes.size() || old->tapes[i].scrollSpeed != config->tapes[i].scrollSpeed) {
+            RenderThread::Post(RenderCommandType::SetSpeed, tape->index, 0, 0, config->tapes[i].scrollSpeed);
+        }
+    }
 
-    RegisterClass(&wc);
+    if (old->fontName != config->fontName || old->fontSize != config->fontSize) {
+        RecalculateCharWidth(g_hMainWnd);
+    }
 
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
+    if (old->windowHeight != config->windowHeight) {
+        for (auto& tape : g_tapes) {
+            if (tape->isDocked) {
+                DockWindow(tape->hWnd, tape->isDockedTop);
+            }
+            else {
+                UpdateWindowSize(tape->hWnd);
+            }
+        }
+    }
 
-    HWND hWnd = CreateWindowEx(
-        WS_EX_TOOLWINDOW | WS_EX_TOPMOST | WS_EX_LAYERED,
-        TEXT("TickerTapeClass"),
-        TEXT("TickerTape"),
-        WS_POPUP | WS_VISIBLE,
-        100, 100, screenWidth, ConfigManager::windowHeight,
-        NULL, NULL, hInstance, NULL);
+    // Colors are read from the snapshot every frame; paused tapes still
+    // need a fresh frame to show them
+    RenderThread::Post(RenderCommandType::Redraw);
 
-    if (!hWnd) {
-        if (g_hMutex) {
-            ReleaseMutex(g_hMutex);
-            CloseHandle(g_hMutex);
+    // Symbols: the engine drops removed ones and fetches only new ones
+    QuoteEngine::Reconfigure();
+
+    if (old->localFeed != config->localFeed) {
+        if (config->localFeed) {
+            QuoteFeedReader::Start();
+        }
+        else {
+            QuoteFeedReader::Stop();
         }
-        return 1;
     }
 
-    g_hMainWnd = hWnd;
-    Renderer::Init(hWnd);
+    if (old->exportQuotes != config->exportQuotes) {
+        if (config->exportQuotes) {
+            QuoteExporter::Start();
+        }
+        else {
+            QuoteExporter::Stop();
+        }
+    }
+}
+
+// Startup work the first frame does not wait for: menus, tray icon,
+// hotkeys and the config watcher
+void FinishStartup(HWND hWnd) {
+    // Reload automatically when config.ini is edited by hand
+    ConfigWatcher::Start(ConfigManager::GetConfigPath(), hWnd, WM_CONFIG_FILE_CHANGED);
 
     // Create main context menu
     hMenu = CreatePopupMenu();
@@ -194,6 +304,7 @@ int APIENTRY wWinMain(
     AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
     AppendMenu(hMenu, MF_STRING, IDM_MINIMIZE, TEXT("Minimize to Tray"));
     AppendMenu(hMenu, MF_STRING, IDM_SETTINGS, TEXT("Settings..."));
+    AppendMenu(hMenu, MF_STRING, IDM_REFRESH, TEXT("Refresh Now"));
     AppendMenu(hMenu, MF_STRING, IDM_RELOAD, TEXT("Reload Config"));
     AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
     AppendMenu(hMenu, MF_STRING, IDM_EXIT, TEXT("Exit"));
@@ -205,6 +316,7 @@ int APIENTRY wWinMain(
     AppendMenu(hTrayMenu, MF_STRING, IDM_RESUME, TEXT("Resume"));
     AppendMenu(hTrayMenu, MF_SEPARATOR, 0, NULL);
     AppendMenu(hTrayMenu, MF_STRING, IDM_SETTINGS, TEXT("Settings..."));
+    AppendMenu(hTrayMenu, MF_STRING, IDM_REFRESH, TEXT("Refresh Now"));
     AppendMenu(hTrayMenu, MF_SEPARATOR, 0, NULL);
     AppendMenu(hTrayMenu, MF_STRING, IDM_EXIT, TEXT("Exit"));
 
@@ -215,19 +327,84 @@ int APIENTRY wWinMain(
     RegisterHotKey(hWnd, 100, MOD_CONTROL | MOD_ALT, 'P');
     RegisterHotKey(hWnd, 101, MOD_CONTROL | MOD_ALT, 'H');
 
-    std::thread apiThread(APIWorkerThread);
+    StartupTimeline::Mark(StartupPhase::Deferred);
+}
+
+int APIENTRY wWinMain(
+    _In_ HINSTANCE hInstance,
+    _In_opt_ HINSTANCE hPrevInstance,
+    _In_ LPWSTR lpCmdLine,
+    _In_ int nCmdShow) {
+
+    StartupTimeline::Begin();
 
-    // Initial setup
-    RecalculateCharWidth(hWnd);
-    {
-        std::lock_guard<std::mutex> lock(textMutex);
-        std::wstring loadingText = L"Loading...   ";
-        tickerText = loadingText + loadingText + loadingText;
+    // Check for single instance
+    if (!CheckSingleInstance()) {
+        // Another instance is running, show it and exit
+        ShowExistingInstance();
+        MessageBox(NULL, L"ARP Ticker Tape is already running. Check the system tray.",
+            L"ARP Ticker Tape", MB_OK | MB_ICONINFORMATION);
+        return 0;
     }
-    dataUpdated = true;
+    StartupTimeline::Mark(StartupPhase::Instance);
 
-    SetTimer(hWnd, TIMER_SCROLL, SCROLL_INTERVAL, NULL);
-    UpdateLayeredDisplay(hWnd);
+    g_hInstance = hInstance;
+    ConfigManager::LoadConfig();
+    Log::Start(std::filesystem::path(ConfigManager::GetConfigPath()).replace_filename(L"ARPTickerTape.log").wstring());
+    Trace::Enable(!ConfigManager::Current()->traceFile.empty());
+    StartupTimeline::Mark(StartupPhase::Config);
+
+    // Quote requests go out first so the network overlaps window creation;
+    // each quote is shown the moment it arrives
+    if (ConfigManager::Current()->exportQuotes) {
+        QuoteExporter::Start();
+    }
+    QuoteEngine::Start();
+    if (ConfigManager::Current()->localFeed) {
+        QuoteFeedReader::Start();
+    }
+
+    // Initialize common controls
+    InitCommonControls();
+
+    WNDCLASS wc = { 0 };
+    wc.style = CS_HREDRAW | CS_VREDRAW;
+    wc.lpfnWndProc = WndProc;
+    wc.hInstance = hInstance;
+    wc.hbrBackground = (HBRUSH)GetStockObject(BLACK_BRUSH);
+    wc.lpszClassName = TEXT("TickerTapeClass");
+    wc.hCursor = LoadCursor(NULL, IDC_ARROW);
+    wc.hIcon = LoadIcon(g_hInstance, MAKEINTRESOURCE(IDI_APPLICATION));
+
+    RegisterClass(&wc);
+
+    // Show placeholder text until the first quote arrives
+    RenderThread::PublishText(L"Loading...   ");
+    RenderThread::Start();
+
+    HWND hWnd = CreateTapeWindow(0, ConfigManager::Current()->tapes[0]);
+
+    if (!hWnd) {
+        QuoteFeedReader::Stop();
+        QuoteEngine::Stop();
+        QuoteExporter::Stop();
+        RenderThread::Stop();
+        if (g_hMutex) {
+            ReleaseMutex(g_hMutex);
+            CloseHandle(g_hMutex);
+        }
+        return 1;
+    }
+
+    g_hMainWnd = hWnd;
+    RenderPolicy::Start(hWnd);
+    CreateExtraTapes();
+    g_appliedConfig = ConfigManager::Current();
+    StartupTimeline::Mark(StartupPhase::Window);
+
+    // Nothing on screen needs the rest; it runs once the message loop has
+    // handled the windows' first messages
+    PostMessage(hWnd, WM_FINISH_STARTUP, 0, 0);
 
     MSG msg;
     while (GetMessage(&msg, NULL, 0, 0)) {
@@ -238,21 +415,28 @@ int APIENTRY wWinMain(
     // Cleanup
     CleanupAndExit();
 
-    if (apiThread.joinable()) {
-        apiThread.join();
+    QuoteFeedReader::Stop();
+    QuoteEngine::Stop();
+    QuoteExporter::Stop();
+
+    // Every traced thread has stopped by now
+    std::shared_ptr<const ConfigSnapshot> config = ConfigManager::Current();
+    if (!config->traceFile.empty() && !Trace::Flush(config->traceFile)) {
+        LOG_ERROR("Could not write the trace file {}", config->traceFile);
     }
+    Log::Stop();
 
     return (int)msg.wParam;
 }
 
 void CleanupAndExit() {
-    appRunning = false;
-
     // Remove system tray icon
     RemoveSystemTrayIcon();
 
-    // Cleanup renderer
-    Renderer::Cleanup();
+    ConfigWatcher::Stop();
+
+    // Stop the render thread (it owns the renderer resources)
+    RenderThread::Stop();
 
     // Destroy menus
     if (hMenu) {
@@ -288,44 +472,85 @@ void RemoveSystemTrayIcon() {
     Shell_NotifyIcon(NIM_DELETE, &nid);
 }
 
+// Handle a menu command. tape is the tape whose context menu was used, or
+// null for commands from the tray menu, which apply to every tape.
+void HandleCommand(HWND hWnd, TapeWindow* tape, UINT id) {
+    switch (id) {
+    case IDM_PAUSE:
+    case IDM_RESUME:
+        for (auto& t : g_tapes) {
+            if (tape && t.get() != tape) continue;
+            t->isPaused = (id == IDM_PAUSE);
+            RenderThread::Post(t->isPaused ? RenderCommandType::Pause : RenderCommandType::Resume, t->index);
+        }
+        break;
+    case IDM_REFRESH:
+        QuoteEngine::RefreshNow();
+        break;
+    case IDM_RELOAD:
+        ConfigManager::LoadConfig();
+        ApplyConfigChanges();
+        break;
+    case IDM_DOCK_TOP:
+        if (tape) DockWindow(tape->hWnd, true);
+        break;
+    case IDM_DOCK_BOTTOM:
+        if (tape) DockWindow(tape->hWnd, false);
+        break;
+    case IDM_UNDOCK:
+        if (tape) UndockWindow(tape->hWnd);
+        break;
+    case IDM_MINIMIZE:
+        for (auto& t : g_tapes) {
+            ShowWindow(t->hWnd, SW_HIDE);
+        }
+        isMinimized = true;
+        break;
+    case IDM_SHOW:
+        for (auto& t : g_tapes) {
+            if (!t->isHidden) ShowWindow(t->hWnd, SW_SHOW);
+        }
+        isMinimized = false;
+        break;
+    case IDM_SETTINGS:
+        // The dialog publishes and applies its own changes
+        ShowConfigDialog(g_hMainWnd);
+        break;
+    case IDM_EXIT:
+        PostMessage(g_hMainWnd, WM_DESTROY, 0, 0);
+        break;
+    }
+}
+
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
     static ULONGLONG lastClickTime = 0;
+    TapeWindow* tape = FindTape(hWnd);
 
     switch (message) {
     case WM_PAINT:
         ValidateRect(hWnd, NULL);
         return 0;
 
-    case WM_TIMER:
-        if (wParam == TIMER_SCROLL && !isPaused && !isHidden && !isMinimized) {
-            if (!tickerText.empty()) {
-                // Calculate the width of one complete cycle of tickers
-                int singleCycleWidth = ((int)tickerText.length() / 3) * charWidth;
-                if (singleCycleWidth > 0) {
-                    scrollOffset += ConfigManager::scrollSpeed;
-                    // Reset scroll when we've completed one full cycle
-                    if (scrollOffset >= singleCycleWidth) {
-                        scrollOffset = fmod(scrollOffset, singleCycleWidth);
-                    }
-                }
-                UpdateLayeredDisplay(hWnd);
-            }
-        }
-        return 0;
-
     case WM_HOTKEY:
-        if (wParam == 100) isPaused = !isPaused;
-        else if (wParam == 101) {
-            isHidden = !isHidden;
-            ShowWindow(hWnd, isHidden ? SW_HIDE : SW_SHOW);
+        // Hotkeys act on every tape
+        if (wParam == 100 && tape) {
+            HandleCommand(hWnd, nullptr, tape->isPaused ? IDM_RESUME : IDM_PAUSE);
+        }
+        else if (wParam == 101 && tape) {
+            bool hide = !tape->isHidden;
+            for (auto& t : g_tapes) {
+                t->isHidden = hide;
+                if (!isMinimized) ShowWindow(t->hWnd, hide ? SW_HIDE : SW_SHOW);
+            }
         }
         return 0;
 
     case WM_LBUTTONDOWN: {
+        if (!tape) return 0;
         ULONGLONG currentTime = GetTickCount64();
         if (currentTime - lastClickTime < GetDoubleClickTime()) {
             // Double-click: toggle dock
-            if (isDocked) {
+            if (tape->isDocked) {
                 UndockWindow(hWnd);
             }
             else {
@@ -334,7 +559,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         }
         else {
             // Single click: drag if not docked
-            if (!isDocked) {
+            if (!tape->isDocked) {
                 ReleaseCapture();
                 SendMessage(hWnd, WM_NCLBUTTONDOWN, HTCAPTION, lParam);
                 return 0;
@@ -345,42 +570,39 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     }
 
     case WM_RBUTTONUP: {
+        if (!tape) return 0;
         POINT pt;
         GetCursorPos(&pt);
 
-        // Update menu items based on current state
-        EnableMenuItem(hMenu, IDM_PAUSE, isPaused ? MF_GRAYED : MF_ENABLED);
-        EnableMenuItem(hMenu, IDM_RESUME, isPaused ? MF_ENABLED : MF_GRAYED);
-        EnableMenuItem(hMenu, IDM_DOCK_TOP, isDocked && isDockedTop ? MF_GRAYED : MF_ENABLED);
-        EnableMenuItem(hMenu, IDM_DOCK_BOTTOM, isDocked && !isDockedTop ? MF_GRAYED : MF_ENABLED);
-        EnableMenuItem(hMenu, IDM_UNDOCK, isDocked ? MF_ENABLED : MF_GRAYED);
-
-        TrackPopupMenu(hMenu, TPM_RIGHTBUTTON, pt.x, pt.y, 0, hWnd, NULL);
+        // Update menu items based on this tape's state
+        EnableMenuItem(hMenu, IDM_PAUSE, tape->isPaused ? MF_GRAYED : MF_ENABLED);
+        EnableMenuItem(hMenu, IDM_RESUME, tape->isPaused ? MF_ENABLED : MF_GRAYED);
+        EnableMenuItem(hMenu, IDM_DOCK_TOP, tape->isDocked && tape->isDockedTop ? MF_GRAYED : MF_ENABLED);
+        EnableMenuItem(hMenu, IDM_DOCK_BOTTOM, tape->isDocked && !tape->isDockedTop ? MF_GRAYED : MF_ENABLED);
+        EnableMenuItem(hMenu, IDM_UNDOCK, tape->isDocked ? MF_ENABLED : MF_GRAYED);
+
+        UINT id = TrackPopupMenu(hMenu, TPM_RIGHTBUTTON | TPM_RETURNCMD, pt.x, pt.y, 0, hWnd, NULL);
+        // The menu's tape may have been destroyed meanwhile (e.g. by a reload)
+        tape = FindTape(hWnd);
+        if (id && tape) HandleCommand(hWnd, tape, id);
         return 0;
     }
 
     case WM_SHOW_EXISTING:
         // Message from another instance trying to start
-        if (isMinimized || isHidden) {
-            ShowWindow(hWnd, SW_SHOW);
-            isMinimized = false;
-            isHidden = false;
+        for (auto& t : g_tapes) {
+            t->isHidden = false;
+            ShowWindow(t->hWnd, SW_SHOW);
         }
+        isMinimized = false;
         SetForegroundWindow(hWnd);
         BringWindowToTop(hWnd);
         return 0;
 
     case WM_TRAYICON:
         if (lParam == WM_LBUTTONDOWN) {
-            // Left click on tray icon - show/hide window
-            if (isMinimized) {
-                ShowWindow(hWnd, SW_SHOW);
-                isMinimized = false;
-            }
-            else {
-                ShowWindow(hWnd, SW_HIDE);
-                isMinimized = true;
-            }
+            // Left click on tray icon - show/hide all tapes
+            HandleCommand(hWnd, nullptr, isMinimized ? IDM_SHOW : IDM_MINIMIZE);
         }
         else if (lParam == WM_RBUTTONDOWN) {
             // Right click on tray icon - show context menu
@@ -388,84 +610,64 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             GetCursorPos(&pt);
 
             // Update tray menu items
+            bool anyPaused = false;
+            bool anyRunning = false;
+            for (auto& t : g_tapes) {
+                if (t->isPaused) anyPaused = true;
+                else anyRunning = true;
+            }
             EnableMenuItem(hTrayMenu, IDM_SHOW, isMinimized ? MF_ENABLED : MF_GRAYED);
-            EnableMenuItem(hTrayMenu, IDM_PAUSE, isPaused ? MF_GRAYED : MF_ENABLED);
-            EnableMenuItem(hTrayMenu, IDM_RESUME, isPaused ? MF_ENABLED : MF_GRAYED);
+            EnableMenuItem(hTrayMenu, IDM_PAUSE, anyRunning ? MF_ENABLED : MF_GRAYED);
+            EnableMenuItem(hTrayMenu, IDM_RESUME, anyPaused ? MF_ENABLED : MF_GRAYED);
 
             SetForegroundWindow(hWnd); // Required for tray menus
-            TrackPopupMenu(hTrayMenu, TPM_RIGHTBUTTON, pt.x, pt.y, 0, hWnd, NULL);
+            UINT id = TrackPopupMenu(hTrayMenu, TPM_RIGHTBUTTON | TPM_RETURNCMD, pt.x, pt.y, 0, hWnd, NULL);
             PostMessage(hWnd, WM_NULL, 0, 0); // Required for tray menus
+            if (id) HandleCommand(hWnd, nullptr, id);
         }
         return 0;
 
     case WM_COMMAND:
-        switch (LOWORD(wParam)) {
-        case IDM_PAUSE:
-            isPaused = true;
-            break;
-        case IDM_RESUME:
-            isPaused = false;
-            break;
-        case IDM_RELOAD:
-            ConfigManager::LoadConfig();
-            Renderer::Init(hWnd);
-            RecalculateCharWidth(hWnd);
-            UpdateWindowSize(hWnd);
-            {
-                std::lock_guard<std::mutex> lock(textMutex);
-                std::wstring reloadingText = L"Reloading...   ";
-                tickerText = reloadingText + reloadingText + reloadingText;
-            }
-            dataUpdated = true;
-            UpdateLayeredDisplay(hWnd);
-            break;
-        case IDM_DOCK_TOP:
-            DockWindow(hWnd, true);
-            break;
-        case IDM_DOCK_BOTTOM:
-            DockWindow(hWnd, false);
-            break;
-        case IDM_UNDOCK:
-            UndockWindow(hWnd);
-            break;
-        case IDM_MINIMIZE:
-            ShowWindow(hWnd, SW_HIDE);
-            isMinimized = true;
-            break;
-        case IDM_SHOW:
-            ShowWindow(hWnd, SW_SHOW);
-            isMinimized = false;
-            break;
-        case IDM_SETTINGS:
-            ShowConfigDialog(hWnd);
-            break;
-        case IDM_EXIT:
-            PostMessage(hWnd, WM_DESTROY, 0, 0);
-            break;
-        }
+        HandleCommand(hWnd, tape, LOWORD(wParam));
+        return 0;
+
+    case WM_FINISH_STARTUP:
+        FinishStartup(hWnd);
+        return 0;
+
+    case WM_CONFIG_FILE_CHANGED:
+        // config.ini was edited outside the application
+        ConfigManager::LoadConfig();
+        ApplyConfigChanges();
         return 0;
 
     case WM_SIZE:
-        windowWidth = LOWORD(lParam);
-        windowHeight = HIWORD(lParam);
-        if (!isMinimized) {
-            UpdateLayeredDisplay(hWnd);
+        if (tape) {
+            RenderThread::Post(RenderCommandType::Resize, tape->index, LOWORD(lParam), HIWORD(lParam));
         }
         return 0;
 
-    case WM_CREATE:
-        RecalculateCharWidth(hWnd);
-        return 0;
+    case WM_SHOWWINDOW:
+        if (tape) {
+            RenderThread::Post(wParam ? RenderCommandType::Show : RenderCommandType::Hide, tape->index);
+        }
+        return DefWindowProc(hWnd, message, wParam, lParam);
+
+    case WM_WTSSESSION_CHANGE:
+    case WM_POWERBROADCAST:
+        // Lock, disconnect and display power decide whether to render
+        RenderPolicy::HandleMessage(message, wParam, lParam);
+        return DefWindowProc(hWnd, message, wParam, lParam);
 
     case WM_SETCURSOR:
         if (LOWORD(lParam) == HTCLIENT) {
-            SetCursor(LoadCursor(NULL, isDocked ? IDC_ARROW : IDC_SIZEALL));
+            SetCursor(LoadCursor(NULL, tape && tape->isDocked ? IDC_ARROW : IDC_SIZEALL));
             return TRUE;
         }
         return DefWindowProc(hWnd, message, wParam, lParam);
 
     case WM_WINDOWPOSCHANGED:
-        if (isDocked && !isMinimized) {
+        if (tape && tape->isDocked && !isMinimized) {
             WINDOWPOS* wp = (WINDOWPOS*)lParam;
             if (!(wp->flags & SWP_NOSIZE) || !(wp->flags & SWP_NOMOVE)) {
                 UpdateLayeredDisplay(hWnd);
@@ -474,7 +676,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         return DefWindowProc(hWnd, message, wParam, lParam);
 
     case APPBAR_CALLBACK:
-        if (wParam == ABN_POSCHANGED && isDocked && !isMinimized) {
+        if (wParam == ABN_POSCHANGED && tape && tape->isDocked && !isMinimized) {
             UpdateLayeredDisplay(hWnd);
             return 0;
         }
@@ -484,25 +686,31 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         // Check if this is a forced exit (from Exit menu) or just a close attempt
         if (forceExit.load()) {
             // Actually exit the application
-            DestroyWindow(hWnd);
+            DestroyWindow(g_hMainWnd);
         }
         else {
-            // Hide window instead of destroying it (minimize to tray)
-            ShowWindow(hWnd, SW_HIDE);
-            isMinimized = true;
+            // Hide the tapes instead of destroying them (minimize to tray)
+            HandleCommand(hWnd, nullptr, IDM_MINIMIZE);
         }
         return 0;
 
     case WM_DESTROY:
+        // Extra tapes are torn down by DestroyExtraTapes; only the primary
+        // window ends the application
+        if (hWnd != g_hMainWnd) return 0;
+
         // Unregister hotkeys
         UnregisterHotKey(hWnd, 100);
         UnregisterHotKey(hWnd, 101);
 
-        // Undock if docked
-        if (isDocked) UndockWindow(hWnd);
+        // Undock every docked tape
+        for (auto& t : g_tapes) {
+            if (t->isDocked) UndockWindow(t->hWnd);
+        }
 
-        // Kill timer
-        KillTimer(hWnd, TIMER_SCROLL);
+        // Stop rendering before the windows go away
+        RenderPolicy::Stop(hWnd);
+        RenderThread::Stop();
 
         // Post quit message
         PostQuitMessage(0);
@@ -515,93 +723,23 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 }
 
 void UpdateLayeredDisplay(HWND hWnd) {
-    // Check if window is visible
-    if (!IsWindowVisible(hWnd) || isHidden || isMinimized) {
-        return;
-    }
-
-    RECT clientRect;
-    if (!GetClientRect(hWnd, &clientRect)) return;
-
-    int width = clientRect.right - clientRect.left;
-    int height = clientRect.bottom - clientRect.top;
-
-    if (width <= 0 || height <= 0) return;
-
-    HDC hdcScreen = GetDC(nullptr);
-    if (!hdcScreen) return;
-
-    HDC hdcMem = CreateCompatibleDC(hdcScreen);
-    if (!hdcMem) {
-        ReleaseDC(nullptr, hdcScreen);
-        return;
-    }
-
-    HBITMAP hbmMem = CreateCompatibleBitmap(hdcScreen, width, height);
-    if (!hbmMem) {
-        DeleteDC(hdcMem);
-        ReleaseDC(nullptr, hdcScreen);
-        return;
-    }
-
-    HGDIOBJ hOldBmp = SelectObject(hdcMem, hbmMem);
-    HGDIOBJ hOldFont = SelectObject(hdcMem, Renderer::GetFont());
-
-    // Clear background
-    RECT fillRect = { 0, 0, width, height };
-    HBRUSH hBrush = CreateSolidBrush(RGB(0, 0, 0));
-    FillRect(hdcMem, &fillRect, hBrush);
-    DeleteObject(hBrush);
-
-    // Render text
-    {
-        std::lock_guard<std::mutex> lock(textMutex);
-        if (!tickerText.empty()) {
-            Renderer::Render(hdcMem, tickerText, scrollOffset, width, height, charWidth);
-        }
-    }
-
-    // Get window position for UpdateLayeredWindow
-    RECT windowRect;
-    GetWindowRect(hWnd, &windowRect);
-    POINT ptDst = { windowRect.left, windowRect.top };
-
-    BLENDFUNCTION bf = { 0 };
-    bf.BlendOp = AC_SRC_OVER;
-    bf.SourceConstantAlpha = 255;
-    bf.AlphaFormat = 0;
-
-    SIZE sizeWnd = { width, height };
-    POINT ptSrc = { 0, 0 };
-
-    BOOL result = UpdateLayeredWindow(hWnd, hdcScreen, &ptDst, &sizeWnd,
-        hdcMem, &ptSrc, 0, &bf, ULW_ALPHA);
-
-    if (!result) {
-        // Fallback: try without destination point
-        result = UpdateLayeredWindow(hWnd, hdcScreen, nullptr, &sizeWnd,
-            hdcMem, &ptSrc, 0, &bf, ULW_ALPHA);
-    }
-
-    // Cleanup
-    SelectObject(hdcMem, hOldFont);
-    SelectObject(hdcMem, hOldBmp);
-    DeleteObject(hbmMem);
-    DeleteDC(hdcMem);
-    ReleaseDC(nullptr, hdcScreen);
+    // Presentation happens on the render thread; just ask for a fresh frame
+    TapeWindow* tape = FindTape(hWnd);
+    RenderThread::Post(RenderCommandType::Redraw, tape ? tape->index : ALL_TAPES);
 }
 
 void DockWindow(HWND hWnd, bool top) {
     static bool isDocking = false;
-    if (isDocking) return;
+    TapeWindow* tape = FindTape(hWnd);
+    if (isDocking || !tape) return;
     isDocking = true;
 
-    if (isDocked) {
+    if (tape->isDocked) {
         APPBARDATA abd = { 0 };
         abd.cbSize = sizeof(APPBARDATA);
         abd.hWnd = hWnd;
         SHAppBarMessage(ABM_REMOVE, &abd);
-        isDocked = false;
+        tape->isDocked = false;
     }
 
     APPBARDATA abd = { 0 };
@@ -614,8 +752,8 @@ void DockWindow(HWND hWnd, bool top) {
         return;
     }
 
-    isDocked = true;
-    isDockedTop = top;
+    tape->isDocked = true;
+    tape->isDockedTop = top;
 
     HMONITOR hMon = MonitorFromWindow(hWnd, MONITOR_DEFAULTTONEAREST);
     MONITORINFO mi = { 0 };
@@ -655,17 +793,11 @@ void DockWindow(HWND hWnd, bool top) {
         abd.rc.left, abd.rc.top,
         abd.rc.right - abd.rc.left,
         abd.rc.bottom - abd.rc.top,
-        SWP_NOACTIVATE | SWP_SHOWWINDOW);
+        SWP_NOACTIVATE | (isMinimized || tape->isHidden ? 0 : SWP_SHOWWINDOW));
 
     // Restore layered style
     SetWindowLong(hWnd, GWL_EXSTYLE, exStyle);
 
-    windowWidth = abd.rc.right - abd.rc.left;
-    windowHeight = abd.rc.bottom - abd.rc.top;
-
-    Renderer::Init(hWnd);
-    RecalculateCharWidth(hWnd);
-
     Sleep(50);
 
     InvalidateRect(hWnd, NULL, TRUE);
@@ -675,45 +807,34 @@ void DockWindow(HWND hWnd, bool top) {
 }
 
 void UndockWindow(HWND hWnd) {
-    if (!isDocked) return;
+    TapeWindow* tape = FindTape(hWnd);
+    if (!tape || !tape->isDocked) return;
 
     APPBARDATA abd = { 0 };
     abd.cbSize = sizeof(APPBARDATA);
     abd.hWnd = hWnd;
     SHAppBarMessage(ABM_REMOVE, &abd);
 
-    isDocked = false;
+    tape->isDocked = false;
 
     RECT currentRect;
     GetWindowRect(hWnd, &currentRect);
 
     SetWindowPos(hWnd, HWND_TOPMOST,
         currentRect.left, currentRect.top,
-        GetSystemMetrics(SM_CXSCREEN), ConfigManager::windowHeight,
-        SWP_NOACTIVATE | SWP_SHOWWINDOW);
-
-    windowWidth = GetSystemMetrics(SM_CXSCREEN);
-    windowHeight = ConfigManager::windowHeight;
+        GetWindowMonitorWidth(hWnd), ConfigManager::windowHeight,
+        SWP_NOACTIVATE | (isMinimized || tape->isHidden ? 0 : SWP_SHOWWINDOW));
 
     UpdateLayeredDisplay(hWnd);
 }
 
 void UpdateWindowSize(HWND hWnd) {
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    SetWindowPos(hWnd, NULL, 0, 0, screenWidth, ConfigManager::windowHeight,
+    SetWindowPos(hWnd, NULL, 0, 0, GetWindowMonitorWidth(hWnd), ConfigManager::windowHeight,
         SWP_NOMOVE | SWP_NOZORDER | SWP_FRAMECHANGED);
     UpdateLayeredDisplay(hWnd);
 }
 
 void RecalculateCharWidth(HWND hWnd) {
-    HDC hdc = GetDC(hWnd);
-    HFONT hFont = Renderer::GetFont();
-    HFONT hOldFont = (HFONT)SelectObject(hdc, hFont);
-
-    SIZE size;
-    GetTextExtentPoint32(hdc, TEXT("A"), 1, &size);
-    charWidth = size.cx;
-
-    SelectObject(hdc, hOldFont);
-    ReleaseDC(hWnd, hdc);
+    // The render thread owns the font; have it recreate and re-measure
+    RenderThread::Post(RenderCommandType::FontChanged);
 }
\ No newline at end of file
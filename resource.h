@@ -18,6 +18,7 @@
 #define IDC_OK                         2010
 #define IDC_CANCEL                     2011
 #define IDC_APPLY                      2012
+#define IDC_SYMBOL_STATUS              2013
 
 // String IDs
 #define IDS_APP_TITLE                  103
@@ -33,6 +34,7 @@
 #define IDM_MINIMIZE                   8
 #define IDM_SETTINGS                   9
 #define IDM_SHOW                       10
+#define IDM_REFRESH                    11
 
 // System Tray
 #define IDI_TRAY                       1001
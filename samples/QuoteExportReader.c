@@ -0,0 +1,73 @@
+/*
+ * Sample quote export reader: prints the tape's latest quotes of the given
+ * symbols once a second, read through QuoteExport.h without polling the
+ * quote server. Start the tape with exportQuotes=1 in config.ini.
+ *
+ * Build:  cl /O2 /I.. QuoteExportReader.c
+ * Run:    QuoteExportReader AAPL MSFT BTC-USD
+ */
+
+#include "QuoteExport.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_SAMPLE_SYMBOLS 64
+
+/* value * 10^-scale as text */
+static void PrintDecimal(int64_t value, int scale) {
+    int64_t divisor = 1;
+    int64_t whole;
+    int64_t fraction;
+    int i;
+    for (i = 0; i < scale; ++i) divisor *= 10;
+    whole = value / divisor;
+    fraction = llabs(value % divisor);
+    if (value < 0 && whole == 0) printf("-");
+    if (scale > 0) printf("%lld.%0*lld", (long long)whole, scale, (long long)fraction);
+    else printf("%lld", (long long)whole);
+}
+
+int main(int argc, char** argv) {
+    QuoteExportReader reader;
+    int rows[MAX_SAMPLE_SYMBOLS];
+    int count = argc - 1;
+    int wasAlive = 0;
+    int i;
+
+    if (count < 1 || count > MAX_SAMPLE_SYMBOLS) {
+        fprintf(stderr, "usage: QuoteExportReader SYMBOL... (at most %d)\n", MAX_SAMPLE_SYMBOLS);
+        return 1;
+    }
+
+    while (!QuoteExportOpen(&reader)) {
+        fprintf(stderr, "Waiting for the tape (exportQuotes=1)...\n");
+        Sleep(2000);
+    }
+
+    for (;;) {
+        /* Rows never move while the tape exports; look up again after it
+           restarts, and symbols it did not show yet on every pass */
+        int alive = ReadAcquire(&reader.header->writerAlive);
+        for (i = 0; i < count; ++i) {
+            QuoteExportQuote quote;
+            if (!alive) rows[i] = -1;
+            else if (!wasAlive || rows[i] < 0) rows[i] = QuoteExportFind(&reader, argv[i + 1]);
+
+            printf("%-12s ", argv[i + 1]);
+            if (!QuoteExportRead(&reader, rows[i], &quote)) {
+                printf("-\n");
+                continue;
+            }
+            PrintDecimal(quote.price, quote.priceScale);
+            if (quote.previousClose) {
+                printf("  (previous close ");
+                PrintDecimal(quote.previousClose, quote.previousCloseScale);
+                printf(")");
+            }
+            printf("\n");
+        }
+        printf("\n");
+        wasAlive = alive;
+        Sleep(1000);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Sample local quote producer: random-walks the given symbols and pushes
+ * them into a running tape through QuoteFeed.h. Start the tape with
+ * localFeed=1 in config.ini and the symbols on one of its tapes.
+ *
+ * Build:  cl /O2 /I.. QuoteFeedProducer.c
+ * Run:    QuoteFeedProducer AAPL MSFT BTC-USD
+ */
+
+#include "QuoteFeed.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PRICE_SCALE 4          /* Prices carry four decimals */
+#define UPDATES_PER_SECOND 20
+#define MAX_SAMPLE_SYMBOLS 64
+
+static uint64_t UnixMillis(void) {
+    FILETIME now;
+    ULARGE_INTEGER ticks;
+    GetSystemTimeAsFileTime(&now);
+    ticks.LowPart = now.dwLowDateTime;
+    ticks.HighPart = now.dwHighDateTime;
+    return (ticks.QuadPart - 116444736000000000ULL) / 10000;
+}
+
+int main(int argc, char** argv) {
+    QuoteFeedProducer producer;
+    int64_t prices[MAX_SAMPLE_SYMBOLS];
+    int64_t opens[MAX_SAMPLE_SYMBOLS];
+    int count = argc - 1;
+    unsigned long pushed = 0;
+    unsigned long rounds = 0;
+    int i;
+
+    if (count < 1 || count > MAX_SAMPLE_SYMBOLS) {
+        fprintf(stderr, "usage: QuoteFeedProducer SYMBOL... (at most %d)\n", MAX_SAMPLE_SYMBOLS);
+        return 1;
+    }
+
+    while (!QuoteFeedOpen(&producer)) {
+        fprintf(stderr, "Waiting for the tape (localFeed=1)...\n");
+        Sleep(2000);
+    }
+
+    srand(GetTickCount());
+    for (i = 0; i < count; ++i) {
+        opens[i] = (50 + rand() % 450) * 10000LL;
+        prices[i] = opens[i];
+    }
+
+    for (;;) {
+        for (i = 0; i < count; ++i) {
+            /* Up to 0.1% either way */
+            prices[i] += prices[i] * (rand() % 2001 - 1000) / 1000000;
+            if (prices[i] < 1) prices[i] = 1;
+            if (QuoteFeedPush(&producer, argv[i + 1], prices[i], PRICE_SCALE,
+                opens[i], PRICE_SCALE, UnixMillis())) {
+                ++pushed;
+            }
+        }
+        if (++rounds % (UPDATES_PER_SECOND * 10) == 0) {
+            printf("%lu quotes pushed, %lld refused by a full ring\n", pushed, (long long)producer.header->dropped);
+        }
+        Sleep(1000 / UPDATES_PER_SECOND);
+    }
+}
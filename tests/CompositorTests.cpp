@@ -0,0 +1,102 @@
+#include "Test.h"
+#include "Compositor.h"
+
+#include <random>
+#include <vector>
+
+// Widths around every vector width and its remainder, plus a tape row
+static const int g_widths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 65, 1923 };
+
+#define PARITY_HEIGHT 3
+#define PARITY_PAD 5   // Stride beyond width, which no kernel may touch
+
+static std::vector<uint32_t> RandomPixels(std::mt19937& random, size_t count) {
+    std::vector<uint32_t> pixels(count);
+    for (uint32_t& pixel : pixels) {
+        // Premultiplied: no channel exceeds alpha
+        uint32_t alpha = random() & 0xFF;
+        uint32_t r = alpha ? random() % (alpha + 1) : 0;
+        uint32_t g = alpha ? random() % (alpha + 1) : 0;
+        uint32_t b = alpha ? random() % (alpha + 1) : 0;
+        pixel = b | (g << 8) | (r << 16) | (alpha << 24);
+    }
+    return pixels;
+}
+
+// Run op over the same random buffer with every kernel set the CPU has and
+// compare each result with the scalar one
+template <typename Op>
+static void CheckParity(const char* what, Op op) {
+    std::mt19937 random(7);
+    for (int width : g_widths) {
+        int stride = width + PARITY_PAD;
+        std::vector<uint32_t> source = RandomPixels(random, static_cast<size_t>(stride) * PARITY_HEIGHT);
+        std::vector<uint32_t> mask = RandomPixels(random, static_cast<size_t>(stride) * PARITY_HEIGHT);
+
+        CHECK(Compositor::SelectKernel("scalar"));
+        std::vector<uint32_t> expected = source;
+        op(expected.data(), mask.data(), width, stride);
+
+        for (const char* kernel : { "sse2", "avx2" }) {
+            if (!Compositor::SelectKernel(kernel)) continue;
+            std::vector<uint32_t> actual = source;
+            op(actual.data(), mask.data(), width, stride);
+            if (actual != expected) {
+                Test::Fail(__FILE__, __LINE__, std::string(what) + ": " + kernel + " differs from scalar at width " +
+                    std::to_string(width));
+            }
+        }
+    }
+    Compositor::SelectKernel(nullptr);
+}
+
+TEST(SelectKernelKnowsTheSets) {
+    CHECK(Compositor::SelectKernel("scalar"));
+    CHECK_EQ(Compositor::GetKernelName(), std::string("scalar"));
+    CHECK(!Compositor::SelectKernel("neon9"));
+    CHECK_EQ(Compositor::GetKernelName(), std::string("scalar"));
+    CHECK(Compositor::SelectKernel(nullptr));
+}
+
+TEST(PremultiplyScalesByAlpha) {
+    CHECK_EQ(Compositor::Premultiply(0xFFFFFF, 255), 0xFFFFFFFFu);
+    CHECK_EQ(Compositor::Premultiply(0xFF8000, 0), 0u);
+    CHECK_EQ(Compositor::Premultiply(0xFF8000, 128), 0x80804000u);
+}
+
+TEST(FullCoverageGivesTheColor) {
+    uint32_t dst[3] = { 0xFF123456u, 0, 0x80402010u };
+    uint32_t mask[3] = { 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu };
+    Compositor::BlendCoverage(dst, 3, mask, 3, 3, 1, 0x00FF00, 255);
+    for (uint32_t pixel : dst) CHECK_EQ(pixel, 0xFF00FF00u);
+
+    // No coverage leaves the destination alone
+    uint32_t keep[2] = { 0xFF123456u, 0x80402010u };
+    uint32_t none[2] = { 0, 0 };
+    Compositor::BlendCoverage(keep, 2, none, 2, 2, 1, 0x00FF00, 255);
+    CHECK_EQ(keep[0], 0xFF123456u);
+    CHECK_EQ(keep[1], 0x80402010u);
+}
+
+TEST(FillParity) {
+    CheckParity("Fill", [](uint32_t* dst, const uint32_t*, int width, int stride) {
+        Compositor::Fill(dst, stride, width, PARITY_HEIGHT, 0xC0102030u);
+    });
+}
+
+TEST(BlendCoverageParity) {
+    for (int alpha : { 1, 77, 200, 255 }) {
+        CheckParity("BlendCoverage", [alpha](uint32_t* dst, const uint32_t* mask, int width, int stride) {
+            Compositor::BlendCoverage(dst, stride, mask, stride, width, PARITY_HEIGHT, 0xFF4040,
+                static_cast<uint8_t>(alpha));
+        });
+    }
+}
+
+TEST(FadeEdgesParity) {
+    for (int fade : { 1, 5, 24 }) {
+        CheckParity("FadeEdges", [fade](uint32_t* dst, const uint32_t*, int width, int stride) {
+            Compositor::FadeEdges(dst, stride, width, PARITY_HEIGHT, fade);
+        });
+    }
+}
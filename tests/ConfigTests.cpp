@@ -0,0 +1,181 @@
+#include "Test.h"
+#include "ConfigManager.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::filesystem::path ScratchDirectory() {
+    return std::filesystem::temp_directory_path() / "ticker_config_tests";
+}
+
+// Removes the scratch directory when the tests exit
+static struct ScratchCleanup {
+    ~ScratchCleanup() {
+        std::error_code error;
+        std::filesystem::remove_all(ScratchDirectory(), error);
+    }
+} g_scratchCleanup;
+
+// Each test works on its own config.ini in a scratch directory
+static std::filesystem::path UseScratchConfig(const char* name) {
+    std::filesystem::path directory = ScratchDirectory();
+    std::filesystem::create_directories(directory);
+    std::filesystem::path path = directory / (std::string(name) + ".ini");
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    ConfigManager::configPath = path.wstring();
+    return path;
+}
+
+static void WriteConfig(const std::filesystem::path& path, const char* text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+TEST(MissingFileIsCreatedWithDefaults) {
+    std::filesystem::path path = UseScratchConfig("missing");
+    unsigned long long version = ConfigManager::Current() ? ConfigManager::Current()->version : 0;
+    ConfigManager::LoadConfig();
+    CHECK(std::filesystem::exists(path));
+
+    std::shared_ptr<const ConfigSnapshot> snapshot = ConfigManager::Current();
+    CHECK(snapshot != nullptr);
+    if (!snapshot) return;
+    CHECK(snapshot->version > version);
+    CHECK_EQ(snapshot->tapes.size(), size_t(1));
+    CHECK(snapshot->tapes[0].symbols == ConfigManager::symbols);
+    CHECK_EQ(snapshot->refreshInterval, 60);
+    CHECK(snapshot->tapeFormat == DEFAULT_TAPE_FORMAT);
+}
+
+// A reload publishes a new snapshot; one a thread still holds is unchanged
+TEST(ReloadLeavesHeldSnapshotsAlone) {
+    std::filesystem::path path = UseScratchConfig("reload");
+    WriteConfig(path, "symbols=AAPL,MSFT\nrefreshInterval=30\nfontName=Courier New\n");
+    ConfigManager::LoadConfig();
+    std::shared_ptr<const ConfigSnapshot> before = ConfigManager::Current();
+
+    WriteConfig(path, "symbols=BTC-USD\nrefreshInterval=5\n\n[tape]\nsymbols=^GSPC\nmonitor=1\ndock=top\n");
+    ConfigManager::LoadConfig();
+    std::shared_ptr<const ConfigSnapshot> after = ConfigManager::Current();
+
+    CHECK(after->version > before->version);
+    CHECK((before->tapes[0].symbols == std::vector<std::string>{ "AAPL", "MSFT" }));
+    CHECK_EQ(before->tapes.size(), size_t(1));
+    CHECK_EQ(before->refreshInterval, 30);
+    CHECK(before->fontName == L"Courier New");
+
+    CHECK((after->tapes[0].symbols == std::vector<std::string>{ "BTC-USD" }));
+    CHECK_EQ(after->refreshInterval, 5);
+    CHECK(after->fontName == L"Consolas");
+    CHECK_EQ(after->tapes.size(), size_t(2));
+    if (after->tapes.size() == 2) {
+        CHECK((after->tapes[1].symbols == std::vector<std::string>{ "^GSPC" }));
+        CHECK_EQ(after->tapes[1].monitor, 1);
+        CHECK(after->tapes[1].dock == L"top");
+    }
+}
+
+TEST(SavedConfigLoadsBack) {
+    UseScratchConfig("roundtrip");
+    ConfigManager::SetDefaults();
+    ConfigManager::symbols = { "EURUSD=X", "GC=F" };
+    ConfigManager::scrollSpeed = 1.5;
+    ConfigManager::textColor = 0x12AB34;
+    ConfigManager::opacity = 70;
+    ConfigManager::tapeFormat = L"{sym} {price:.4}";
+    ConfigManager::extraTapes = { { { "ETH-USD" }, 3.0, 2, L"bottom" } };
+    ConfigManager::SaveConfig();
+
+    ConfigManager::SetDefaults();
+    ConfigManager::LoadConfig();
+    std::shared_ptr<const ConfigSnapshot> snapshot = ConfigManager::Current();
+    CHECK((snapshot->tapes[0].symbols == std::vector<std::string>{ "EURUSD=X", "GC=F" }));
+    CHECK_EQ(snapshot->tapes[0].scrollSpeed, 1.5);
+    CHECK_EQ(snapshot->textColor, DWORD(0x12AB34));
+    CHECK_EQ(snapshot->opacity, 70);
+    CHECK(snapshot->tapeFormat == L"{sym} {price:.4}");
+    CHECK(!snapshot->tapeTemplate.HasSparkline());
+    CHECK_EQ(snapshot->tapes.size(), size_t(2));
+    if (snapshot->tapes.size() == 2) {
+        CHECK_EQ(snapshot->tapes[1].scrollSpeed, 3.0);
+        CHECK_EQ(snapshot->tapes[1].monitor, 2);
+        CHECK(snapshot->tapes[1].dock == L"bottom");
+    }
+}
+
+// config.ini is UTF-8, with or without a BOM: non-ASCII symbols and text
+// survive a load and a save
+TEST(NonAsciiConfigRoundTrips) {
+    std::filesystem::path path = UseScratchConfig("utf8");
+    WriteConfig(path, "\xEF\xBB\xBFsymbols=NESN.SW,\xC3\x85" "BC\r\ntapeFormat={sym} \xE2\x82\xAC{price}\r\n");
+    ConfigManager::LoadConfig();
+    std::shared_ptr<const ConfigSnapshot> snapshot = ConfigManager::Current();
+    CHECK((snapshot->tapes[0].symbols == std::vector<std::string>{ "NESN.SW", "\xC3\x85" "BC" }));
+    CHECK(snapshot->tapeFormat == L"{sym} \x20AC{price}");
+
+    ConfigManager::SaveConfig();
+    std::ifstream file(path, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    CHECK(text.find("symbols=NESN.SW,\xC3\x85" "BC") != std::string::npos);
+    CHECK(text.find("tapeFormat={sym} \xE2\x82\xAC{price}") != std::string::npos);
+
+    ConfigManager::SetDefaults();
+    ConfigManager::LoadConfig();
+    snapshot = ConfigManager::Current();
+    CHECK((snapshot->tapes[0].symbols == std::vector<std::string>{ "NESN.SW", "\xC3\x85" "BC" }));
+    CHECK(snapshot->tapeFormat == L"{sym} \x20AC{price}");
+}
+
+// A tapeFormat that does not compile leaves the default template in place
+TEST(BadTapeFormatFallsBack) {
+    std::filesystem::path path = UseScratchConfig("badformat");
+    WriteConfig(path, "symbols=AAPL\ntapeFormat={sym} {nope}\n");
+    ConfigManager::LoadConfig();
+    std::shared_ptr<const ConfigSnapshot> snapshot = ConfigManager::Current();
+    CHECK(snapshot->tapeFormat == L"{sym} {nope}");
+    CHECK(snapshot->tapeTemplate.HasSparkline());
+
+    std::string text;
+    snapshot->tapeTemplate.Format("AAPL", Price::FromUnits(12345, 2), Price(), false, text);
+    CHECK_EQ(text, std::string("AAPL: $123.45"));
+}
+
+// Readers on other threads only ever see whole snapshots, newest last
+TEST(ReadersSeeWholeSnapshots) {
+    UseScratchConfig("readers");
+    ConfigManager::SetDefaults();
+    ConfigManager::symbols.assign(1, "SYM");
+    ConfigManager::refreshInterval = 1;
+    ConfigManager::Publish();
+    std::atomic<bool> publishing{ true };
+    std::atomic<int> bad{ 0 };
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            unsigned long long last = 0;
+            while (publishing.load()) {
+                std::shared_ptr<const ConfigSnapshot> snapshot = ConfigManager::Current();
+                if (snapshot->version < last) ++bad;
+                // Published with refreshInterval equal to the symbol count
+                if (snapshot->refreshInterval != static_cast<int>(snapshot->tapes[0].symbols.size())) ++bad;
+                last = snapshot->version;
+            }
+        });
+    }
+
+    for (int i = 1; i <= 2000; ++i) {
+        ConfigManager::symbols.assign(i % 50 + 1, "SYM");
+        ConfigManager::refreshInterval = i % 50 + 1;
+        ConfigManager::Publish();
+    }
+    publishing = false;
+    for (std::thread& reader : readers) reader.join();
+    CHECK_EQ(bad.load(), 0);
+}
@@ -0,0 +1,171 @@
+#include "Test.h"
+#include "QuoteConflator.h"
+#include "QuoteExporter.h"
+#include "QuoteExport.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Every quote these tests publish has price == previousClose, so a torn
+// read shows as a mismatch
+static void PublishPair(int id, int64_t units) {
+    QuoteConflator::Publish(id, Price::FromUnits(units, 2), Price::FromUnits(units, 2));
+}
+
+static std::vector<ConflatedQuote> DrainId(int id) {
+    std::vector<ConflatedQuote> all;
+    std::vector<ConflatedQuote> mine;
+    QuoteConflator::Drain(all);
+    for (const ConflatedQuote& quote : all) {
+        if (quote.id == id) mine.push_back(quote);
+    }
+    return mine;
+}
+
+TEST(InternAssignsStableIds) {
+    int id = QuoteConflator::Intern("INTERN");
+    CHECK(id >= 0);
+    CHECK_EQ(QuoteConflator::Intern("INTERN"), id);
+    CHECK_EQ(QuoteConflator::Find("INTERN"), id);
+    CHECK_EQ(QuoteConflator::Find("NEVER"), -1);
+    CHECK_EQ(QuoteConflator::GetSymbol(id), std::string("INTERN"));
+}
+
+TEST(DrainReturnsLatestOnce) {
+    int id = QuoteConflator::Intern("LATEST");
+    PublishPair(id, 100);
+    PublishPair(id, 101);
+    PublishPair(id, 102);
+
+    std::vector<ConflatedQuote> drained = DrainId(id);
+    CHECK_EQ(drained.size(), size_t(1));
+    if (!drained.empty()) CHECK(drained[0].price == Price::FromUnits(102, 2));
+    CHECK(DrainId(id).empty());
+}
+
+// Only updates replaced before a drain count as conflated, and draining
+// never lowers the count
+TEST(ConflatedCountOnlyGrows) {
+    int id = QuoteConflator::Intern("CONFLATED");
+    DrainId(id);
+    unsigned long long before = QuoteConflator::GetUpdatesConflated();
+    PublishPair(id, 1);
+    CHECK_EQ(QuoteConflator::GetUpdatesConflated(), before);
+    PublishPair(id, 2);
+    PublishPair(id, 3);
+    CHECK_EQ(QuoteConflator::GetUpdatesConflated(), before + 2);
+
+    DrainId(id);
+    CHECK_EQ(QuoteConflator::GetUpdatesConflated(), before + 2);
+    PublishPair(id, 4);
+    CHECK_EQ(QuoteConflator::GetUpdatesConflated(), before + 2);
+    DrainId(id);
+}
+
+TEST(ReadLeavesTheUpdateToDrain) {
+    int id = QuoteConflator::Intern("READ");
+    ConflatedQuote quote;
+    CHECK(!QuoteConflator::Read(id, quote));
+
+    PublishPair(id, 500);
+    CHECK(QuoteConflator::Read(id, quote));
+    CHECK(quote.price == Price::FromUnits(500, 2));
+    CHECK_EQ(DrainId(id).size(), size_t(1));
+}
+
+TEST(LatestFollowsTheLastPublisher) {
+    int id = QuoteConflator::Intern("HANDOFF");
+    std::thread([id] { PublishPair(id, 1); }).join();
+    std::thread([id] { PublishPair(id, 2); }).join();
+
+    // The first thread's buffer went to the second or is free; either way
+    // the slot shows the second thread's quote
+    ConflatedQuote quote;
+    CHECK(QuoteConflator::Read(id, quote));
+    CHECK(quote.price == Price::FromUnits(2, 2));
+    std::thread([id] { PublishPair(id, 3); }).join();
+    CHECK(QuoteConflator::Read(id, quote));
+    CHECK(quote.price == Price::FromUnits(3, 2));
+}
+
+TEST(ConcurrentProducersNeverTear) {
+    const int producers = 4;
+    const int perProducer = 20000;
+    int id = QuoteConflator::Intern("TEAR");
+
+    std::atomic<bool> running(true);
+    std::atomic<int> torn(0);
+    std::thread consumer([&] {
+        ConflatedQuote quote;
+        while (running.load()) {
+            if (QuoteConflator::Read(id, quote) && quote.price != quote.previousClose) ++torn;
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([id, p] {
+            for (int n = 1; n <= perProducer; ++n) PublishPair(id, p * 1000000 + n);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    running = false;
+    consumer.join();
+    CHECK_EQ(torn.load(), 0);
+
+    // Whoever published last, its final quote is the latest
+    ConflatedQuote quote;
+    CHECK(QuoteConflator::Read(id, quote));
+    bool final = false;
+    for (int p = 0; p < producers; ++p) {
+        if (quote.price == Price::FromUnits(p * 1000000 + perProducer, 2)) final = true;
+    }
+    CHECK(final);
+}
+
+TEST(ExportRowsFollowTheConflator) {
+    CHECK(QuoteExporter::Start());
+    int id = QuoteConflator::Intern("EXPORT");
+
+    QuoteExportReader reader;
+    CHECK(QuoteExportOpen(&reader));
+    if (!reader.header) return;
+    int row = QuoteExportFind(&reader, "EXPORT");
+    CHECK_EQ(row, id);
+
+    QuoteExportQuote exported = {};
+    CHECK(!QuoteExportRead(&reader, row, &exported));
+
+    // Writers of one row combine; the row ends on the latest quote and
+    // never shows a torn one
+    std::atomic<bool> running(true);
+    std::atomic<int> torn(0);
+    std::thread watcher([&] {
+        QuoteExportQuote quote;
+        while (running.load()) {
+            if (QuoteExportRead(&reader, row, &quote) &&
+                (quote.price != quote.previousClose || quote.priceScale != quote.previousCloseScale)) {
+                ++torn;
+            }
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 4; ++p) {
+        threads.emplace_back([id, p] {
+            for (int n = 1; n <= 20000; ++n) PublishPair(id, p * 1000000 + n);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    running = false;
+    watcher.join();
+    CHECK_EQ(torn.load(), 0);
+
+    ConflatedQuote latest;
+    CHECK(QuoteConflator::Read(id, latest));
+    CHECK(QuoteExportRead(&reader, row, &exported));
+    CHECK(Price::FromUnits(exported.price, exported.priceScale) == latest.price);
+
+    QuoteExportClose(&reader);
+    QuoteExporter::Stop();
+}
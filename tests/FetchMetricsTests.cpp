@@ -0,0 +1,79 @@
+#include "Test.h"
+#include "FetchMetrics.h"
+#include "QuoteConflator.h"
+
+#include <string>
+
+static unsigned long long g_value = 0;
+
+static unsigned long long ReadValue() {
+    return g_value;
+}
+
+static unsigned long long ReadSeven() {
+    return 7;
+}
+
+static bool Contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+TEST(AddedSeriesAreDumped) {
+    g_value = 42;
+    FetchMetrics::AddSeries("test_events_total", "Events the test counted", "counter", ReadValue);
+    std::string dump = FetchMetrics::FormatPrometheus();
+    CHECK(Contains(dump, "# HELP test_events_total Events the test counted\n"));
+    CHECK(Contains(dump, "# TYPE test_events_total counter\n"));
+    CHECK(Contains(dump, "\ntest_events_total 42\n"));
+
+    // Read at dump time
+    g_value = 43;
+    CHECK(Contains(FetchMetrics::FormatPrometheus(), "\ntest_events_total 43\n"));
+}
+
+TEST(AddingANameAgainReplacesIt) {
+    FetchMetrics::AddSeries("test_level", "A level", "gauge", ReadValue);
+    FetchMetrics::AddSeries("test_level", "A level", "gauge", ReadSeven);
+    std::string dump = FetchMetrics::FormatPrometheus();
+    CHECK(Contains(dump, "\ntest_level 7\n"));
+    CHECK_EQ(dump.find("# TYPE test_level"), dump.rfind("# TYPE test_level"));
+}
+
+TEST(RequestsAreCountedByGroup) {
+    RequestTiming timing;
+    timing.ttfbUs = 900;
+    timing.totalUs = 1200;
+    FetchMetrics::RecordRequest(SymbolGroup::Crypto, timing, 5000, 200);
+    FetchMetrics::RecordResult(SymbolGroup::Crypto, FetchError::None);
+    std::string dump = FetchMetrics::FormatPrometheus();
+    CHECK(Contains(dump, "group=\"crypto\""));
+    CHECK(Contains(dump, "code=\"200\"} 1\n"));
+    CHECK(Contains(dump, "result=\"ok\"} 1\n"));
+}
+
+TEST(ConflatorCountersAreDumped) {
+    int id = QuoteConflator::Intern("METRICS");
+    QuoteConflator::Publish(id, Price::FromUnits(1, 0), Price::FromUnits(1, 0));
+    QuoteConflator::Publish(id, Price::FromUnits(2, 0), Price::FromUnits(1, 0));
+    std::string dump = FetchMetrics::FormatPrometheus();
+    CHECK(Contains(dump, "# TYPE quote_updates_published_total counter\n"));
+    CHECK(Contains(dump, "\nquote_updates_published_total " + std::to_string(QuoteConflator::GetUpdatesPublished()) + "\n"));
+    CHECK(Contains(dump, "\nquote_updates_conflated_total " + std::to_string(QuoteConflator::GetUpdatesConflated()) + "\n"));
+    CHECK(QuoteConflator::GetUpdatesPublished() >= 2);
+}
+
+TEST(HistogramBucketsStayWithinAnEighth) {
+    for (uint64_t value : { 0ULL, 7ULL, 8ULL, 100ULL, 12345ULL, 999999ULL }) {
+        uint64_t floor = Histogram::BucketFloor(Histogram::BucketOf(value));
+        CHECK(floor <= value);
+        CHECK(value - floor <= value / 8);
+    }
+
+    Histogram histogram;
+    for (uint64_t value = 1; value <= 1000; ++value) histogram.Record(value);
+    Histogram::Totals totals;
+    histogram.Read(totals);
+    CHECK_EQ(totals.count, 1000ULL);
+    uint64_t median = Histogram::Quantile(totals, 0.5);
+    CHECK(median >= 440 && median <= 560);
+}
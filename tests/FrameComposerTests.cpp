@@ -0,0 +1,81 @@
+#include "Test.h"
+#include "HeadlessRenderer.h"
+#include "TapeModel.h"
+
+#include <string>
+#include <vector>
+
+#define FRAME_WIDTH 480
+#define FRAME_HEIGHT 24
+
+static const FrameStyle g_style = { 0xC0C0C0, 0x00E050, 0xFF4040, 0xFFFF00, 0x000000, 200, 16 };
+
+// A tape of symbols alternating up and down; the first symbols are the same
+// whatever the length
+static TapeSnapshot BuildTape(int symbols) {
+    TapeSnapshot snapshot;
+    TapeModel::Begin(snapshot);
+    for (int i = 0; i < symbols; ++i) {
+        std::string text = "SYM" + std::to_string(i) + " " + std::to_string(100 + i) + ".25";
+        TapeModel::Append(snapshot, text, i % 2 ? SegmentTone::Down : SegmentTone::Up, false);
+    }
+    TapeModel::Finish(snapshot, 0);
+    return snapshot;
+}
+
+static std::vector<uint32_t> Render(HeadlessRenderer& renderer, const TapeSnapshot& tape, double offset) {
+    const uint32_t* pixels = renderer.RenderFrame(tape, offset, g_style, 0);
+    return std::vector<uint32_t>(pixels, pixels + static_cast<size_t>(renderer.GetWidth()) * renderer.GetHeight());
+}
+
+// Only the visible slice is drawn: a frame of a long watchlist costs the
+// same and looks the same as one of a short list with the same start
+TEST(FrameCostTracksTheWindow) {
+    TapeSnapshot shortTape = BuildTape(20);
+    TapeSnapshot longTape = BuildTape(2000);
+    HeadlessRenderer renderer(FRAME_WIDTH, FRAME_HEIGHT);
+    CHECK(shortTape.cycleLength * renderer.GetCellWidth() > FRAME_WIDTH * 2);
+
+    for (double offset : { 0.0, 37.5, 300.0 }) {
+        std::vector<uint32_t> expected = Render(renderer, shortTape, offset);
+        int drawCalls = renderer.GetLastFrameDrawCalls();
+        CHECK(Render(renderer, longTape, offset) == expected);
+        CHECK_EQ(renderer.GetLastFrameDrawCalls(), drawCalls);
+
+        // One blend per visible run, a couple of symbols' worth at most
+        CHECK(drawCalls > 0);
+        CHECK(drawCalls <= FRAME_WIDTH / renderer.GetCellWidth() / 4 + 2);
+    }
+}
+
+// The text holds the cycle three times so the scroll can wrap seamlessly
+TEST(FrameRepeatsEveryCycle) {
+    TapeSnapshot tape = BuildTape(20);
+    HeadlessRenderer renderer(FRAME_WIDTH, FRAME_HEIGHT);
+    double cycle = static_cast<double>(tape.cycleLength) * renderer.GetCellWidth();
+    for (double offset : { 0.0, 113.0, cycle - FRAME_WIDTH / 2.0 }) {
+        std::vector<uint32_t> first = Render(renderer, tape, offset);
+        int drawCalls = renderer.GetLastFrameDrawCalls();
+        CHECK(Render(renderer, tape, offset + cycle) == first);
+        CHECK_EQ(renderer.GetLastFrameDrawCalls(), drawCalls);
+    }
+}
+
+// Tapes share no frame state: interleaving them changes no frame
+TEST(TapesRenderIndependently) {
+    TapeSnapshot first = BuildTape(12);
+    TapeSnapshot second = BuildTape(30);
+    HeadlessRenderer wide(FRAME_WIDTH, FRAME_HEIGHT);
+    HeadlessRenderer narrow(FRAME_WIDTH / 2, FRAME_HEIGHT + 8);
+
+    std::vector<std::vector<uint32_t>> alone;
+    for (int frame = 0; frame < 4; ++frame) alone.push_back(Render(wide, first, frame * 7.5));
+    for (int frame = 0; frame < 4; ++frame) alone.push_back(Render(narrow, second, frame * 3.0));
+
+    HeadlessRenderer wideAgain(FRAME_WIDTH, FRAME_HEIGHT);
+    HeadlessRenderer narrowAgain(FRAME_WIDTH / 2, FRAME_HEIGHT + 8);
+    for (int frame = 0; frame < 4; ++frame) {
+        CHECK(Render(wideAgain, first, frame * 7.5) == alone[frame]);
+        CHECK(Render(narrowAgain, second, frame * 3.0) == alone[4 + frame]);
+    }
+}
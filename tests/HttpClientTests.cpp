@@ -0,0 +1,103 @@
+#include "Test.h"
+#include "StubServer.h"
+#include "HttpClient.h"
+
+#include <windows.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define SLOW_REQUESTS 1000
+#define SLOW_DELAY_MS 1000
+
+// Both ends of every connection are open at once
+static void AllowSockets(size_t count) {
+#ifndef _WIN32
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < count) {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, count);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#else
+    (void)count;
+#endif
+}
+
+struct SlowFetch {
+    std::wstring path;
+    std::string body;
+    HttpResponse response;
+    std::thread::id finishedOn;
+};
+
+// A thousand requests the server holds for a second each are all in flight
+// together, and every one completes on the same I/O thread
+TEST(SlowRequestsShareOneThread) {
+    AllowSockets(SLOW_REQUESTS * 2 + 64);
+    StubServer server;
+    CHECK(server.Port() != 0);
+    server.SetDelay(SLOW_DELAY_MS);
+    HttpClient client(L"127.0.0.1", server.Port(), false, SLOW_REQUESTS);
+    CHECK(client.IsOpen());
+
+    std::vector<SlowFetch> fetches(SLOW_REQUESTS);
+    std::latch finished(SLOW_REQUESTS);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < fetches.size(); ++i) {
+        SlowFetch& fetch = fetches[i];
+        fetch.path = L"/v8/finance/chart/SLOW" + std::to_wstring(i);
+        Spawn(client.Get(fetch.path, fetch.body, nullptr, 30000, GetTickCount64() + 60000),
+            [&fetch, &finished](HttpResponse response) {
+                fetch.response = response;
+                fetch.finishedOn = std::this_thread::get_id();
+                finished.count_down();
+            });
+    }
+    finished.wait();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t succeeded = 0;
+    bool oneThread = true;
+    for (const SlowFetch& fetch : fetches) {
+        if (fetch.response.error == FetchError::None && fetch.response.status == 200 && fetch.body == STUB_BODY) {
+            ++succeeded;
+        }
+        oneThread = oneThread && fetch.finishedOn == fetches[0].finishedOn;
+    }
+    CHECK_EQ(succeeded, static_cast<size_t>(SLOW_REQUESTS));
+    CHECK(oneThread);
+    CHECK(fetches[0].finishedOn != std::this_thread::get_id());
+    CHECK_EQ(server.PeakPending(), static_cast<size_t>(SLOW_REQUESTS));
+    // One after another they would take over 16 minutes
+    CHECK(elapsed < std::chrono::seconds(10));
+}
+
+// A request the server never answers fails once its timeout runs out
+TEST(StalledRequestTimesOut) {
+    StubServer server;
+    server.SetStalled(true);
+    HttpClient client(L"127.0.0.1", server.Port(), false, 1);
+
+    std::wstring path = L"/v8/finance/chart/STALL";
+    std::string body;
+    HttpResponse response;
+    std::latch finished(1);
+    auto start = std::chrono::steady_clock::now();
+    Spawn(client.Get(path, body, nullptr, 300, GetTickCount64() + 60000), [&](HttpResponse result) {
+        response = result;
+        finished.count_down();
+    });
+    finished.wait();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    CHECK(response.error == FetchError::Timeout);
+    CHECK(elapsed < std::chrono::seconds(2));
+}
@@ -0,0 +1,115 @@
+#include "Test.h"
+#include "Price.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+
+static bool ParseText(const char* text, Price& price) {
+    return Price::Parse(text, text + strlen(text), price);
+}
+
+static std::string FormatText(Price price, int decimals) {
+    char buffer[PRICE_MAX_CHARS];
+    return std::string(buffer, price.Format(buffer, decimals));
+}
+
+// Parse text and format it back at decimals places
+static std::string Reformat(const char* text, int decimals) {
+    Price price;
+    if (!ParseText(text, price)) return "(none)";
+    return FormatText(price, decimals);
+}
+
+TEST(ParsesExactDecimals) {
+    Price price;
+    CHECK(ParseText("0.1", price));
+    CHECK(price == Price::FromUnits(1, 1));
+    CHECK(ParseText("187.4400", price));
+    CHECK(price == Price::FromUnits(18744, 2));
+    CHECK(ParseText("-3", price));
+    CHECK(price == Price::FromUnits(-3, 0));
+    CHECK(ParseText("-0.000", price));
+    CHECK(price.IsZero());
+}
+
+TEST(ExponentMovesTheDecimalPoint) {
+    Price price;
+    CHECK(ParseText("1.5e-2", price));
+    CHECK(price == Price::FromUnits(15, 3));
+    CHECK(ParseText("2E+3", price));
+    CHECK(price == Price::FromUnits(2000, 0));
+    CHECK(!ParseText("1e", price));
+}
+
+TEST(ParseStopsAtTheNumber) {
+    const char* text = "12.5,\"next\"";
+    Price price;
+    CHECK(Price::Parse(text, text + strlen(text), price));
+    CHECK(price == Price::FromUnits(125, 1));
+}
+
+TEST(RejectsWhatIsNotAPrice) {
+    Price price;
+    CHECK(!ParseText("", price));
+    CHECK(!ParseText("-", price));
+    CHECK(!ParseText("null", price));
+    CHECK(!ParseText(".", price));
+    CHECK(!ParseText("99999999999999999999", price));
+    CHECK(!ParseText("1e30", price));
+}
+
+TEST(ExtraDecimalsRoundHalfUp) {
+    CHECK_EQ(Reformat("0.1234567890125", 12), std::string("0.123456789013"));
+    CHECK_EQ(Reformat("0.1234567890124", 12), std::string("0.123456789012"));
+}
+
+TEST(FormatRoundsHalfAwayFromZero) {
+    CHECK_EQ(Reformat("1.005", 2), std::string("1.01"));
+    CHECK_EQ(Reformat("-1.005", 2), std::string("-1.01"));
+    CHECK_EQ(Reformat("1.004", 2), std::string("1.00"));
+    CHECK_EQ(Reformat("9.995", 2), std::string("10.00"));
+    CHECK_EQ(Reformat("-0.004", 2), std::string("0.00"));
+    CHECK_EQ(Reformat("0.5", 0), std::string("1"));
+    CHECK_EQ(Reformat("1.5", 4), std::string("1.5000"));
+    CHECK_EQ(Reformat("0", 2), std::string("0.00"));
+}
+
+TEST(CanonicalValuesCompareByBits) {
+    CHECK(Price::FromUnits(500, 2) == Price::FromUnits(5, 0));
+    CHECK_EQ(Price::FromUnits(500, 2).GetBits(), Price::FromUnits(5, 0).GetBits());
+    CHECK(Price::FromUnits(501, 2) != Price::FromUnits(5, 0));
+    CHECK_EQ(Price::FromUnits(1, 1).Compare(Price::FromUnits(99, 3)), 1);
+    CHECK_EQ(Price::FromUnits(-1, 0).Compare(Price::FromUnits(0, 0)), -1);
+    CHECK_EQ(Price::FromUnits(10, 1).Compare(Price::FromUnits(1, 0)), 0);
+}
+
+TEST(SubtractIsExact) {
+    Price difference;
+    CHECK(Price::Subtract(Price::FromUnits(3, 1), Price::FromUnits(1, 1), difference));
+    CHECK(difference == Price::FromUnits(2, 1));
+    CHECK(Price::Subtract(Price::FromUnits(1, 0), Price::FromUnits(1, 12), difference));
+    CHECK(difference == Price::FromUnits(999999999999LL, 12));
+}
+
+// Any price formatted at its own scale parses back to the same bits
+TEST(FormatParseRoundTrip) {
+    std::mt19937_64 random(43);
+    int mismatches = 0;
+    for (int i = 0; i < 200000; ++i) {
+        int scale = static_cast<int>(random() % (PRICE_MAX_SCALE + 1));
+        int64_t units = static_cast<int64_t>(random() >> (random() % 63 + 6));
+        if (random() & 1) units = -units;
+        Price price = Price::FromUnits(units, scale);
+
+        char buffer[PRICE_MAX_CHARS];
+        char* end = price.Format(buffer, price.GetScale());
+        Price parsed;
+        if (!Price::Parse(buffer, end, parsed) || parsed != price) {
+            if (++mismatches <= 5) {
+                Test::Fail(__FILE__, __LINE__, "round trip of " + std::string(buffer, end));
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
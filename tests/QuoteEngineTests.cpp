@@ -0,0 +1,185 @@
+#include "Test.h"
+#include "StubServer.h"
+#include "ConfigManager.h"
+#include "FetchMetrics.h"
+#include "QuoteConflator.h"
+#include "QuoteEngine.h"
+#include "SymbolStatus.h"
+
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Point the engine at the stub with a watchlist, far from its next
+// scheduled pass, so every pass in a test is one the test asked for
+static void UseServer(const StubServer& server, std::vector<std::string> symbols) {
+    ConfigManager::SetDefaults();
+    ConfigManager::apiHost = L"127.0.0.1";
+    ConfigManager::apiPort = server.Port();
+    ConfigManager::apiHttps = false;
+    ConfigManager::symbols = std::move(symbols);
+    ConfigManager::refreshInterval = 3600;
+    ConfigManager::fetchTimeout = 30;
+    ConfigManager::Publish();
+}
+
+static std::vector<std::string> Sorted(std::vector<std::string> symbols) {
+    std::sort(symbols.begin(), symbols.end());
+    return symbols;
+}
+
+// Fetches that ended in a timeout so far, summed over every group
+static uint64_t TimedOutFetches() {
+    std::istringstream dump(FetchMetrics::FormatPrometheus());
+    uint64_t total = 0;
+    for (std::string line; std::getline(dump, line);) {
+        if (line.rfind("quote_fetch_results_total{", 0) != 0 || line.find("result=\"timeout\"") == std::string::npos) {
+            continue;
+        }
+        total += strtoull(line.c_str() + line.rfind(' ') + 1, nullptr, 10);
+    }
+    return total;
+}
+
+static bool WaitForQuote(const char* symbol, int milliseconds) {
+    int id = QuoteConflator::Intern(symbol);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+    ConflatedQuote quote;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (QuoteConflator::Read(id, quote)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+TEST(PassPublishesEveryQuote) {
+    StubServer server;
+    CHECK(server.Port() != 0);
+    UseServer(server, { "ENGPASSA", "ENGPASSB" });
+    QuoteEngine::Start();
+
+    CHECK(WaitForQuote("ENGPASSA", 5000));
+    CHECK(WaitForQuote("ENGPASSB", 5000));
+    CHECK((Sorted(server.Requests()) == std::vector<std::string>{ "ENGPASSA", "ENGPASSB" }));
+    ConflatedQuote quote;
+    CHECK(QuoteConflator::Read(QuoteConflator::Intern("ENGPASSA"), quote));
+    CHECK(quote.price == Price::FromUnits(425, 1));
+    CHECK(quote.previousClose == Price::FromUnits(40, 0));
+    QuoteEngine::Stop();
+}
+
+// Stop() cancels a request the server never answers instead of waiting out
+// its 30 s timeout
+TEST(StopInterruptsStalledRequest) {
+    StubServer server;
+    server.SetStalled(true);
+    UseServer(server, { "ENGSTALL" });
+    QuoteEngine::Start();
+    CHECK(server.WaitForRequests(1, 5000));
+
+    auto start = std::chrono::steady_clock::now();
+    QuoteEngine::Stop();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(elapsed < std::chrono::seconds(1));
+
+    ConflatedQuote quote;
+    CHECK(!QuoteConflator::Read(QuoteConflator::Intern("ENGSTALL"), quote));
+}
+
+// A server that never answers costs a fetch its fetchTimeout and no more:
+// the request fails as a timeout and the engine goes on to the next pass
+TEST(StalledRequestTimesOutWithinFetchTimeout) {
+    StubServer server;
+    server.SetStalled(true);
+    UseServer(server, { "ENGSLOW" });
+    ConfigManager::fetchTimeout = 1;
+    ConfigManager::Publish();
+    uint64_t timedOut = TimedOutFetches();
+
+    auto start = std::chrono::steady_clock::now();
+    QuoteEngine::Start();
+    CHECK(server.WaitForRequests(1, 5000));
+    while (TimedOutFetches() == timedOut && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK_EQ(TimedOutFetches(), timedOut + 1);
+    CHECK(elapsed >= std::chrono::milliseconds(900));
+    CHECK(elapsed < std::chrono::milliseconds(1500));
+
+    server.ClearRequests();
+    QuoteEngine::RefreshNow();
+    CHECK(server.WaitForRequests(1, 2000));
+    QuoteEngine::Stop();
+}
+
+TEST(RefreshNowStartsAFullPass) {
+    StubServer server;
+    UseServer(server, { "ENGREFA", "ENGREFB" });
+    QuoteEngine::Start();
+    CHECK(server.WaitForRequests(2, 5000));
+    CHECK(WaitForQuote("ENGREFB", 5000));
+
+    server.ClearRequests();
+    QuoteEngine::RefreshNow();
+    CHECK(server.WaitForRequests(2, 2000));
+    CHECK((Sorted(server.Requests()) == std::vector<std::string>{ "ENGREFA", "ENGREFB" }));
+    QuoteEngine::Stop();
+}
+
+// A symbol the server answers 404 for is not asked for again inside its
+// backoff window, while the rest of the watchlist keeps updating
+TEST(NotFoundSymbolWaitsOutItsBackoff) {
+    StubServer server;
+    server.SetNotFound("ENGGONE");
+    UseServer(server, { "ENGLIVE", "ENGGONE" });
+    QuoteEngine::Start();
+    CHECK(server.WaitForRequests(2, 5000));
+    CHECK(WaitForQuote("ENGLIVE", 5000));
+
+    unsigned long long retryAt = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (SymbolStatus::Get("ENGGONE", &retryAt) != SymbolState::NotFound &&
+        std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(SymbolStatus::Get("ENGGONE", &retryAt) == SymbolState::NotFound);
+    CHECK(retryAt > GetTickCount64() + SYMBOL_RETRY_MIN_MS / 2);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        server.ClearRequests();
+        unsigned long long published = QuoteConflator::GetUpdatesPublished();
+        QuoteEngine::RefreshNow();
+        CHECK(server.WaitForRequests(1, 2000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        CHECK((server.Requests() == std::vector<std::string>{ "ENGLIVE" }));
+        CHECK(QuoteConflator::GetUpdatesPublished() > published);
+    }
+    ConflatedQuote quote;
+    CHECK(QuoteConflator::Read(QuoteConflator::Intern("ENGLIVE"), quote));
+    CHECK(!QuoteConflator::Read(QuoteConflator::Intern("ENGGONE"), quote));
+    QuoteEngine::Stop();
+}
+
+// A new watchlist is applied at once, fetching only the added symbol
+TEST(ReconfigureFetchesOnlyAddedSymbols) {
+    StubServer server;
+    UseServer(server, { "ENGCFGA" });
+    QuoteEngine::Start();
+    CHECK(server.WaitForRequests(1, 5000));
+    CHECK(WaitForQuote("ENGCFGA", 5000));
+
+    server.ClearRequests();
+    ConfigManager::symbols = { "ENGCFGA", "ENGCFGB" };
+    ConfigManager::Publish();
+    QuoteEngine::Reconfigure();
+    CHECK(WaitForQuote("ENGCFGB", 2000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK((server.Requests() == std::vector<std::string>{ "ENGCFGB" }));
+    QuoteEngine::Stop();
+}
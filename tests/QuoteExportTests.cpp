@@ -0,0 +1,117 @@
+#include "Test.h"
+#include "QuoteConflator.h"
+#include "QuoteExport.h"
+#include "QuoteExporter.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(SymbolsAndQuotesAreExported) {
+    int before = QuoteConflator::Intern("EXPBEFORE");
+    QuoteConflator::Publish(before, Price::FromUnits(12345, 2), Price::FromUnits(12000, 2));
+    CHECK(QuoteExporter::Start());
+    QuoteExportReader reader;
+    CHECK(QuoteExportOpen(&reader));
+    CHECK_EQ(static_cast<int>(reader.header->writerAlive), 1);
+
+    // Rows are conflator ids; a symbol interned later is appended
+    int after = QuoteConflator::Intern("EXPAFTER");
+    CHECK_EQ(QuoteExportFind(&reader, "EXPBEFORE"), before);
+    CHECK_EQ(QuoteExportFind(&reader, "EXPAFTER"), after);
+    CHECK_EQ(QuoteExportFind(&reader, "EXPNONE"), -1);
+
+    // Rows fill as quotes arrive
+    QuoteExportQuote quote = {};
+    CHECK(!QuoteExportRead(&reader, before, &quote));
+    CHECK(!QuoteExportRead(&reader, after, &quote));
+    QuoteConflator::Publish(after, Price::FromUnits(7, 1), Price());
+    CHECK(QuoteExportRead(&reader, after, &quote));
+    CHECK_EQ(quote.price, 7LL);
+    CHECK_EQ(quote.priceScale, 1);
+    CHECK_EQ(quote.previousClose, 0LL);
+    CHECK(quote.timestamp > 0);
+
+    QuoteExporter::Stop();
+    CHECK_EQ(static_cast<int>(reader.header->writerAlive), 0);
+    QuoteExportClose(&reader);
+}
+
+// Readers racing the writer only ever see whole quotes: each price is
+// written with previousClose = price + 2
+TEST(ReadersNeverSeeTornRows) {
+    int id = QuoteConflator::Intern("EXPRACE");
+    CHECK(QuoteExporter::Start());
+    QuoteConflator::Publish(id, Price::FromUnits(1, 0), Price::FromUnits(3, 0));
+
+    std::atomic<bool> writing{ true };
+    std::atomic<int> torn{ 0 };
+    std::atomic<long long> reads{ 0 };
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            QuoteExportReader reader;
+            if (!QuoteExportOpen(&reader)) {
+                ++torn;
+                return;
+            }
+            int row = QuoteExportFind(&reader, "EXPRACE");
+            QuoteExportQuote quote = {};
+            while (writing.load()) {
+                if (!QuoteExportRead(&reader, row, &quote)) continue;
+                if (quote.previousClose != quote.price + 2 || quote.priceScale != 0 || quote.previousCloseScale != 0) {
+                    ++torn;
+                }
+                ++reads;
+            }
+            QuoteExportClose(&reader);
+        });
+    }
+
+    // Odd values never end in a zero, so their scale stays 0
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([id, w] {
+            for (long long n = 0; n < 100000; ++n) {
+                long long price = (n * 2 + w) * 2 + 1;
+                QuoteConflator::Publish(id, Price::FromUnits(price, 0), Price::FromUnits(price + 2, 0));
+            }
+        });
+    }
+    for (std::thread& writer : writers) writer.join();
+    writing = false;
+    for (std::thread& reader : readers) reader.join();
+
+    CHECK_EQ(torn.load(), 0);
+    CHECK(reads.load() > 0);
+
+    // The row ends on the latest quote
+    ConflatedQuote latest;
+    CHECK(QuoteConflator::Read(id, latest));
+    QuoteExportReader reader;
+    CHECK(QuoteExportOpen(&reader));
+    QuoteExportQuote quote = {};
+    CHECK(QuoteExportRead(&reader, id, &quote));
+    CHECK_EQ(quote.price, latest.price.GetUnits());
+    QuoteExportClose(&reader);
+    QuoteExporter::Stop();
+}
+
+// Restarting lays the region out again for readers that kept it open
+TEST(RestartClearsRows) {
+    int id = QuoteConflator::Intern("EXPRESTART");
+    CHECK(QuoteExporter::Start());
+    QuoteConflator::Publish(id, Price::FromUnits(5, 0), Price());
+    QuoteExportReader reader;
+    CHECK(QuoteExportOpen(&reader));
+    QuoteExportQuote quote = {};
+    CHECK(QuoteExportRead(&reader, id, &quote));
+
+    QuoteExporter::Stop();
+    CHECK(QuoteExporter::Start());
+    CHECK_EQ(static_cast<int>(reader.header->writerAlive), 1);
+    CHECK_EQ(QuoteExportFind(&reader, "EXPRESTART"), id);
+    CHECK(!QuoteExportRead(&reader, id, &quote));
+    QuoteExportClose(&reader);
+    QuoteExporter::Stop();
+}
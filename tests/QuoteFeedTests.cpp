@@ -0,0 +1,114 @@
+#include "Test.h"
+#include "QuoteConflator.h"
+#include "QuoteFeed.h"
+#include "QuoteFeedReader.h"
+
+#include <chrono>
+#include <thread>
+
+typedef std::chrono::steady_clock Clock;
+
+// Wait until the reader has published count records in all, a few seconds
+// at most
+static bool WaitForPublished(unsigned long long count) {
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    while (QuoteFeedReader::GetRecordsPublished() < count) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+static bool ReadPrice(int id, Price& price) {
+    ConflatedQuote quote;
+    if (!QuoteConflator::Read(id, quote)) return false;
+    price = quote.price;
+    return true;
+}
+
+// Several laps of the ring, each push retried until the reader frees a slot
+TEST(RingWrapsAround) {
+    int id = QuoteConflator::Intern("FEEDWRAP");
+    CHECK(QuoteFeedReader::Start());
+    QuoteFeedProducer producer;
+    CHECK(QuoteFeedOpen(&producer));
+
+    unsigned long long published = QuoteFeedReader::GetRecordsPublished();
+    const int count = QUOTE_FEED_CAPACITY * 3 + 17;
+    for (int i = 1; i <= count; ++i) {
+        while (!QuoteFeedPush(&producer, "FEEDWRAP", i, 2, 100, 0, i)) std::this_thread::yield();
+    }
+    CHECK(WaitForPublished(published + count));
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    while (producer.header->tail != producer.header->head && Clock::now() < deadline) std::this_thread::yield();
+    CHECK(producer.header->tail == producer.header->head);
+
+    Price price;
+    CHECK(ReadPrice(id, price));
+    CHECK(price == Price::FromUnits(count, 2));
+    CHECK(QuoteFeedReader::IsFed(id, 60000));
+
+    QuoteFeedClose(&producer);
+    QuoteFeedReader::Stop();
+}
+
+// A full ring refuses pushes; a restarted reader picks up what was left in
+// the ring a producer kept open
+TEST(FullRingRefusesAndResumes) {
+    int id = QuoteConflator::Intern("FEEDFULL");
+    CHECK(QuoteFeedReader::Start());
+    QuoteFeedProducer producer;
+    CHECK(QuoteFeedOpen(&producer));
+    QuoteFeedReader::Stop();
+
+    long long dropped = producer.header->dropped;
+    for (int i = 1; i <= QUOTE_FEED_CAPACITY; ++i) {
+        CHECK(QuoteFeedPush(&producer, "FEEDFULL", i, 0, 0, 0, i));
+    }
+    CHECK(!QuoteFeedPush(&producer, "FEEDFULL", 1, 0, 0, 0, 1));
+    CHECK_EQ(producer.header->dropped, dropped + 1);
+
+    unsigned long long published = QuoteFeedReader::GetRecordsPublished();
+    CHECK(QuoteFeedReader::Start());
+    CHECK(WaitForPublished(published + QUOTE_FEED_CAPACITY));
+    Price price;
+    CHECK(ReadPrice(id, price));
+    CHECK(price == Price::FromUnits(QUOTE_FEED_CAPACITY, 0));
+
+    QuoteFeedClose(&producer);
+    QuoteFeedReader::Stop();
+}
+
+TEST(BadRecordsAreSkipped) {
+    int id = QuoteConflator::Intern("FEEDSKIP");
+    CHECK(QuoteFeedReader::Start());
+    QuoteFeedProducer producer;
+    CHECK(QuoteFeedOpen(&producer));
+
+    // Refused by the producer side: bad scale, empty or overlong symbol
+    CHECK(!QuoteFeedPush(&producer, "FEEDSKIP", 1, QUOTE_FEED_MAX_SCALE + 1, 0, 0, 1));
+    CHECK(!QuoteFeedPush(&producer, "", 1, 0, 0, 0, 1));
+    CHECK(!QuoteFeedPush(&producer, "ABCDEFGHIJKLMNOPQRSTUVWXYZ", 1, 0, 0, 0, 1));
+
+    // Skipped by the tape: unknown symbol, non-positive price, older quote
+    unsigned long long published = QuoteFeedReader::GetRecordsPublished();
+    unsigned long long skipped = QuoteFeedReader::GetRecordsSkipped();
+    CHECK(QuoteFeedPush(&producer, "FEEDNOTAPE", 5, 0, 0, 0, 10));
+    CHECK(QuoteFeedPush(&producer, "FEEDSKIP", -5, 0, 0, 0, 10));
+    CHECK(QuoteFeedPush(&producer, "FEEDSKIP", 7, 0, 0, 0, 20));
+    CHECK(QuoteFeedPush(&producer, "FEEDSKIP", 6, 0, 0, 0, 19));
+    CHECK(WaitForPublished(published + 1));
+
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    while (QuoteFeedReader::GetRecordsSkipped() < skipped + 3 && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK_EQ(QuoteFeedReader::GetRecordsSkipped(), skipped + 3);
+    CHECK_EQ(QuoteFeedReader::GetRecordsPublished(), published + 1);
+    Price price;
+    CHECK(ReadPrice(id, price));
+    CHECK(price == Price::FromUnits(7, 0));
+
+    QuoteFeedClose(&producer);
+    QuoteFeedReader::Stop();
+}
@@ -0,0 +1,153 @@
+#include "Test.h"
+#include "ApiFetcher.h"
+#include "Sparkline.h"
+#include "TapeTemplate.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Reference Largest-Triangle-Three-Buckets after Steinarsson's thesis,
+// returning the chosen indices
+static std::vector<size_t> ReferenceLttb(const std::vector<float>& values, size_t threshold) {
+    std::vector<size_t> chosen;
+    size_t count = values.size();
+    if (threshold >= count || threshold < 3) {
+        for (size_t i = 0; i < count; ++i) chosen.push_back(i);
+        return chosen;
+    }
+
+    double every = static_cast<double>(count - 2) / (threshold - 2);
+    size_t a = 0;
+    chosen.push_back(0);
+    for (size_t i = 0; i < threshold - 2; ++i) {
+        size_t averageStart = static_cast<size_t>(std::floor((i + 1) * every)) + 1;
+        size_t averageEnd = std::min(static_cast<size_t>(std::floor((i + 2) * every)) + 1, count);
+        double averageX = 0.0;
+        double averageY = 0.0;
+        for (size_t j = averageStart; j < averageEnd; ++j) {
+            averageX += j;
+            averageY += values[j];
+        }
+        averageX /= averageEnd - averageStart;
+        averageY /= averageEnd - averageStart;
+
+        size_t rangeStart = static_cast<size_t>(std::floor(i * every)) + 1;
+        size_t rangeEnd = static_cast<size_t>(std::floor((i + 1) * every)) + 1;
+        double maxArea = -1.0;
+        size_t next = rangeStart;
+        for (size_t j = rangeStart; j < rangeEnd; ++j) {
+            double area = std::fabs((a - averageX) * (values[j] - values[a]) -
+                (static_cast<double>(a) - j) * (averageY - values[a])) * 0.5;
+            if (area > maxArea) {
+                maxArea = area;
+                next = j;
+            }
+        }
+        chosen.push_back(next);
+        a = next;
+    }
+    chosen.push_back(count - 1);
+    return chosen;
+}
+
+static std::vector<float> RandomWalk(std::mt19937& random, size_t count) {
+    std::vector<float> values;
+    float value = 100.0f;
+    for (size_t i = 0; i < count; ++i) {
+        value += (static_cast<float>(random() % 2001) - 1000.0f) / 1000.0f;
+        values.push_back(value);
+    }
+    return values;
+}
+
+TEST(DownsampleMatchesReferenceLttb) {
+    std::mt19937 random(45);
+    std::vector<SparkPoint> points;
+    for (size_t count : { 3, 10, 78, 79, 390, 1000 }) {
+        for (size_t threshold : { 3, 7, 50, 63 }) {
+            std::vector<float> values = RandomWalk(random, count);
+            Sparkline::Downsample(values.data(), values.size(), threshold, points);
+            std::vector<size_t> expected = ReferenceLttb(values, threshold);
+
+            CHECK_EQ(points.size(), expected.size());
+            for (size_t i = 0; i < points.size() && i < expected.size(); ++i) {
+                CHECK_EQ(static_cast<size_t>(points[i].x), expected[i]);
+                CHECK_EQ(points[i].y, values[expected[i]]);
+            }
+        }
+    }
+}
+
+TEST(DownsampleKeepsEndsAndOrder) {
+    std::mt19937 random(46);
+    std::vector<float> values = RandomWalk(random, 500);
+    std::vector<SparkPoint> points;
+    Sparkline::Downsample(values.data(), values.size(), 40, points);
+
+    CHECK_EQ(points.size(), size_t(40));
+    CHECK_EQ(points.front().x, 0.0f);
+    CHECK_EQ(points.back().x, 499.0f);
+    for (size_t i = 1; i < points.size(); ++i) CHECK(points[i].x > points[i - 1].x);
+}
+
+TEST(DownsampleKeepsASpike) {
+    std::vector<float> values(300, 10.0f);
+    values[137] = 50.0f;
+    values[211] = -30.0f;
+    std::vector<SparkPoint> points;
+    Sparkline::Downsample(values.data(), values.size(), 20, points);
+
+    bool high = false;
+    bool low = false;
+    for (const SparkPoint& point : points) {
+        if (point.x == 137.0f) high = true;
+        if (point.x == 211.0f) low = true;
+    }
+    CHECK(high);
+    CHECK(low);
+}
+
+TEST(ShortSeriesPassThrough) {
+    std::vector<float> values = { 1.0f, 3.0f, 2.0f };
+    std::vector<SparkPoint> points;
+    Sparkline::Downsample(values.data(), values.size(), 10, points);
+    CHECK_EQ(points.size(), size_t(3));
+
+    Sparkline::Downsample(values.data(), values.size(), 2, points);
+    CHECK_EQ(points.size(), size_t(2));
+    if (points.size() == 2) CHECK_EQ(points[1].x, 2.0f);
+
+    Sparkline::Downsample(values.data(), 0, 10, points);
+    CHECK(points.empty());
+}
+
+TEST(RasterizeDrawsInsideTheBitmap) {
+    std::vector<float> values = { 1.0f, 2.0f, 0.5f, 3.0f };
+    std::vector<SparkPoint> points;
+    Sparkline::Downsample(values.data(), values.size(), 4, points);
+    SparklineBitmap bitmap;
+    Sparkline::Rasterize(points, 10, bitmap);
+
+    CHECK_EQ(bitmap.width, SPARKLINE_CELLS * 10);
+    CHECK_EQ(bitmap.mask.size(), static_cast<size_t>(bitmap.width) * bitmap.height);
+    size_t lit = 0;
+    for (uint32_t pixel : bitmap.mask) lit += (pixel >> 8 & 0xFF) != 0;
+    CHECK(lit > 0);
+}
+
+// Series cost a larger response, so they are requested only when the tape
+// draws sparklines
+TEST(SeriesRequestedOnlyForSparklines) {
+    CHECK(ApiFetcher::ChartPath("^GSPC", true) == L"/v8/finance/chart/%5EGSPC?range=1d&interval=5m");
+    CHECK(ApiFetcher::ChartPath("^GSPC", false) == L"/v8/finance/chart/%5EGSPC");
+
+    TapeTemplate format;
+    CHECK(format.HasSparkline());
+    CHECK(format.Compile(L"{sym} {price:.2}"));
+    CHECK(!format.HasSparkline());
+    CHECK(format.Compile(L"{sym} {spark}"));
+    CHECK(format.HasSparkline());
+    CHECK(!format.Compile(L"{sym} {oops}"));
+    CHECK(format.HasSparkline());
+}
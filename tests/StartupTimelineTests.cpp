@@ -0,0 +1,87 @@
+#include "Test.h"
+#include "FetchMetrics.h"
+#include "StartupTimeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The timeline is process-wide and cannot be reset, so the tests run as one
+// startup: Begin, then the phases in order
+
+static void Pause() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+TEST(MarksFollowThePhaseOrder) {
+    StartupTimeline::Begin();
+    for (int phase = 0; phase < static_cast<int>(StartupPhase::Count); ++phase) {
+        CHECK_EQ(StartupTimeline::GetMicros(static_cast<StartupPhase>(phase)), uint64_t(0));
+    }
+
+    const StartupPhase phases[] = { StartupPhase::Instance, StartupPhase::Config, StartupPhase::Window };
+    uint64_t previous = 0;
+    for (StartupPhase phase : phases) {
+        Pause();
+        StartupTimeline::Mark(phase);
+        uint64_t micros = StartupTimeline::GetMicros(phase);
+        CHECK(micros > previous);
+        CHECK(micros - previous >= 1000);
+        previous = micros;
+    }
+    CHECK_EQ(StartupTimeline::GetMicros(StartupPhase::FirstFrame), uint64_t(0));
+}
+
+TEST(LaterMarksAreIgnored) {
+    uint64_t instance = StartupTimeline::GetMicros(StartupPhase::Instance);
+    Pause();
+    StartupTimeline::Mark(StartupPhase::Instance);
+    CHECK_EQ(StartupTimeline::GetMicros(StartupPhase::Instance), instance);
+}
+
+// Every render thread marks its first frame; the earliest one counts
+TEST(RacingMarksKeepOneTime) {
+    Pause();
+    std::atomic<bool> go{ false };
+    std::vector<uint64_t> seen(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < seen.size(); ++i) {
+        threads.emplace_back([&, i] {
+            while (!go.load()) std::this_thread::yield();
+            StartupTimeline::Mark(StartupPhase::FirstFrame);
+            seen[i] = StartupTimeline::GetMicros(StartupPhase::FirstFrame);
+        });
+    }
+    go = true;
+    for (std::thread& thread : threads) thread.join();
+
+    uint64_t firstFrame = StartupTimeline::GetMicros(StartupPhase::FirstFrame);
+    CHECK(firstFrame > StartupTimeline::GetMicros(StartupPhase::Window));
+    for (uint64_t micros : seen) CHECK_EQ(micros, firstFrame);
+}
+
+TEST(DescribeAndMetricsListReachedPhases) {
+    Pause();
+    StartupTimeline::Mark(StartupPhase::FirstPrice);
+    CHECK(StartupTimeline::GetMicros(StartupPhase::FirstPrice) > StartupTimeline::GetMicros(StartupPhase::FirstFrame));
+
+    std::string text = StartupTimeline::Describe();
+    size_t instance = text.find("instance ");
+    size_t config = text.find(", config ");
+    size_t window = text.find(", window ");
+    size_t firstFrame = text.find(", first_frame ");
+    size_t firstPrice = text.find(", first_price ");
+    CHECK(instance == 0);
+    CHECK(config != std::string::npos && config > instance);
+    CHECK(window != std::string::npos && window > config);
+    CHECK(firstFrame != std::string::npos && firstFrame > window);
+    CHECK(firstPrice != std::string::npos && firstPrice > firstFrame);
+    CHECK(text.find("deferred") == std::string::npos);
+
+    std::string dump = FetchMetrics::FormatPrometheus();
+    CHECK(dump.find("startup_phase_microseconds{phase=\"first_price\"} " +
+        std::to_string(StartupTimeline::GetMicros(StartupPhase::FirstPrice)) + "\n") != std::string::npos);
+    CHECK(dump.find("phase=\"deferred\"") == std::string::npos);
+}
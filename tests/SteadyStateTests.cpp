@@ -0,0 +1,129 @@
+#include "Test.h"
+#include "ApiFetcher.h"
+#include "CoTask.h"
+#include "QuoteConflator.h"
+#include "Sparkline.h"
+#include "TapeModel.h"
+#include "TapeTemplate.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Heap allocations made by this thread while g_counting is set
+static thread_local bool g_counting = false;
+static thread_local size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    if (g_counting) ++g_allocations;
+    if (void* block = std::malloc(size ? size : 1)) return block;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    std::free(block);
+}
+
+// Allocations op makes once it has run a few times to size its buffers
+template <typename Op>
+static size_t SteadyStateAllocations(Op op) {
+    for (int pass = 0; pass < 3; ++pass) op();
+    g_allocations = 0;
+    g_counting = true;
+    for (int pass = 0; pass < 10; ++pass) op();
+    g_counting = false;
+    return g_allocations;
+}
+
+TEST(CounterSeesAllocations) {
+    std::vector<std::string> kept;
+    size_t allocations = SteadyStateAllocations([&] { kept.push_back(std::string(100, 'x')); });
+    CHECK(allocations >= 10);
+}
+
+static std::string ChartBody(int price, int previousClose) {
+    std::string body = "{\"chart\":{\"result\":[{\"meta\":{\"currency\":\"USD\",\"regularMarketPrice\":";
+    body += std::to_string(price) + ".25,\"chartPreviousClose\":" + std::to_string(previousClose) + ".5}";
+    body += ",\"indicators\":{\"quote\":[{\"close\":[";
+    for (int i = 0; i < 78; ++i) body += (i % 10 == 9 ? "null," : std::to_string(price + i % 7) + ".5,");
+    body += "1.0]}]}}]}}";
+    return body;
+}
+
+// What a fetch pass does with each response once the bytes are in
+TEST(ParsingAllocatesNothing) {
+    std::vector<std::string> bodies;
+    for (int i = 0; i < 8; ++i) bodies.push_back(ChartBody(100 + i, 99 + i));
+    int ids[8];
+    for (int i = 0; i < 8; ++i) ids[i] = QuoteConflator::Intern("STEADY" + std::to_string(i));
+    std::vector<float> closes;
+    std::vector<SparkPoint> points;
+
+    size_t allocations = SteadyStateAllocations([&] {
+        for (int i = 0; i < 8; ++i) {
+            Quote quote = ApiFetcher::ParseQuote(bodies[i]);
+            CHECK(quote.Ok());
+            QuoteConflator::Publish(ids[i], quote.price, quote.previousClose);
+            CHECK(ApiFetcher::ParseSeries(bodies[i], closes));
+            Sparkline::Downsample(closes.data(), closes.size(), 40, points);
+        }
+    });
+    CHECK_EQ(allocations, size_t(0));
+}
+
+// What the render side does for each layout: drain, format, rebuild
+TEST(LayoutAllocatesNothing) {
+    const char* symbols[] = { "AAPL", "MSFT", "^GSPC", "BTC-USD", "EURUSD=X", "GC=F" };
+    int ids[6];
+    for (int i = 0; i < 6; ++i) ids[i] = QuoteConflator::Intern(symbols[i]);
+    TapeTemplate format;
+    std::vector<TapeSegment> segments(6);
+    std::vector<ConflatedQuote> drained;
+    TapeSnapshot snapshot;
+    int tick = 0;
+
+    size_t allocations = SteadyStateAllocations([&] {
+        ++tick;
+        for (int i = 0; i < 6; ++i) {
+            QuoteConflator::Publish(ids[i], Price::FromUnits(10000 + tick * 7 + i, 2), Price::FromUnits(10000, 2));
+        }
+        drained.clear();
+        QuoteConflator::Drain(drained);
+
+        TapeModel::Begin(snapshot);
+        for (int i = 0; i < 6; ++i) {
+            ConflatedQuote quote;
+            CHECK(QuoteConflator::Read(ids[i], quote));
+            TapeModel::FormatQuote(format, symbols[i], quote.price, quote.previousClose, false, segments[i]);
+            TapeModel::Append(snapshot, segments[i].text, segments[i].tone, (tick + i) % 2 == 0);
+        }
+        TapeModel::Finish(snapshot, 0);
+    });
+    CHECK_EQ(allocations, size_t(0));
+    CHECK(snapshot.cycleLength > 0);
+}
+
+static CoTask<int> Leaf(int value) {
+    co_return value * 2;
+}
+
+static CoTask<int> Chain(int value) {
+    int sum = 0;
+    for (int i = 0; i < 3; ++i) sum += co_await Leaf(value + i);
+    co_return sum;
+}
+
+// Coroutine frames come back from the free lists
+TEST(CoroutineFramesAreReused) {
+    int result = 0;
+    size_t allocations = SteadyStateAllocations([&] {
+        Spawn(Chain(1), [&result](int value) { result = value; });
+    });
+    CHECK_EQ(allocations, size_t(0));
+    CHECK_EQ(result, 12);
+}
@@ -0,0 +1,248 @@
+#pragma once
+#ifndef STUB_SERVER_H
+#define STUB_SERVER_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET Socket;
+#define CloseSocket closesocket
+#define PollSockets WSAPoll
+typedef WSAPOLLFD PollEntry;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int Socket;
+#define INVALID_SOCKET (-1)
+#define CloseSocket close
+#define PollSockets poll
+typedef pollfd PollEntry;
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CHART_PREFIX "/v8/finance/chart/"
+
+// Every stub quote: 42.5, previous close 40
+#define STUB_BODY "{\"chart\":{\"result\":[{\"meta\":{\"regularMarketPrice\":42.5,\"chartPreviousClose\":40}}],\"error\":null}}"
+#define STUB_NOT_FOUND_BODY "{\"chart\":{\"result\":null,\"error\":{\"code\":\"Not Found\",\"description\":\"No data found, symbol may be delisted\"}}}"
+
+// Quote server on a free loopback port, serving every connection from one
+// polling thread so it can hold thousands open at once. Records the symbol
+// of every request. A stalled server reads requests but never answers
+// them; a delayed one answers each after a set time; symbols marked not
+// found get a 404.
+class StubServer {
+public:
+    StubServer() {
+#ifdef _WIN32
+        WSADATA wsa;
+        WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+        m_listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(address);
+        if (bind(m_listener, reinterpret_cast<sockaddr*>(&address), size) != 0 || listen(m_listener, 1024) != 0 ||
+            getsockname(m_listener, reinterpret_cast<sockaddr*>(&address), &size) != 0) {
+            return;
+        }
+        m_port = ntohs(address.sin_port);
+        SetNonBlocking(m_listener);
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    ~StubServer() {
+        m_stopping = true;
+        if (m_thread.joinable()) m_thread.join();
+        for (Connection& connection : m_connections) CloseSocket(connection.socket);
+        CloseSocket(m_listener);
+    }
+
+    int Port() const { return m_port; }
+
+    void SetStalled(bool stalled) { m_stalled = stalled; }
+
+    // Hold each response this long after its request arrives
+    void SetDelay(int milliseconds) { m_delayMs = milliseconds; }
+
+    void SetNotFound(const std::string& symbol) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_notFound.insert(symbol);
+    }
+
+    std::vector<std::string> Requests() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_requests;
+    }
+
+    void ClearRequests() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.clear();
+    }
+
+    // Wait until count requests have arrived since the last clear
+    bool WaitForRequests(size_t count, int milliseconds) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (Requests().size() >= count) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    }
+
+    // Most requests received and not yet answered at any one time
+    size_t PeakPending() const { return m_peakPending.load(); }
+
+private:
+    struct Connection {
+        Socket socket;
+        std::string request;
+        std::string response;   // Empty until the request is answered
+        size_t sent = 0;
+        bool pending = false;   // Request read, response not due yet
+        std::chrono::steady_clock::time_point due;
+    };
+
+    static void SetNonBlocking(Socket socket) {
+#ifdef _WIN32
+        u_long on = 1;
+        ioctlsocket(socket, FIONBIO, &on);
+#else
+        fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+#endif
+    }
+
+    void Run() {
+        std::vector<PollEntry> polled;
+        while (!m_stopping.load()) {
+            // Answer what is due, and sleep no later than the next one
+            auto now = std::chrono::steady_clock::now();
+            auto next = now + std::chrono::milliseconds(20);
+            for (Connection& connection : m_connections) {
+                if (!connection.pending || m_stalled.load()) continue;
+                if (now >= connection.due) {
+                    connection.pending = false;
+                    --m_pending;
+                    Answer(connection);
+                }
+                else {
+                    next = std::min(next, connection.due);
+                }
+            }
+
+            polled.clear();
+            polled.push_back({ m_listener, POLLIN, 0 });
+            for (const Connection& connection : m_connections) {
+                polled.push_back({ connection.socket, static_cast<short>(connection.response.empty() ? POLLIN : POLLOUT), 0 });
+            }
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1;
+            if (PollSockets(polled.data(), static_cast<unsigned>(polled.size()), static_cast<int>(wait)) < 0) continue;
+
+            // Step the existing connections first: accepting appends to them
+            size_t kept = 0;
+            for (size_t i = 0; i < m_connections.size(); ++i) {
+                Connection& connection = m_connections[i];
+                bool open = true;
+                if (polled[i + 1].revents) open = Step(connection);
+                if (!open) {
+                    if (connection.pending) --m_pending;
+                    CloseSocket(connection.socket);
+                    continue;
+                }
+                if (kept != i) m_connections[kept] = std::move(connection);
+                ++kept;
+            }
+            m_connections.resize(kept);
+
+            if (polled[0].revents & POLLIN) {
+                for (;;) {
+                    Socket client = accept(m_listener, nullptr, nullptr);
+                    if (client == INVALID_SOCKET) break;
+                    SetNonBlocking(client);
+                    Connection connection;
+                    connection.socket = client;
+                    m_connections.push_back(std::move(connection));
+                }
+            }
+        }
+    }
+
+    // Read a request or write a response; false once the connection is done
+    bool Step(Connection& connection) {
+        char chunk[4096];
+        if (connection.response.empty()) {
+            int n = recv(connection.socket, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            if (connection.pending) return true;   // Anything after the request is ignored
+            connection.request.append(chunk, n);
+            if (connection.request.find("\r\n\r\n") == std::string::npos) return true;
+
+            connection.pending = true;
+            connection.due = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_delayMs.load());
+            if (++m_pending > m_peakPending.load()) m_peakPending = m_pending;
+
+            // GET /v8/finance/chart/<symbol>[?...] HTTP/1.1
+            size_t start = connection.request.find(CHART_PREFIX);
+            if (start != std::string::npos) {
+                start += strlen(CHART_PREFIX);
+                size_t end = connection.request.find_first_of("? ", start);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_requests.push_back(connection.request.substr(start, end - start));
+            }
+            return true;
+        }
+
+        int n = send(connection.socket, connection.response.data() + connection.sent,
+            static_cast<int>(connection.response.size() - connection.sent), 0);
+        if (n <= 0) return false;
+        connection.sent += n;
+        return connection.sent < connection.response.size();
+    }
+
+    void Answer(Connection& connection) {
+        std::string symbol;
+        size_t start = connection.request.find(CHART_PREFIX);
+        if (start != std::string::npos) {
+            start += strlen(CHART_PREFIX);
+            symbol = connection.request.substr(start, connection.request.find_first_of("? ", start) - start);
+        }
+        bool notFound;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            notFound = m_notFound.count(symbol) != 0;
+        }
+        std::string body = notFound ? STUB_NOT_FOUND_BODY : STUB_BODY;
+        connection.response = std::string(notFound ? "HTTP/1.1 404 Not Found" : "HTTP/1.1 200 OK") +
+            "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+            "\r\nConnection: close\r\n\r\n" + body;
+    }
+
+    Socket m_listener = INVALID_SOCKET;
+    int m_port = 0;
+    std::atomic<bool> m_stopping{ false };
+    std::atomic<bool> m_stalled{ false };
+    std::atomic<int> m_delayMs{ 0 };
+    std::atomic<size_t> m_peakPending{ 0 };
+    std::thread m_thread;
+    std::vector<Connection> m_connections;   // Server thread only
+    size_t m_pending = 0;                    // Server thread only
+    std::mutex m_mutex;
+    std::vector<std::string> m_requests;
+    std::set<std::string> m_notFound;
+};
+
+#endif
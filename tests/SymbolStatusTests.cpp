@@ -0,0 +1,87 @@
+#include "Test.h"
+#include "QuoteConflator.h"
+#include "SymbolStatus.h"
+
+#include <windows.h>
+#include <climits>
+#include <string>
+#include <vector>
+
+TEST(NewSymbolsAreFetched) {
+    int id = QuoteConflator::Intern("STATNEW");
+    CHECK(SymbolStatus::Get("STATNEW") == SymbolState::Unchecked);
+    CHECK(SymbolStatus::ShouldFetch(id, 0));
+    SymbolStatus::RecordFound(id);
+    CHECK(SymbolStatus::Get("STATNEW") == SymbolState::Valid);
+    CHECK(SymbolStatus::ShouldFetch(id, 0));
+    CHECK(SymbolStatus::Get("STATNEVERINTERNED") == SymbolState::Unchecked);
+}
+
+TEST(MalformedSymbolsAreNeverFetched) {
+    const char* symbols[] = { "BAD SYM", "A/B", "Q?X", "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456" };
+    for (const char* symbol : symbols) {
+        int id = QuoteConflator::Intern(symbol);
+        CHECK(!SymbolStatus::ShouldFetch(id, 0));
+        CHECK(SymbolStatus::Get(symbol) == SymbolState::Invalid);
+        CHECK(!SymbolStatus::ShouldFetch(id, ULLONG_MAX - 1));
+    }
+
+    // Non-ASCII is for the server to judge
+    CHECK(SymbolStatus::ShouldFetch(QuoteConflator::Intern("\xC3\x85" "BC"), 0));
+}
+
+// A rejected symbol waits out its retry time, which doubles up to the cap
+TEST(RejectionsBackOff) {
+    int id = QuoteConflator::Intern("STATGONE");
+    unsigned long long now = 1000000;
+    unsigned long long delay = SYMBOL_RETRY_MIN_MS;
+    for (int rejection = 0; rejection < 16; ++rejection) {
+        CHECK(SymbolStatus::ShouldFetch(id, now));
+        SymbolStatus::RecordRejected(id, SymbolState::NotFound, now);
+
+        unsigned long long retryAt = 0;
+        CHECK(SymbolStatus::Get("STATGONE", &retryAt) == SymbolState::NotFound);
+        CHECK_EQ(retryAt, now + delay);
+        CHECK(!SymbolStatus::ShouldFetch(id, now));
+        CHECK(!SymbolStatus::ShouldFetch(id, retryAt - 1));
+
+        now = retryAt;
+        delay = delay * 2 < SYMBOL_RETRY_MAX_MS ? delay * 2 : SYMBOL_RETRY_MAX_MS;
+    }
+    CHECK_EQ(delay, SYMBOL_RETRY_MAX_MS);
+
+    // Found again: fetched every pass and backing off from the start
+    SymbolStatus::RecordFound(id);
+    CHECK(SymbolStatus::ShouldFetch(id, now));
+    SymbolStatus::RecordRejected(id, SymbolState::Invalid, now);
+    unsigned long long retryAt = 0;
+    CHECK(SymbolStatus::Get("STATGONE", &retryAt) == SymbolState::Invalid);
+    CHECK_EQ(retryAt, now + SYMBOL_RETRY_MIN_MS);
+}
+
+TEST(ForgetStartsAfresh) {
+    int id = QuoteConflator::Intern("STATFORGET");
+    SymbolStatus::RecordRejected(id, SymbolState::NotFound, 0);
+    SymbolStatus::RecordRejected(id, SymbolState::NotFound, 0);
+    SymbolStatus::Forget(id);
+    CHECK(SymbolStatus::Get("STATFORGET") == SymbolState::Unchecked);
+    CHECK(SymbolStatus::ShouldFetch(id, 0));
+
+    SymbolStatus::RecordRejected(id, SymbolState::NotFound, 0);
+    unsigned long long retryAt = 0;
+    SymbolStatus::Get("STATFORGET", &retryAt);
+    CHECK_EQ(retryAt, SYMBOL_RETRY_MIN_MS);
+}
+
+TEST(DescribeListsRejectedSymbols) {
+    int gone = QuoteConflator::Intern("STATDESCGONE");
+    int bad = QuoteConflator::Intern("STAT DESC");
+    int good = QuoteConflator::Intern("STATDESCOK");
+    SymbolStatus::RecordRejected(gone, SymbolState::NotFound, GetTickCount64());
+    SymbolStatus::ShouldFetch(bad, 0);
+    SymbolStatus::RecordFound(good);
+
+    CHECK(SymbolStatus::Describe({ "STATDESCOK" }).empty());
+    CHECK(SymbolStatus::Describe({ "STATDESCGONE", "STAT DESC", "STATDESCOK" }) ==
+        L"Not found: STATDESCGONE (next try in 1 min)   Invalid: STAT DESC");
+}
@@ -0,0 +1,93 @@
+#include "Test.h"
+#include "TapeTemplate.h"
+
+#include <string>
+
+static std::string Format(const TapeTemplate& format, const char* symbol, Price price, Price previousClose) {
+    std::string out;
+    format.Format(symbol, price, previousClose, false, out);
+    return out;
+}
+
+TEST(DoubledBracesAreLiteral) {
+    TapeTemplate format;
+    CHECK(format.Compile(L"{{{sym}}} }}x{{"));
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(1, 0), Price()), std::string("{AAPL} }x{"));
+}
+
+// A rejected format describes the problem and leaves the template as it was
+TEST(BadFormatsKeepTheTemplate) {
+    TapeTemplate format;
+    CHECK(format.Compile(L"{sym}={price:.1}"));
+
+    std::wstring error;
+    CHECK(!format.Compile(L"{sym} {bogus}", &error));
+    CHECK(error == L"unknown field {bogus}");
+    CHECK(!format.Compile(L"{sym", &error));
+    CHECK(error == L"unterminated '{'");
+    CHECK(!format.Compile(L"sym}", &error));
+    CHECK(error == L"unmatched '}'");
+    CHECK(!format.Compile(L"{spark}{spark}", &error));
+    CHECK(error == L"more than one {spark}");
+    CHECK(!format.Compile(std::wstring(MAX_TAPE_FORMAT + 1, L'x'), &error));
+
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(1234, 1), Price()), std::string("AAPL=123.4"));
+}
+
+TEST(BadPrecisionSpecsAreRejected) {
+    TapeTemplate format;
+    std::wstring error;
+    for (const wchar_t* bad : { L"{price:.}", L"{price:.11}", L"{price:.123}", L"{price:2}", L"{price:+.2}",
+        L"{price:.2%}", L"{chg:.2%%}", L"{chg:+-.2}", L"{chg:autox}", L"{sym:.2}", L"{cur:+}" }) {
+        error.clear();
+        CHECK(!format.Compile(bad, &error));
+        CHECK(!error.empty());
+    }
+    CHECK(error == L"{cur:+} takes no format");
+
+    for (const wchar_t* good : { L"{price:.0}", L"{price:.10}", L"{price:auto}", L"{chg:+}", L"{chg:%}",
+        L"{chg:+auto%}", L"{chg:+.4%}" }) {
+        CHECK(format.Compile(good));
+    }
+}
+
+// The absolute and percent change agree on the sign of every change,
+// including one that rounds to zero
+TEST(ChangeSignsAgree) {
+    TapeTemplate format;
+    CHECK(format.Compile(L"{chg:+.2} {chg:+.2%} {chg:.2} {chg:.2%}"));
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(101, 0), Price::FromUnits(100, 0)),
+        std::string("+1.00 +1.00% 1.00 1.00%"));
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(99, 0), Price::FromUnits(100, 0)),
+        std::string("-1.00 -1.00% -1.00 -1.00%"));
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(100, 0), Price::FromUnits(100, 0)),
+        std::string("+0.00 +0.00% 0.00 0.00%"));
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(1000000, 4), Price::FromUnits(1000004, 4)),
+        std::string("+0.00 +0.00% 0.00 0.00%"));
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(1000004, 4), Price::FromUnits(1000000, 4)),
+        std::string("+0.00 +0.00% 0.00 0.00%"));
+}
+
+// Without a previous close the change and the text leading into it go
+TEST(UnknownChangeIsLeftOut) {
+    TapeTemplate format;
+    CHECK(format.Compile(L"{sym} {price:.2} {chg:+.2%}"));
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(10, 0), Price()), std::string("AAPL 10.00"));
+}
+
+// Decimals picked per symbol: FX to the pip, others to the cent, and three
+// significant digits below 1
+TEST(AutoPrecisionFollowsTheSymbol) {
+    TapeTemplate format;
+    CHECK(format.Compile(L"{price}|{price:auto}"));
+    CHECK_EQ(Format(format, "AAPL", Price::FromUnits(123456, 3), Price()), std::string("123.46|123.46"));
+    CHECK_EQ(Format(format, "EURUSD=X", Price::FromUnits(108345, 5), Price()), std::string("1.0835|1.0835"));
+    CHECK_EQ(Format(format, "USDJPY=X", Price::FromUnits(1512345, 4), Price()), std::string("151.235|151.235"));
+    CHECK_EQ(Format(format, "SHIB-USD", Price::FromUnits(12345, 6), Price()), std::string("0.0123|0.0123"));
+    CHECK_EQ(Format(format, "^GSPC", Price::FromUnits(5000, 0), Price()), std::string("5000.00|5000.00"));
+
+    // A change without decimals of its own takes the price's
+    CHECK(format.Compile(L"{chg:+}"));
+    CHECK_EQ(Format(format, "EURUSD=X", Price::FromUnits(108345, 5), Price::FromUnits(108, 2)),
+        std::string("+0.0035"));
+}
@@ -0,0 +1,177 @@
+#include "Test.h"
+#include "TaskPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// Spin until done() or a few seconds pass, so a broken pool fails instead
+// of hanging the run
+template <typename Done>
+static bool WaitFor(Done done) {
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    while (!done()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// A worker's own tasks are taken newest first
+TEST(OwnQueueIsLifo) {
+    std::vector<int> order;
+    std::atomic<bool> done{ false };
+    {
+        TaskPool pool(1);
+        pool.Submit([&] {
+            for (int i = 1; i <= 3; ++i) {
+                pool.Submit([&, i] {
+                    order.push_back(i);
+                    if (order.size() == 3) done = true;
+                });
+            }
+        });
+        CHECK(WaitFor([&] { return done.load(); }));
+    }
+    CHECK((order == std::vector<int>{ 3, 2, 1 }));
+}
+
+// Tasks a busy worker queued for itself are run by the idle ones
+TEST(IdleWorkersSteal) {
+    const int count = 64;
+    std::atomic<int> run{ 0 };
+    std::atomic<bool> stolen{ false };
+    std::atomic<bool> finished{ false };
+    TaskPool pool(4);
+    pool.Submit([&] {
+        std::thread::id owner = std::this_thread::get_id();
+        for (int i = 0; i < count; ++i) {
+            pool.Submit([&, owner] {
+                if (std::this_thread::get_id() != owner) stolen = true;
+                ++run;
+            });
+        }
+        // Stay busy: only a thief can run the queued tasks now
+        finished = WaitFor([&] { return run.load() == count; });
+    });
+    CHECK(WaitFor([&] { return run.load() == count; }));
+    CHECK(stolen.load());
+    CHECK(WaitFor([&] { return finished.load(); }));
+}
+
+TEST(TasksSpreadAcrossWorkers) {
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<int> waiting{ 0 };
+    TaskPool pool(3);
+    {
+        TaskGroup group(pool);
+        for (int i = 0; i < 3; ++i) {
+            group.Run([&] {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    threads.insert(std::this_thread::get_id());
+                }
+                // Hold each worker until all three have a task
+                ++waiting;
+                WaitFor([&] { return waiting.load() >= 3; });
+            });
+        }
+    }
+    CHECK(threads.size() >= 2);
+}
+
+// Destroying the pool runs what is still queued, then joins
+TEST(ShutdownDrainsQueuedTasks) {
+    std::atomic<int> run{ 0 };
+    {
+        TaskPool pool(2);
+        for (int i = 0; i < 1000; ++i) {
+            pool.Submit([&] { ++run; });
+        }
+    }
+    CHECK_EQ(run.load(), 1000);
+}
+
+TEST(IdlePoolShutsDownPromptly) {
+    Clock::time_point start = Clock::now();
+    {
+        TaskPool pool(4);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    CHECK(Clock::now() - start < std::chrono::seconds(1));
+}
+
+// Wait() covers tasks the group's tasks added to it
+TEST(GroupWaitsForChainedTasks) {
+    std::atomic<int> run{ 0 };
+    TaskPool pool(2);
+    TaskGroup group(pool);
+    for (int i = 0; i < 8; ++i) {
+        group.Run([&] {
+            ++run;
+            group.Run([&] {
+                ++run;
+                group.Run([&] { ++run; });
+            });
+        });
+    }
+    group.Wait();
+    CHECK_EQ(run.load(), 24);
+}
+
+// With every worker blocked, the waiting thread runs the group itself
+TEST(GroupWaitHelps) {
+    std::atomic<bool> blocked{ false };
+    std::atomic<bool> release{ false };
+    std::atomic<int> run{ 0 };
+    TaskPool pool(1);
+    pool.Submit([&] {
+        blocked = true;
+        WaitFor([&] { return release.load(); });
+    });
+    CHECK(WaitFor([&] { return blocked.load(); }));
+    {
+        TaskGroup group(pool);
+        for (int i = 0; i < 10; ++i) {
+            group.Run([&] { ++run; });
+        }
+        group.Wait();
+        CHECK_EQ(run.load(), 10);
+    }
+    release = true;
+}
+
+// Every index runs exactly once, across the pool and the calling thread
+TEST(ParallelForCoversEveryIndex) {
+    TaskPool pool(4);
+    for (size_t grain : { size_t(1), size_t(7), size_t(64), size_t(5000) }) {
+        std::vector<std::atomic<int>> hits(1000);
+        pool.ParallelFor(0, hits.size(), grain, [&](size_t i) { ++hits[i]; });
+        int wrong = 0;
+        for (const std::atomic<int>& hit : hits) {
+            if (hit.load() != 1) ++wrong;
+        }
+        CHECK_EQ(wrong, 0);
+    }
+
+    int calls = 0;
+    pool.ParallelFor(10, 10, 1, [&](size_t) { ++calls; });
+    pool.ParallelFor(10, 3, 1, [&](size_t) { ++calls; });
+    CHECK_EQ(calls, 0);
+}
+
+// A chunk may run its own parallel loop; the waiting worker helps
+TEST(ParallelForNests) {
+    TaskPool pool(2);
+    std::atomic<int> run{ 0 };
+    pool.ParallelFor(0, 8, 1, [&](size_t) {
+        pool.ParallelFor(0, 100, 10, [&](size_t) { ++run; });
+    });
+    CHECK_EQ(run.load(), 800);
+}
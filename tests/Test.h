@@ -0,0 +1,55 @@
+#pragma once
+#ifndef TEST_H
+#define TEST_H
+
+#include <string>
+
+// Minimal test harness: each tests/*Tests.cpp is linked with TestMain.cpp
+// into one executable that runs its TESTs in order and exits non-zero if a
+// CHECK failed. A failed CHECK reports and lets the test go on.
+class Test {
+public:
+    typedef void (*Function)();
+    static void Register(const char* name, Function function);
+    static void Fail(const char* file, int line, const std::string& message);
+};
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, Test::Function function) { Test::Register(name, function); }
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) Test::Fail(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+// Compares with ==; shows both values when they print with std::to_string
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto checkActual = (actual); \
+        auto checkExpected = (expected); \
+        if (!(checkActual == checkExpected)) { \
+            Test::Fail(__FILE__, __LINE__, std::string(#actual " == " #expected) + \
+                TestDescribe(checkActual, checkExpected)); \
+        } \
+    } while (0)
+
+template <typename A, typename B>
+std::string TestDescribe(const A& actual, const B& expected) {
+    if constexpr (requires { std::to_string(actual); std::to_string(expected); }) {
+        return " (" + std::to_string(actual) + " vs " + std::to_string(expected) + ")";
+    }
+    else if constexpr (requires { std::string(actual); std::string(expected); }) {
+        return " (\"" + std::string(actual) + "\" vs \"" + std::string(expected) + "\")";
+    }
+    else {
+        return std::string();
+    }
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+struct TestEntry {
+    const char* name;
+    Test::Function function;
+};
+
+static std::vector<TestEntry>& Entries() {
+    static std::vector<TestEntry> entries;
+    return entries;
+}
+
+static int g_failures = 0;
+
+void Test::Register(const char* name, Function function) {
+    Entries().push_back({ name, function });
+}
+
+void Test::Fail(const char* file, int line, const std::string& message) {
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, message.c_str());
+    ++g_failures;
+}
+
+// usage: <tests> [name]   runs every test, or only the one named
+int main(int argc, char** argv) {
+    int run = 0;
+    int failed = 0;
+    for (const TestEntry& entry : Entries()) {
+        if (argc > 1 && strcmp(argv[1], entry.name) != 0) continue;
+        int before = g_failures;
+        entry.function();
+        ++run;
+        if (g_failures != before) ++failed;
+        fprintf(stderr, "%-40s %s\n", entry.name, g_failures == before ? "ok" : "FAILED");
+    }
+    fprintf(stderr, "%d of %d tests passed\n", run - failed, run);
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#include "Test.h"
+#include "Trace.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+// Events named name in a fresh flush
+static size_t FlushedEvents(const char* name) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "ticker_trace_tests.json";
+    CHECK(Trace::Flush(path.wstring()));
+    std::ifstream file(path, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+
+    std::string quoted = std::string("\"name\":\"") + name + "\"";
+    size_t count = 0;
+    for (size_t at = text.find(quoted); at != std::string::npos; at = text.find(quoted, at + 1)) ++count;
+    return count;
+}
+
+static void TraceOnNewThread(const char* name) {
+    std::thread([name] {
+        Trace::Complete("test", name, Trace::NowMicros(), 1);
+    }).join();
+}
+
+// A thread's events stay in the trace after it exits
+TEST(ExitedThreadsEventsAreFlushed) {
+    Trace::Enable(true);
+    TraceOnNewThread("exited");
+    CHECK_EQ(FlushedEvents("exited"), size_t(1));
+    Trace::Enable(false);
+}
+
+// Threads that come and go share the buffers of the ones before them
+// rather than each leaving one behind
+TEST(ExitedThreadsBuffersAreReused) {
+    Trace::Enable(true);
+    for (int i = 0; i < 20; ++i) {
+        TraceOnNewThread("reused");
+    }
+    CHECK_EQ(FlushedEvents("reused"), size_t(1));
+    Trace::Enable(false);
+}
+
+TEST(NothingIsRecordedWhileOff) {
+    Trace::Enable(false);
+    TraceOnNewThread("off");
+    {
+        TRACE_SCOPE("test", "off");
+    }
+    CHECK_EQ(FlushedEvents("off"), size_t(0));
+}
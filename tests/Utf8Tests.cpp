@@ -0,0 +1,68 @@
+#include "Test.h"
+#include "Price.h"
+#include "TapeTemplate.h"
+#include "Utf8.h"
+
+#include <string>
+
+// Lengths around the 16 character blocks of the ASCII fast path
+TEST(AsciiRoundTrip) {
+    for (size_t length = 0; length <= 40; ++length) {
+        std::string text;
+        for (size_t i = 0; i < length; ++i) text += static_cast<char>(' ' + (i * 7) % 95);
+        std::wstring wide = Utf8::ToWide(text);
+        CHECK_EQ(wide.size(), length);
+        for (size_t i = 0; i < length && i < wide.size(); ++i) {
+            CHECK_EQ(static_cast<int>(wide[i]), static_cast<int>(text[i]));
+        }
+        CHECK(Utf8::FromWide(wide) == text);
+        CHECK_EQ(Utf8::Utf16Length(text), length);
+    }
+}
+
+// Non-ASCII text after an ASCII prefix longer than one block, up to a pair
+// of surrogates
+TEST(MixedTextRoundTrip) {
+    const std::string text = "ABCDEFGHIJKLMNOPQ \xC3\xA9 \xE2\x82\xAC \xF0\x9F\x93\x88 Z";
+    std::wstring wide = Utf8::ToWide(text);
+    const wchar_t expected[] = { L'A', L'B', L'C', L'D', L'E', L'F', L'G', L'H', L'I', L'J', L'K', L'L',
+        L'M', L'N', L'O', L'P', L'Q', L' ', 0xE9, L' ', 0x20AC, L' ', 0xD83D, 0xDCC8, L' ', L'Z' };
+    CHECK(wide == std::wstring(expected, sizeof(expected) / sizeof(expected[0])));
+    CHECK_EQ(Utf8::Utf16Length(text), wide.size());
+    CHECK(Utf8::FromWide(wide) == text);
+}
+
+TEST(AppendKeepsExistingText) {
+    std::wstring wide = L"x";
+    Utf8::AppendWide("\xE2\x82\xAC" "1", wide);
+    CHECK(wide == std::wstring(L"x\x20AC" L"1"));
+
+    std::string utf8 = "y";
+    Utf8::AppendUtf8(L"\x20AC" L"2", utf8);
+    CHECK(utf8 == "y\xE2\x82\xAC" "2");
+}
+
+TEST(InvalidUtf8BecomesReplacement) {
+    // Stray continuation, overlong form, encoded surrogate, truncated sequence
+    CHECK(Utf8::ToWide("a\x80" "b") == std::wstring(L"a\xFFFD" L"b"));
+    CHECK(Utf8::ToWide("\xC0\xAF") == std::wstring(L"\xFFFD\xFFFD"));
+    CHECK(Utf8::ToWide("\xED\xA0\x80") == std::wstring(L"\xFFFD"));
+    CHECK(Utf8::ToWide("z\xE2\x82") == std::wstring(L"z\xFFFD"));
+}
+
+TEST(LoneSurrogateBecomesReplacement) {
+    const wchar_t high[] = { L'a', 0xD83D, L'b' };
+    CHECK(Utf8::FromWide(std::wstring_view(high, 3)) == "a\xEF\xBF\xBD" "b");
+    const wchar_t low[] = { 0xDCC8 };
+    CHECK(Utf8::FromWide(std::wstring_view(low, 1)) == "\xEF\xBF\xBD");
+}
+
+// The tape text stays UTF-8 from the template to the render snapshot
+TEST(TemplateFormatsUtf8) {
+    TapeTemplate format;
+    CHECK(format.Compile(L"{sym} \x20AC{price:.2} \x2191"));
+    std::string out;
+    format.Format("\xC3\x85" "BC", Price::FromUnits(1234, 1), Price(), false, out);
+    CHECK(out == "\xC3\x85" "BC \xE2\x82\xAC" "123.40 \xE2\x86\x91");
+    CHECK(Utf8::ToWide(out) == std::wstring(L"\x00C5" L"BC \x20AC" L"123.40 \x2191"));
+}